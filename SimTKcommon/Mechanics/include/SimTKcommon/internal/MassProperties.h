@@ -438,10 +438,11 @@ static bool isValidInertiaMatrix(const SymMat<3,P>& m) {
         return false;               // must satisfy triangle inequality
 
     // Thanks to Paul Mitiguy for this condition on products of inertia.
+    using std::abs;
     const Vec<3,P>& p = m.getLower();
-    if (!( d[0]+Slop>=std::abs(2*p[2])
-        && d[1]+Slop>=std::abs(2*p[1])
-        && d[2]+Slop>=std::abs(2*p[0])))
+    if (!( d[0]+Slop>=abs(2*p[2])
+        && d[1]+Slop>=abs(2*p[1])
+        && d[2]+Slop>=abs(2*p[0])))
         return false;               // max products are limited by moments
 
     return true;
@@ -536,8 +537,9 @@ void errChk(const char* methodName) const {
     // TODO: This is looser than it should be as a workaround for distorted
     // rotation matrices that were produced by an 11,000 body chain that
     // Sam Flores encountered. 
+    using std::sqrt; using std::abs; // or P's own, for P=Dual
     const P Slop = std::max(d.sum(),P(1))
-                       * std::sqrt(NTraits<P>::getEps());
+                       * sqrt(NTraits<P>::getEps());
 
     SimTK_ERRCHK3(   Ixx+Iyy+Slop>=Izz 
                   && Ixx+Izz+Slop>=Iyy 
@@ -548,9 +550,9 @@ void errChk(const char* methodName) const {
         (double)Ixx,(double)Iyy,(double)Izz);
 
     // Thanks to Paul Mitiguy for this condition on products of inertia.
-    SimTK_ERRCHK(   Ixx+Slop>=std::abs(2*Iyz) 
-                 && Iyy+Slop>=std::abs(2*Ixz)
-                 && Izz+Slop>=std::abs(2*Ixy),
+    SimTK_ERRCHK(   Ixx+Slop>=abs(2*Iyz) 
+                 && Iyy+Slop>=abs(2*Ixz)
+                 && Izz+Slop>=abs(2*Ixy),
         methodName,
         "The magnitude of a product of inertia was too large to be physical.");
 #endif
@@ -170,11 +170,13 @@ Rotation_& setRotationFromAngleAboutAxis(RealP angle, const CoordinateAxis& axis
 /** Constructor for right-handed rotation by an angle (in radians) about the 
 X-axis. **/
 Rotation_( RealP angle, const CoordinateAxis::XCoordinateAxis )  
-{ setRotationFromAngleAboutX( std::cos(angle), std::sin(angle) ); }
+{   using std::sin; using std::cos;
+    setRotationFromAngleAboutX( cos(angle), sin(angle) ); }
 /** Set this Rotation_ object to a right-handed rotation by an angle (in 
 radians) about the X-axis. **/
 Rotation_&  setRotationFromAngleAboutX( RealP angle )  
-{ return setRotationFromAngleAboutX( std::cos(angle), std::sin(angle) ); }
+{   using std::sin; using std::cos;
+    return setRotationFromAngleAboutX( cos(angle), sin(angle) ); }
 /** Set this Rotation_ object to a right-handed rotation by an angle about the
 X-axis, where the cosine and sine of the angle are specified. **/
 Rotation_&  setRotationFromAngleAboutX( RealP cosAngle, RealP sinAngle )  
@@ -185,11 +187,13 @@ Rotation_&  setRotationFromAngleAboutX( RealP cosAngle, RealP sinAngle )
 /** Constructor for right-handed rotation by an angle (in radians) about the 
 Y-axis. **/
 Rotation_( RealP angle, const CoordinateAxis::YCoordinateAxis )  
-{ setRotationFromAngleAboutY( std::cos(angle), std::sin(angle) ); }
+{   using std::sin; using std::cos;
+    setRotationFromAngleAboutY( cos(angle), sin(angle) ); }
 /** Set this Rotation_ object to a right-handed rotation by an angle (in 
 radians) about the Y-axis. **/
 Rotation_&  setRotationFromAngleAboutY( RealP angle )  
-{ return setRotationFromAngleAboutY( std::cos(angle), std::sin(angle) ); }
+{   using std::sin; using std::cos;
+    return setRotationFromAngleAboutY( cos(angle), sin(angle) ); }
 /** Set this Rotation_ object to a right-handed rotation by an angle about the
 Y-axis, where the cosine and sine of the angle are specified. **/
 Rotation_&  setRotationFromAngleAboutY( RealP cosAngle, RealP sinAngle )  
@@ -200,11 +204,13 @@ Rotation_&  setRotationFromAngleAboutY( RealP cosAngle, RealP sinAngle )
 /** Constructor for right-handed rotation by an angle (in radians) about the 
 Z-axis. **/
 Rotation_( RealP angle, const CoordinateAxis::ZCoordinateAxis )  
-{ setRotationFromAngleAboutZ( std::cos(angle), std::sin(angle) ); }
+{   using std::sin; using std::cos;
+    setRotationFromAngleAboutZ( cos(angle), sin(angle) ); }
 /** Set this Rotation_ object to a right-handed rotation by an angle (in 
 radians) about the Z-axis. **/
 Rotation_&  setRotationFromAngleAboutZ( RealP angle )  
-{ return setRotationFromAngleAboutZ( std::cos(angle), std::sin(angle) ); }
+{   using std::sin; using std::cos;
+    return setRotationFromAngleAboutZ( cos(angle), sin(angle) ); }
 /** Set this Rotation_ object to a right-handed rotation by an angle about the
 Z-axis, where the cosine and sine of the angle are specified. **/
 Rotation_&  setRotationFromAngleAboutZ( RealP cosAngle, RealP sinAngle )  
@@ -509,11 +515,12 @@ matrix will be singular if Y (q[1]) gets near 90 degrees!
 Cost: about 100 flops for sin/cos plus 12 to calculate N_B.
 @see Kane's Spacecraft Dynamics, page 427, body-three: 1-2-3. **/
 static Mat33P calcNForBodyXYZInBodyFrame(const Vec3P& q) {
+    using std::sin; using std::cos;
     // Note: q[0] is not referenced so we won't waste time calculating
     // its cosine and sine here.
     return calcNForBodyXYZInBodyFrame
-        (Vec3P(0, std::cos(q[1]), std::cos(q[2])),
-        Vec3P(0, std::sin(q[1]), std::sin(q[2])));
+        (Vec3P(0, cos(q[1]), cos(q[2])),
+        Vec3P(0, sin(q[1]), sin(q[2])));
 }
 
 /** This faster version of calcNForBodyXYZInBodyFrame() assumes you have 
@@ -543,11 +550,12 @@ N_P = N_B*~R_PB. This matrix will be singular if Y (q[1]) gets near 90 degrees!
 
 Cost: about 100 flops for sin/cos plus 12 to calculate N_P. **/
 static Mat33P calcNForBodyXYZInParentFrame(const Vec3P& q) {
+    using std::sin; using std::cos;
     // Note: q[2] is not referenced so we won't waste time calculating
     // its cosine and sine here.
     return calcNForBodyXYZInParentFrame
-        (Vec3P(std::cos(q[0]), std::cos(q[1]), 0),
-        Vec3P(std::sin(q[0]), std::sin(q[1]), 0));
+        (Vec3P(cos(q[0]), cos(q[1]), 0),
+        Vec3P(sin(q[0]), sin(q[1]), 0));
 }
 
 /** This faster version of calcNForBodyXYZInParentFrame() assumes you have 
@@ -578,11 +586,12 @@ we're differentiating here.
       of this method. **/
 static Mat33P calcNDotForBodyXYZInBodyFrame
    (const Vec3P& q, const Vec3P& qdot) {
+    using std::sin; using std::cos;
     // Note: q[0] is not referenced so we won't waste time calculating
     // its cosine and sine here.
     return calcNDotForBodyXYZInBodyFrame
-        (Vec3P(0, std::cos(q[1]), std::cos(q[2])),
-        Vec3P(0, std::sin(q[1]), std::sin(q[2])),
+        (Vec3P(0, cos(q[1]), cos(q[2])),
+        Vec3P(0, sin(q[1]), sin(q[2])),
         qdot);
 }
 
@@ -619,12 +628,13 @@ we're differentiating here.
       of this method. **/
 static Mat33P calcNDotForBodyXYZInParentFrame
    (const Vec3P& q, const Vec3P& qdot) {
+    using std::sin; using std::cos;
     // Note: q[2] is not referenced so we won't waste time calculating
     // its cosine and sine here.
-    const RealP cy = std::cos(q[1]); // cos(y)
+    const RealP cy = cos(q[1]); // cos(y)
     return calcNDotForBodyXYZInParentFrame
-        (Vec2P(std::cos(q[0]), cy), 
-        Vec2P(std::sin(q[0]), std::sin(q[1])),
+        (Vec2P(cos(q[0]), cy), 
+        Vec2P(sin(q[0]), sin(q[1])),
         1/cy, qdot);
 }
 
@@ -655,11 +665,12 @@ never singular.
       and cosines. If you already have those, use the alternate form
       of this method. **/
 static Mat33P calcNInvForBodyXYZInBodyFrame(const Vec3P& q) {
+    using std::sin; using std::cos;
     // Note: q[0] is not referenced so we won't waste time calculating
     // its cosine and sine here.
     return calcNInvForBodyXYZInBodyFrame
-       (Vec3P(0, std::cos(q[1]), std::cos(q[2])),
-        Vec3P(0, std::sin(q[1]), std::sin(q[2])));
+       (Vec3P(0, cos(q[1]), cos(q[2])),
+        Vec3P(0, sin(q[1]), sin(q[2])));
 }
 
 /** This faster version of calcNInvForBodyXYZInBodyFrame() assumes you have
@@ -684,11 +695,12 @@ NInv_P=R_PB*NInv_B. This matrix is never singular.
       and cosines. If you already have those, use the alternate form
       of this method. **/
 static Mat33P calcNInvForBodyXYZInParentFrame(const Vec3P& q) {
+    using std::sin; using std::cos;
     // Note: q[0] is not referenced so we won't waste time calculating
     // its cosine and sine here.
     return calcNInvForBodyXYZInParentFrame
-       (Vec3P(std::cos(q[0]), std::cos(q[1]), 0),
-        Vec3P(std::sin(q[0]), std::sin(q[1]), 0));
+       (Vec3P(cos(q[0]), cos(q[1]), 0),
+        Vec3P(sin(q[0]), sin(q[1]), 0));
 }
 
 /** This faster version of calcNInvForBodyXYZInParentFrame() assumes you have 
@@ -849,8 +861,9 @@ angular velocity vector of B in the parent frame, *BUT EXPRESSED IN THE BODY
 FRAME*, return the Euler angle derivatives. You are dead if q[1] gets near 
 90 degrees! See Kane's Spacecraft Dynamics, page 428, body-three: 3-2-1. **/
 static Vec3P convertAngVelToBodyFixed321Dot(const Vec3P& q, const Vec3P& w_PB_B) {
-    const RealP s1 = std::sin(q[1]), c1 = std::cos(q[1]);
-    const RealP s2 = std::sin(q[2]), c2 = std::cos(q[2]);
+    using std::sin; using std::cos;
+    const RealP s1 = sin(q[1]), c1 = cos(q[1]);
+    const RealP s2 = sin(q[2]), c2 = cos(q[2]);
     const RealP ooc1 = RealP(1)/c1;
     const RealP s2oc1 = s2*ooc1, c2oc1 = c2*ooc1;
 
@@ -863,8 +876,9 @@ static Vec3P convertAngVelToBodyFixed321Dot(const Vec3P& q, const Vec3P& w_PB_B)
 /** Inverse of convertAngVelToBodyFixed321Dot. Returned angular velocity is B in
 P, expressed in *B*: w_PB_B. **/
 static Vec3P convertBodyFixed321DotToAngVel(const Vec3P& q, const Vec3P& qd) {
-    const RealP s1 = std::sin(q[1]), c1 = std::cos(q[1]);
-    const RealP s2 = std::sin(q[2]), c2 = std::cos(q[2]);
+    using std::sin; using std::cos;
+    const RealP s1 = sin(q[1]), c1 = cos(q[1]);
+    const RealP s2 = sin(q[2]), c2 = cos(q[2]);
 
     const Mat33P Einv(  -s1  ,  0  ,  1 ,
                         c1*s2 ,  c2 ,  0 ,
@@ -880,8 +894,9 @@ static Vec3P convertBodyFixed321DotToAngVel(const Vec3P& q, const Vec3P& qd) {
 static Vec3P convertAngVelDotToBodyFixed321DotDot
     (const Vec3P& q, const Vec3P& w_PB_B, const Vec3P& wdot_PB_B)
 {
-    const RealP s1 = std::sin(q[1]), c1 = std::cos(q[1]);
-    const RealP s2 = std::sin(q[2]), c2 = std::cos(q[2]);
+    using std::sin; using std::cos;
+    const RealP s1 = sin(q[1]), c1 = cos(q[1]);
+    const RealP s2 = sin(q[2]), c2 = cos(q[2]);
     const RealP ooc1  = 1/c1;
     const RealP s2oc1 = s2*ooc1, c2oc1 = c2*ooc1, s1oc1 = s1*ooc1;
 
@@ -911,9 +926,10 @@ derivatives. You are dead if q[1] gets near 90 degrees!
 @see Kane's Spacecraft Dynamics, page 427, body-three: 1-2-3. **/
 static Vec3P convertAngVelInBodyFrameToBodyXYZDot
     (const Vec3P& q, const Vec3P& w_PB_B) {  
+    using std::sin; using std::cos;
     return convertAngVelInBodyFrameToBodyXYZDot
-        (Vec3P(0, std::cos(q[1]), std::cos(q[2])),
-        Vec3P(0, std::sin(q[1]), std::sin(q[2])),
+        (Vec3P(0, cos(q[1]), cos(q[2])),
+        Vec3P(0, sin(q[1]), sin(q[2])),
         w_PB_B); 
 }
 
@@ -934,9 +950,10 @@ expressed in *B*: w_PB_B.
       of this method. **/
 static Vec3P convertBodyXYZDotToAngVelInBodyFrame
    (const Vec3P& q, const Vec3P& qdot) {   
+        using std::sin; using std::cos;
         return convertBodyXYZDotToAngVelInBodyFrame
-                   (Vec3P(0, std::cos(q[1]), std::cos(q[2])),
-                    Vec3P(0, std::sin(q[1]), std::sin(q[2])),
+                   (Vec3P(0, cos(q[1]), cos(q[2])),
+                    Vec3P(0, sin(q[1]), sin(q[2])),
                     qdot); 
 }
 
@@ -959,11 +976,12 @@ Caution: needs testing. **/
 static Vec3P convertAngVelDotInBodyFrameToBodyXYZDotDot
    (const Vec3P& q, const Vec3P& w_PB_B, const Vec3P& wdot_PB_B)
 {
+    using std::sin; using std::cos;
     // Note: q[0] is not referenced so we won't waste time calculating
     // its cosine and sine here.
     return convertAngVelDotInBodyFrameToBodyXYZDotDot
-               (Vec3P(0, std::cos(q[1]), std::cos(q[2])),
-                Vec3P(0, std::sin(q[1]), std::sin(q[2])),
+               (Vec3P(0, cos(q[1]), cos(q[2])),
+                Vec3P(0, sin(q[1]), sin(q[2])),
                 w_PB_B, wdot_PB_B);
 }
 
@@ -1077,9 +1095,10 @@ bool isSameRotationToWithinAngleOfMachinePrecision(const Rotation_& R) const
 /** Returns maximum absolute difference between elements in "this" Rotation and
 elements in "R". **/
 RealP getMaxAbsDifferenceInRotationElements( const Rotation_& R ) const {            
+    using std::abs;
     const Mat33P& A=asMat33(); const Mat33P& B=R.asMat33(); RealP maxDiff=0;  
     for( int i=0;  i<=2; i++ ) for( int j=0; j<=2; j++ ) {
-        const RealP absDiff = std::abs(A[i][j] - B[i][j]);  
+        const RealP absDiff = abs(A[i][j] - B[i][j]);  
         if( absDiff > maxDiff ) maxDiff = absDiff; 
     }
     return maxDiff; 
@@ -38,6 +38,7 @@ namespace SimTK {
 // Instantiate so we catch bugs now.
 template class Inertia_<float>;
 template class Inertia_<double>;
+template class Inertia_<Dual>;
 
     /////////////////////////
     //     UNIT INERTIA    //
@@ -46,6 +47,7 @@ template class Inertia_<double>;
 // Instantiate so we catch bugs now.
 template class UnitInertia_<float>;
 template class UnitInertia_<double>;
+template class UnitInertia_<Dual>;
 
     /////////////////////////
     //   MASS PROPERTIES   //
@@ -54,6 +56,7 @@ template class UnitInertia_<double>;
 // Instantiate so we catch bugs now.
 template class MassProperties_<float>;
 template class MassProperties_<double>;
+template class MassProperties_<Dual>;
 
     /////////////////////////
     //   SPATIAL INERTIA   //
@@ -62,6 +65,7 @@ template class MassProperties_<double>;
 // Instantiate so we catch bugs now.
 template class SpatialInertia_<float>;
 template class SpatialInertia_<double>;
+template class SpatialInertia_<Dual>;
 
     /////////////////////////
     // ARTICULATED INERTIA //
@@ -139,6 +143,7 @@ ArticulatedInertia_<P>::shiftInPlace(const Vec3P& s) {
 // Instantiate so we catch bugs now.
 template class ArticulatedInertia_<float>;
 template class ArticulatedInertia_<double>;
+template class ArticulatedInertia_<Dual>;
 
 
 
@@ -36,8 +36,10 @@ namespace SimTK {
 // instantiate some broken method.
 template class Transform_<float>;
 template class Transform_<double>;
+template class Transform_<Dual>;
 template class InverseTransform_<float>;
 template class InverseTransform_<double>;
+template class InverseTransform_<Dual>;
 
 
 // Define the stream output operators and instantiate them for float and
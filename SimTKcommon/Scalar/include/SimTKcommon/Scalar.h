@@ -41,6 +41,7 @@
 #include "SimTKcommon/internal/CompositeNumericalTypes.h"
 #include "SimTKcommon/internal/NTraits.h"
 #include "SimTKcommon/internal/negator.h"
+#include "SimTKcommon/internal/Dual.h"
 
 #include <complex>
 #include <cmath>
@@ -0,0 +1,413 @@
+#ifndef SimTK_SIMMATRIX_DUAL_H_
+#define SimTK_SIMMATRIX_DUAL_H_
+
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/** @file
+ * This file defines the Dual_<R> template, a dual number used for forward-mode
+ * automatic differentiation, and the NTraits and CNT specializations that
+ * allow it to be used as the element type of the SimTK small matrix classes
+ * Vec, Row, Mat and SymMat, and of the Rotation_, Transform_ and
+ * MassProperties_ templates built on them.
+ *
+ * A dual number a + b*e, with e*e == 0, carries a value a together with the
+ * derivative b of that value with respect to some seed variable. Arithmetic on
+ * dual numbers propagates the derivative exactly by the chain rule, so code
+ * written for a generic scalar type, evaluated with the seed variable's
+ * derivative set to one, produces the exact derivative of its result without
+ * finite differencing.
+ *
+ * Only real dual numbers are supported; there is no complex or conjugate dual.
+ * Comparisons look at the value only, so branches taken by templatized code
+ * are the same ones it would take when evaluated with plain reals.
+ */
+
+#include "SimTKcommon/internal/common.h"
+#include "SimTKcommon/internal/NTraits.h"
+#include "SimTKcommon/internal/negator.h"
+
+#include <cmath>
+#include <limits>
+#include <iostream>
+
+namespace SimTK {
+
+/** A dual number of real precision R (float or double), holding a value and
+its derivative with respect to a single seed variable. Use the typedef Dual
+for the default precision Real. Mathematical functions (sqrt, sin, atan2,
+etc.) are found by argument-dependent lookup, so templatized code should call
+them unqualified after a using-declaration for the std:: version, for example
+@code
+    using std::sin; using std::cos;
+    const P s = sin(angle), c = cos(angle); // works for P=Real and P=Dual
+@endcode **/
+template <class R>
+class Dual_ {
+public:
+    /** Default construction gives a dual number with zero value and zero
+    derivative. **/
+    Dual_() : v(0), d(0) {}
+    /** Implicit conversion from a real constant, whose derivative is zero. **/
+    Dual_(const R& value) : v(value), d(0) {}
+    /** Create a dual number with the given value and derivative. Use a
+    derivative of 1 to seed the variable to differentiate with respect to. **/
+    Dual_(const R& value, const R& deriv) : v(value), d(deriv) {}
+
+    /** Return the value part of this dual number. **/
+    const R& value() const {return v;}
+    /** Return the derivative part of this dual number. **/
+    const R& deriv() const {return d;}
+    /** Return a writable reference to the value part. **/
+    R& updValue() {return v;}
+    /** Return a writable reference to the derivative part. **/
+    R& updDeriv() {return d;}
+    /** Explicit conversion to the value part, dropping the derivative, as
+    when formatting an error message with (double)x. **/
+    explicit operator R() const {return v;}
+
+    Dual_& operator+=(const Dual_& r) {v += r.v; d += r.d; return *this;}
+    Dual_& operator-=(const Dual_& r) {v -= r.v; d -= r.d; return *this;}
+    Dual_& operator*=(const Dual_& r) {d = d*r.v + v*r.d; v *= r.v; return *this;}
+    Dual_& operator/=(const Dual_& r)
+    {   v /= r.v; d = (d - v*r.d)/r.v; return *this; }
+
+    Dual_& operator+=(const R& r) {v += r; return *this;}
+    Dual_& operator-=(const R& r) {v -= r; return *this;}
+    Dual_& operator*=(const R& r) {v *= r; d *= r; return *this;}
+    Dual_& operator/=(const R& r) {v /= r; d /= r; return *this;}
+
+    // Arithmetic and comparison operators, and the elementary functions, are
+    // friends defined in place so that they are found only by
+    // argument-dependent lookup and never hide the std:: functions that
+    // templatized code uses for real arguments.
+
+    friend Dual_ operator+(const Dual_& a) {return a;}
+    friend Dual_ operator-(const Dual_& a) {return Dual_(-a.v, -a.d);}
+
+    friend Dual_ operator+(const Dual_& a, const Dual_& b)
+    {   return Dual_(a.v+b.v, a.d+b.d); }
+    friend Dual_ operator+(const Dual_& a, const R& b)
+    {   return Dual_(a.v+b, a.d); }
+    friend Dual_ operator+(const R& a, const Dual_& b)
+    {   return Dual_(a+b.v, b.d); }
+
+    friend Dual_ operator-(const Dual_& a, const Dual_& b)
+    {   return Dual_(a.v-b.v, a.d-b.d); }
+    friend Dual_ operator-(const Dual_& a, const R& b)
+    {   return Dual_(a.v-b, a.d); }
+    friend Dual_ operator-(const R& a, const Dual_& b)
+    {   return Dual_(a-b.v, -b.d); }
+
+    friend Dual_ operator*(const Dual_& a, const Dual_& b)
+    {   return Dual_(a.v*b.v, a.d*b.v + a.v*b.d); }
+    friend Dual_ operator*(const Dual_& a, const R& b)
+    {   return Dual_(a.v*b, a.d*b); }
+    friend Dual_ operator*(const R& a, const Dual_& b)
+    {   return Dual_(a*b.v, a*b.d); }
+
+    friend Dual_ operator/(const Dual_& a, const Dual_& b)
+    {   const R q = a.v/b.v; return Dual_(q, (a.d - q*b.d)/b.v); }
+    friend Dual_ operator/(const Dual_& a, const R& b)
+    {   return Dual_(a.v/b, a.d/b); }
+    friend Dual_ operator/(const R& a, const Dual_& b)
+    {   const R q = a/b.v; return Dual_(q, -q*b.d/b.v); }
+
+    friend bool operator==(const Dual_& a, const Dual_& b) {return a.v==b.v;}
+    friend bool operator!=(const Dual_& a, const Dual_& b) {return a.v!=b.v;}
+    friend bool operator< (const Dual_& a, const Dual_& b) {return a.v< b.v;}
+    friend bool operator> (const Dual_& a, const Dual_& b) {return a.v> b.v;}
+    friend bool operator<=(const Dual_& a, const Dual_& b) {return a.v<=b.v;}
+    friend bool operator>=(const Dual_& a, const Dual_& b) {return a.v>=b.v;}
+
+    friend Dual_ sqrt(const Dual_& a)
+    {   const R s = std::sqrt(a.v); return Dual_(s, a.d/(2*s)); }
+    friend Dual_ abs(const Dual_& a) {return a.v < 0 ? -a : a;}
+    friend Dual_ fabs(const Dual_& a) {return a.v < 0 ? -a : a;}
+    friend Dual_ exp(const Dual_& a)
+    {   const R e = std::exp(a.v); return Dual_(e, e*a.d); }
+    friend Dual_ log(const Dual_& a) {return Dual_(std::log(a.v), a.d/a.v);}
+    friend Dual_ pow(const Dual_& a, const R& p)
+    {   return Dual_(std::pow(a.v,p), p*std::pow(a.v,p-1)*a.d); }
+    friend Dual_ sin(const Dual_& a)
+    {   return Dual_(std::sin(a.v), std::cos(a.v)*a.d); }
+    friend Dual_ cos(const Dual_& a)
+    {   return Dual_(std::cos(a.v), -std::sin(a.v)*a.d); }
+    friend Dual_ tan(const Dual_& a)
+    {   const R t = std::tan(a.v); return Dual_(t, (1+t*t)*a.d); }
+    friend Dual_ asin(const Dual_& a)
+    {   return Dual_(std::asin(a.v), a.d/std::sqrt(1-a.v*a.v)); }
+    friend Dual_ acos(const Dual_& a)
+    {   return Dual_(std::acos(a.v), -a.d/std::sqrt(1-a.v*a.v)); }
+    friend Dual_ atan(const Dual_& a)
+    {   return Dual_(std::atan(a.v), a.d/(1+a.v*a.v)); }
+    friend Dual_ atan2(const Dual_& y, const Dual_& x)
+    {   return Dual_(std::atan2(y.v,x.v), (x.v*y.d - y.v*x.d)/(x.v*x.v+y.v*y.v)); }
+    friend Dual_ square(const Dual_& a) {return a*a;}
+    friend Dual_ cube(const Dual_& a) {return a*a*a;}
+
+    /** Write a dual number as (value,derivative). **/
+    template <class CHAR, class TRAITS>
+    friend std::basic_ostream<CHAR,TRAITS>&
+    operator<<(std::basic_ostream<CHAR,TRAITS>& o, const Dual_& a)
+    {   return o << '(' << a.v << ',' << a.d << ')'; }
+
+private:
+    R v, d;
+};
+
+/** The dual number type in the default precision Real. **/
+typedef Dual_<Real> Dual;
+
+/// @addtogroup isNaN
+//@{
+template <class R> inline bool
+isNaN(const Dual_<R>& x) {return isNaN(x.value()) || isNaN(x.deriv());}
+template <class R> inline bool
+isNaN(const negator< Dual_<R> >& x) {return isNaN(-x);}
+//@}
+
+/// @addtogroup isFinite
+//@{
+template <class R> inline bool
+isFinite(const Dual_<R>& x) {return isFinite(x.value()) && isFinite(x.deriv());}
+template <class R> inline bool
+isFinite(const negator< Dual_<R> >& x) {return isFinite(-x);}
+//@}
+
+/// @addtogroup isInf
+//@{
+template <class R> inline bool
+isInf(const Dual_<R>& x)
+{   return (isInf(x.value()) && !isNaN(x.deriv()))
+        || (isInf(x.deriv()) && !isNaN(x.value())); }
+template <class R> inline bool
+isInf(const negator< Dual_<R> >& x) {return isInf(-x);}
+//@}
+
+/// @addtogroup isNumericallyEqual
+//@{
+/** Two dual numbers are numerically equal if both their values and their
+derivatives are. **/
+template <class R> inline bool
+isNumericallyEqual(const Dual_<R>& a, const Dual_<R>& b,
+                   double tol = RTraits<R>::getDefaultTolerance())
+{   return isNumericallyEqual(a.value(), b.value(), tol)
+        && isNumericallyEqual(a.deriv(), b.deriv(), tol); }
+//@}
+
+// NTraits for dual numbers. These behave like the real number types, except
+// that the Precision is the underlying real type and only operations with
+// reals of any precision or with another dual of the same precision are
+// defined.
+template <class R> class NTraits< Dual_<R> > {
+public:
+    typedef Dual_<R>         T;
+    typedef negator<T>       TNeg;
+    typedef T                TWithoutNegator;
+    typedef T                TReal;
+    typedef T                TImag;
+    typedef T                TComplex;
+    typedef T                THerm;
+    typedef T                TPosTrans;
+    typedef T                TSqHermT;
+    typedef T                TSqTHerm;
+    typedef T                TElement;
+    typedef T                TRow;
+    typedef T                TCol;
+    typedef T                TSqrt;
+    typedef T                TAbs;
+    typedef T                TStandard;
+    typedef T                TInvert;
+    typedef T                TNormalize;
+    typedef T                Scalar;
+    typedef T                ULessScalar;
+    typedef T                Number;
+    typedef T                StdNumber;
+    typedef R                Precision;
+    typedef T                ScalarNormSq;
+    template <class P> struct Result {
+        typedef typename CNT<P>::template Result<T>::Mul Mul;
+        typedef typename CNT< typename CNT<P>::THerm >::template Result<T>::Mul Dvd;
+        typedef typename CNT<P>::template Result<T>::Add Add;
+        typedef typename CNT< typename CNT<P>::TNeg >::template Result<T>::Add Sub;
+    };
+    template <class P> struct Substitute {
+        typedef P Type;
+    };
+    enum {
+        NRows               = 1,
+        NCols               = 1,
+        RowSpacing          = 1,
+        ColSpacing          = 1,
+        NPackedElements     = 1,
+        NActualElements     = 1,
+        NActualScalars      = 2,
+        ImagOffset          = 0,
+        RealStrideFactor    = 1,
+        ArgDepth            = SCALAR_DEPTH,
+        IsScalar            = 1,
+        IsULessScalar       = 1,
+        IsNumber            = 1,
+        IsStdNumber         = 1,
+        IsPrecision         = 0,
+        SignInterpretation  = 1
+    };
+    static const T* getData(const T& t) { return &t; }
+    static T*       updData(T& t)       { return &t; }
+    static const T& real(const T& t) { return t; }
+    static T&       real(T& t)       { return t; }
+    static const T& imag(const T&)   { return getZero(); }
+    static T&       imag(T&)         { assert(false); return *reinterpret_cast<T*>(0); }
+    static const TNeg& negate(const T& t) {return reinterpret_cast<const TNeg&>(t);}
+    static       TNeg& negate(T& t) {return reinterpret_cast<TNeg&>(t);}
+    static const THerm& transpose(const T& t) {return reinterpret_cast<const THerm&>(t);}
+    static       THerm& transpose(T& t) {return reinterpret_cast<THerm&>(t);}
+    static const TPosTrans& positionalTranspose(const T& t)
+        {return reinterpret_cast<const TPosTrans&>(t);}
+    static       TPosTrans& positionalTranspose(T& t)
+        {return reinterpret_cast<TPosTrans&>(t);}
+    static const TWithoutNegator& castAwayNegatorIfAny(const T& t)
+        {return reinterpret_cast<const TWithoutNegator&>(t);}
+    static       TWithoutNegator& updCastAwayNegatorIfAny(T& t)
+        {return reinterpret_cast<TWithoutNegator&>(t);}
+    static ScalarNormSq scalarNormSqr(const T& t) {return t*t;}
+    // The elementary functions are friends of Dual_ found by argument-
+    // dependent lookup, which doesn't happen here where the names sqrt()
+    // and abs() refer to these members.
+    static TSqrt sqrt(const T& t)
+    {   const R s = std::sqrt(t.value()); return T(s, t.deriv()/(2*s)); }
+    static TAbs  abs(const T& t) {return t.value() < 0 ? -t : t;}
+    static const TStandard& standardize(const T& t) {return t;}
+    static TNormalize normalize(const T& t)
+    {   return t.value()>0 ? T(1) : (t.value()<0 ? T(-1) : getNaN()); }
+    static TInvert invert(const T& t) {return T(1)/t;}
+    // Properties of the underlying floating point representation.
+    static const T& getEps()          {static const T c=RTraits<R>::getEps();                return c;}
+    static const T& getSignificant()  {static const T c=RTraits<R>::getSignificant();        return c;}
+    static const T& getNaN()          {static const T c=NTraits<R>::getNaN();                return c;}
+    static const T& getInfinity()     {static const T c=NTraits<R>::getInfinity();           return c;}
+    static const T& getLeastPositive(){static const T c=NTraits<R>::getLeastPositive();      return c;}
+    static const T& getMostPositive() {static const T c=NTraits<R>::getMostPositive();       return c;}
+    static const T& getLeastNegative(){static const T c=NTraits<R>::getLeastNegative();      return c;}
+    static const T& getMostNegative() {static const T c=NTraits<R>::getMostNegative();       return c;}
+    static const T& getSqrtEps()      {static const T c=NTraits<R>::getSqrtEps();            return c;}
+    static const T& getTiny()         {static const T c=NTraits<R>::getTiny();               return c;}
+    static bool isFinite(const T& t) {return SimTK::isFinite(t);}
+    static bool isNaN   (const T& t) {return SimTK::isNaN(t);}
+    static bool isInf   (const T& t) {return SimTK::isInf(t);}
+    // Approximate comparisons check the derivatives as well as the values;
+    // comparison with a constant requires a zero derivative.
+    static double getDefaultTolerance() {return RTraits<R>::getDefaultTolerance();}
+    static bool isNumericallyEqual(const T& t, const T& d)
+    {   return SimTK::isNumericallyEqual(t,d); }
+    static bool isNumericallyEqual(const T& t, const T& d, double tol)
+    {   return SimTK::isNumericallyEqual(t,d,tol); }
+    static bool isNumericallyEqual(const T& t, const float& f) {return isNumericallyEqual(t,T(R(f)));}
+    static bool isNumericallyEqual(const T& t, const double& d) {return isNumericallyEqual(t,T(R(d)));}
+    static bool isNumericallyEqual(const T& t, const long double& l) {return isNumericallyEqual(t,T(R(l)));}
+    static bool isNumericallyEqual(const T& t, int i) {return isNumericallyEqual(t,T(R(i)));}
+    static bool isNumericallyEqual(const T& t, const float& f, double tol){return isNumericallyEqual(t,T(R(f)),tol);}
+    static bool isNumericallyEqual(const T& t, const double& d, double tol){return isNumericallyEqual(t,T(R(d)),tol);}
+    static bool isNumericallyEqual(const T& t, const long double& l, double tol){return isNumericallyEqual(t,T(R(l)),tol);}
+    static bool isNumericallyEqual(const T& t, int i, double tol){return isNumericallyEqual(t,T(R(i)),tol);}
+    // Constants with convenient memory addresses; their derivatives are zero.
+    static const T& getZero()         {static const T c(NTraits<R>::getZero());         return c;}
+    static const T& getOne()          {static const T c(NTraits<R>::getOne());          return c;}
+    static const T& getMinusOne()     {static const T c(NTraits<R>::getMinusOne());     return c;}
+    static const T& getTwo()          {static const T c(NTraits<R>::getTwo());          return c;}
+    static const T& getThree()        {static const T c(NTraits<R>::getThree());        return c;}
+    static const T& getOneHalf()      {static const T c(NTraits<R>::getOneHalf());      return c;}
+    static const T& getOneThird()     {static const T c(NTraits<R>::getOneThird());     return c;}
+    static const T& getOneFourth()    {static const T c(NTraits<R>::getOneFourth());    return c;}
+    static const T& getOneFifth()     {static const T c(NTraits<R>::getOneFifth());     return c;}
+    static const T& getOneSixth()     {static const T c(NTraits<R>::getOneSixth());     return c;}
+    static const T& getOneSeventh()   {static const T c(NTraits<R>::getOneSeventh());   return c;}
+    static const T& getOneEighth()    {static const T c(NTraits<R>::getOneEighth());    return c;}
+    static const T& getOneNinth()     {static const T c(NTraits<R>::getOneNinth());     return c;}
+    static const T& getPi()           {static const T c(NTraits<R>::getPi());           return c;}
+    static const T& getOneOverPi()    {static const T c(NTraits<R>::getOneOverPi());    return c;}
+    static const T& getE()            {static const T c(NTraits<R>::getE());            return c;}
+    static const T& getLog2E()        {static const T c(NTraits<R>::getLog2E());        return c;}
+    static const T& getLog10E()       {static const T c(NTraits<R>::getLog10E());       return c;}
+    static const T& getSqrt2()        {static const T c(NTraits<R>::getSqrt2());        return c;}
+    static const T& getOneOverSqrt2() {static const T c(NTraits<R>::getOneOverSqrt2()); return c;}
+    static const T& getSqrt3()        {static const T c(NTraits<R>::getSqrt3());        return c;}
+    static const T& getOneOverSqrt3() {static const T c(NTraits<R>::getOneOverSqrt3()); return c;}
+    static const T& getCubeRoot2()    {static const T c(NTraits<R>::getCubeRoot2());    return c;}
+    static const T& getCubeRoot3()    {static const T c(NTraits<R>::getCubeRoot3());    return c;}
+    static const T& getLn2()          {static const T c(NTraits<R>::getLn2());          return c;}
+    static const T& getLn10()         {static const T c(NTraits<R>::getLn10());         return c;}
+    static int getNumDigits()         {return NTraits<R>::getNumDigits();}
+    static int getLosslessNumDigits() {return NTraits<R>::getLosslessNumDigits();}
+};
+
+// A dual number combined with a real of any precision, or with another dual
+// of the same precision, is a dual of its own precision.
+#define SimTK_NTRAITS_DUAL_SPEC(R,P) \
+template<> template<> struct NTraits< Dual_<R> >::Result<P> \
+  {typedef Dual_<R> Mul;typedef Mul Dvd;typedef Mul Add;typedef Mul Sub;}
+SimTK_NTRAITS_DUAL_SPEC(float,float);SimTK_NTRAITS_DUAL_SPEC(float,double);
+SimTK_NTRAITS_DUAL_SPEC(float,long double);SimTK_NTRAITS_DUAL_SPEC(float,Dual_<float>);
+SimTK_NTRAITS_DUAL_SPEC(double,float);SimTK_NTRAITS_DUAL_SPEC(double,double);
+SimTK_NTRAITS_DUAL_SPEC(double,long double);SimTK_NTRAITS_DUAL_SPEC(double,Dual_<double>);
+#undef SimTK_NTRAITS_DUAL_SPEC
+
+// The same from the real number's side; the general Result<P> member of the
+// real NTraits would otherwise recurse through negator<Dual_>.
+#define SimTK_NTRAITS_REAL_DUAL_SPEC(R,P) \
+template<> struct NTraits<R>::Result< Dual_<P> > \
+  {typedef Dual_<P> Mul;typedef Mul Dvd;typedef Mul Add;typedef Mul Sub;}
+SimTK_NTRAITS_REAL_DUAL_SPEC(float,float);SimTK_NTRAITS_REAL_DUAL_SPEC(float,double);
+SimTK_NTRAITS_REAL_DUAL_SPEC(double,float);SimTK_NTRAITS_REAL_DUAL_SPEC(double,double);
+SimTK_NTRAITS_REAL_DUAL_SPEC(long double,float);
+SimTK_NTRAITS_REAL_DUAL_SPEC(long double,double);
+#undef SimTK_NTRAITS_REAL_DUAL_SPEC
+
+/// Specialization of CNT for dual numbers.
+template <class R> class CNT< Dual_<R> > : public NTraits< Dual_<R> > { };
+
+} // namespace SimTK
+
+namespace std {
+/** Dual numbers report the floating point properties of their underlying
+real type, with zero derivatives, so that templatized code asking for
+std::numeric_limits<P>::epsilon() and the like behaves as it does for the
+real type. **/
+template <class R>
+class numeric_limits< SimTK::Dual_<R> > : public numeric_limits<R> {
+    typedef SimTK::Dual_<R> T;
+public:
+    static T min()           {return T(numeric_limits<R>::min());}
+    static T max()           {return T(numeric_limits<R>::max());}
+    static T lowest()        {return T(numeric_limits<R>::lowest());}
+    static T epsilon()       {return T(numeric_limits<R>::epsilon());}
+    static T round_error()   {return T(numeric_limits<R>::round_error());}
+    static T infinity()      {return T(numeric_limits<R>::infinity());}
+    static T quiet_NaN()     {return T(numeric_limits<R>::quiet_NaN());}
+    static T signaling_NaN() {return T(numeric_limits<R>::signaling_NaN());}
+    static T denorm_min()    {return T(numeric_limits<R>::denorm_min());}
+};
+} // namespace std
+
+#endif //SimTK_SIMMATRIX_DUAL_H_
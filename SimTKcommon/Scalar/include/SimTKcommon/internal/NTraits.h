@@ -69,6 +69,7 @@ namespace SimTK {
 // Together, these defininitions and guarantees permit conjugation
 // to be done by reinterpretation rather than be computation.
 template <class R> class conjugate; // Only defined for float, double, long double
+template <class R> class Dual_;     // Only defined for float, double
 
 // Specializations of this class provide information about Composite Numerical 
 // Types in the style of std::numeric_limits<T>. It is specialized for the 
@@ -82,6 +83,7 @@ template <class R> class NTraits< conjugate<R> >;
 template <> class NTraits<float>;
 template <> class NTraits<double>;
 template <> class NTraits<long double>;
+template <class R> class NTraits< Dual_<R> >;
 
 // This is an adaptor for numeric types which negates the apparent values. A
 // negator<N> has exactly the same internal representation as a numeric value N, 
@@ -38,6 +38,8 @@
 #include "SimTKcommon/internal/System.h"
 #include "SimTKcommon/internal/SystemGuts.h"
 
+#include <atomic>
+
 namespace SimTK {
 
 class System::Guts::GutsRep {
@@ -200,19 +202,23 @@ private:
     mutable State           defaultState;
 
         // STATISTICS //
-    mutable int nRealizationsOfStage[Stage::NValid];
-    mutable int nRealizeCalls; // counts realizeTopology(), realizeModel(), realize()
-
-    mutable int nPrescribeQCalls, nPrescribeUCalls;
-
-    mutable int nProjectQCalls, nProjectUCalls;
-    mutable int nFailedProjectQCalls, nFailedProjectUCalls;
-    mutable int nQProjections, nUProjections; // the ones that did something
-    mutable int nQErrEstProjections, nUErrEstProjections;
-
-    mutable int nHandlerCallsThatChangedStage[Stage::NValid];
-    mutable int nHandleEventsCalls;
-    mutable int nReportEventsCalls;
+    // These are atomic because const methods like realize() and projectQ()
+    // may be called concurrently on different States of the same System.
+    mutable std::atomic<int> nRealizationsOfStage[Stage::NValid];
+    // counts realizeTopology(), realizeModel(), realize()
+    mutable std::atomic<int> nRealizeCalls;
+
+    mutable std::atomic<int> nPrescribeQCalls, nPrescribeUCalls;
+
+    mutable std::atomic<int> nProjectQCalls, nProjectUCalls;
+    mutable std::atomic<int> nFailedProjectQCalls, nFailedProjectUCalls;
+    // the ones that did something
+    mutable std::atomic<int> nQProjections, nUProjections;
+    mutable std::atomic<int> nQErrEstProjections, nUErrEstProjections;
+
+    mutable std::atomic<int> nHandlerCallsThatChangedStage[Stage::NValid];
+    mutable std::atomic<int> nHandleEventsCalls;
+    mutable std::atomic<int> nReportEventsCalls;
 
     void resetAllCounters() {
         for (int i=0; i<Stage::NValid; ++i)
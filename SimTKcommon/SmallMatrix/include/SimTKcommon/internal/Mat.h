@@ -358,14 +358,16 @@ public:
     type E sets all the main diagonal elements to \a e but sets the rest of 
     the elements to zero. **/
     explicit Mat(const E& e)
-      { for (int j=0;j<N;++j) (*this)(j) = E(0); diag()=e; }
+      { for (int j=0;j<N;++j) (*this)(j) = E(0); 
+        for (int i=0;i<MinDim;++i) (*this)(i,i) = e; }
 
     /** Explicit construction from a single element \a e whose type is
     negator<E> (abbreviated ENeg here) where E is this Mat's element
     type sets all the main diagonal elements to \a e but sets the rest of 
     the elements to zero. **/
     explicit Mat(const ENeg& e)
-      { for (int j=0;j<N;++j) (*this)(j) = E(0); diag()=e; }
+      { for (int j=0;j<N;++j) (*this)(j) = E(0); 
+        for (int i=0;i<MinDim;++i) (*this)(i,i) = e; }
 
     /** Explicit construction from an int value means we convert the int into
     an object of this Mat's element type E, and then apply the single-element
@@ -843,11 +845,14 @@ public:
         return result;
     }
 
-    // Additive operators for scalars operate only on the diagonal.
+    // Additive operators for scalars operate only on the diagonal. These
+    // index the diagonal elements directly rather than through diag(), whose
+    // strided Vec view overhangs the end of the matrix storage and draws
+    // -Warray-bounds from gcc when inlined.
     template <class EE> Mat<M,N, typename CNT<E>::template Result<EE>::Add>
     scalarAdd(const EE& e) const {
         Mat<M,N, typename CNT<E>::template Result<EE>::Add> result(*this);
-        result.diag() += e;
+        for (int i=0; i<MinDim; ++i) result(i,i) += e;
         return result;
     }
     // Add is commutative, so no 'FromLeft'.
@@ -855,14 +860,14 @@ public:
     template <class EE> Mat<M,N, typename CNT<E>::template Result<EE>::Sub>
     scalarSubtract(const EE& e) const {
         Mat<M,N, typename CNT<E>::template Result<EE>::Sub> result(*this);
-        result.diag() -= e;
+        for (int i=0; i<MinDim; ++i) result(i,i) -= e;
         return result;
     }
     // Should probably do something clever with negation here (s - m)
     template <class EE> Mat<M,N, typename CNT<EE>::template Result<E>::Sub>
     scalarSubtractFromLeft(const EE& e) const {
         Mat<M,N, typename CNT<EE>::template Result<E>::Sub> result(-(*this));
-        result.diag() += e; // yes, add
+        for (int i=0; i<MinDim; ++i) result(i,i) += e; // yes, add
         return result;
     }
 
@@ -879,14 +884,14 @@ public:
     // for any assignment-compatible element, not just scalars.
     template <class EE> Mat& scalarEq(const EE& ee)
       { for(int j=0; j<N; ++j) (*this)(j).scalarEq(EE(0)); 
-        diag().scalarEq(ee); 
+        for (int i=0; i<MinDim; ++i) (*this)(i,i) = ee; 
         return *this; }
 
     template <class EE> Mat& scalarPlusEq(const EE& ee)
-      { diag().scalarPlusEq(ee); return *this; }
+      { for (int i=0; i<MinDim; ++i) (*this)(i,i) += ee; return *this; }
 
     template <class EE> Mat& scalarMinusEq(const EE& ee)
-      { diag().scalarMinusEq(ee); return *this; }
+      { for (int i=0; i<MinDim; ++i) (*this)(i,i) -= ee; return *this; }
     // m = s - m; negate m, then add s
     template <class EE> Mat& scalarMinusEqFromLeft(const EE& ee)
       { scalarTimesEq(E(-1)); diag().scalarAdd(ee); return *this; }
@@ -1346,6 +1351,15 @@ template <int M, int N, class E, int CS, int RS, class R> inline
 typename Mat<M,N,E,CS,RS>::template Result<std::complex<R> >::Mul
 operator*(const conjugate<R>& l, const Mat<M,N,E,CS,RS>& r) {return r*(std::complex<R>)l;}
 
+// m = m*dual, dual*m
+template <int M, int N, class E, int CS, int RS, class R> inline
+typename Mat<M,N,E,CS,RS>::template Result<Dual_<R> >::Mul
+operator*(const Mat<M,N,E,CS,RS>& l, const Dual_<R>& r)
+  { return Mat<M,N,E,CS,RS>::template Result<Dual_<R> >::MulOp::perform(l,r); }
+template <int M, int N, class E, int CS, int RS, class R> inline
+typename Mat<M,N,E,CS,RS>::template Result<Dual_<R> >::Mul
+operator*(const Dual_<R>& l, const Mat<M,N,E,CS,RS>& r) {return r*l;}
+
 // m = m*negator, negator*m: convert negator to standard number
 template <int M, int N, class E, int CS, int RS, class R> inline
 typename Mat<M,N,E,CS,RS>::template Result<typename negator<R>::StdNumber>::Mul
@@ -1424,6 +1438,12 @@ template <int M, int N, class E, int CS, int RS, class R> inline
 typename CNT<std::complex<R> >::template Result<Mat<M,N,E,CS,RS> >::Dvd
 operator/(const conjugate<R>& l, const Mat<M,N,E,CS,RS>& r) {return (std::complex<R>)l/r;}
 
+// m = m/dual
+template <int M, int N, class E, int CS, int RS, class R> inline
+typename Mat<M,N,E,CS,RS>::template Result<Dual_<R> >::Dvd
+operator/(const Mat<M,N,E,CS,RS>& l, const Dual_<R>& r)
+  { return Mat<M,N,E,CS,RS>::template Result<Dual_<R> >::DvdOp::perform(l,r); }
+
 // m = m/negator, negator/m: convert negator to a standard number
 template <int M, int N, class E, int CS, int RS, class R> inline
 typename Mat<M,N,E,CS,RS>::template Result<typename negator<R>::StdNumber>::Dvd
@@ -1491,6 +1511,15 @@ template <int M, int N, class E, int CS, int RS, class R> inline
 typename Mat<M,N,E,CS,RS>::template Result<std::complex<R> >::Add
 operator+(const conjugate<R>& l, const Mat<M,N,E,CS,RS>& r) {return r+(std::complex<R>)l;}
 
+// m = m+dual, dual+m
+template <int M, int N, class E, int CS, int RS, class R> inline
+typename Mat<M,N,E,CS,RS>::template Result<Dual_<R> >::Add
+operator+(const Mat<M,N,E,CS,RS>& l, const Dual_<R>& r)
+  { return Mat<M,N,E,CS,RS>::template Result<Dual_<R> >::AddOp::perform(l,r); }
+template <int M, int N, class E, int CS, int RS, class R> inline
+typename Mat<M,N,E,CS,RS>::template Result<Dual_<R> >::Add
+operator+(const Dual_<R>& l, const Mat<M,N,E,CS,RS>& r) {return r+l;}
+
 // m = m+negator, negator+m: convert negator to standard number
 template <int M, int N, class E, int CS, int RS, class R> inline
 typename Mat<M,N,E,CS,RS>::template Result<typename negator<R>::StdNumber>::Add
@@ -1558,6 +1587,12 @@ template <int M, int N, class E, int CS, int RS, class R> inline
 typename CNT<std::complex<R> >::template Result<Mat<M,N,E,CS,RS> >::Sub
 operator-(const conjugate<R>& l, const Mat<M,N,E,CS,RS>& r) {return (std::complex<R>)l-r;}
 
+// m = m-dual
+template <int M, int N, class E, int CS, int RS, class R> inline
+typename Mat<M,N,E,CS,RS>::template Result<Dual_<R> >::Sub
+operator-(const Mat<M,N,E,CS,RS>& l, const Dual_<R>& r)
+  { return Mat<M,N,E,CS,RS>::template Result<Dual_<R> >::SubOp::perform(l,r); }
+
 // m = m-negator, negator-m: convert negator to standard number
 template <int M, int N, class E, int CS, int RS, class R> inline
 typename Mat<M,N,E,CS,RS>::template Result<typename negator<R>::StdNumber>::Sub
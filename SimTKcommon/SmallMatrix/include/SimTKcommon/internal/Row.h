@@ -927,6 +927,15 @@ template <int N, class E, int S, class R> inline
 typename Row<N,E,S>::template Result<std::complex<R> >::Mul
 operator*(const conjugate<R>& l, const Row<N,E,S>& r) {return r*(std::complex<R>)l;}
 
+// v = v*dual, dual*v
+template <int N, class E, int S, class R> inline
+typename Row<N,E,S>::template Result<Dual_<R> >::Mul
+operator*(const Row<N,E,S>& l, const Dual_<R>& r)
+  { return Row<N,E,S>::template Result<Dual_<R> >::MulOp::perform(l,r); }
+template <int N, class E, int S, class R> inline
+typename Row<N,E,S>::template Result<Dual_<R> >::Mul
+operator*(const Dual_<R>& l, const Row<N,E,S>& r) {return r*l;}
+
 // v = v*negator, negator*v: convert negator to standard number
 template <int N, class E, int S, class R> inline
 typename Row<N,E,S>::template Result<typename negator<R>::StdNumber>::Mul
@@ -997,6 +1006,12 @@ template <int N, class E, int S, class R> inline
 typename CNT<std::complex<R> >::template Result<Row<N,E,S> >::Dvd
 operator/(const conjugate<R>& l, const Row<N,E,S>& r) {return (std::complex<R>)l/r;}
 
+// v = v/dual
+template <int N, class E, int S, class R> inline
+typename Row<N,E,S>::template Result<Dual_<R> >::Dvd
+operator/(const Row<N,E,S>& l, const Dual_<R>& r)
+  { return Row<N,E,S>::template Result<Dual_<R> >::DvdOp::perform(l,r); }
+
 // v = v/negator, negator/v: convert negator to number
 template <int N, class E, int S, class R> inline
 typename Row<N,E,S>::template Result<typename negator<R>::StdNumber>::Dvd
@@ -1064,6 +1079,15 @@ template <int N, class E, int S, class R> inline
 typename Row<N,E,S>::template Result<std::complex<R> >::Add
 operator+(const conjugate<R>& l, const Row<N,E,S>& r) {return r+(std::complex<R>)l;}
 
+// v = v+dual, dual+v
+template <int N, class E, int S, class R> inline
+typename Row<N,E,S>::template Result<Dual_<R> >::Add
+operator+(const Row<N,E,S>& l, const Dual_<R>& r)
+  { return Row<N,E,S>::template Result<Dual_<R> >::AddOp::perform(l,r); }
+template <int N, class E, int S, class R> inline
+typename Row<N,E,S>::template Result<Dual_<R> >::Add
+operator+(const Dual_<R>& l, const Row<N,E,S>& r) {return r+l;}
+
 // v = v+negator, negator+v: convert negator to standard number
 template <int N, class E, int S, class R> inline
 typename Row<N,E,S>::template Result<typename negator<R>::StdNumber>::Add
@@ -1131,6 +1155,12 @@ template <int N, class E, int S, class R> inline
 typename CNT<std::complex<R> >::template Result<Row<N,E,S> >::Sub
 operator-(const conjugate<R>& l, const Row<N,E,S>& r) {return (std::complex<R>)l-r;}
 
+// v = v-dual
+template <int N, class E, int S, class R> inline
+typename Row<N,E,S>::template Result<Dual_<R> >::Sub
+operator-(const Row<N,E,S>& l, const Dual_<R>& r)
+  { return Row<N,E,S>::template Result<Dual_<R> >::SubOp::perform(l,r); }
+
 // v = v-negator, negator-v: convert negator to standard number
 template <int N, class E, int S, class R> inline
 typename Row<N,E,S>::template Result<typename negator<R>::StdNumber>::Sub
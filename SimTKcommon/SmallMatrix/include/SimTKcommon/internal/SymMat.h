@@ -993,6 +993,15 @@ template <int M, class E, int S, class R> inline
 typename SymMat<M,E,S>::template Result<std::complex<R> >::Mul
 operator*(const conjugate<R>& l, const SymMat<M,E,S>& r) {return r*(std::complex<R>)l;}
 
+// m = m*dual, dual*m
+template <int M, class E, int S, class R> inline
+typename SymMat<M,E,S>::template Result<Dual_<R> >::Mul
+operator*(const SymMat<M,E,S>& l, const Dual_<R>& r)
+  { return SymMat<M,E,S>::template Result<Dual_<R> >::MulOp::perform(l,r); }
+template <int M, class E, int S, class R> inline
+typename SymMat<M,E,S>::template Result<Dual_<R> >::Mul
+operator*(const Dual_<R>& l, const SymMat<M,E,S>& r) {return r*l;}
+
 // m = m*negator, negator*m: convert negator to standard number
 template <int M, class E, int S, class R> inline
 typename SymMat<M,E,S>::template Result<typename negator<R>::StdNumber>::Mul
@@ -1063,6 +1072,12 @@ template <int M, class E, int S, class R> inline
 typename CNT<std::complex<R> >::template Result<SymMat<M,E,S> >::Dvd
 operator/(const conjugate<R>& l, const SymMat<M,E,S>& r) {return (std::complex<R>)l/r;}
 
+// m = m/dual
+template <int M, class E, int S, class R> inline
+typename SymMat<M,E,S>::template Result<Dual_<R> >::Dvd
+operator/(const SymMat<M,E,S>& l, const Dual_<R>& r)
+  { return SymMat<M,E,S>::template Result<Dual_<R> >::DvdOp::perform(l,r); }
+
 // m = m/negator, negator/m: convert negator to number
 template <int M, class E, int S, class R> inline
 typename SymMat<M,E,S>::template Result<typename negator<R>::StdNumber>::Dvd
@@ -1130,6 +1145,15 @@ template <int M, class E, int S, class R> inline
 typename SymMat<M,E,S>::template Result<std::complex<R> >::Add
 operator+(const conjugate<R>& l, const SymMat<M,E,S>& r) {return r+(std::complex<R>)l;}
 
+// m = m+dual, dual+m
+template <int M, class E, int S, class R> inline
+typename SymMat<M,E,S>::template Result<Dual_<R> >::Add
+operator+(const SymMat<M,E,S>& l, const Dual_<R>& r)
+  { return SymMat<M,E,S>::template Result<Dual_<R> >::AddOp::perform(l,r); }
+template <int M, class E, int S, class R> inline
+typename SymMat<M,E,S>::template Result<Dual_<R> >::Add
+operator+(const Dual_<R>& l, const SymMat<M,E,S>& r) {return r+l;}
+
 // m = m+negator, negator+m: convert negator to standard number
 template <int M, class E, int S, class R> inline
 typename SymMat<M,E,S>::template Result<typename negator<R>::StdNumber>::Add
@@ -1197,6 +1221,12 @@ template <int M, class E, int S, class R> inline
 typename CNT<std::complex<R> >::template Result<SymMat<M,E,S> >::Sub
 operator-(const conjugate<R>& l, const SymMat<M,E,S>& r) {return (std::complex<R>)l-r;}
 
+// m = m-dual
+template <int M, class E, int S, class R> inline
+typename SymMat<M,E,S>::template Result<Dual_<R> >::Sub
+operator-(const SymMat<M,E,S>& l, const Dual_<R>& r)
+  { return SymMat<M,E,S>::template Result<Dual_<R> >::SubOp::perform(l,r); }
+
 // m = m-negator, negator-m: convert negator to standard number
 template <int M, class E, int S, class R> inline
 typename SymMat<M,E,S>::template Result<typename negator<R>::StdNumber>::Sub
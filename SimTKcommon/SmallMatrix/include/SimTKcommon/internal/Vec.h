@@ -1154,6 +1154,15 @@ template <int M, class E, int S, class R> inline
 typename Vec<M,E,S>::template Result<std::complex<R> >::Mul
 operator*(const conjugate<R>& l, const Vec<M,E,S>& r) {return r*(std::complex<R>)l;}
 
+// v = v*dual, dual*v
+template <int M, class E, int S, class R> inline
+typename Vec<M,E,S>::template Result<Dual_<R> >::Mul
+operator*(const Vec<M,E,S>& l, const Dual_<R>& r)
+  { return Vec<M,E,S>::template Result<Dual_<R> >::MulOp::perform(l,r); }
+template <int M, class E, int S, class R> inline
+typename Vec<M,E,S>::template Result<Dual_<R> >::Mul
+operator*(const Dual_<R>& l, const Vec<M,E,S>& r) {return r*l;}
+
 // v = v*negator, negator*v: convert negator to standard number
 template <int M, class E, int S, class R> inline
 typename Vec<M,E,S>::template Result<typename negator<R>::StdNumber>::Mul
@@ -1224,6 +1233,12 @@ template <int M, class E, int S, class R> inline
 typename CNT<std::complex<R> >::template Result<Vec<M,E,S> >::Dvd
 operator/(const conjugate<R>& l, const Vec<M,E,S>& r) {return (std::complex<R>)l/r;}
 
+// v = v/dual
+template <int M, class E, int S, class R> inline
+typename Vec<M,E,S>::template Result<Dual_<R> >::Dvd
+operator/(const Vec<M,E,S>& l, const Dual_<R>& r)
+  { return Vec<M,E,S>::template Result<Dual_<R> >::DvdOp::perform(l,r); }
+
 // v = v/negator, negator/v: convert negator to number
 template <int M, class E, int S, class R> inline
 typename Vec<M,E,S>::template Result<typename negator<R>::StdNumber>::Dvd
@@ -1291,6 +1306,15 @@ template <int M, class E, int S, class R> inline
 typename Vec<M,E,S>::template Result<std::complex<R> >::Add
 operator+(const conjugate<R>& l, const Vec<M,E,S>& r) {return r+(std::complex<R>)l;}
 
+// v = v+dual, dual+v
+template <int M, class E, int S, class R> inline
+typename Vec<M,E,S>::template Result<Dual_<R> >::Add
+operator+(const Vec<M,E,S>& l, const Dual_<R>& r)
+  { return Vec<M,E,S>::template Result<Dual_<R> >::AddOp::perform(l,r); }
+template <int M, class E, int S, class R> inline
+typename Vec<M,E,S>::template Result<Dual_<R> >::Add
+operator+(const Dual_<R>& l, const Vec<M,E,S>& r) {return r+l;}
+
 // v = v+negator, negator+v: convert negator to standard number
 template <int M, class E, int S, class R> inline
 typename Vec<M,E,S>::template Result<typename negator<R>::StdNumber>::Add
@@ -1358,6 +1382,12 @@ template <int M, class E, int S, class R> inline
 typename CNT<std::complex<R> >::template Result<Vec<M,E,S> >::Sub
 operator-(const conjugate<R>& l, const Vec<M,E,S>& r) {return (std::complex<R>)l-r;}
 
+// v = v-dual
+template <int M, class E, int S, class R> inline
+typename Vec<M,E,S>::template Result<Dual_<R> >::Sub
+operator-(const Vec<M,E,S>& l, const Dual_<R>& r)
+  { return Vec<M,E,S>::template Result<Dual_<R> >::SubOp::perform(l,r); }
+
 // v = v-negator, negator-v: convert negator to standard number
 template <int M, class E, int S, class R> inline
 typename Vec<M,E,S>::template Result<typename negator<R>::StdNumber>::Sub
@@ -36,8 +36,6 @@ class ParallelExecutorImpl;
 // We only want the template instantiation to occur once. This symbol is defined in the SimTK core
 // compilation unit that defines the ParallelExecutor class but should not be defined any other time.
 
-//TODO: Rewrite the threading class using C++11 std::thread
-
 #ifndef SimTK_SIMTKCOMMON_DEFINING_PARALLEL_EXECUTOR
     extern template class PIMPLHandle<ParallelExecutor, ParallelExecutorImpl>;
 #endif
@@ -65,6 +63,22 @@ class ParallelExecutorImpl;
  * processor utilitization.  Alternatively, if the Task will only be executed four times, you might
  * specify min(4, ParallelExecutor::getNumProcessors()) to avoid creating extra threads that will never
  * have any work to do.
+ *
+ * Indices are not assigned to threads statically. Each thread starts with a contiguous block of
+ * indices which it works through in small chunks; a thread that runs out of work steals half of
+ * the remaining indices of another thread. A few expensive indices therefore don't hold up the
+ * whole batch. For simple loops you can use parallelFor() instead of writing a Task subclass:
+ *
+ * <pre>
+ * executor.parallelFor(0, n, [&](int i) {result[i] = compute(i);});
+ * </pre>
+ *
+ * Calling execute() or parallelFor() from inside a task that is already running on a worker
+ * thread is safe: the nested loop is simply executed on the calling thread.
+ *
+ * If the Task throws an exception on a worker thread, that worker stops taking indices, the
+ * others run to completion, and then the first such exception is rethrown from execute() on
+ * the calling thread. Indices that were never reached are simply not executed.
  */
 
 class SimTK_SimTKCOMMON_EXPORT ParallelExecutor : public PIMPLHandle<ParallelExecutor, ParallelExecutorImpl> {
@@ -94,8 +108,21 @@ public:
      * 
      * @param task    the Task to execute
      * @param times   the number of times the Task should be executed
+     *
+     * If any invocation throws, the first exception is rethrown here after
+     * all the worker threads have finished.
      */
     void execute(Task& task, int times);
+    /**
+     * Execute body(i) in parallel for every i in [begin, end). The body must
+     * be callable concurrently from multiple threads.
+     *
+     * @param begin   the first index
+     * @param end     one past the last index
+     * @param body    a function object taking an int index
+     */
+    template <class Body>
+    void parallelFor(int begin, int end, const Body& body);
     /**
      * Get the total number of available processor cores (physical cores and
      * hyperthreads on Intel architecture). If the number of threads is not
@@ -142,6 +169,22 @@ public:
     }
 };
 
+template <class Body>
+void ParallelExecutor::parallelFor(int begin, int end, const Body& body) {
+    class ForTask : public Task {
+    public:
+        ForTask(int begin, const Body& body) : begin(begin), body(body) {}
+        void execute(int index) override {body(begin + index);}
+    private:
+        const int begin;
+        const Body& body;
+    };
+    if (end <= begin)
+        return;
+    ForTask task(begin, body);
+    execute(task, end - begin);
+}
+
 } // namespace SimTK
 
 #endif // SimTK_SimTKCOMMON_PARALLEL_EXECUTOR_H_
@@ -23,19 +23,24 @@
 
 #include "ParallelExecutorImpl.h"
 #include "SimTKcommon/internal/ParallelExecutor.h"
-#include <pthread.h>
 
 #include <iostream>
 #include <string>
 #include <algorithm>
+#include <exception>
 
 using namespace std;
 
 namespace SimTK {
 
-static void* threadBody(void* args);
+// Number of times an idle thread polls for new work (or for the workers to
+// finish) before blocking on a condition variable.
+static const int SpinCount = 2000;
+// Each thread's initial range is split into about this many chunks, which is
+// the granularity at which the owner claims work and thieves can steal it.
+static const int ChunksPerThread = 8;
 
-ParallelExecutorImpl::ParallelExecutorImpl() : finished(false) {
+ParallelExecutorImpl::ParallelExecutorImpl() {
 
     //By default, we use the total number of processors available of the
     //computer (including hyperthreads)
@@ -45,7 +50,7 @@ ParallelExecutorImpl::ParallelExecutorImpl() : finished(false) {
 
     ParallelExecutorImpl::init();
 }
-ParallelExecutorImpl::ParallelExecutorImpl(int numThreads) : finished(false) {
+ParallelExecutorImpl::ParallelExecutorImpl(int numThreads) {
 
     // Set the maximum number of threads that we can use
     SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "ParallelExecutorImpl",
@@ -55,82 +60,160 @@ ParallelExecutorImpl::ParallelExecutorImpl(int numThreads) : finished(false) {
     ParallelExecutorImpl::init();
 }
 ParallelExecutorImpl::~ParallelExecutorImpl() {
-    
+
     // Notify the threads that they should exit.
-    
-    pthread_mutex_lock(&runLock);
-    finished = true;
-    for (int i = 0; i < (int) threads.size(); ++i)
-        threadInfo[i]->running = true;
-    pthread_cond_broadcast(&runCondition);
-    pthread_mutex_unlock(&runLock);
-    
+
+    {
+        std::lock_guard<std::mutex> guard(runLock);
+        finished = true;
+        ++generation;
+    }
+    runCondition.notify_all();
+
     // Wait until all the threads have finished.
-    
-    for (int i = 0; i < (int) threads.size(); ++i)
-        pthread_join(threads[i], NULL);
-    
-    // Clean up threading related objects.
-    
-    pthread_mutex_destroy(&runLock);
-    pthread_cond_destroy(&runCondition);
-    pthread_cond_destroy(&waitCondition);
+
+    for (auto& thread : threads)
+        thread.join();
 }
 ParallelExecutorImpl* ParallelExecutorImpl::clone() const {
     return new ParallelExecutorImpl(numMaxThreads);
 }
 void ParallelExecutorImpl::init()
 {
-  pthread_mutex_init(&runLock, NULL);
-  pthread_cond_init(&runCondition, NULL);
-  pthread_cond_init(&waitCondition, NULL);
+    generation = 0;
+    activeThreadCount = 0;
+    finished = false;
+    currentTask = nullptr;
+    chunkSize = 1;
+}
+void ParallelExecutorImpl::startThreads()
+{
+    // We launch the maximum number of threads and save them for later use.
+    ranges.reset(new WorkRange[numMaxThreads]);
+    for (int i = 0; i < numMaxThreads; ++i)
+        ranges[i].range = packRange(0, 0);
+    threads.reserve(numMaxThreads);
+    for (int i = 0; i < numMaxThreads; ++i)
+        threads.emplace_back(&ParallelExecutorImpl::runWorker, this, i);
 }
 void ParallelExecutorImpl::execute(ParallelExecutor::Task& task, int times) {
-  if (min(times, numMaxThreads) == 1) {
-      //(1) NON-PARALLEL CASE:
-      // Nothing is actually going to get done in parallel, so we might as well
-      // just execute the task directly and save the threading overhead.
-      task.initialize();
-      for (int i = 0; i < times; ++i)
-          task.execute(i);
-      task.finish();
-      return;
+    if (times <= 0)
+        return;
+    if (min(times, numMaxThreads) == 1 || isWorker.get()) {
+        //(1) NON-PARALLEL CASE:
+        // Nothing is actually going to get done in parallel, so we might as
+        // well just execute the task directly and save the threading overhead.
+        // This is also where nested calls made from inside a worker thread
+        // end up; the outer execute() already occupies every worker, so
+        // running the inner loop inline is both safe and no slower.
+        task.initialize();
+        for (int i = 0; i < times; ++i)
+            task.execute(i);
+        task.finish();
+        return;
     }
-    
+
     //(2) PARALLEL CASE:
-    // We launch the maximum number of threads and save them for later use
-    if(threads.size() < (size_t)numMaxThreads)
+    std::lock_guard<std::mutex> executeGuard(executeLock);
+    if (threads.empty())
+        startThreads();
+
+    // Deal out a contiguous block of indices to each worker. Work stealing
+    // takes care of any imbalance between the blocks.
+    const int n = getThreadCount();
+    for (int i = 0; i < n; ++i) {
+        const int begin = int((std::int64_t(times)*i)/n);
+        const int end   = int((std::int64_t(times)*(i+1))/n);
+        ranges[i].range.store(packRange(begin, end), std::memory_order_relaxed);
+    }
+    chunkSize = max(1, times/(n*ChunksPerThread));
+    currentTask = &task;
+    activeThreadCount = n;
+
+    // Wake up the worker threads and wait until they finish.
     {
-      threads.resize(numMaxThreads);
-      for (int i = 0; i < numMaxThreads; ++i) {
-          threadInfo.push_back(new ThreadInfo(i, this));
-          pthread_create(&threads[i], NULL, threadBody, threadInfo[i]);
-      }
+        std::lock_guard<std::mutex> guard(runLock);
+        ++generation;
     }
+    runCondition.notify_all();
 
-  // Initialize fields to execute the new task.
-  pthread_mutex_lock(&runLock);
-  currentTask = &task;
-  currentTaskCount = times;
-  waitingThreadCount = 0;
-  for (int i = 0; i < (int) threadInfo.size(); ++i)
-      threadInfo[i]->running = true;
-
-  // Wake up the worker threads and wait until they finish.
-  pthread_cond_broadcast(&runCondition);
-  do {
-      pthread_cond_wait(&waitCondition, &runLock);
-  } while (waitingThreadCount < (int) threads.size());
-  pthread_mutex_unlock(&runLock);
+    for (int spin = 0; spin < SpinCount; ++spin) {
+        if (activeThreadCount.load(std::memory_order_acquire) == 0)
+            break;
+        std::this_thread::yield();
+    }
+    if (activeThreadCount.load(std::memory_order_acquire) != 0) {
+        std::unique_lock<std::mutex> lock(runLock);
+        waitCondition.wait(lock, [this]
+            {return activeThreadCount.load(std::memory_order_acquire) == 0;});
+    }
+
+    // Report a worker's failure on the calling thread.
+    std::exception_ptr failure;
+    {
+        std::lock_guard<std::mutex> guard(finishLock);
+        std::swap(failure, firstException);
+    }
+    if (failure)
+        std::rethrow_exception(failure);
+}
+bool ParallelExecutorImpl::waitForWork(unsigned& seenGeneration) {
+    for (int spin = 0; spin < SpinCount; ++spin) {
+        if (generation.load(std::memory_order_acquire) != seenGeneration)
+            break;
+        std::this_thread::yield();
+    }
+    if (generation.load(std::memory_order_acquire) == seenGeneration) {
+        std::unique_lock<std::mutex> lock(runLock);
+        runCondition.wait(lock, [&]
+            {return generation.load(std::memory_order_acquire)
+                    != seenGeneration;});
+    }
+    seenGeneration = generation.load(std::memory_order_acquire);
+    return !finished.load(std::memory_order_acquire);
 }
-void ParallelExecutorImpl::incrementWaitingThreads() {
-    pthread_mutex_lock(&runLock);
-    getCurrentTask().finish();
-    waitingThreadCount++;
-    if (waitingThreadCount == (int)threads.size()) {
-        pthread_cond_signal(&waitCondition);
+bool ParallelExecutorImpl::popLocal(int thread, int& begin, int& end) {
+    std::atomic<std::uint64_t>& range = ranges[thread].range;
+    std::uint64_t r = range.load(std::memory_order_acquire);
+    while (true) {
+        const int b = rangeBegin(r), e = rangeEnd(r);
+        if (b >= e)
+            return false;
+        const int nb = min(e, b + chunkSize);
+        if (range.compare_exchange_weak(r, packRange(nb, e),
+                                        std::memory_order_acq_rel)) {
+            begin = b;
+            end = nb;
+            return true;
+        }
+    }
+}
+bool ParallelExecutorImpl::steal(int thief, int& begin, int& end) {
+    const int n = getThreadCount();
+    for (int k = 1; k < n; ++k) {
+        std::atomic<std::uint64_t>& range = ranges[(thief+k) % n].range;
+        std::uint64_t r = range.load(std::memory_order_acquire);
+        while (true) {
+            const int b = rangeBegin(r), e = rangeEnd(r);
+            if (b >= e)
+                break;
+            // Take the back half, leaving the front for the owner.
+            const int mid = b + (e-b)/2;
+            if (range.compare_exchange_weak(r, packRange(b, mid),
+                                            std::memory_order_acq_rel)) {
+                // Keep one chunk to work on and publish the rest in our own
+                // range so that it can be stolen in turn. Our range is empty
+                // here and no other thread modifies an empty range.
+                const int stop = min(e, mid + chunkSize);
+                ranges[thief].range.store(packRange(stop, e),
+                                          std::memory_order_release);
+                begin = mid;
+                end = stop;
+                return true;
+            }
+        }
     }
-    pthread_mutex_unlock(&runLock);
+    return false;
 }
 
 ThreadLocal<bool> ParallelExecutorImpl::isWorker(false);
@@ -139,48 +222,35 @@ ThreadLocal<bool> ParallelExecutorImpl::isWorker(false);
  * This function contains the code executed by the worker threads.
  */
 
-void* threadBody(void* args) {
-    ParallelExecutorImpl::isWorker.upd() = true;
-    ThreadInfo& info = *reinterpret_cast<ThreadInfo*>(args);
-    ParallelExecutorImpl& executor = *info.executor;
-    int threadCount = executor.getThreadCount();
-    while (!executor.isFinished()) {
-        
-        // Wait for a Task to come in.
-        
-        pthread_mutex_lock(executor.getLock());
-        while (!info.running) {
-            pthread_cond_wait(executor.getCondition(), executor.getLock());
-        }
-        pthread_mutex_unlock(executor.getLock());
-        if (!executor.isFinished()) {
-            
-            // Execute the task for all the indices belonging to this thread.
-            
-            int count = executor.getCurrentTaskCount();
-            ParallelExecutor::Task& task = executor.getCurrentTask();
+void ParallelExecutorImpl::runWorker(int index) {
+    isWorker.upd() = true;
+    unsigned seenGeneration = 0;
+    while (waitForWork(seenGeneration)) {
+        ParallelExecutor::Task& task = *currentTask;
+        std::exception_ptr failure;
+        try {
             task.initialize();
-            int index = info.index;
-                        
-            try {
-                while (index < count) {
-                    task.execute(index);
-                    index += threadCount;
-                }
-            }
-            catch (const std::exception& ex) {
-                std::cerr <<"The parallel task threw an unhandled exception:"<< std::endl;
-                std::cerr <<ex.what()<< std::endl;
-            }
-            catch (...) {
-                std::cerr <<"The parallel task threw an error."<< std::endl;
-            }
-            info.running = false;
-            executor.incrementWaitingThreads();
+            int begin, end;
+            while (popLocal(index, begin, end) || steal(index, begin, end))
+                for (int i = begin; i < end; ++i)
+                    task.execute(i);
+        }
+        catch (...) {
+            failure = std::current_exception();
+        }
+        {
+            // Only the first exception is kept; execute() rethrows it once
+            // all the workers are done.
+            std::lock_guard<std::mutex> guard(finishLock);
+            if (failure && !firstException)
+                firstException = failure;
+            task.finish();
+        }
+        if (activeThreadCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> guard(runLock);
+            waitCondition.notify_one();
         }
     }
-    delete &info;
-    return 0;
 }
 
 ParallelExecutor::ParallelExecutor() : HandleBase(new ParallelExecutorImpl()) {
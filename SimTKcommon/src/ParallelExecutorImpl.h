@@ -28,31 +28,29 @@
 #include "SimTKcommon/internal/ThreadLocal.h"
 #include "SimTKcommon/internal/Array.h"
 
-#include <pthread.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <thread>
-#include <iostream>
+#include <vector>
 
 namespace SimTK {
 
-class ParallelExecutorImpl;
-
-/**
- * This class stores per-thread information used while executing a task.
- */
- 
-//TODO: Rewrite the threading class using C++11 std::thread
-
-class ThreadInfo {
-public:
-    ThreadInfo(int index, ParallelExecutorImpl* executor) : index(index), executor(executor), running(false) {
-    }
-    const int index;
-    ParallelExecutorImpl* const executor;
-    bool running;
-};
-
 /**
  * This is the internal implementation class for ParallelExecutor.
+ *
+ * Each worker thread owns a contiguous range of task indices, packed into a
+ * single 64-bit atomic word as [begin,end). The owner pops small chunks from
+ * the front of its range; a thread that runs out of work steals the back half
+ * of another thread's range and then continues popping from that. All range
+ * updates are lock free, so the only synchronization per execute() call is
+ * the wake-up of the workers and the final wait for them to drain. Idle
+ * workers spin briefly before parking on a condition variable so that
+ * back-to-back calls (e.g. once per force evaluation) don't pay for a full
+ * sleep/wake cycle.
  */
 
 class ParallelExecutorImpl : public PIMPLImplementation<ParallelExecutor, ParallelExecutorImpl> {
@@ -62,40 +60,56 @@ public:
     ~ParallelExecutorImpl();
     ParallelExecutorImpl* clone() const;
     void execute(ParallelExecutor::Task& task, int times);
-    int getThreadCount() {
-        return threads.size();
-    }
-    ParallelExecutor::Task& getCurrentTask() {
-        return *currentTask;
-    }
-    int getCurrentTaskCount() {
-        return currentTaskCount;
-    }
-    bool isFinished() {
-        return finished;
-    }
-    pthread_mutex_t* getLock() {
-        return &runLock;
-    }
-    pthread_cond_t* getCondition() {
-        return &runCondition;
+    int getThreadCount() const {
+        return (int)threads.size();
     }
     int getMaxThreads() const{
       return numMaxThreads;
     }
-    void incrementWaitingThreads();
     static ThreadLocal<bool> isWorker;
 private:
+    // One work range per worker, padded to a cache line so that the owner's
+    // pops don't cause false sharing with the neighbors' ranges. The padding
+    // keeps any two ranges a full line apart without needing an over-aligned
+    // type, which operator new[] doesn't support before C++17.
+    struct WorkRange {
+        std::atomic<std::uint64_t> range;
+        char padding[64 - sizeof(std::atomic<std::uint64_t>)];
+    };
+
+    static std::uint64_t packRange(int begin, int end) {
+        return (std::uint64_t(std::uint32_t(begin)) << 32)
+               | std::uint64_t(std::uint32_t(end));
+    }
+    static int rangeBegin(std::uint64_t r) {return int(std::uint32_t(r >> 32));}
+    static int rangeEnd(std::uint64_t r)   {return int(std::uint32_t(r));}
+
     void init();
-    bool finished;
-    pthread_mutex_t runLock;
-    pthread_cond_t runCondition, waitCondition;
-    Array_<pthread_t> threads;
-    Array_<ThreadInfo*> threadInfo;
-    ParallelExecutor::Task* currentTask;
-    int currentTaskCount;
-    int waitingThreadCount;
+    void startThreads();
+    void runWorker(int index);
+    bool waitForWork(unsigned& seenGeneration);
+    bool popLocal(int thread, int& begin, int& end);
+    bool steal(int thief, int& begin, int& end);
+
     int numMaxThreads;
+    std::vector<std::thread> threads;
+    std::unique_ptr<WorkRange[]> ranges;
+
+    // Serializes execute() calls made concurrently from different threads.
+    std::mutex executeLock;
+    // Protects the generation counter and the two condition variables.
+    std::mutex runLock;
+    std::condition_variable runCondition, waitCondition;
+    // Serializes calls to Task::finish() and guards firstException.
+    std::mutex finishLock;
+    // The first exception thrown by the current task on any worker.
+    std::exception_ptr firstException;
+
+    std::atomic<unsigned> generation;
+    std::atomic<int> activeThreadCount;
+    std::atomic<bool> finished;
+    ParallelExecutor::Task* currentTask;
+    int chunkSize;
 };
 
 } // namespace SimTK
@@ -0,0 +1,173 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that dual numbers carry exact derivatives through scalar functions,
+// the small matrix classes, rotations, transforms and mass properties. Each
+// computation is written once for a generic scalar P; the derivative obtained
+// by evaluating it with P=Dual is compared against a central difference of
+// the same computation with P=Real.
+
+#include "SimTKcommon.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+using namespace SimTK;
+
+// Split a composite of duals into its values and its derivatives.
+template <int M, int N>
+static Mat<M,N> valueOf(const Mat<M,N,Dual>& m) {
+    Mat<M,N> v; for (int i=0; i<M; ++i) for (int j=0; j<N; ++j)
+        v(i,j) = m(i,j).value();
+    return v;
+}
+template <int M, int N>
+static Mat<M,N> derivOf(const Mat<M,N,Dual>& m) {
+    Mat<M,N> d; for (int i=0; i<M; ++i) for (int j=0; j<N; ++j)
+        d(i,j) = m(i,j).deriv();
+    return d;
+}
+template <int M>
+static Vec<M> valueOf(const Vec<M,Dual>& v) {
+    Vec<M> r; for (int i=0; i<M; ++i) r[i] = v[i].value(); return r;
+}
+template <int M>
+static Vec<M> derivOf(const Vec<M,Dual>& v) {
+    Vec<M> r; for (int i=0; i<M; ++i) r[i] = v[i].deriv(); return r;
+}
+
+static const Real h = 1e-6;   // step for central differences
+static const Real tol = 1e-8; // relative tolerance for comparing them
+
+template <class P> static P scalarFunc(const P& t) {
+    using std::sin; using std::cos; using std::exp; using std::log;
+    using std::sqrt; using std::atan2; using std::pow;
+    return sin(t)*exp(t)/(1+t*t) - 3*log(2+cos(t))
+           + sqrt(t) + atan2(t, P(2)) + pow(1+t, 2.5)/t;
+}
+
+void testScalar() {
+    const Real t = .7;
+    const Dual f = scalarFunc(Dual(t, 1));
+    SimTK_TEST_EQ(f.value(), scalarFunc(t));
+    SimTK_TEST_EQ_TOL(f.deriv(),
+        (scalarFunc(t+h) - scalarFunc(t-h))/(2*h), tol);
+
+    // Constants have zero derivative and mix freely with duals.
+    const Dual c(2.5), x(3, 1);
+    SimTK_TEST(c.deriv() == 0);
+    SimTK_TEST_EQ((2*x - x/4 + 1).deriv(), 1.75);
+    SimTK_TEST_EQ((1/x).deriv(), -1./9);
+    SimTK_TEST_EQ((x*x*x).deriv(), 27.);
+    SimTK_TEST(x > c && c < x && x == Dual(3, -1));
+    SimTK_TEST((double)x == 3);
+
+    SimTK_TEST(isNaN(Dual(0, NTraits<Real>::getNaN())));
+    SimTK_TEST(!isFinite(Dual(1, Infinity)));
+    SimTK_TEST(isNumericallyEqual(Dual(1, 2), Dual(1, 2)));
+    SimTK_TEST(!isNumericallyEqual(Dual(1, 2), Dual(1, 3)));
+    SimTK_TEST(std::numeric_limits<Dual>::epsilon().value()
+               == NTraits<Real>::getEps());
+}
+
+template <class P> static Vec<3,P> vecFunc(const P& t) {
+    using std::sin; using std::cos;
+    const Vec<3,P> v(t, t*t, sin(t));
+    const Vec<3,P> w = Vec3(1,-2,.5) % v + v*cos(t);
+    const Mat<3,3,P> A = Mat33(4,1,0, 1,3,1, 0,1,2) + t*Mat33(1);
+    const SymMat<3,P> S = SymMat33(2, .1,3, .2,.3,4) * t;
+    const Row<3,P> r = ~v - t;
+    return A.invert()*w / v.norm() + S*v + (~r)*(r*w) + (v+t);
+}
+
+void testSmallMatrix() {
+    const Real t = .4;
+    const Vec<3,Dual> v = vecFunc(Dual(t, 1));
+    SimTK_TEST_EQ(valueOf(v), vecFunc(t));
+    SimTK_TEST_EQ_TOL(derivOf(v), (vecFunc(t+h) - vecFunc(t-h))/(2*h), tol);
+
+    // Mixed real and dual operands.
+    const Vec<3,Dual> x = Vec3(1,2,3) * Dual(2, 1);
+    SimTK_TEST_EQ(derivOf(x), Vec3(1,2,3));
+    SimTK_TEST_EQ(derivOf(Mat<2,2,Dual>(Mat22(1,2,3,4) - Dual(0,1))),
+                  Mat22(-1,0,0,-1));
+}
+
+template <class P> static Mat<3,3,P> rotationFunc(const P& t) {
+    const Rotation_<P> R1(t, ZAxis), R2(2*t, UnitVec<P,1>(Vec<3,P>(1,t,2)));
+    Rotation_<P> R3; R3.setRotationToBodyFixedXYZ(Vec<3,P>(t, -t/2, 3*t));
+    const Rotation_<P> R = R1*R2*~R3;
+    // The Euler angles come back out of the rotation matrix through
+    // atan2() and sqrt(), so they check the non-inline methods too.
+    const Vec<3,P> q = R.convertRotationToBodyFixedXYZ();
+    const Quaternion_<P> quat = R.convertRotationToQuaternion();
+    const Vec<3,P> qv = quat.template getSubVec<3>(1);
+    return R.asMat33() + Mat<3,3,P>(~q, ~qv, quat[0]*~q);
+}
+
+void testRotation() {
+    const Real t = .3;
+    const Mat<3,3,Dual> R = rotationFunc(Dual(t, 1));
+    SimTK_TEST_EQ(valueOf(R), rotationFunc(t));
+    SimTK_TEST_EQ_TOL(derivOf(R),
+        (rotationFunc(t+h) - rotationFunc(t-h))/(2*h), tol);
+
+    // Body-fixed angles round trip, so their derivatives come back exactly.
+    const Vec<3,Dual> q(Dual(.1, 1), Dual(-.2, 2), Dual(.3, 3));
+    Rotation_<Dual> Rq; Rq.setRotationToBodyFixedXYZ(q);
+    SimTK_TEST_EQ(derivOf(Rq.convertRotationToBodyFixedXYZ()), Vec3(1,2,3));
+}
+
+template <class P> static Vec<6,P> massPropertiesFunc(const P& t) {
+    const Rotation_<P> R(t, XAxis);
+    const Transform_<P> X(R, Vec<3,P>(t, 1, -t));
+    const Vec<3,P> com = X*Vec<3,P>(.1, .2, t);
+    const MassProperties_<P> mp(2*t+1, com,
+        UnitInertia_<P>(Vec<3,P>(1,2,3)*(1+t), Vec<3,P>(.1,.2,.3)));
+    const Inertia_<P> I = mp.calcInertia().reexpress(~R)
+        .shiftToMassCenter(com, mp.getMass());
+    const Vec<3,P> w(1, t, 2);
+    Vec<6,P> r;
+    r.template updSubVec<3>(0) = I*w;
+    r.template updSubVec<3>(3) = X.shiftFrameStationToBase(com);
+    return r;
+}
+
+void testMassProperties() {
+    const Real t = .6;
+    const Vec<6,Dual> v = massPropertiesFunc(Dual(t, 1));
+    SimTK_TEST_EQ(valueOf(v), massPropertiesFunc(t));
+    SimTK_TEST_EQ_TOL(derivOf(v),
+        (massPropertiesFunc(t+h) - massPropertiesFunc(t-h))/(2*h), tol);
+}
+
+int main() {
+    SimTK_START_TEST("TestDual");
+        SimTK_SUBTEST(testScalar);
+        SimTK_SUBTEST(testSmallMatrix);
+        SimTK_SUBTEST(testRotation);
+        SimTK_SUBTEST(testMassProperties);
+    SimTK_END_TEST();
+}
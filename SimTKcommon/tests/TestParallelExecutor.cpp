@@ -23,7 +23,10 @@
 
 #include "SimTKcommon.h"
 
+#include <chrono>
 #include <iostream>
+#include <stdexcept>
+#include <thread>
 
 #define ASSERT(cond) {SimTK_ASSERT_ALWAYS(cond, "Assertion failed");}
 
@@ -91,6 +94,61 @@ void testSingleThreadedExecution() {
         ASSERT(flags[j] == (j < numFlags-10 ? 1 : 0));
 }
 
+void testParallelFor() {
+    const int n = 1000;
+    Array_<int> flags(n, 0);
+    ParallelExecutor executor(4); // Exercise the threaded path everywhere.
+    for (int i = 0; i < 20; ++i) {
+        executor.parallelFor(0, n, [&](int index) {flags[index]++;});
+        executor.parallelFor(n/2, n, [&](int index) {flags[index]++;});
+    }
+    for (int j = 0; j < n; ++j)
+        ASSERT(flags[j] == (j < n/2 ? 20 : 40));
+    executor.parallelFor(5, 5, [&](int index) {flags[index]++;});
+    ASSERT(flags[5] == 20);
+}
+
+// One index is much more expensive than the others; the rest must still
+// all get done, and the per-thread results must add up.
+void testUnevenWork() {
+    const int n = 200;
+    Array_<int> flags(n, 0);
+    ParallelExecutor executor(4);
+    executor.parallelFor(0, n, [&](int index) {
+        if (index == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        flags[index]++;
+    });
+    for (int j = 0; j < n; ++j)
+        ASSERT(flags[j] == 1);
+}
+
+void testNestedExecution() {
+    const int outer = 16, inner = 50;
+    Array_<int> flags(outer*inner, 0);
+    ParallelExecutor executor(4);
+    executor.parallelFor(0, outer, [&](int i) {
+        executor.parallelFor(0, inner, [&](int j) {flags[i*inner+j]++;});
+    });
+    for (int j = 0; j < outer*inner; ++j)
+        ASSERT(flags[j] == 1);
+}
+
+// An exception thrown by the task on a worker must be rethrown by execute(),
+// and the executor must still be usable afterwards.
+void testWorkerException() {
+    const int n = 100;
+    Array_<int> flags(n, 0);
+    ParallelExecutor executor(4);
+    SimTK_TEST_MUST_THROW_EXC(executor.parallelFor(0, n, [&](int index) {
+        if (index == 77)
+            throw std::runtime_error("index 77 failed");
+    }), std::runtime_error);
+    executor.parallelFor(0, n, [&](int index) {flags[index]++;});
+    for (int j = 0; j < n; ++j)
+        ASSERT(flags[j] == 1);
+}
+
 void testResizeThreads() {
     for(int x = 1; x < 100; ++x)
     {
@@ -102,6 +160,10 @@ int main() {
     SimTK_START_TEST("TestParallelExecutor");
         SimTK_SUBTEST(testParallelExecution);
         SimTK_SUBTEST(testSingleThreadedExecution);
+        SimTK_SUBTEST(testParallelFor);
+        SimTK_SUBTEST(testUnevenWork);
+        SimTK_SUBTEST(testNestedExecution);
+        SimTK_SUBTEST(testWorkerException);
         SimTK_SUBTEST(testResizeThreads);
     SimTK_END_TEST();
     return 0;
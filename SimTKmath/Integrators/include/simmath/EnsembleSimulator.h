@@ -0,0 +1,144 @@
+#ifndef SimTK_SIMMATH_ENSEMBLE_SIMULATOR_H_
+#define SimTK_SIMMATH_ENSEMBLE_SIMULATOR_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include "simmath/internal/common.h"
+#include "simmath/Integrator.h"
+
+#include <functional>
+
+namespace SimTK {
+
+/**
+ * This class runs many independent simulations of the same System, each from
+ * its own initial State, using a pool of threads. Each run is an ordinary 
+ * TimeStepper simulation using its own freshly created Integrator, so every 
+ * run produces exactly the same trajectory it would have produced if it were
+ * simulated by itself, regardless of the number of threads or of which 
+ * thread picks it up. For example:
+ * 
+ * <pre>
+ * EnsembleSimulator ensemble(system, [](const System& sys) 
+ *     {   return new RungeKuttaMersonIntegrator(sys); });
+ * ensemble.setFinalTime(2);
+ * ensemble.setReportInterval(0.01);
+ * ensemble.setReportHandler([&](int run, const State& state) {...});
+ * ensemble.simulate(initialStates);
+ * const State& endOfRun3 = ensemble.getFinalState(3);
+ * </pre>
+ * 
+ * Runs are scheduled with a work-stealing ParallelExecutor, so runs that 
+ * finish early don't leave threads idle. The System, its subsystems, and any
+ * force elements, event handlers, and event reporters it contains must be 
+ * safe to use concurrently on different States. Parallel operations 
+ * requested inside the System (for example parallel force evaluation) run 
+ * serially within each run since the runs themselves already occupy the
+ * threads.
+ * 
+ * If a run throws an exception it is marked as failed and the exception
+ * message is recorded; the other runs continue.
+ */
+class SimTK_SIMMATH_EXPORT EnsembleSimulator {
+public:
+    /** A function that creates a new Integrator for the given System, 
+    including setting any accuracy or step size options. The 
+    EnsembleSimulator takes over ownership of the returned Integrator. **/
+    typedef std::function<Integrator*(const System&)> IntegratorFactory;
+    /** A function that is called with the index of the run and the State of
+    that run at each reporting time. Calls are serialized so the handler 
+    need not be thread-safe. Within a run the calls are made in time order,
+    but calls for different runs are interleaved arbitrarily. **/
+    typedef std::function<void(int run, const State& state)> ReportHandler;
+
+    /**
+     * Create an EnsembleSimulator for a System, using the given function
+     * to create an Integrator for each run and the given number of threads
+     * (by default the number of processors).
+     */
+    EnsembleSimulator(const System& system, 
+                      const IntegratorFactory& createIntegrator,
+                      int numThreads = ParallelExecutor::getNumProcessors());
+    ~EnsembleSimulator();
+
+    /**
+     * Set the time at which every run ends. This is required before calling
+     * simulate().
+     */
+    void setFinalTime(Real finalTime);
+    /** Get the time at which every run ends. **/
+    Real getFinalTime() const;
+    /**
+     * Set the interval between calls to the report handler, measured from 
+     * each run's initial time. The handler is always called for the initial
+     * and final State of each run. An interval of zero (the default) means 
+     * that only the initial and final States are reported.
+     */
+    void setReportInterval(Real interval);
+    /** Get the interval between calls to the report handler. **/
+    Real getReportInterval() const;
+    /**
+     * Set the function to be called with each reported State. By default 
+     * nothing is reported, but the final State of each run is always 
+     * available from getFinalState().
+     */
+    void setReportHandler(const ReportHandler& handler);
+
+    /** Get the maximum number of threads used for the runs. **/
+    int getNumThreads() const;
+
+    /**
+     * Simulate one run from each of the given initial States, returning
+     * when all runs have finished. Run i starts from initialStates[i]. The
+     * results from any previous call are discarded.
+     */
+    void simulate(const Array_<State>& initialStates);
+
+    /** Get the number of runs in the most recent call to simulate(). **/
+    int getNumRuns() const;
+    /** Get the State at which the given run ended. This is the State at the
+    final time unless the run was terminated early by an event handler. If
+the run failed this is an empty State. **/
+    const State& getFinalState(int run) const;
+    /** Return true if the given run ended with an exception. **/
+    bool didRunFail(int run) const;
+    /** If the given run failed, return the message of the exception that
+    caused the failure; otherwise return an empty string. **/
+    const std::string& getRunFailureMessage(int run) const;
+    /** Get the number of integration steps taken by the given run. **/
+    int getNumStepsTaken(int run) const;
+
+private:
+    // Don't allow copying.
+    EnsembleSimulator(const EnsembleSimulator&);
+    EnsembleSimulator& operator=(const EnsembleSimulator&);
+
+    class EnsembleSimulatorRep* rep;
+    friend class EnsembleSimulatorRep;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMMATH_ENSEMBLE_SIMULATOR_H_
@@ -0,0 +1,204 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/** @file
+ * This is the private (library side) implementation of the Simmath
+ * EnsembleSimulator class.
+ */
+
+#include "SimTKcommon.h"
+#include "simmath/TimeStepper.h"
+#include "simmath/EnsembleSimulator.h"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+namespace SimTK {
+
+    //////////////////////////////////
+    // CLASS ENSEMBLE SIMULATOR REP //
+    //////////////////////////////////
+
+class EnsembleSimulatorRep {
+public:
+    EnsembleSimulatorRep(const System& system, 
+                         const EnsembleSimulator::IntegratorFactory& factory,
+                         int numThreads)
+    :   system(system), createIntegrator(factory), executor(numThreads),
+        finalTime(NaN), reportInterval(0), initialStates(0) {}
+
+    // Carry out run number k. Everything the run touches other than the
+    // System and the report handler is local to this call.
+    void performRun(int k);
+
+    // Call the report handler, if any, one call at a time.
+    void report(int k, const State& state) {
+        if (!reportHandler) return;
+        std::lock_guard<std::mutex> guard(reportLock);
+        reportHandler(k, state);
+    }
+
+    const System&                           system;
+    EnsembleSimulator::IntegratorFactory    createIntegrator;
+    EnsembleSimulator::ReportHandler        reportHandler;
+    ParallelExecutor                        executor;
+    Real                                    finalTime;
+    Real                                    reportInterval;
+    std::mutex                              reportLock;
+
+    // Inputs and results of the most recent simulate(), indexed by run.
+    const Array_<State>*    initialStates;
+    Array_<State>           finalStates;
+    Array_<bool>            failed;
+    Array_<std::string>     failureMessages;
+    Array_<int>             numSteps;
+};
+
+void EnsembleSimulatorRep::performRun(int k) {
+    try {
+        std::unique_ptr<Integrator> integ(createIntegrator(system));
+        SimTK_ERRCHK1_ALWAYS(integ.get() != 0, 
+            "EnsembleSimulator::simulate()",
+            "The integrator factory returned a null Integrator for run %d.", k);
+        integ->setFinalTime(finalTime);
+        TimeStepper ts(system, *integ);
+        ts.initialize((*initialStates)[k]);
+        report(k, ts.getState());
+
+        // Compute each report time from the start time rather than 
+        // accumulating the interval, so round off doesn't depend on history.
+        const Real t0 = ts.getTime();
+        for (int i=1; !integ->isSimulationOver(); ++i) {
+            const Real t = reportInterval > 0 
+                ? std::min(t0 + i*reportInterval, finalTime) : finalTime;
+            ts.stepTo(t);
+            report(k, ts.getState());
+            if (ts.getTime() >= finalTime)
+                break;
+        }
+        finalStates[k] = ts.getState();
+        numSteps[k] = integ->getNumStepsTaken();
+    } catch (const std::exception& e) {
+        failed[k] = true;
+        failureMessages[k] = e.what();
+    } catch (...) {
+        failed[k] = true;
+        failureMessages[k] = "Run threw an exception that was not derived "
+                             "from std::exception.";
+    }
+}
+
+    //////////////////////////////////////////
+    // IMPLEMENTATION OF ENSEMBLE SIMULATOR //
+    //////////////////////////////////////////
+
+EnsembleSimulator::EnsembleSimulator(const System& system, 
+                                     const IntegratorFactory& createIntegrator,
+                                     int numThreads) 
+:   rep(new EnsembleSimulatorRep(system, createIntegrator, numThreads)) {}
+
+EnsembleSimulator::~EnsembleSimulator() {
+    delete rep;
+    rep = 0;
+}
+
+void EnsembleSimulator::setFinalTime(Real finalTime) {
+    rep->finalTime = finalTime;
+}
+
+Real EnsembleSimulator::getFinalTime() const {
+    return rep->finalTime;
+}
+
+void EnsembleSimulator::setReportInterval(Real interval) {
+    SimTK_APIARGCHECK1_ALWAYS(interval >= 0, "EnsembleSimulator", 
+        "setReportInterval", "Illegal report interval %g.", interval);
+    rep->reportInterval = interval;
+}
+
+Real EnsembleSimulator::getReportInterval() const {
+    return rep->reportInterval;
+}
+
+void EnsembleSimulator::setReportHandler(const ReportHandler& handler) {
+    rep->reportHandler = handler;
+}
+
+int EnsembleSimulator::getNumThreads() const {
+    return rep->executor.getMaxThreads();
+}
+
+void EnsembleSimulator::simulate(const Array_<State>& initialStates) {
+    SimTK_ERRCHK_ALWAYS(!isNaN(rep->finalTime), 
+        "EnsembleSimulator::simulate()",
+        "The final time must be set before simulating.");
+    const int nRuns = (int)initialStates.size();
+    rep->initialStates = &initialStates;
+    rep->finalStates.clear();       rep->finalStates.resize(nRuns);
+    rep->failed.assign(nRuns, false);
+    rep->failureMessages.clear();   rep->failureMessages.resize(nRuns);
+    rep->numSteps.assign(nRuns, 0);
+
+    // Don't keep a pointer to the caller's States past this call, however
+    // it ends.
+    EnsembleSimulatorRep& r = *rep;
+    try {
+        rep->executor.parallelFor(0, nRuns, [&r](int k) {r.performRun(k);});
+    } catch (...) {
+        rep->initialStates = 0;
+        throw;
+    }
+    rep->initialStates = 0;
+}
+
+int EnsembleSimulator::getNumRuns() const {
+    return (int)rep->finalStates.size();
+}
+
+const State& EnsembleSimulator::getFinalState(int run) const {
+    SimTK_INDEXCHECK_ALWAYS(run, getNumRuns(), 
+                            "EnsembleSimulator::getFinalState()");
+    return rep->finalStates[run];
+}
+
+bool EnsembleSimulator::didRunFail(int run) const {
+    SimTK_INDEXCHECK_ALWAYS(run, getNumRuns(), 
+                            "EnsembleSimulator::didRunFail()");
+    return rep->failed[run];
+}
+
+const std::string& EnsembleSimulator::getRunFailureMessage(int run) const {
+    SimTK_INDEXCHECK_ALWAYS(run, getNumRuns(), 
+                            "EnsembleSimulator::getRunFailureMessage()");
+    return rep->failureMessages[run];
+}
+
+int EnsembleSimulator::getNumStepsTaken(int run) const {
+    SimTK_INDEXCHECK_ALWAYS(run, getNumRuns(), 
+                            "EnsembleSimulator::getNumStepsTaken()");
+    return rep->numSteps[run];
+}
+
+} // namespace SimTK
@@ -0,0 +1,170 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKmath.h"
+#include "SimTKcommon/Testing.h"
+
+#include "PendulumSystem.h"
+
+#include <iostream>
+
+using namespace SimTK;
+
+using std::cout;
+using std::endl;
+
+const Real FinalTime = 3;
+const int  NumRuns   = 11;
+
+static Integrator* createIntegrator(const System& sys) {
+    Integrator* integ = new RungeKuttaMersonIntegrator(sys);
+    integ->setAccuracy(1e-4);
+    integ->setConstraintTolerance(1e-5);
+    return integ;
+}
+
+// Start each run at (x,y)=(1,0) with a different tangential speed.
+static Array_<State> makeInitialStates(PendulumSystem& sys) {
+    Array_<State> states;
+    for (int k=0; k < NumRuns; ++k) {
+        const Real qi[] = {1,0};
+        const Real ui[] = {0,Real(k)/4};
+        sys.setDefaultTimeAndState(0, Vector(2,qi), Vector(2,ui));
+        states.push_back(sys.getDefaultState());
+    }
+    return states;
+}
+
+// Each run must give exactly the same answer as a plain TimeStepper run.
+void testMatchesTimeStepper() {
+    PendulumSystem sys;
+    sys.realizeTopology();
+    sys.setDefaultMass(10);
+    const Array_<State> initialStates = makeInitialStates(sys);
+
+    EnsembleSimulator ensemble(sys, createIntegrator, 4);
+    ensemble.setFinalTime(FinalTime);
+    ensemble.simulate(initialStates);
+    SimTK_TEST(ensemble.getNumRuns() == NumRuns);
+
+    for (int k=0; k < NumRuns; ++k) {
+        RungeKuttaMersonIntegrator integ(sys);
+        integ.setAccuracy(1e-4);
+        integ.setConstraintTolerance(1e-5);
+        integ.setFinalTime(FinalTime);
+        TimeStepper ts(sys, integ);
+        ts.initialize(initialStates[k]);
+        ts.stepTo(FinalTime);
+
+        const State& s = ensemble.getFinalState(k);
+        SimTK_TEST(!ensemble.didRunFail(k));
+        SimTK_TEST(s.getTime() == FinalTime);
+        SimTK_TEST(ensemble.getNumStepsTaken(k) == integ.getNumStepsTaken());
+        for (int i=0; i < s.getNY(); ++i)
+            SimTK_TEST(s.getY()[i] == ts.getState().getY()[i]);
+    }
+}
+
+// Results and reports must not depend on the number of threads, and neither
+// may the System's statistics, which all the runs update concurrently.
+void testThreadCountIndependence() {
+    PendulumSystem sys;
+    sys.realizeTopology();
+    const Array_<State> initialStates = makeInitialStates(sys);
+
+    Array_<Array_<Real> > reportTimes[2];
+    Array_<Vector> finalY[2];
+    Array_<int> counts[2];
+    const int nThreads[2] = {1, 3};
+    for (int t=0; t < 2; ++t) {
+        sys.resetAllCountersToZero();
+        reportTimes[t].resize(NumRuns);
+        EnsembleSimulator ensemble(sys, createIntegrator, nThreads[t]);
+        SimTK_TEST(ensemble.getNumThreads() == nThreads[t]);
+        ensemble.setFinalTime(FinalTime);
+        ensemble.setReportInterval(0.5);
+        Array_<Array_<Real> >& times = reportTimes[t];
+        ensemble.setReportHandler([&times](int run, const State& state)
+        {   times[run].push_back(state.getTime()); });
+        ensemble.simulate(initialStates);
+        for (int k=0; k < NumRuns; ++k)
+            finalY[t].push_back(ensemble.getFinalState(k).getY());
+        for (int g=Stage::Time; g <= Stage::Report; ++g)
+            counts[t].push_back(sys.getNumRealizationsOfThisStage(Stage(g)));
+        counts[t].push_back(sys.getNumProjectQCalls());
+        counts[t].push_back(sys.getNumProjectUCalls());
+        counts[t].push_back(sys.getNumQProjections());
+        counts[t].push_back(sys.getNumUProjections());
+    }
+
+    SimTK_TEST(counts[0][Stage::Acceleration-Stage::Time] > 0);
+    SimTK_TEST(counts[0] == counts[1]);
+
+    for (int k=0; k < NumRuns; ++k) {
+        SimTK_TEST(reportTimes[0][k].size() == 7); // 0, .5, ..., 3
+        SimTK_TEST(reportTimes[0][k] == reportTimes[1][k]);
+        SimTK_TEST(reportTimes[0][k].back() == FinalTime);
+        for (int i=0; i < finalY[0][k].size(); ++i)
+            SimTK_TEST(finalY[0][k][i] == finalY[1][k][i]);
+    }
+}
+
+// A failed run is recorded without affecting the others.
+void testFailedRun() {
+    PendulumSystem sys;
+    sys.realizeTopology();
+    Array_<State> initialStates = makeInitialStates(sys);
+
+    int nCreated = 0;
+    EnsembleSimulator ensemble(sys, [&nCreated](const System& s) {
+            // Only one thread, so no need for synchronization here.
+            return ++nCreated == 3 ? (Integrator*)0 : createIntegrator(s);
+        }, 1);
+    SimTK_TEST_MUST_THROW(ensemble.simulate(initialStates)); // no final time
+    ensemble.setFinalTime(FinalTime);
+    ensemble.simulate(initialStates);
+    for (int k=0; k < NumRuns; ++k) {
+        SimTK_TEST(ensemble.didRunFail(k) == (k == 2));
+        SimTK_TEST(ensemble.getRunFailureMessage(k).empty() == (k != 2));
+        if (k != 2)
+            SimTK_TEST(ensemble.getFinalState(k).getTime() == FinalTime);
+    }
+
+    // Anything a run throws is caught, not just std::exceptions.
+    ensemble.setReportHandler([](int run, const State&) {
+            if (run == 5) throw run;
+        });
+    ensemble.simulate(initialStates);
+    for (int k=0; k < NumRuns; ++k) {
+        SimTK_TEST(ensemble.didRunFail(k) == (k == 5));
+        SimTK_TEST(ensemble.getRunFailureMessage(k).empty() == (k != 5));
+    }
+}
+
+int main() {
+    SimTK_START_TEST("EnsembleSimulatorTest");
+        SimTK_SUBTEST(testMatchesTimeStepper);
+        SimTK_SUBTEST(testThreadCountIndependence);
+        SimTK_SUBTEST(testFailedRun);
+    SimTK_END_TEST();
+}
@@ -174,12 +174,15 @@ public:
     class MobilityDiscreteForce;
     class DiscreteForces;
     class LinearBushing;
+    class LinearSpringArray;
+    class BushingArray;
     class ConstantForce;
     class ConstantTorque;
     class GlobalDamper;
     class Thermostat;
     class UniformGravity;
     class Gravity;
+    class UniformFluid;
     class Custom;
     
     class TwoPointLinearSpringImpl;
@@ -192,12 +195,15 @@ public:
     class MobilityDiscreteForceImpl;
     class DiscreteForcesImpl;
     class LinearBushingImpl;
+    class LinearSpringArrayImpl;
+    class BushingArrayImpl;
     class ConstantForceImpl;
     class ConstantTorqueImpl;
     class GlobalDamperImpl;
     class ThermostatImpl;
     class UniformGravityImpl;
     class GravityImpl;
+    class UniformFluidImpl;
     class CustomImpl;
 
 protected:
@@ -58,6 +58,21 @@ public:
     /// be at Dynamics stage or later.
     virtual Real calcPotentialEnergy(const State& state) const = 0;
 
+    /// Add in the change in this subsystem's body and mobility forces for a
+    /// change (\a dq, \a du) in the state, given the resulting change \a dX_GB
+    /// in each body's pose (as a twist, angular then linear, in Ground) and
+    /// \a dV_GB in each body's spatial velocity. Return false if that can't be
+    /// done analytically; the caller will then use finite differences. The
+    /// state must be at Dynamics stage or later. The default returns false.
+    virtual bool calcForceDerivative(const State&               state,
+                                     const Vector&              dq,
+                                     const Vector&              du,
+                                     const Vector_<SpatialVec>& dX_GB,
+                                     const Vector_<SpatialVec>& dV_GB,
+                                     Vector_<SpatialVec>&       dBodyForces,
+                                     Vector&                    dMobilityForces)
+                                     const { return false; }
+
     SimTK_DOWNCAST(ForceSubsystem::Guts, Subsystem::Guts);
 };
 
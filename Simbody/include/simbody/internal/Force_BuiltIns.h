@@ -31,16 +31,19 @@ other force elements; these are just the ones that are internal classes
 with the Force class, so logically their definitions are part of the
 Force class definition. **/
 
+#include "simbody/internal/Force_BushingArray.h"
 #include "simbody/internal/Force_Custom.h"
 #include "simbody/internal/Force_DiscreteForces.h"
 #include "simbody/internal/Force_Gravity.h"
 #include "simbody/internal/Force_LinearBushing.h"
+#include "simbody/internal/Force_LinearSpringArray.h"
 #include "simbody/internal/Force_MobilityConstantForce.h"
 #include "simbody/internal/Force_MobilityDiscreteForce.h"
 #include "simbody/internal/Force_MobilityLinearDamper.h"
 #include "simbody/internal/Force_MobilityLinearSpring.h"
 #include "simbody/internal/Force_MobilityLinearStop.h"
 #include "simbody/internal/Force_Thermostat.h"
+#include "simbody/internal/Force_UniformFluid.h"
 
 #endif // SimTK_SIMBODY_FORCE_BUILTINS_H_
 
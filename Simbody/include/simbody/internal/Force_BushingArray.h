@@ -0,0 +1,145 @@
+#ifndef SimTK_SIMBODY_FORCE_BUSHING_ARRAY_H_
+#define SimTK_SIMBODY_FORCE_BUSHING_ARRAY_H_
+
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include "simbody/internal/Force.h"
+
+/** @file
+This contains the user-visible API ("handle" class) for the SimTK::Force
+subclass Force::BushingArray and is logically part of Force.h. The file
+assumes that Force.h will have included all necessary declarations. **/
+
+namespace SimTK {
+
+/** A set of linear bushings, each connecting a frame F fixed on one body to
+a frame M fixed on another, calculated together as a single force element.
+
+Each bushing in the array generates exactly the same forces and potential
+energy as a Force::LinearBushing with the same frames, stiffness, and damping;
+see that class for the definition of the six coordinates q=[qx,qy,qz,px,py,pz]
+and the theory. Unlike Force::LinearBushing, the array does not keep track of
+the energy dissipated by its bushings.
+
+Use this element rather than many individual LinearBushing elements for large
+networks of bushings. The bushing parameters are kept in contiguous arrays and
+all the enabled bushings are evaluated together in a few tight loops, which
+avoids the per-element overhead of separate Force objects and lets the
+compiler vectorize the arithmetic. Each bushing can be enabled or disabled
+individually in a State; all the enable flags are held in a single
+Instance-stage state variable, so changing them is cheap but invalidates
+Stage::Instance.
+
+The stiffness forces depend only on positions so they are cached by the
+GeneralForceSubsystem and reused while the configuration doesn't change; only
+the damping forces are recalculated when just the velocities change. **/
+class SimTK_SIMBODY_EXPORT Force::BushingArray : public Force {
+public:
+    /** Create an empty %BushingArray force element; add bushings to it with
+    addBushing().
+    @param[in,out]  forces
+        The subsystem to which this force should be added.
+    @param[in]      matter
+        The subsystem containing the bodies that will be connected. **/
+    BushingArray(GeneralForceSubsystem&         forces,
+                 const SimbodyMatterSubsystem&  matter);
+
+    /** Default constructor creates an empty handle that can be assigned to
+    refer to any %BushingArray object. **/
+    BushingArray() {}
+
+    /** Add a bushing between a pair of arbitrary frames, one fixed to each of
+    two bodies. This is a topological change so realizeTopology() will have to
+    be called again before use.
+    @param[in]      body1
+        The first body to which the bushing is attached.
+    @param[in]      frameOnB1
+        The frame F fixed to body 1 given by its transform X_B1F.
+    @param[in]      body2
+        The second body to which the bushing is attached.
+    @param[in]      frameOnB2
+        The frame M fixed to body 2 given by its transform X_B2M.
+    @param[in]      stiffness
+        The six nonnegative spring constants, torsional followed by
+        translational.
+    @param[in]      damping
+        The six nonnegative damping coefficients, torsional followed by
+        translational.
+    @return
+        The index of the new bushing within this array (first is 0). **/
+    int addBushing(const MobilizedBody& body1, const Transform& frameOnB1,
+                   const MobilizedBody& body2, const Transform& frameOnB2,
+                   const Vec6& stiffness, const Vec6& damping);
+
+    /** Add a bushing connecting the body frames of two bodies. This is the
+    same as the more general addBushing() with identity transforms for the
+    two frames. **/
+    int addBushing(const MobilizedBody& body1, const MobilizedBody& body2,
+                   const Vec6& stiffness, const Vec6& damping)
+    {   return addBushing(body1, Transform(), body2, Transform(),
+                          stiffness, damping); }
+
+    /** Return the number of bushings in this array, whether or not they are
+    enabled. **/
+    int getNumBushings() const;
+
+    /** Set whether a bushing is enabled in the default state. Bushings are
+    enabled by default. This is a topological change.
+    @return
+        A writable reference to this modified force element for convenience in
+        chaining set methods. **/
+    BushingArray& setBushingIsEnabledByDefault(int bushing, bool enabled);
+    /** Return whether a bushing is enabled in the default state. **/
+    bool isBushingEnabledByDefault(int bushing) const;
+
+    /** Enable or disable a bushing in the given \a state. A disabled bushing
+    generates no force or energy and costs nothing to evaluate. This
+    invalidates Stage::Instance in \a state. **/
+    void setBushingIsEnabled(State& state, int bushing, bool enabled) const;
+    /** Return whether a bushing is enabled in the given \a state.
+    @pre \a state realized to Stage::Topology **/
+    bool isBushingEnabled(const State& state, int bushing) const;
+
+    /** Return the six generalized coordinates q of a bushing, rotations
+    first, as defined for Force::LinearBushing::getQ(). Returns NaN if the
+    bushing is disabled in \a state.
+    @pre \a state realized to Stage::Position **/
+    Vec6 getQ(const State& state, int bushing) const;
+
+    /** Return the six scalar generalized forces f that a bushing applies to
+    body 2, as defined for Force::LinearBushing::getF(). Returns NaN if the
+    bushing is disabled in \a state.
+    @pre \a state realized to Stage::Velocity **/
+    Vec6 getF(const State& state, int bushing) const;
+
+    /** @cond **/
+    SimTK_INSERT_DERIVED_HANDLE_DECLARATIONS(BushingArray,
+                                             BushingArrayImpl, Force);
+    /** @endcond **/
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMBODY_FORCE_BUSHING_ARRAY_H_
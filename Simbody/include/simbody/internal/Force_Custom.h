@@ -261,6 +261,44 @@ public:
     virtual bool shouldBeParallelIfPossible() const {
         return false;
     }
+    /**
+     * Optionally report which MobilizedBodies and which mobilities (elements
+     * of the state's u vector) calcForce() may apply forces to. This is only
+     * used for forces that are calculated in parallel (see
+     * shouldBeParallelIfPossible()). A force that reports what it affects
+     * deposits its results in a small buffer of its own instead of requiring
+     * each thread to accumulate into full-size force arrays, which matters
+     * when there are many cheap forces that each affect only a few bodies.
+     * The default implementation returns false, meaning that the force may
+     * affect any body or mobility.
+     *
+     * This is called at Instance stage and the answer must remain valid
+     * until the Instance stage is invalidated. Forces applied to bodies or
+     * mobilities that were not reported will produce wrong results. Particle
+     * forces are handled as usual and need not be reported.
+     *
+     * @param state          the State, realized through Model stage
+     * @param bodies         on return, the bodies this force may affect
+     * @param mobilities     on return, the mobilities this force may affect
+     * @return true if \a bodies and \a mobilities are complete; false if
+     *         they are unknown, in which case they are ignored
+     */
+    virtual bool findAffectedBodiesAndMobilities
+       (const State& state, Array_<MobilizedBodyIndex>& bodies,
+        Array_<UIndex>& mobilities) const {
+        return false;
+    }
+    /**
+     * Optionally return a rough estimate of the cost of calcForce(), relative
+     * to a simple two-point linear spring (which has cost 1). Forces that are
+     * calculated in parallel are divided into contiguous chunks of about equal
+     * total cost, a few per thread, so that the threads stay evenly loaded
+     * without scheduling each force separately. Only the relative sizes of
+     * the estimates matter. The default implementation returns 1.
+     */
+    virtual Real getCostEstimate() const {
+        return 1;
+    }
     /** The following methods may optionally be overridden to do specialized 
     realization for a Force. **/
     //@{
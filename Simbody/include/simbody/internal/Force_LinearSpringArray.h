@@ -0,0 +1,139 @@
+#ifndef SimTK_SIMBODY_FORCE_LINEAR_SPRING_ARRAY_H_
+#define SimTK_SIMBODY_FORCE_LINEAR_SPRING_ARRAY_H_
+
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include "simbody/internal/Force.h"
+
+/** @file
+This contains the user-visible API ("handle" class) for the SimTK::Force
+subclass Force::LinearSpringArray and is logically part of Force.h. The file
+assumes that Force.h will have included all necessary declarations. **/
+
+namespace SimTK {
+
+/** A set of linear spring-dampers, each acting between a station on one body
+and a station on another, calculated together as a single force element.
+
+Each spring in the array behaves like a Force::TwoPointLinearSpring combined
+with a Force::TwoPointLinearDamper acting between the same two points. If d
+is the unit vector from point 1 to point 2, x the current separation, and
+xdot its rate of change, the spring tension is t = k (x-x0) + c xdot; we
+apply t*d to point 1 and -t*d to point 2. The spring contributes potential
+energy pe = 1/2 k (x-x0)^2; the damping contributes none. It is an error if
+the two points of an enabled spring become coincident.
+
+Use this element rather than many individual force elements for large
+networks of similar springs, such as tissue or cable-net models. The spring
+parameters are kept in contiguous arrays, one per parameter, and all the
+enabled springs are evaluated together in a few tight loops, which avoids the
+per-element overhead of separate Force objects and lets the compiler
+vectorize the arithmetic. Each spring can be enabled or disabled individually
+in a State; all the enable flags are held in a single Instance-stage state
+variable, so changing them is cheap but invalidates Stage::Instance.
+
+The stiffness forces depend only on positions so they are cached by the
+GeneralForceSubsystem and reused while the configuration doesn't change; only
+the damping forces are recalculated when just the velocities change. **/
+class SimTK_SIMBODY_EXPORT Force::LinearSpringArray : public Force {
+public:
+    /** Create an empty %LinearSpringArray force element; add springs to it
+    with addSpring().
+    @param[in,out]  forces
+        The subsystem to which this force should be added.
+    @param[in]      matter
+        The subsystem containing the bodies that will be connected. **/
+    LinearSpringArray(GeneralForceSubsystem&         forces,
+                      const SimbodyMatterSubsystem&  matter);
+
+    /** Default constructor creates an empty handle that can be assigned to
+    refer to any %LinearSpringArray object. **/
+    LinearSpringArray() {}
+
+    /** Add a spring to this array. This is a topological change so
+    realizeTopology() will have to be called again before use.
+    @param[in]      body1
+        The first body to which the spring is attached.
+    @param[in]      station1
+        The attachment point on body 1, given in the body 1 frame.
+    @param[in]      body2
+        The second body to which the spring is attached.
+    @param[in]      station2
+        The attachment point on body 2, given in the body 2 frame.
+    @param[in]      stiffness
+        The spring constant k (>= 0).
+    @param[in]      restLength
+        The separation x0 (>= 0) at which the spring generates no force.
+    @param[in]      damping
+        The damping coefficient c (>= 0), zero by default.
+    @return
+        The index of the new spring within this array (first is 0). **/
+    int addSpring(const MobilizedBody& body1, const Vec3& station1,
+                  const MobilizedBody& body2, const Vec3& station2,
+                  Real stiffness, Real restLength, Real damping = 0);
+
+    /** Return the number of springs in this array, whether or not they are
+    enabled. **/
+    int getNumSprings() const;
+
+    /** Set whether a spring is enabled in the default state. Springs are
+    enabled by default. This is a topological change.
+    @return
+        A writable reference to this modified force element for convenience in
+        chaining set methods. **/
+    LinearSpringArray& setSpringIsEnabledByDefault(int spring, bool enabled);
+    /** Return whether a spring is enabled in the default state. **/
+    bool isSpringEnabledByDefault(int spring) const;
+
+    /** Enable or disable a spring in the given \a state. A disabled spring
+    generates no force or energy and costs nothing to evaluate. This
+    invalidates Stage::Instance in \a state. **/
+    void setSpringIsEnabled(State& state, int spring, bool enabled) const;
+    /** Return whether a spring is enabled in the given \a state.
+    @pre \a state realized to Stage::Topology **/
+    bool isSpringEnabled(const State& state, int spring) const;
+
+    /** Return the current separation x of the two points of a spring. This is
+    calculated along with the spring forces; the first call after a position
+    change may initiate that calculation. Returns NaN if the spring is
+    disabled in \a state.
+    @pre \a state realized to Stage::Position **/
+    Real getLength(const State& state, int spring) const;
+
+    /** Return the current tension t of a spring; positive when the points
+    are being pulled together. Returns NaN if the spring is disabled in
+    \a state.
+    @pre \a state realized to Stage::Velocity **/
+    Real getTension(const State& state, int spring) const;
+
+    /** @cond **/
+    SimTK_INSERT_DERIVED_HANDLE_DECLARATIONS(LinearSpringArray,
+                                             LinearSpringArrayImpl, Force);
+    /** @endcond **/
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMBODY_FORCE_LINEAR_SPRING_ARRAY_H_
@@ -0,0 +1,182 @@
+#ifndef SimTK_SIMBODY_FORCE_UNIFORM_FLUID_H_
+#define SimTK_SIMBODY_FORCE_UNIFORM_FLUID_H_
+
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include "simbody/internal/Force.h"
+#include "simbody/internal/Force_Gravity.h"
+
+/** @file
+This contains the user-visible API ("handle" class) for the SimTK::Force
+subclass Force::UniformFluid and is logically part of Force.h. The file
+assumes that Force.h will have included all necessary declarations. **/
+
+namespace SimTK {
+
+/** A uniform fluid of density rho, optionally flowing with a uniform velocity
+v_f, that applies buoyancy and drag to a set of immersed bodies, calculated
+together as a single force element.
+
+Each body added to the fluid is given a displaced volume V, a center of
+buoyancy station C fixed on the body, and linear and quadratic drag
+coefficients for each of its body-frame axes. The buoyancy force -rho V g,
+where g is the gravity vector of an associated Force::Gravity element, acts
+at C; bodies excluded from that Gravity element (see
+Force::Gravity::setBodyIsExcluded()) are not buoyant. Let w be the body's
+angular velocity and v the velocity of C relative to the fluid, both
+expressed in the body frame B. Then the drag moment about C and the drag
+force at C are, in B, component by component
+<pre>
+    m_i = -(cl_i + cq_i |w_i|) w_i,    f_i = -(cl_{i+3} + cq_{i+3} |v_i|) v_i
+</pre>
+where the 6-vectors cl and cq hold the rotational coefficients followed by
+the translational ones, as for Force::LinearBushing. Buoyancy contributes
+potential energy rho V (g . p_GC) where p_GC is the location of C in Ground;
+drag contributes none.
+
+A region, an axis-aligned box in Ground, can be set so that only bodies whose
+center of buoyancy is inside it feel the fluid. Membership is found once per
+configuration and the rest of the calculation runs only over the bodies
+inside, so the cost is linear in the number of bodies with a small constant.
+By default the region is unbounded.
+
+The parameters are kept one array per parameter, as for
+Force::LinearSpringArray, and the forces for all the bodies are evaluated in
+a few tight loops. Buoyancy depends only on positions so it is cached by the
+GeneralForceSubsystem; only the drag is recalculated when just the
+velocities change. Changing the associated Gravity element in a State
+discards the cached buoyancy.
+
+Added-mass effects are not modeled since a Force cannot depend on
+accelerations; include them in the bodies' mass properties instead. **/
+class SimTK_SIMBODY_EXPORT Force::UniformFluid : public Force {
+public:
+    /** Create an empty %UniformFluid force element; add bodies to it with
+    addBody().
+    @param[in,out]  forces
+        The subsystem to which this force should be added.
+    @param[in]      matter
+        The subsystem containing the immersed bodies.
+    @param[in]      gravity
+        The gravity element whose gravity vector determines buoyancy. If this
+        is an empty handle there is no buoyancy.
+    @param[in]      defaultDensity
+        The default fluid density rho (>= 0). **/
+    UniformFluid(GeneralForceSubsystem&         forces,
+                 const SimbodyMatterSubsystem&  matter,
+                 const Force::Gravity&          gravity,
+                 Real                           defaultDensity);
+
+    /** Default constructor creates an empty handle that can be assigned to
+    refer to any %UniformFluid object. **/
+    UniformFluid() {}
+
+    /** Immerse a body in this fluid. This is a topological change so
+    realizeTopology() will have to be called again before use.
+    @param[in]      body
+        The immersed body.
+    @param[in]      volume
+        The volume V (>= 0) of fluid displaced by the body.
+    @param[in]      centerOfBuoyancy
+        The station C on the body, given in the body frame, at which buoyancy
+        and drag act.
+    @param[in]      linearDrag
+        The six nonnegative linear drag coefficients cl, rotational followed
+        by translational, for the body frame axes.
+    @param[in]      quadraticDrag
+        The six nonnegative quadratic drag coefficients cq, ordered as for
+        \a linearDrag.
+    @return
+        The index of the new entry within this fluid (first is 0). **/
+    int addBody(const MobilizedBody& body, Real volume,
+                const Vec3& centerOfBuoyancy,
+                const Vec6& linearDrag, const Vec6& quadraticDrag);
+
+    /** Return the number of bodies immersed in this fluid, whether or not
+    they are currently inside its region. **/
+    int getNumBodies() const;
+
+    /** Set the density rho that will be used by default. This is a
+    topological change.
+    @return
+        A writable reference to this modified force element for convenience in
+        chaining set methods. **/
+    UniformFluid& setDefaultDensity(Real density);
+    /** Set the flow velocity v_f, in Ground, that will be used by default.
+    This is a topological change. **/
+    UniformFluid& setDefaultFlowVelocity(const Vec3& flowVelocity);
+    /** Set the box in Ground, given by its \a low and \a high corners, that
+    will be used by default as the region in which bodies feel the fluid.
+    This is a topological change. **/
+    UniformFluid& setDefaultRegion(const Vec3& low, const Vec3& high);
+
+    /** Return the default density rho. **/
+    Real getDefaultDensity() const;
+    /** Return the default flow velocity v_f. **/
+    const Vec3& getDefaultFlowVelocity() const;
+    /** Return the low and high corners of the default region. **/
+    void getDefaultRegion(Vec3& low, Vec3& high) const;
+
+    /** Set the density rho in the given \a state. This invalidates
+    Stage::Dynamics and discards the cached buoyancy forces. **/
+    void setDensity(State& state, Real density) const;
+    /** Set the flow velocity v_f in the given \a state. This invalidates
+    Stage::Dynamics. **/
+    void setFlowVelocity(State& state, const Vec3& flowVelocity) const;
+    /** Set the region in the given \a state. This invalidates
+    Stage::Dynamics and discards the cached region membership and buoyancy
+    forces. **/
+    void setRegion(State& state, const Vec3& low, const Vec3& high) const;
+
+    /** Return the density rho set in \a state.
+    @pre \a state realized to Stage::Topology **/
+    Real getDensity(const State& state) const;
+    /** Return the flow velocity v_f set in \a state.
+    @pre \a state realized to Stage::Topology **/
+    const Vec3& getFlowVelocity(const State& state) const;
+    /** Return the low and high corners of the region set in \a state.
+    @pre \a state realized to Stage::Topology **/
+    void getRegion(const State& state, Vec3& low, Vec3& high) const;
+
+    /** Return true if the center of buoyancy of a body's entry is inside
+    the region in the given \a state. The first call after a position change
+    may initiate the membership calculation.
+    @pre \a state realized to Stage::Position **/
+    bool isBodyInRegion(const State& state, int entry) const;
+
+    /** Return the number of bodies whose center of buoyancy is inside the
+    region in the given \a state.
+    @pre \a state realized to Stage::Position **/
+    int getNumBodiesInRegion(const State& state) const;
+
+    /** @cond **/
+    SimTK_INSERT_DERIVED_HANDLE_DECLARATIONS(UniformFluid, UniformFluidImpl,
+                                             Force);
+    /** @endcond **/
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMBODY_FORCE_UNIFORM_FLUID_H_
@@ -90,7 +90,14 @@ public:
     calculate computationally expensive forces (that have the
     shouldBeParallelIfPossible() method overridden). By default, the
     number of threads is the number of total processors (including hyperthreads)
-    on the machine.
+    on the machine. Parallel forces that report which bodies and mobilities
+    they affect (see
+    Force::Custom::Implementation::findAffectedBodiesAndMobilities()) are
+    accumulated into small per-force buffers rather than full-size per-thread
+    arrays, and are added into the results in a fixed order. States that
+    have already been realized remain valid; their parallel forces are
+    redivided among the new number of threads the next time they are
+    realized through Stage::Dynamics.
     
     @note This method should NOT be called while realizing Stage::Dynamics.**/
     void setNumberOfThreads(unsigned numThreads);
@@ -103,6 +110,58 @@ public:
     computations**/
     int getNumberOfThreads() const;
 
+    /** Allow built-in force elements that are safe to calculate concurrently
+    (two-point springs, dampers and constant forces, mobility springs,
+    dampers and constant forces, constant body forces and torques, and linear
+    bushings) to be calculated in parallel along with any Force::Custom
+    elements that have shouldBeParallelIfPossible() overridden. This is
+    worthwhile for models with thousands of such elements. The parallel
+    forces are divided into chunks of about equal estimated cost rather than
+    being scheduled one at a time (see
+    Force::Custom::Implementation::getCostEstimate()). The default is
+    false; changing it invalidates the subsystem's Topology stage. **/
+    void setUseParallelBuiltInForces(bool useParallel);
+
+    /** Return the current setting of the flag set by
+    setUseParallelBuiltInForces(). **/
+    bool getUseParallelBuiltInForces() const;
+
+    /** Force elements that depend only on positions (see
+    Force::Custom::Implementation::dependsOnlyOnPositions()), and the
+    position-only parts of built-in force elements like springs with damping,
+    are calculated once per configuration and cached here; only the
+    velocity-dependent forces are recalculated when just the velocities
+    change. Normally that cache is discarded whenever Stage::Position is
+    invalidated. If this flag is set, the cache is instead kept as long as
+    the time, the generalized coordinates q, and Stage::Instance are the same
+    as when the cache was filled, so that evaluations that revisit the same
+    configuration (as an implicit integrator does when it perturbs only the
+    velocities to form a Jacobian) reuse it.
+
+    Only the time, q, and the Topology through Instance stage versions are
+    compared. A change to a discrete state variable whose invalidated stage is
+    Time or Position (in any subsystem) invalidates Stage::Position just as a
+    change to q does, but is not recorded separately, so it is \e not
+    detected here. If any of your position-only forces depends on such a
+    variable, either leave this flag off or call invalidateCachedForces()
+    whenever you change that variable. The default is false; changing it
+    invalidates the subsystem's Topology stage. **/
+    void setReuseCachedForcesAtSameConfiguration(bool reuse);
+
+    /** Return the current setting of the flag set by
+    setReuseCachedForcesAtSameConfiguration(). **/
+    bool getReuseCachedForcesAtSameConfiguration() const;
+
+    /** Discard the cached position-only forces in \a state so that they will
+    be recalculated at the next realization of Stage::Dynamics. Built-in force
+    elements call this when one of their parameters changes; a
+    Force::Custom element whose dependsOnlyOnPositions() forces depend on its
+    own Dynamics-stage state variables must call it when those change, as
+    must anyone changing a Time- or Position-stage discrete variable that a
+    position-only force depends on while
+    setReuseCachedForcesAtSameConfiguration() is in effect. **/
+    void invalidateCachedForces(const State& state) const;
+
     /** Every Subsystem is owned by a System; a GeneralForceSubsystem expects
     to be owned by a MultibodySystem. This method returns a const reference
     to the containing MultibodySystem and will throw an exception if there is
@@ -39,6 +39,7 @@ namespace SimTK {
 class MobilizedBody;
 class MultibodySystem;
 class Constraint;
+class TaskJacobianPlan;
 
 class UnilateralContact;
 class StateLimitedFriction;
@@ -205,6 +206,165 @@ void setShowDefaultGeometry(bool show);
 geometry that can be used to visualize this multibody system. **/
 bool getShowDefaultGeometry() const;
 
+/** Request that the base-to-tip and tip-to-base sweeps over the multibody 
+tree (position and velocity kinematics, articulated body inertias, forward 
+and inverse dynamics, and the mass matrix operators) be run in parallel. At 
+realizeTopology() the tree is split into a small serial trunk containing 
+Ground and, if necessary, bodies near the root, plus balanced groups of 
+independent subtrees hanging off the trunk; the groups are then swept 
+concurrently. This pays off for models with many bodies spread over several 
+branches (e.g. several robots or vehicles in one system); for a single serial
+chain there is nothing to run in parallel. Results are identical to the 
+serial ones since every body's computation is unchanged. This is off by 
+default. If you turn it on, any custom mobilizers in the system must be safe
+to evaluate concurrently. **/
+void setUseParallelTreeSweeps(bool useParallel);
+/** Return whether parallel tree sweeps have been requested. 
+@see setUseParallelTreeSweeps() **/
+bool getUseParallelTreeSweeps() const;
+/** Set the number of threads used for parallel tree sweeps and parallel 
+constraint evaluation. By default this is the number of processors. This 
+invalidates the subsystem topology since the tree partitioning depends on it.
+@see setUseParallelTreeSweeps(), setUseParallelConstraintEvaluation() **/
+void setNumberOfThreads(int numThreads);
+/** Get the number of threads used for parallel tree sweeps. **/
+int getNumberOfThreads() const;
+
+/** Request that the per-constraint calculations of position, velocity, and
+acceleration constraint errors, and of constraint forces from multipliers, 
+be run in parallel. The Constraints are split into a fixed number of 
+contiguous blocks (depending on the number of Constraints and the number of
+threads set with setNumberOfThreads()) which are evaluated concurrently. 
+Errors are identical to the serial ones; constraint forces are accumulated 
+separately for each block and then added together in block order, so they 
+are reproducible from run to run but may differ from the serial result in 
+the last bits. This pays off for systems with thousands of small constraints;
+with fewer than a few dozen Constraints everything stays serial. This is off
+by default. If you turn it on, any custom constraints in the system must be 
+safe to evaluate concurrently. That includes the built-in constraints that 
+evaluate a user-supplied Function (Constraint::CoordinateCoupler, 
+Constraint::SpeedCoupler, and Constraint::PrescribedMotion): their Function
+objects will be called from several threads at once, so they must be 
+thread-safe (no unsynchronized mutable state such as internal caches). **/
+void setUseParallelConstraintEvaluation(bool useParallel);
+/** Return whether parallel constraint evaluation has been requested. 
+@see setUseParallelConstraintEvaluation() **/
+bool getUseParallelConstraintEvaluation() const;
+
+/** Constraint multipliers are calculated by factoring the m X m matrix 
+G M^-1 ~G, where m is the number of constraint equations. The factorization
+is cached in the State and reused until time, the generalized coordinates q,
+or an Instance-stage variable changes (or the generalized speeds u, if there 
+are nonholonomic or acceleration-only constraints). By default we use a 
+rank-revealing QTZ factorization that handles redundant constraints. If you 
+know your constraints are independent and transmit their forces through 
+~G (true for ordinary, non-working constraints), the matrix is 
+symmetric and positive definite and you can request the roughly 
+three-times-cheaper Cholesky factorization instead. If the Cholesky 
+factorization fails we fall back to QTZ automatically. This is off by 
+default.
+
+When the constraints are sparsely coupled (each acting on only a few of many
+independent subtrees of the multibody tree, as in lattices of particles),
+the entries of the matrix are computed for a whole group of uncoupled 
+constraints at once, with either factorization. With this option on the
+matrix is also stored and factored in sparse (profile) form, without O(m^2)
+storage; the QTZ factorization stores it densely. Position and velocity 
+projection always use a dense factorization of the constraint Jacobians.
+
+With this option on, realizing Stage::Acceleration for a State that is 
+already realized through Stage::Dynamics performs no heap allocation in this
+subsystem once that State has been through one such realization. That 
+covers the tree and loop forward dynamics operators, the constraint error 
+and constraint force calculations, and the multiplier solve. It does not 
+cover the realization of earlier stages, other subsystems, the iterative
+multiplier solver, or the default QTZ multiplier solve, which allocates 
+temporaries each time it is used. **/
+void setUseCholeskyForMultipliers(bool useCholesky);
+/** Return whether a Cholesky factorization has been requested for 
+calculating constraint multipliers.
+@see setUseCholeskyForMultipliers() **/
+bool getUseCholeskyForMultipliers() const;
+/** Request that constraint multipliers be calculated with a preconditioned
+conjugate gradient method instead of by factoring G M^-1 ~G. The matrix is 
+never formed; each iteration costs O(n) using the same operators as 
+multiplyByMInv() and multiplyByG(), and each solve starts from the 
+multipliers found by the previous one at the same State, which are usually
+an excellent guess during time stepping. This can be much faster for very 
+large constrained systems. It requires G M^-1 ~G to be symmetric and positive
+definite; if the iteration fails to converge we fall back to the direct 
+factorization automatically. This is off by default.
+@see setIterativeMultiplierSolverTolerance() **/
+void setUseIterativeMultiplierSolver(bool useIterative);
+/** Return whether the iterative multiplier solver has been requested.
+@see setUseIterativeMultiplierSolver() **/
+bool getUseIterativeMultiplierSolver() const;
+/** Set the relative residual tolerance at which the iterative multiplier
+solver stops: the residual norm must be no more than \a tol times the norm
+of the constraint acceleration errors being removed. The default is 1e-10.
+@see setUseIterativeMultiplierSolver() **/
+void setIterativeMultiplierSolverTolerance(Real tol);
+/** Return the relative tolerance used by the iterative multiplier solver.
+@see setIterativeMultiplierSolverTolerance() **/
+Real getIterativeMultiplierSolverTolerance() const;
+
+/** Request that position kinematics be recalculated incrementally. Normally
+any change to the generalized coordinates q causes the transforms, Jacobian
+blocks, and spatial inertias of every body to be recalculated at the next
+realize(Stage::Position). With this option on we remember the q's used last
+time, and if only a few mobilizers' q's have changed since (for example
+after setOneQ() or MobilizedBody::setQ() on a wrist joint) we recalculate 
+only the bodies outboard of those mobilizers; everything inboard and on 
+other branches is left as it was. Constraint kinematics and everything 
+later in the realization are still recalculated in full. If more than half 
+the bodies would need recalculating we do the ordinary full sweep instead.
+Results are identical either way. This is off by default. If you turn it on,
+any custom mobilizers in the system must calculate their kinematics from 
+their own q's only. **/
+void setUseIncrementalPositionKinematics(bool useIncremental);
+/** Return whether incremental position kinematics has been requested.
+@see setUseIncrementalPositionKinematics() **/
+bool getUseIncrementalPositionKinematics() const;
+
+/** Request that position and velocity projection (see projectQ() and 
+projectU()) use a modified Newton iteration that reuses an existing 
+factorization of the weighted constraint Jacobian. Normally projectQ() forms
+and factors the Jacobian in every iteration and projectU() does so once per
+call. With this option each projection starts with the factorization left 
+in the State by the previous one, since during time stepping the 
+configuration changes little between projections, and refactors only if an
+iteration with it makes the constraint errors worse or reduces them too 
+slowly. The result satisfies the constraints to the requested accuracy but 
+may differ slightly from the full Newton result. The ProjectOptions 
+ForceFullNewton option overrides this for a single call. This is off by 
+default.
+@see getNumQProjectionFactorizations() **/
+void setUseModifiedNewtonProjection(bool useModifiedNewton);
+/** Return whether modified Newton projection has been requested.
+@see setUseModifiedNewtonProjection() **/
+bool getUseModifiedNewtonProjection() const;
+
+/** Return the number of times projectQ() has factored the position 
+constraint Jacobian using this State since it was created by 
+realizeTopology() or resetProjectionStatistics() was last called. **/
+int getNumQProjectionFactorizations(const State& state) const;
+/** Return the number of position constraint Jacobian factorizations that
+projectQ() avoided by reusing an existing one; a full Newton iteration 
+would have performed them. A reuse whose step made the errors worse, and
+so had to be followed by a fresh factorization, is not counted. **/
+int getNumQProjectionFactorizationsAvoided(const State& state) const;
+/** Return the number of times projectU() has factored the velocity 
+constraint Jacobian using this State. **/
+int getNumUProjectionFactorizations(const State& state) const;
+/** Return the number of calls to projectU() that reused an existing 
+factorization of the velocity constraint Jacobian instead of forming one.
+A call whose first step with the old factorization made the errors worse is
+not counted. **/
+int getNumUProjectionFactorizationsAvoided(const State& state) const;
+/** Set all the projection factorization counters in this State to zero.
+@see getNumQProjectionFactorizations() **/
+void resetProjectionStatistics(State& state) const;
+
 /** The number of bodies includes all mobilized bodies \e including Ground,
 which is the first mobilized body, at MobilizedBodyIndex 0. (Note: if 
 special particle handling were implemented, the count here would \e not 
@@ -1353,12 +1513,49 @@ like multiplyByM() which calculates the matrix-vector product M*v in O(n)
 without explicitly forming M. Also, don't invert this matrix numerically to get
 M^-1. Instead, call the method calcMInv() which can produce M^-1 directly.
 
+M is formed with the composite rigid body method, which computes only the
+lower triangle and skips the entries that are structurally zero because the
+corresponding mobilities are on different branches of the tree. The matrix is
+cached in the State, so repeated calls at the same configuration cost only the
+O(n^2) copy into \a M. Changes to velocities or forces don't invalidate it; 
+changes to q or to Instance-stage variables do.
+
 @par Required stage
   \c Stage::Position 
 
-@see multiplyByM(), calcMInv() **/
+@see multiplyByM(), calcMInv(), solveM() **/
 void calcM(const State&, Matrix& M) const;
 
+/** Solve M*udot=f for udot using a sparse factorization M = ~L*D*L of the 
+full mass matrix, including the rows and columns of any prescribed mobilities.
+L has the same branch-induced sparsity as M so the factorization produces no
+fill-in; its cost is O(n*d^2) for a tree of depth d, and each subsequent solve
+costs O(n*d). The factorization is cached in the State and reused until the
+configuration changes, so this is the fast way to apply M^-1 to many right 
+hand sides at the same configuration.
+
+For ordinary forward dynamics use multiplyByMInv() instead, which is O(n),
+needs no factorization, and restricts itself to the free mobilities as the
+dynamics requires. 
+
+@param[in]      state
+    A State realized through Stage::Position.
+@param[in]      f
+    A mobility-space vector of length nu.
+@param[out]     udot
+    The solution, resized to nu if necessary.
+
+@par Required stage
+  \c Stage::Position 
+
+@see calcM(), multiplyByMInv() **/
+void solveM(const State& state, const Vector& f, Vector& udot) const;
+
+/** Same as the other signature but solves for each column of \a F, which must
+have nu rows; \a Udot is resized to match. The factorization is computed at
+most once. **/
+void solveM(const State& state, const Matrix& F, Matrix& Udot) const;
+
 /** This operator explicitly calculates the inverse of the part of the system
 mobility-space mass matrix corresponding to free (non-prescribed)
 mobilities. The returned matrix is always n X n, but rows and columns 
@@ -1370,7 +1567,8 @@ DYNAMICS</em>. To do so would change an O(n) operation into an O(n^2) one.
 Instead, see if you can accomplish what you need with O(n) operators like 
 multiplyByMInv() which calculates the matrix-vector product M^-1*v in O(n) 
 without explicitly forming M or M^-1. If you need M explicitly, you can get it
-with the calcM() method.
+with the calcM() method. Like M, the result is cached in the State until the
+configuration changes.
 
 @par Required stage
   \c Stage::Position (articulated body inertias realized first if necessary)
@@ -1420,6 +1618,13 @@ Even if G and M^-1 were already available, computing W by matrix multiplication
 would cost O(m^2*n + m*n^2) time and O(m*n) intermediate storage. Here we do 
 it in O(m*n) time with O(n) intermediate storage, which is a \e lot better.
 
+Constraints that act on disjoint subtrees of the multibody tree (that is, 
+subtrees with different base bodies) are not coupled through M^-1, so their
+block of W is zero. We exploit that by applying the operators to several 
+unit vectors at once, one for each of a group of Constraints no two of which
+are coupled to the same Constraint. For systems like particle lattices that
+reduces the number of operator applications from m to a small constant.
+
 @par Required stage
   \c Stage::Velocity (articulated body inertias realized first if necessary)
      
@@ -1428,6 +1633,59 @@ it in O(m*n) time with O(n) intermediate storage, which is a \e lot better.
 void calcProjectedMInv(const State&   s,
                        Matrix&        GMInvGt) const;
 
+/** Calculate the inverse of the task-space (operational-space) inertia 
+Lambda^-1 = J M^-1 ~J for the station and frame tasks of a TaskJacobianPlan,
+where J is the plan's task Jacobian. The result is square with 
+tasks.getNumRows() rows, arranged as described for TaskJacobianPlan. As for 
+multiplyByMInv(), M^-1 is restricted to the free (non-prescribed) mobilities, 
+and constraints are ignored.
+
+Neither J nor M^-1 is formed. Instead, an outward sweep over the bodies on the
+tasks' paths uses the articulated body inertias to calculate for each body B
+the 6x6 matrix Omega_B, the spatial acceleration of B produced by a unit
+spatial force applied to B. Each task's force is then carried inward along its
+path through the articulated body force shifts, and the coupling between two 
+tasks is read off at their nearest common ancestor. The cost is O(n) for the 
+sweep plus O(d) per task and O(1) per pair of tasks for a tree of depth d, 
+compared with O(m*n) for m task rows by multiplying by M^-1 column by column.
+
+@par Required stage
+  \c Stage::Position (articulated body inertias realized first if necessary)
+
+@see calcTaskSpaceInertia(), calcProjectedMInv(), TaskJacobianPlan **/
+void calcTaskSpaceInertiaInverse(const State&            state,
+                                 const TaskJacobianPlan& tasks,
+                                 Matrix&                 LambdaInv) const;
+
+/** Alternate signature for station tasks only, with the task bodies and
+stations given as arrays like calcStationJacobian(); the result has 3 rows and
+columns per station. **/
+void calcTaskSpaceInertiaInverse(const State&                      state,
+                                 const Array_<MobilizedBodyIndex>& onBodyB,
+                                 const Array_<Vec3>&               p_BS,
+                                 Matrix&                           LambdaInv) 
+                                 const;
+
+/** Calculate the task-space (operational-space) inertia 
+Lambda = (J M^-1 ~J)^-1 for the station and frame tasks of a TaskJacobianPlan,
+by inverting the result of calcTaskSpaceInertiaInverse(). If the tasks are 
+redundant, J M^-1 ~J is singular and the pseudoinverse is returned instead.
+
+@par Required stage
+  \c Stage::Position (articulated body inertias realized first if necessary)
+
+@see calcTaskSpaceInertiaInverse() **/
+void calcTaskSpaceInertia(const State&            state,
+                          const TaskJacobianPlan& tasks,
+                          Matrix&                 Lambda) const;
+
+/** Alternate signature for station tasks only; see 
+calcTaskSpaceInertiaInverse(). **/
+void calcTaskSpaceInertia(const State&                      state,
+                          const Array_<MobilizedBodyIndex>& onBodyB,
+                          const Array_<Vec3>&               p_BS,
+                          Matrix&                           Lambda) const;
+
 /** Given a set of desired constraint-space speed changes, calculate the
 corresponding constraint-space impulses that would cause those changes. Here we 
 are solving the equation
@@ -2086,6 +2344,11 @@ the system are ignored.
      measure of how much the given \a knownUdot fails to satisfy the equations 
      of motion.
 
+This method keeps its temporaries in the cache of the given \a state so that
+repeated calls don't allocate. Hence it must not be called concurrently on the
+same State, even though \a state is const; concurrent calls on different 
+States are fine.
+
 @par Required stage
   \c Stage::Velocity 
 
@@ -2169,6 +2432,74 @@ void calcResidualForce
     const Vector&              knownLambda,
     Vector&                    residualMobilityForces) const;
 
+/** Calculate the partial derivatives of unconstrained forward dynamics with
+respect to the generalized coordinates q, the generalized speeds u, and 
+additional generalized forces tau. The forward dynamics here is that of
+calcAccelerationIgnoringConstraints() applied to the forces the System 
+produces at Dynamics stage:
+<pre>
+    M(q) udot + f_inertial(q,u) = f_applied(t,q,u) + tau
+</pre>
+The results are the dense nu X nq, nu X nu and nu X nu matrices 
+d udot/dq, d udot/du and d udot/dtau. Constraints are ignored. Prescribed
+accelerations are treated as given, so the corresponding rows are zero.
+
+d udot/dtau is M_ff^-1, calculated exactly with the O(n) multiplyByMInv()
+operator. For q and u we use the identity 
+d udot = -M_ff^-1 (d residual) at fixed udot, where the residual is that of
+calcResidualForceIgnoringConstraints() using the forces the System applies.
+No forward dynamics solve is done per column.
+
+If every mobilizer's cross-joint velocity Jacobian H_FM is constant (Pin,
+Slider, Screw, Cylinder, Planar, Translation, Ball, Free and Weld, when not
+reversed), each residual column is found analytically by running the O(n)
+kinematics and inverse dynamics recursions once with Dual numbers in place
+of Real, so the matrices cost O(n^2) with no realization. Force elements contribute their own derivatives; the
+built-in Gravity, TwoPointLinearSpring, TwoPointLinearDamper,
+MobilityLinearSpring, MobilityLinearDamper, MobilityConstantForce,
+ConstantForce, ConstantTorque, GlobalDamper and DiscreteForces elements do.
+If any other force element is enabled, the change in the System's applied
+forces is found by central differences on a scratch copy of the State 
+realized to Dynamics stage, while the rest stays analytic. With any other
+mobilizer the whole residual is differenced that way, costing two 
+realizations per column.
+
+Use multiplyByForwardDynamicsDerivatives() if you need only the product with
+a direction; that costs a single residual derivative.
+
+@par Required stage
+  \c Stage::Dynamics
+
+@see multiplyByForwardDynamicsDerivatives(), calcResidualForceIgnoringConstraints()
+**/
+void calcForwardDynamicsDerivatives
+   (const State&    state,
+    Matrix&         dudot_dq,
+    Matrix&         dudot_du,
+    Matrix&         dudot_dtau) const;
+
+/** Calculate the product of the forward dynamics derivatives from 
+calcForwardDynamicsDerivatives() with the given directions, that is
+<pre>
+    dudot = (d udot/dq) dq + (d udot/du) du + (d udot/dtau) dtau
+</pre>
+without forming any of the matrices. Any of \a dq, \a du and \a dtau may be
+zero length, meaning all zero. The q and u terms take one derivative of the
+inverse dynamics residual along the combined direction (dq,du), analytic or
+by central differences as described for calcForwardDynamicsDerivatives(), 
+and the result is obtained with a single application of M_ff^-1.
+
+@par Required stage
+  \c Stage::Dynamics
+
+@see calcForwardDynamicsDerivatives() **/
+void multiplyByForwardDynamicsDerivatives
+   (const State&    state,
+    const Vector&   dq,
+    const Vector&   du,
+    const Vector&   dtau,
+    Vector&         dudot) const;
+
 
 /** This operator calculates the composite body inertias R given a State 
 realized to Position stage. Composite body inertias are the spatial mass 
@@ -2176,7 +2507,9 @@ properties of the rigid body formed by a particular body and all bodies
 outboard of that body as if all the outboard mobilizers were welded in their 
 current orientations. 
 
-This is a very fast O(n) operator.
+This is a very fast O(n) operator. The result is cached in the State, so 
+further calls at the same configuration just copy it out, even if the 
+velocities have changed.
 
 @par Required stage
   \c Stage::Position **/
@@ -2329,17 +2662,34 @@ origin Bo, we shift it to M for reporting.
 <h3>Performance</h3>
 The cost of the above calculation is 114 flops/body. The code presented
 above for converting from M to F costs an additional 81 flops/body if you
-use it.
+use it. The reactions are calculated at most once per realization of 
+Acceleration stage and then cached in the \a state; this method copies the
+cached values into \a forcesAtMInG and does not allocate heap memory if 
+that Vector already has the right size. Use getMobilizerReactionForces() to
+avoid the copy.
     
 @par Required stage
   \c Stage::Acceleration 
  
+@see getMobilizerReactionForces()
 @see SimTK::MobilizedBody::findMobilizerReactionOnBodyAtMInGround()
 @see calcMobilizerReactionForcesUsingFreebodyMethod() **/
 void calcMobilizerReactionForces
    (const State&         state, 
     Vector_<SpatialVec>& forcesAtMInG) const;
 
+/** Return a reference to the mobilizer reaction forces for every body, 
+calculated as described for calcMobilizerReactionForces() the first time they
+are requested after \a state has been realized through Acceleration stage, 
+and cached there until Acceleration stage is invalidated. The returned
+reference remains valid until then.
+
+@par Required stage
+  \c Stage::Acceleration 
+@see calcMobilizerReactionForces() **/
+const Vector_<SpatialVec>& getMobilizerReactionForces
+   (const State& state) const;
+
 /** Return a reference to the prescribed motion multipliers tau that have 
 already been calculated in the given \a state, which must have been realized 
 through Acceleration stage. The result contains entries only for prescribed 
@@ -2523,6 +2873,101 @@ void addInMobilityForce(const State&        state,
 
 
 
+//==============================================================================
+/** @name              Batched evaluation at many States
+
+These operators evaluate the same multibody system at many different 
+configurations (and speeds) in one call, as needed for Monte Carlo sampling, 
+sampling-based planning, or policy rollouts. Each sample is stored in one 
+column of the input and output matrices. The supplied \a state is used as a 
+template: it supplies everything other than q and u (time, modeling and 
+instance variables, z, etc.) and must have been realized through 
+Stage::Instance; it is not modified.
+
+The samples are divided into one contiguous block per thread of the matter 
+subsystem's thread pool (see setNumberOfThreads()), and each block is 
+evaluated on its own private copy of \a state, so the per-sample cost is just
+that of the realization and the operator itself, without any State 
+allocation. The result for each sample is exactly what you would get by 
+setting q and u in a State and calling the corresponding single-State 
+operator, independent of the number of threads. Any forces and custom 
+mobilizers or constraints in the system must be safe to evaluate 
+concurrently on different States. **/
+/**@{**/
+
+/** For each column k of \a q, calculate Ma(k) = M(q(k))*a(k). \a q must have
+nq rows and \a a must have nu rows and the same number of columns as \a q. 
+The system is realized through Stage::Position for each sample. 
+@see multiplyByM() **/
+void multiplyByMForStates(const State&  state,
+                          const Matrix& q,
+                          const Matrix& a,
+                          Matrix&       Ma) const;
+
+/** For each column k of \a q, calculate MInvV(k) = M(q(k))^-1 * v(k). \a q 
+must have nq rows and \a v must have nu rows and the same number of columns
+as \a q. The system is realized through Stage::Position for each sample, 
+and articulated body inertias are then calculated as needed.
+@see multiplyByMInv() **/
+void multiplyByMInvForStates(const State&   state,
+                             const Matrix&  q,
+                             const Matrix&  v,
+                             Matrix&        MInvV) const;
+
+/** For each sample k, set q(k) and u(k), realize the system through 
+Stage::Dynamics, and calculate the tree forward dynamics udot(k) that result
+from the given applied forces, ignoring constraints as in 
+calcAccelerationIgnoringConstraints(). The forces computed by force elements
+in the system are \e not included; only \a appliedMobilityForces (nu rows) 
+and \a appliedBodyForces (one row per body including Ground) are applied. 
+Either force matrix may be empty (0 columns), meaning no forces of that kind.
+@see calcAccelerationIgnoringConstraints() **/
+void calcAccelerationIgnoringConstraintsForStates
+   (const State&                state,
+    const Matrix&               q,
+    const Matrix&               u,
+    const Matrix&               appliedMobilityForces,
+    const Matrix_<SpatialVec>&  appliedBodyForces,
+    Matrix&                     udot) const;
+
+/** For each column k of \a q, calculate the Ground-frame locations of a set
+of stations, each given by a body and a station location in that body's 
+frame. On return row i of \a locationsInG holds the location of station i
+for each of the samples.
+@see MobilizedBody::findStationLocationInGround() **/
+void calcStationLocationsForStates
+   (const State&                        state,
+    const Matrix&                       q,
+    const Array_<MobilizedBodyIndex>&   onBodyB,
+    const Array_<Vec3>&                 stationPinB,
+    Matrix_<Vec3>&                      locationsInG) const;
+
+/** Tree inverse dynamics along a whole trajectory: for each frame k (column
+of \a q, \a u and \a knownUdot) calculate the residual mobility forces 
+f_resid(k) = M(q(k)) udot(k) + f_inertial(q(k),u(k)) - f_applied(k), exactly
+as calcResidualForceIgnoringConstraints() would for a State holding q(k) 
+and u(k). Unlike the other operators here, the system is \e not realized for
+each frame; only the position and velocity kinematics of this subsystem are
+calculated, followed directly by the two inverse dynamics sweeps. So the 
+forces computed by force elements in the system are \e not included, nor are
+constraint forces; only \a appliedMobilityForces (nu rows) and \a appliedBodyForces 
+(one row per body including Ground) are applied. Either force matrix may be
+empty (0 columns), meaning no forces of that kind. \a u and \a knownUdot 
+must have nu rows and the same number of columns as \a q. Frames are 
+divided among threads as described above.
+@see calcResidualForceIgnoringConstraints() **/
+void calcResidualForceIgnoringConstraintsForStates
+   (const State&                state,
+    const Matrix&               q,
+    const Matrix&               u,
+    const Matrix&               knownUdot,
+    const Matrix&               appliedMobilityForces,
+    const Matrix_<SpatialVec>&  appliedBodyForces,
+    Matrix&                     residualMobilityForces) const;
+/**@}**/
+
+
+
 //==============================================================================
 /** @name              Realization and response methods
 
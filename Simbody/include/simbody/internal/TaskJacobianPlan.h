@@ -0,0 +1,174 @@
+#ifndef SimTK_SIMBODY_TASK_JACOBIAN_PLAN_H_
+#define SimTK_SIMBODY_TASK_JACOBIAN_PLAN_H_
+
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include "simbody/internal/common.h"
+
+namespace SimTK {
+
+class SimbodyMatterSubsystem;
+
+/** A TaskJacobianPlan evaluates the Jacobians of a fixed set of station and 
+frame tasks, and their products with vectors, much faster than the 
+corresponding SimbodyMatterSubsystem methods like calcStationJacobian() when
+there are many tasks to be evaluated repeatedly, as in a task-space controller.
+
+Each task is a point (station task) or a frame (frame task) fixed on some 
+mobilized body B. A task's Jacobian has nonzero columns only for the 
+mobilities on the path from B to Ground. The plan records those paths once, 
+when the tasks are added, along with the inverse map giving for each 
+mobilized body the tasks that lie outboard of it. Evaluation is then a single 
+sweep over the mobilized bodies that appear on any path, in which each 
+mobility's hinge matrix column is obtained once and applied to every task that
+depends on it. The cost of every operator is proportional to the total number 
+of path mobilities summed over the tasks, rather than to the number of tasks
+times the full system size as for the general-purpose methods.
+
+The rows of the task Jacobian J are ordered by task, in the order the tasks 
+were added. A station task S contributes 3 rows, the linear velocity v_GS. A 
+frame task A contributes 6 rows, the angular velocity w_GA followed by the 
+linear velocity v_GA of A's origin, as in calcFrameJacobian().
+
+Results are written into caller-owned Vectors and Matrices which are resized
+only if necessary, so repeated evaluations don't allocate heap memory once 
+the buffers have grown to size. The plan keeps a small internal workspace, so
+a single plan must not be evaluated from multiple threads at the same time; 
+use one plan per thread instead. 
+
+@see SimbodyMatterSubsystem::calcStationJacobian(), 
+     SimbodyMatterSubsystem::calcFrameJacobian() **/
+class SimTK_SIMBODY_EXPORT TaskJacobianPlan {
+public:
+    /** Create an empty plan that is not yet associated with a 
+    SimbodyMatterSubsystem. **/
+    TaskJacobianPlan() : matter(nullptr), numRows(0) {}
+
+    /** Create an empty plan for tasks on the mobilized bodies of the given
+    SimbodyMatterSubsystem, which must outlive the plan. **/
+    explicit TaskJacobianPlan(const SimbodyMatterSubsystem& matter) 
+    :   matter(&matter), numRows(0) {}
+
+    /** Associate this plan with a different SimbodyMatterSubsystem; all
+    existing tasks are removed. **/
+    void setMatterSubsystem(const SimbodyMatterSubsystem& matter)
+    {   clear(); this->matter = &matter; }
+
+    /** Remove all the tasks, leaving the SimbodyMatterSubsystem unchanged. **/
+    void clear();
+
+    /** Add a station task for the point fixed on mobilized body \a body at 
+    \a p_BS, measured and expressed in the body frame. The mobilized body
+    must already have been added to the SimbodyMatterSubsystem. Returns the 
+    index of the new task. **/
+    int addStationTask(MobilizedBodyIndex body, const Vec3& p_BS);
+
+    /** Add a frame task for a frame A fixed on mobilized body \a body with
+    origin at \a p_BA, measured and expressed in the body frame. Only A's 
+    origin matters since all frames fixed on a body share its angular 
+    velocity. Returns the index of the new task. **/
+    int addFrameTask(MobilizedBodyIndex body, const Vec3& p_BA);
+
+    /** Return the number of tasks in this plan. **/
+    int getNumTasks() const {return (int)tasks.size();}
+    /** Return the number of rows in the task Jacobian, that is, 3 for each
+    station task plus 6 for each frame task. **/
+    int getNumRows() const {return numRows;}
+    /** Return the first row of the task Jacobian belonging to the given 
+    task. **/
+    int getFirstRow(int task) const {return tasks[task].firstRow;}
+    /** Return true if the given task is a frame task, false if it is a 
+    station task. **/
+    bool isFrameTask(int task) const {return tasks[task].isFrame;}
+    /** Return the mobilized body on which the given task is fixed. **/
+    MobilizedBodyIndex getTaskBody(int task) const {return tasks[task].body;}
+    /** Return the given task's station, or frame origin, in its body's 
+    frame. **/
+    const Vec3& getTaskStation(int task) const {return tasks[task].station;}
+    /** Return the mobilized bodies on the path from the given task's body 
+    inward to (but not including) Ground. These are the only bodies whose 
+    mobilities can have nonzero columns in the task's rows of J. **/
+    ArrayViewConst_<MobilizedBodyIndex> getPath(int task) const {
+        const Task& t = tasks[task];
+        return paths(t.firstPathEntry, t.numPathEntries);
+    }
+
+    /** Calculate the task Jacobian J explicitly as a getNumRows() X nu 
+    Matrix. Columns of mobilities not on a task's path are zero in that 
+    task's rows. 
+    @par Required stage
+      \c Stage::Position **/
+    void calcJacobian(const State& state, Matrix& J) const;
+
+    /** Calculate the product J*u, the stacked task velocities induced by the
+    mobilities \a u, without forming J.
+    @par Required stage
+      \c Stage::Position **/
+    void multiplyByJacobian(const State& state, const Vector& u, 
+                            Vector& Ju) const;
+
+    /** Calculate the product ~J*F, the generalized forces produced by 
+    applying the stacked task forces \a F, without forming J. Frame task
+    entries are a moment followed by a force applied at the frame origin.
+    @par Required stage
+      \c Stage::Position **/
+    void multiplyByJacobianTranspose(const State& state, const Vector& F,
+                                     Vector& f) const;
+
+    /** Calculate the bias term JDot*u, the stacked task accelerations that 
+    result from the current velocities when udot is zero. 
+    @par Required stage
+      \c Stage::Velocity **/
+    void calcBias(const State& state, Vector& JDotu) const;
+
+private:
+    struct Task {
+        MobilizedBodyIndex  body;
+        Vec3                station;
+        bool                isFrame;
+        int                 firstRow;
+        int                 firstPathEntry, numPathEntries;
+    };
+
+    int addTask(MobilizedBodyIndex body, const Vec3& station, bool isFrame);
+    const SimbodyMatterSubsystem& getMatterSubsystem() const;
+    void calcTaskStationLocations(const State& state) const;
+
+    const SimbodyMatterSubsystem*   matter;
+    int                             numRows;
+    Array_<Task>                    tasks;
+    // Concatenated task paths; see Task::firstPathEntry.
+    Array_<MobilizedBodyIndex>      paths;
+    // For each mobilized body, the tasks whose paths include it. Bodies
+    // beyond the last one used by any task are not present.
+    Array_<Array_<int>,MobilizedBodyIndex> tasksOnBody;
+
+    // Workspace: task station locations in Ground, from the last evaluation.
+    mutable Array_<Vec3>            p_GS;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMBODY_TASK_JACOBIAN_PLAN_H_
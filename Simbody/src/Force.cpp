@@ -120,6 +120,27 @@ void Force::TwoPointLinearSpringImpl::calcForce(const State& state, Vector_<Spat
     bodyForces[body2] -=  SpatialVec(s2_G % f1_G, f1_G);
 }
 
+// With r the vector between the points and d its length, f1 = k(1-x0/d) r.
+bool Force::TwoPointLinearSpringImpl::calcForceDerivative(const State& state, const Vector& dq, const Vector& du, const Vector_<SpatialVec>& dX_GB, const Vector_<SpatialVec>& dV_GB, Vector_<SpatialVec>& dBodyForces, Vector& dMobilityForces) const {
+    const Transform& X_GB1 = matter.getMobilizedBody(body1).getBodyTransform(state);
+    const Transform& X_GB2 = matter.getMobilizedBody(body2).getBodyTransform(state);
+    const SpatialVec& dX1 = dX_GB[body1];
+    const SpatialVec& dX2 = dX_GB[body2];
+
+    const Vec3 s1_G = X_GB1.R() * station1, ds1_G = dX1[0] % s1_G;
+    const Vec3 s2_G = X_GB2.R() * station2, ds2_G = dX2[0] % s2_G;
+
+    const Vec3 r_G  = (X_GB2.p() + s2_G) - (X_GB1.p() + s1_G);
+    const Vec3 dr_G = (dX2[1] + ds2_G) - (dX1[1] + ds1_G);
+    const Real d    = r_G.norm();
+
+    const Vec3 f1_G  = (k*(d-x0)/d) * r_G;
+    const Vec3 df1_G = (k*(d-x0)/d) * dr_G + (k*x0*dot(r_G,dr_G)/(d*d*d)) * r_G;
+    dBodyForces[body1] += SpatialVec(ds1_G % f1_G + s1_G % df1_G, df1_G);
+    dBodyForces[body2] -= SpatialVec(ds2_G % f1_G + s2_G % df1_G, df1_G);
+    return true;
+}
+
 Real Force::TwoPointLinearSpringImpl::calcPotentialEnergy(const State& state) const {
     const Transform& X_GB1 = matter.getMobilizedBody(body1).getBodyTransform(state);
     const Transform& X_GB2 = matter.getMobilizedBody(body2).getBodyTransform(state);
@@ -198,6 +219,41 @@ void Force::TwoPointLinearDamperImpl::calcForce(const State& state, Vector_<Spat
     bodyForces[body2] -=  SpatialVec(s2_G % f1_G, f1_G);
 }
 
+bool Force::TwoPointLinearDamperImpl::calcForceDerivative(const State& state, const Vector& dq, const Vector& du, const Vector_<SpatialVec>& dX_GB, const Vector_<SpatialVec>& dV_GB, Vector_<SpatialVec>& dBodyForces, Vector& dMobilityForces) const {
+    const MobilizedBody& mobod1 = matter.getMobilizedBody(body1);
+    const MobilizedBody& mobod2 = matter.getMobilizedBody(body2);
+    const Transform&  X_GB1 = mobod1.getBodyTransform(state);
+    const Transform&  X_GB2 = mobod2.getBodyTransform(state);
+    const SpatialVec& V_GB1 = mobod1.getBodyVelocity(state);
+    const SpatialVec& V_GB2 = mobod2.getBodyVelocity(state);
+    const SpatialVec& dX1 = dX_GB[body1];
+    const SpatialVec& dX2 = dX_GB[body2];
+    const SpatialVec& dV1 = dV_GB[body1];
+    const SpatialVec& dV2 = dV_GB[body2];
+
+    const Vec3 s1_G = X_GB1.R() * station1, ds1_G = dX1[0] % s1_G;
+    const Vec3 s2_G = X_GB2.R() * station2, ds2_G = dX2[0] % s2_G;
+
+    // Station positions and velocities, and their changes.
+    const Vec3 r_G  = (X_GB2.p() + s2_G) - (X_GB1.p() + s1_G);
+    const Vec3 dr_G = (dX2[1] + ds2_G) - (dX1[1] + ds1_G);
+    const Vec3 vRel = (V_GB2[1] + V_GB2[0] % s2_G) - (V_GB1[1] + V_GB1[0] % s1_G);
+    const Vec3 dvRel = (dV2[1] + dV2[0] % s2_G + V_GB2[0] % ds2_G)
+                     - (dV1[1] + dV1[0] % s1_G + V_GB1[0] % ds1_G);
+
+    const Real len = r_G.norm();
+    const Vec3 d   = r_G / len;
+    const Vec3 dd  = (dr_G - dot(d,dr_G)*d) / len;
+    const Real frc  = damping*dot(vRel, d);
+    const Real dfrc = damping*(dot(dvRel, d) + dot(vRel, dd));
+
+    const Vec3 f1_G  = frc*d;
+    const Vec3 df1_G = dfrc*d + frc*dd;
+    dBodyForces[body1] += SpatialVec(ds1_G % f1_G + s1_G % df1_G, df1_G);
+    dBodyForces[body2] -= SpatialVec(ds2_G % f1_G + s2_G % df1_G, df1_G);
+    return true;
+}
+
 Real Force::TwoPointLinearDamperImpl::calcPotentialEnergy(const State& state) const {
     return 0;
 }
@@ -310,12 +366,15 @@ setStiffness(State& state, Real stiffness) const {
         "(stiffness=%g).", stiffness);
 
     getImpl().updParams(state).first = stiffness; 
+    getImpl().invalidateCachedForces(state);
     return *this; 
 }
 
 const Force::MobilityLinearSpring& Force::MobilityLinearSpring::
 setQZero(State& state, Real qZero) const 
-{   getImpl().updParams(state).second = qZero; return *this; }
+{   getImpl().updParams(state).second = qZero; 
+    getImpl().invalidateCachedForces(state);
+    return *this; }
 
 Real Force::MobilityLinearSpring::
 getStiffness(const State& state) const 
@@ -350,6 +409,31 @@ calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
                              frc, mobilityForces);
 }
 
+bool Force::MobilityLinearSpringImpl::
+calcForceDerivative(const State& state, const Vector& dq, const Vector& du,
+                    const Vector_<SpatialVec>& dX_GB,
+                    const Vector_<SpatialVec>& dV_GB,
+                    Vector_<SpatialVec>& dBodyForces,
+                    Vector& dMobilityForces) const 
+{
+    const MobilizedBody& mb = m_matter.getMobilizedBody(m_mobodIx);
+    const Real k = getParams(state).first;
+    const Real dq1 = dq[mb.getFirstQIndex(state) + (int)m_whichQ];
+    mb.applyOneMobilityForce(state, MobilizerUIndex((int)m_whichQ), 
+                             -k*dq1, dMobilityForces);
+    return true;
+}
+
+bool Force::MobilityLinearSpringImpl::
+findAffectedBodiesAndMobilities(const State& state, 
+                                Array_<MobilizedBodyIndex>& bodies,
+                                Array_<UIndex>& mobilities) const 
+{
+    const MobilizedBody& mb = m_matter.getMobilizedBody(m_mobodIx);
+    mobilities.push_back(UIndex(mb.getFirstUIndex(state) + (int)m_whichQ));
+    return true;
+}
+
 Real Force::MobilityLinearSpringImpl::
 calcPotentialEnergy(const State& state) const {
     const MobilizedBody& mb = m_matter.getMobilizedBody(m_mobodIx);
@@ -442,6 +526,30 @@ calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
     mb.applyOneMobilityForce(state, m_whichU, frc, mobilityForces);
 }
 
+bool Force::MobilityLinearDamperImpl::
+calcForceDerivative(const State& state, const Vector& dq, const Vector& du,
+                    const Vector_<SpatialVec>& dX_GB,
+                    const Vector_<SpatialVec>& dV_GB,
+                    Vector_<SpatialVec>& dBodyForces,
+                    Vector& dMobilityForces) const 
+{
+    const MobilizedBody& mb = m_matter.getMobilizedBody(m_mobodIx);
+    const Real du1 = du[mb.getFirstUIndex(state) + (int)m_whichU];
+    mb.applyOneMobilityForce(state, m_whichU, -getDamping(state)*du1, 
+                             dMobilityForces);
+    return true;
+}
+
+bool Force::MobilityLinearDamperImpl::
+findAffectedBodiesAndMobilities(const State& state, 
+                                Array_<MobilizedBodyIndex>& bodies,
+                                Array_<UIndex>& mobilities) const 
+{
+    const MobilizedBody& mb = m_matter.getMobilizedBody(m_mobodIx);
+    mobilities.push_back(UIndex(mb.getFirstUIndex(state) + (int)m_whichU));
+    return true;
+}
+
 Real Force::MobilityLinearDamperImpl::
 calcPotentialEnergy(const State& state) const {
     return 0;
@@ -482,6 +590,7 @@ getDefaultForce() const
 void Force::MobilityConstantForce::
 setForce(State& state, Real force) const {
     getImpl().updForce(state) = force;
+    getImpl().invalidateCachedForces(state);
 }
 
 Real Force::MobilityConstantForce::
@@ -506,6 +615,16 @@ calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
     mb.applyOneMobilityForce(state, m_whichU, getForce(state), mobilityForces);
 }
 
+bool Force::MobilityConstantForceImpl::
+findAffectedBodiesAndMobilities(const State& state, 
+                                Array_<MobilizedBodyIndex>& bodies,
+                                Array_<UIndex>& mobilities) const 
+{
+    const MobilizedBody& mb = m_matter.getMobilizedBody(m_mobodIx);
+    mobilities.push_back(UIndex(mb.getFirstUIndex(state) + (int)m_whichU));
+    return true;
+}
+
 
 //---------------------------- MobilityLinearStop ------------------------------
 //------------------------------------------------------------------------------
@@ -595,6 +714,7 @@ setBounds(State& state, Real qLow, Real qHigh) const {
     MobilityLinearStopImpl::Parameters& params =
         getImpl().updParameters(state); // invalidates Dynamics stage
     params.qLow = qLow; params.qHigh = qHigh;
+    getImpl().invalidateCachedForces(state);
 }
 void Force::MobilityLinearStop::
 setMaterialProperties(State& state, Real stiffness, Real dissipation) const {
@@ -607,6 +727,7 @@ setMaterialProperties(State& state, Real stiffness, Real dissipation) const {
     MobilityLinearStopImpl::Parameters& params =
         getImpl().updParameters(state); // invalidates Dynamics stage
     params.k = stiffness; params.d = dissipation;
+    getImpl().invalidateCachedForces(state);
 }
 
 Real Force::MobilityLinearStop::getLowerBound(const State& state) const 
@@ -663,6 +784,56 @@ calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
     }
 }
 
+// The elastic part -k*x of the stop force, when a stop is engaged.
+void Force::MobilityLinearStopImpl::
+calcPositionOnlyPart(const State& state, Vector_<SpatialVec>& bodyForces,
+                     Vector_<Vec3>& particleForces, Vector& mobilityForces) const
+{
+    const Parameters& param = getParameters(state);
+    if (param.k == 0) return; // no stiffness, no force
+
+    const MobilizedBody& mb = m_matter.getMobilizedBody(m_mobodIx);
+    const Real q = mb.getOneQ(state, m_whichQ);
+    Real x = 0;
+    if      (q > param.qHigh) x = q-param.qHigh;
+    else if (q < param.qLow)  x = q-param.qLow;
+    else return; // neither stop is engaged
+
+    mb.applyOneMobilityForce(state, 
+        MobilizerUIndex(m_whichQ), // TODO: only works qdot & u match
+        -param.k*x, mobilityForces);
+}
+
+// Everything calcForce() applies beyond the elastic part: the dissipation
+// force, limited so that the total never pulls on the body.
+void Force::MobilityLinearStopImpl::
+calcVelocityDependentPart
+   (const State& state, Vector_<SpatialVec>& bodyForces,
+    Vector_<Vec3>& particleForces, Vector& mobilityForces) const
+{
+    const Parameters& param = getParameters(state);
+    if (param.k == 0 || param.d == 0) return; // no dissipation force
+
+    const MobilizedBody& mb = m_matter.getMobilizedBody(m_mobodIx);
+    const Real q = mb.getOneQ(state, m_whichQ);
+    const Real qdot = mb.getOneQDot(state, m_whichQ);
+
+    Real f = 0;
+    if (q > param.qHigh) {
+        const Real x = q-param.qHigh;  // x > 0
+        const Real fraw = param.k*x*(1+param.d*qdot);
+        f = std::min(Real(0), -fraw) + param.k*x;
+    } else if (q < param.qLow) {
+        const Real x = q-param.qLow;    // x < 0
+        const Real fraw = param.k*x*(1-param.d*qdot);
+        f = std::max(Real(0), -fraw) + param.k*x;
+    } else return; // neither stop is engaged
+
+    mb.applyOneMobilityForce(state, 
+        MobilizerUIndex(m_whichQ), // TODO: only works qdot & u match
+        f, mobilityForces);
+}
+
 Real Force::MobilityLinearStopImpl::
 calcPotentialEnergy(const State& state) const {
     const Parameters& param = getParameters(state);
@@ -951,6 +1122,13 @@ void Force::ConstantForceImpl::calcForce(const State& state, Vector_<SpatialVec>
     bodyForces[body] += SpatialVec(station_G % force, force);
 }
 
+bool Force::ConstantForceImpl::calcForceDerivative(const State& state, const Vector& dq, const Vector& du, const Vector_<SpatialVec>& dX_GB, const Vector_<SpatialVec>& dV_GB, Vector_<SpatialVec>& dBodyForces, Vector& dMobilityForces) const {
+    const Transform& X_GB = matter.getMobilizedBody(body).getBodyTransform(state);
+    const Vec3 dstation_G = dX_GB[body][0] % (X_GB.R() * station);
+    dBodyForces[body][0] += dstation_G % force;
+    return true;
+}
+
 Real Force::ConstantForceImpl::calcPotentialEnergy(const State& state) const {
     return 0;
 }
@@ -997,6 +1175,11 @@ void Force::GlobalDamperImpl::calcForce(const State& state, Vector_<SpatialVec>&
     mobilityForces -= damping*matter.getU(state);
 }
 
+bool Force::GlobalDamperImpl::calcForceDerivative(const State& state, const Vector& dq, const Vector& du, const Vector_<SpatialVec>& dX_GB, const Vector_<SpatialVec>& dV_GB, Vector_<SpatialVec>& dBodyForces, Vector& dMobilityForces) const {
+    dMobilityForces -= damping*du;
+    return true;
+}
+
 Real Force::GlobalDamperImpl::calcPotentialEnergy(const State& state) const {
     return 0;
 }
@@ -49,9 +49,96 @@ public:
     virtual bool dependsOnlyOnPositions() const {
         return false;
     }
+    // A force element that depends on velocities but is the sum of a part
+    // that depends only on positions and a velocity-dependent part may say so
+    // here and implement the two calc...Part() methods below, which together
+    // must add in exactly what calcForce() would. GeneralForceSubsystem then
+    // caches the position part along with the dependsOnlyOnPositions()
+    // forces, and calculates only the velocity part while the configuration
+    // doesn't change. A force's parameters that affect its position part are
+    // typically Dynamics-stage variables; changing one must call
+    // GeneralForceSubsystem::invalidateCachedForces().
+    virtual bool hasPositionOnlyPart() const {
+        return false;
+    }
+    virtual void calcPositionOnlyPart
+       (const State&         state,
+        Vector_<SpatialVec>& bodyForces,
+        Vector_<Vec3>&       particleForces,
+        Vector&              mobilityForces) const {}
+    virtual void calcVelocityDependentPart
+       (const State&         state,
+        Vector_<SpatialVec>& bodyForces,
+        Vector_<Vec3>&       particleForces,
+        Vector&              mobilityForces) const {}
+
+    // These say which part of this force GeneralForceSubsystem may cache and
+    // which part it must calculate every time, and calculate those parts.
+    bool hasCachedPart() const
+    {   return dependsOnlyOnPositions() || hasPositionOnlyPart(); }
+    bool hasNonCachedPart() const
+    {   return !dependsOnlyOnPositions(); }
+    void calcCachedPart(const State& state, Vector_<SpatialVec>& bodyForces,
+                        Vector_<Vec3>& particleForces,
+                        Vector& mobilityForces) const {
+        if (dependsOnlyOnPositions())
+            calcForce(state, bodyForces, particleForces, mobilityForces);
+        else if (hasPositionOnlyPart())
+            calcPositionOnlyPart(state, bodyForces, particleForces,
+                                 mobilityForces);
+    }
+    void calcNonCachedPart(const State& state, Vector_<SpatialVec>& bodyForces,
+                           Vector_<Vec3>& particleForces,
+                           Vector& mobilityForces) const {
+        if (dependsOnlyOnPositions())
+            return;
+        if (hasPositionOnlyPart())
+            calcVelocityDependentPart(state, bodyForces, particleForces,
+                                      mobilityForces);
+        else
+            calcForce(state, bodyForces, particleForces, mobilityForces);
+    }
+
     virtual bool shouldBeParallelIfPossible() const{
         return false;
     }
+    // Optionally report the bodies and mobilities to which calcForce() may
+    // apply forces, so that a parallel force can accumulate into a compact
+    // buffer rather than a full-size one. Return false if that isn't known.
+    // This is called at Instance stage and the answer must hold until that
+    // stage is invalidated.
+    virtual bool findAffectedBodiesAndMobilities
+       (const State&                state,
+        Array_<MobilizedBodyIndex>& bodies,
+        Array_<UIndex>&             mobilities) const {
+        return false;
+    }
+    // Built-in force elements whose calcForce() only reads the State (or
+    // writes only to this force's own cache entries) may be calculated
+    // concurrently with other forces if GeneralForceSubsystem is asked to.
+    virtual bool canBeCalculatedInParallel() const {
+        return false;
+    }
+    // A rough cost for calcForce(), relative to a two-point linear spring,
+    // used to divide the parallel forces into evenly loaded chunks.
+    virtual Real getCostEstimate() const {
+        return 1;
+    }
+    // Optionally add in the change in what calcForce() produces for a change
+    // (dq,du) in the state, given the resulting change dX_GB in each body's
+    // pose as a twist in Ground and dV_GB in its spatial velocity. This is
+    // used for analytic forward dynamics derivatives; return false if it
+    // isn't implemented and finite differences will be used instead.
+    virtual bool calcForceDerivative
+       (const State&               state,
+        const Vector&              dq,
+        const Vector&              du,
+        const Vector_<SpatialVec>& dX_GB,
+        const Vector_<SpatialVec>& dV_GB,
+        Vector_<SpatialVec>&       dBodyForces,
+        Vector&                    dMobilityForces) const {
+        return false;
+    }
     ForceIndex getForceIndex() const {return index;}
     const GeneralForceSubsystem& getForceSubsystem() const 
     {   assert(forces); return *forces; }
@@ -62,6 +149,11 @@ public:
     void invalidateTopologyCache() const {
         if (forces) forces->invalidateSubsystemTopologyCache();
     }
+    // Call this when a parameter that affects the cached part of this force
+    // changes without invalidating Stage::Position.
+    void invalidateCachedForces(const State& state) const {
+        getForceSubsystem().invalidateCachedForces(state);
+    }
 
     // Every force element must provide the next two methods. Note that 
     // calcForce() must *add in* (+=) its forces to the given arrays.
@@ -124,6 +216,18 @@ public:
                    Vector_<Vec3>&       particleForces, 
                    Vector&              mobilityForces) const override;
     Real calcPotentialEnergy(const State& state) const override;
+    bool calcForceDerivative
+       (const State& state, const Vector& dq, const Vector& du,
+        const Vector_<SpatialVec>& dX_GB, const Vector_<SpatialVec>& dV_GB,
+        Vector_<SpatialVec>& dBodyForces, Vector& dMobilityForces)
+        const override;
+    bool canBeCalculatedInParallel() const override {return true;}
+    bool findAffectedBodiesAndMobilities
+       (const State& state, Array_<MobilizedBodyIndex>& bodies,
+        Array_<UIndex>& mobilities) const override {
+        bodies.push_back(body1); bodies.push_back(body2);
+        return true;
+    }
 
     void calcDecorativeGeometryAndAppend(const State& s, Stage stage, 
                                          Array_<DecorativeGeometry>& geom) 
@@ -149,6 +253,18 @@ public:
     }
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
     Real calcPotentialEnergy(const State& state) const override;
+    bool calcForceDerivative
+       (const State& state, const Vector& dq, const Vector& du,
+        const Vector_<SpatialVec>& dX_GB, const Vector_<SpatialVec>& dV_GB,
+        Vector_<SpatialVec>& dBodyForces, Vector& dMobilityForces)
+        const override;
+    bool canBeCalculatedInParallel() const override {return true;}
+    bool findAffectedBodiesAndMobilities
+       (const State& state, Array_<MobilizedBodyIndex>& bodies,
+        Array_<UIndex>& mobilities) const override {
+        bodies.push_back(body1); bodies.push_back(body2);
+        return true;
+    }
 private:
     const SimbodyMatterSubsystem& matter;
     const MobilizedBodyIndex body1, body2;
@@ -172,6 +288,13 @@ public:
     }
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
     Real calcPotentialEnergy(const State& state) const override;
+    bool canBeCalculatedInParallel() const override {return true;}
+    bool findAffectedBodiesAndMobilities
+       (const State& state, Array_<MobilizedBodyIndex>& bodies,
+        Array_<UIndex>& mobilities) const override {
+        bodies.push_back(body1); bodies.push_back(body2);
+        return true;
+    }
 private:
     const SimbodyMatterSubsystem& matter;
     const MobilizedBodyIndex body1, body2;
@@ -208,6 +331,15 @@ friend class MobilityLinearSpring;
                    Vector_<Vec3>& particleForces, Vector& mobilityForces) const
                    override;
     Real calcPotentialEnergy(const State& state) const override;
+    bool calcForceDerivative
+       (const State& state, const Vector& dq, const Vector& du,
+        const Vector_<SpatialVec>& dX_GB, const Vector_<SpatialVec>& dV_GB,
+        Vector_<SpatialVec>& dBodyForces, Vector& dMobilityForces)
+        const override;
+    bool canBeCalculatedInParallel() const override {return true;}
+    bool findAffectedBodiesAndMobilities
+       (const State& state, Array_<MobilizedBodyIndex>& bodies,
+        Array_<UIndex>& mobilities) const override;
 
     // Allocate the discrete state variable for the parameters. 
     void realizeTopology(State& s) const override {
@@ -258,6 +390,15 @@ friend class MobilityLinearDamper;
                    Vector_<Vec3>& particleForces, Vector& mobilityForces) const
                    override;
     Real calcPotentialEnergy(const State& state) const override;
+    bool calcForceDerivative
+       (const State& state, const Vector& dq, const Vector& du,
+        const Vector_<SpatialVec>& dX_GB, const Vector_<SpatialVec>& dV_GB,
+        Vector_<SpatialVec>& dBodyForces, Vector& dMobilityForces)
+        const override;
+    bool canBeCalculatedInParallel() const override {return true;}
+    bool findAffectedBodiesAndMobilities
+       (const State& state, Array_<MobilizedBodyIndex>& bodies,
+        Array_<UIndex>& mobilities) const override;
 
     // Allocate the discrete state variable for the parameters. 
     void realizeTopology(State& s) const override {
@@ -306,15 +447,26 @@ friend class MobilityConstantForce;
     MobilityConstantForceImpl* clone() const override 
     {   return new MobilityConstantForceImpl(*this); }
 
-    // Has to wait for Dynamics stage because that's all that gets invalidated
-    // if the constant force is changed.
-    bool dependsOnlyOnPositions() const override {return false;}
+    // This is cached along with the position-dependent forces; changing the
+    // force must invalidate that cache since only Dynamics stage is
+    // invalidated automatically.
+    bool dependsOnlyOnPositions() const override {return true;}
 
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, 
                    Vector_<Vec3>& particleForces, Vector& mobilityForces) const
                    override;
 
     Real calcPotentialEnergy(const State& state) const override {return 0;}
+    // A constant force doesn't change with the state.
+    bool calcForceDerivative
+       (const State& state, const Vector& dq, const Vector& du,
+        const Vector_<SpatialVec>& dX_GB, const Vector_<SpatialVec>& dV_GB,
+        Vector_<SpatialVec>& dBodyForces, Vector& dMobilityForces)
+        const override {return true;}
+    bool canBeCalculatedInParallel() const override {return true;}
+    bool findAffectedBodiesAndMobilities
+       (const State& state, Array_<MobilizedBodyIndex>& bodies,
+        Array_<UIndex>& mobilities) const override;
 
     // Allocate the discrete state variable for the force. 
     void realizeTopology(State& s) const override {
@@ -371,6 +523,17 @@ friend class MobilityLinearStop;
                    Vector_<Vec3>& particleForces, Vector& mobilityForces) const
                    override; 
 
+    // The elastic force -k*x is the position-only part; the velocity-dependent
+    // part is whatever the dissipation adds to that, including the effect of
+    // not letting the stop pull.
+    bool hasPositionOnlyPart() const override {return true;}
+    void calcPositionOnlyPart
+       (const State& state, Vector_<SpatialVec>& bodyForces,
+        Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
+    void calcVelocityDependentPart
+       (const State& state, Vector_<SpatialVec>& bodyForces,
+        Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
+
     // We're not bothering to cache P.E. -- just recalculate it when asked.
     Real calcPotentialEnergy(const State& state) const override; 
 
@@ -484,6 +647,12 @@ public:
 
     // This force element does not store potential energy.
     Real calcPotentialEnergy(const State& state) const override {return 0;}
+    // The applied forces are discrete variables, not functions of q or u.
+    bool calcForceDerivative
+       (const State& state, const Vector& dq, const Vector& du,
+        const Vector_<SpatialVec>& dX_GB, const Vector_<SpatialVec>& dV_GB,
+        Vector_<SpatialVec>& dBodyForces, Vector& dMobilityForces)
+        const override {return true;}
 
     // Allocate the needed state variable and record its index.
     void realizeTopology(State& state) const override;
@@ -520,6 +689,18 @@ public:
     }
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
     Real calcPotentialEnergy(const State& state) const override;
+    bool calcForceDerivative
+       (const State& state, const Vector& dq, const Vector& du,
+        const Vector_<SpatialVec>& dX_GB, const Vector_<SpatialVec>& dV_GB,
+        Vector_<SpatialVec>& dBodyForces, Vector& dMobilityForces)
+        const override;
+    bool canBeCalculatedInParallel() const override {return true;}
+    bool findAffectedBodiesAndMobilities
+       (const State& state, Array_<MobilizedBodyIndex>& bodies,
+        Array_<UIndex>& mobilities) const override {
+        bodies.push_back(body);
+        return true;
+    }
 private:
     const SimbodyMatterSubsystem& matter;
     const MobilizedBodyIndex body;
@@ -542,6 +723,19 @@ public:
     }
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
     Real calcPotentialEnergy(const State& state) const override;
+    // Constant forces don't change with the state.
+    bool calcForceDerivative
+       (const State& state, const Vector& dq, const Vector& du,
+        const Vector_<SpatialVec>& dX_GB, const Vector_<SpatialVec>& dV_GB,
+        Vector_<SpatialVec>& dBodyForces, Vector& dMobilityForces)
+        const override {return true;}
+    bool canBeCalculatedInParallel() const override {return true;}
+    bool findAffectedBodiesAndMobilities
+       (const State& state, Array_<MobilizedBodyIndex>& bodies,
+        Array_<UIndex>& mobilities) const override {
+        bodies.push_back(body);
+        return true;
+    }
 private:
     const SimbodyMatterSubsystem& matter;
     const MobilizedBodyIndex body;
@@ -561,6 +755,11 @@ public:
     }
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
     Real calcPotentialEnergy(const State& state) const override;
+    bool calcForceDerivative
+       (const State& state, const Vector& dq, const Vector& du,
+        const Vector_<SpatialVec>& dX_GB, const Vector_<SpatialVec>& dV_GB,
+        Vector_<SpatialVec>& dBodyForces, Vector& dMobilityForces)
+        const override;
 private:
     const SimbodyMatterSubsystem& matter;
     Real damping;
@@ -577,6 +776,9 @@ public:
     UniformGravityImpl* clone() const override {
         return new UniformGravityImpl(*this);
     }
+    bool dependsOnlyOnPositions() const override {
+        return true;
+    }
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
     Real calcPotentialEnergy(const State& state) const override;
     Vec3 getGravity() const {
@@ -620,6 +822,15 @@ public:
     bool shouldBeParallelIfPossible() const override {
         return implementation->shouldBeParallelIfPossible();
     }
+    bool findAffectedBodiesAndMobilities
+       (const State& state, Array_<MobilizedBodyIndex>& bodies,
+        Array_<UIndex>& mobilities) const override {
+        return implementation->findAffectedBodiesAndMobilities
+                                                (state, bodies, mobilities);
+    }
+    Real getCostEstimate() const override {
+        return implementation->getCostEstimate();
+    }
     ~CustomImpl() {
         delete implementation;
     }
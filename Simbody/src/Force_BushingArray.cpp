@@ -0,0 +1,530 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+
+#include "simbody/internal/common.h"
+#include "simbody/internal/MobilizedBody.h"
+#include "simbody/internal/SimbodyMatterSubsystem.h"
+#include "simbody/internal/Force_BushingArray.h"
+
+#include "ForceImpl.h"
+
+#include <algorithm>
+
+namespace SimTK {
+
+//==============================================================================
+//                        FORCE :: BUSHING ARRAY IMPL
+//==============================================================================
+// This is the hidden implementation class for Force::BushingArray. Each
+// bushing is calculated exactly as in Force::LinearBushingImpl; see
+// Force_LinearBushing.cpp for the derivation. The enabled bushings' parameters
+// are packed at Instance stage, and the stiffness and damping terms for all
+// of them are evaluated as single loops over the packed 6-vectors.
+class Force::BushingArrayImpl : public ForceImpl {
+friend class Force::BushingArray;
+
+    // The enabled bushings, in order, with copies of their parameters. The
+    // slot map gives each bushing's position here, or -1 if it is disabled.
+    struct ActiveBushings {
+        Array_<int>                 slot;       // [nbushings]
+        Array_<MobilizedBodyIndex>  body1, body2;
+        Array_<Transform>           X_B1F, X_B2M;
+        Array_<Vec6>                k, c;
+    };
+    // Lazy, Position stage.
+    struct PositionCache {
+        Array_<Transform>   X_GF, X_GM, X_FM;
+        Array_<Vec3>        p_B1F_G, p_B2M_G, p_FM_G;
+        Array_<Vec6>        q;
+        Real                pe;
+    };
+    // Lazy, Position stage. The forces due to stiffness alone.
+    struct StiffnessForceCache {
+        Array_<Vec6>        f;      // scalar generalized forces on body 2
+        Array_<SpatialVec>  F_GB1, F_GB2;
+    };
+    // Lazy, Velocity stage unless no bushing has damping, then Position.
+    struct ForceCache {
+        Array_<Vec6>        qdot;   // only if there is damping
+        Array_<Vec6>        f;      // scalar generalized forces on body 2
+        Array_<Vec6>        fc;     // damping part of f; only with damping
+        Array_<SpatialVec>  Fc_GB1, Fc_GB2; // damping part; ditto
+    };
+public:
+    explicit BushingArrayImpl(const SimbodyMatterSubsystem& matter)
+    :   matter(matter), numDamped(0) {}
+
+    BushingArrayImpl* clone() const override {
+        return new BushingArrayImpl(*this);
+    }
+    bool dependsOnlyOnPositions() const override {
+        return numDamped == 0;
+    }
+    void calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
+                   Vector_<Vec3>& particleForces,
+                   Vector& mobilityForces) const override;
+    Real calcPotentialEnergy(const State& state) const override;
+
+    // With damping, the stiffness forces are the position-only part and the
+    // damping forces the velocity-dependent part.
+    bool hasPositionOnlyPart() const override {return numDamped > 0;}
+    void calcPositionOnlyPart
+       (const State& state, Vector_<SpatialVec>& bodyForces,
+        Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
+    void calcVelocityDependentPart
+       (const State& state, Vector_<SpatialVec>& bodyForces,
+        Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
+
+    // calcForce() writes only to this array's own cache entries.
+    bool canBeCalculatedInParallel() const override {return true;}
+    Real getCostEstimate() const override {return 4*(Real)body1.size();}
+    bool findAffectedBodiesAndMobilities
+       (const State& state, Array_<MobilizedBodyIndex>& bodies,
+        Array_<UIndex>& mobilities) const override;
+
+    void realizeTopology(State& s) const override;
+    void realizeInstance(const State& s) const override;
+
+    int addBushing(MobilizedBodyIndex b1, const Transform& X_B1F_,
+                   MobilizedBodyIndex b2, const Transform& X_B2M_,
+                   const Vec6& k_, const Vec6& c_) {
+        invalidateTopologyCache();
+        body1.push_back(b1); X_B1F.push_back(X_B1F_);
+        body2.push_back(b2); X_B2M.push_back(X_B2M_);
+        k.push_back(k_); c.push_back(c_);
+        defEnabled.push_back(true);
+        if (c_ != Vec6(0)) ++numDamped;
+        return (int)body1.size() - 1;
+    }
+
+private:
+    const Array_<bool>& getEnabled(const State& s) const
+    {   return Value<Array_<bool>>::downcast
+           (getForceSubsystem().getDiscreteVariable(s,enabledIx)); }
+    Array_<bool>& updEnabled(State& s) const
+    {   return Value<Array_<bool>>::updDowncast
+           (getForceSubsystem().updDiscreteVariable(s,enabledIx)); }
+
+    const ActiveBushings& getActiveBushings(const State& s) const
+    {   return Value<ActiveBushings>::downcast
+            (getForceSubsystem().getCacheEntry(s,activeBushingsIx)); }
+    ActiveBushings& updActiveBushings(const State& s) const
+    {   return Value<ActiveBushings>::updDowncast
+            (getForceSubsystem().updCacheEntry(s,activeBushingsIx)); }
+
+    const PositionCache& getPositionCache(const State& s) const
+    {   return Value<PositionCache>::downcast
+            (getForceSubsystem().getCacheEntry(s,positionCacheIx)); }
+    PositionCache& updPositionCache(const State& s) const
+    {   return Value<PositionCache>::updDowncast
+            (getForceSubsystem().updCacheEntry(s,positionCacheIx)); }
+    const ForceCache& getForceCache(const State& s) const
+    {   return Value<ForceCache>::downcast
+            (getForceSubsystem().getCacheEntry(s,forceCacheIx)); }
+    ForceCache& updForceCache(const State& s) const
+    {   return Value<ForceCache>::updDowncast
+            (getForceSubsystem().updCacheEntry(s,forceCacheIx)); }
+    const StiffnessForceCache& getStiffnessForceCache(const State& s) const
+    {   return Value<StiffnessForceCache>::downcast
+            (getForceSubsystem().getCacheEntry(s,stiffnessForceCacheIx)); }
+    StiffnessForceCache& updStiffnessForceCache(const State& s) const
+    {   return Value<StiffnessForceCache>::updDowncast
+            (getForceSubsystem().updCacheEntry(s,stiffnessForceCacheIx)); }
+
+    void ensurePositionCacheValid(const State&) const;
+    void ensureStiffnessForceCacheValid(const State&) const;
+    void ensureForceCacheValid(const State&) const;
+
+    // Convert each active bushing's scalar generalized forces f on body 2
+    // into spatial forces at the two body origins.
+    void calcSpatialForces(const PositionCache& pc, const Array_<Vec6>& f,
+                           Array_<SpatialVec>& F_GB1,
+                           Array_<SpatialVec>& F_GB2) const;
+    // Apply the spatial forces of each active bushing.
+    void applyForces(const State& state, const Array_<SpatialVec>& F_GB1,
+                     const Array_<SpatialVec>& F_GB2,
+                     Vector_<SpatialVec>& bodyForces) const;
+
+    // TOPOLOGY STATE
+    const SimbodyMatterSubsystem&   matter;
+    Array_<MobilizedBodyIndex>      body1, body2;
+    Array_<Transform>               X_B1F, X_B2M;
+    Array_<Vec6>                    k, c;
+    Array_<bool>                    defEnabled;
+    int                             numDamped;
+
+    // TOPOLOGY CACHE
+    DiscreteVariableIndex           enabledIx;
+    CacheEntryIndex                 activeBushingsIx;
+    CacheEntryIndex                 positionCacheIx;
+    CacheEntryIndex                 stiffnessForceCacheIx;
+    CacheEntryIndex                 forceCacheIx;
+};
+
+
+
+//==============================================================================
+//                           FORCE :: BUSHING ARRAY
+//==============================================================================
+
+SimTK_INSERT_DERIVED_HANDLE_DEFINITIONS(Force::BushingArray,
+                                        Force::BushingArrayImpl, Force);
+
+Force::BushingArray::BushingArray
+   (GeneralForceSubsystem& forces, const SimbodyMatterSubsystem& matter)
+:   Force(new BushingArrayImpl(matter))
+{
+    updImpl().setForceSubsystem(forces, forces.adoptForce(*this));
+}
+
+int Force::BushingArray::
+addBushing(const MobilizedBody& body1, const Transform& frameOnB1,
+           const MobilizedBody& body2, const Transform& frameOnB2,
+           const Vec6& stiffness, const Vec6& damping) {
+    SimTK_ERRCHK_ALWAYS(stiffness >= 0,
+        "Force::BushingArray::addBushing()",
+        "Bushing spring constants must be nonnegative.");
+    SimTK_ERRCHK_ALWAYS(damping >= 0,
+        "Force::BushingArray::addBushing()",
+        "Bushing damping coefficients must be nonnegative.");
+    return updImpl().addBushing(body1.getMobilizedBodyIndex(), frameOnB1,
+                                body2.getMobilizedBodyIndex(), frameOnB2,
+                                stiffness, damping);
+}
+
+int Force::BushingArray::
+getNumBushings() const {return (int)getImpl().body1.size();}
+
+Force::BushingArray& Force::BushingArray::
+setBushingIsEnabledByDefault(int bushing, bool enabled) {
+    SimTK_INDEXCHECK_ALWAYS(bushing, getNumBushings(),
+        "Force::BushingArray::setBushingIsEnabledByDefault()");
+    getImpl().invalidateTopologyCache();
+    updImpl().defEnabled[bushing] = enabled;
+    return *this;
+}
+
+bool Force::BushingArray::
+isBushingEnabledByDefault(int bushing) const {
+    SimTK_INDEXCHECK_ALWAYS(bushing, getNumBushings(),
+        "Force::BushingArray::isBushingEnabledByDefault()");
+    return getImpl().defEnabled[bushing];
+}
+
+void Force::BushingArray::
+setBushingIsEnabled(State& state, int bushing, bool enabled) const {
+    SimTK_INDEXCHECK_ALWAYS(bushing, getNumBushings(),
+        "Force::BushingArray::setBushingIsEnabled()");
+    getImpl().updEnabled(state)[bushing] = enabled;
+}
+
+bool Force::BushingArray::
+isBushingEnabled(const State& state, int bushing) const {
+    SimTK_INDEXCHECK_ALWAYS(bushing, getNumBushings(),
+        "Force::BushingArray::isBushingEnabled()");
+    return getImpl().getEnabled(state)[bushing];
+}
+
+Vec6 Force::BushingArray::
+getQ(const State& state, int bushing) const {
+    SimTK_INDEXCHECK_ALWAYS(bushing, getNumBushings(),
+        "Force::BushingArray::getQ()");
+    const BushingArrayImpl& impl = getImpl();
+    const int j = impl.getActiveBushings(state).slot[bushing];
+    if (j < 0) return Vec6(NaN);
+    impl.ensurePositionCacheValid(state);
+    return impl.getPositionCache(state).q[j];
+}
+
+Vec6 Force::BushingArray::
+getF(const State& state, int bushing) const {
+    SimTK_INDEXCHECK_ALWAYS(bushing, getNumBushings(),
+        "Force::BushingArray::getF()");
+    const BushingArrayImpl& impl = getImpl();
+    const int j = impl.getActiveBushings(state).slot[bushing];
+    if (j < 0) return Vec6(NaN);
+    impl.ensureForceCacheValid(state);
+    return impl.getForceCache(state).f[j];
+}
+
+
+
+//==============================================================================
+//                        FORCE :: BUSHING ARRAY IMPL
+//==============================================================================
+
+//----------------------------- REALIZE TOPOLOGY -------------------------------
+// The enable flags for all the bushings share one discrete variable. The force
+// cache can be calculated as soon as positions are known if no bushing has
+// damping.
+void Force::BushingArrayImpl::
+realizeTopology(State& s) const {
+    BushingArrayImpl* mThis = const_cast<BushingArrayImpl*>(this);
+    mThis->enabledIx = getForceSubsystem().allocateDiscreteVariable
+       (s, Stage::Instance, new Value<Array_<bool>>(defEnabled));
+    mThis->activeBushingsIx = getForceSubsystem().allocateCacheEntry
+       (s, Stage::Instance, new Value<ActiveBushings>());
+    mThis->positionCacheIx = getForceSubsystem().allocateLazyCacheEntry
+       (s, Stage::Position, new Value<PositionCache>());
+    mThis->stiffnessForceCacheIx = getForceSubsystem().allocateLazyCacheEntry
+       (s, Stage::Position, new Value<StiffnessForceCache>());
+    mThis->forceCacheIx = getForceSubsystem().allocateLazyCacheEntry
+       (s, numDamped ? Stage::Velocity : Stage::Position,
+        new Value<ForceCache>());
+}
+
+//----------------------------- REALIZE INSTANCE -------------------------------
+// Pack the enabled bushings' parameters.
+void Force::BushingArrayImpl::
+realizeInstance(const State& s) const {
+    const Array_<bool>& enabled = getEnabled(s);
+    ActiveBushings& ab = updActiveBushings(s);
+    ab.slot.resize(enabled.size());
+    ab.body1.clear(); ab.body2.clear();
+    ab.X_B1F.clear(); ab.X_B2M.clear();
+    ab.k.clear(); ab.c.clear();
+    for (int i=0; i < (int)enabled.size(); ++i) {
+        if (!enabled[i]) {ab.slot[i] = -1; continue;}
+        ab.slot[i] = (int)ab.body1.size();
+        ab.body1.push_back(body1[i]); ab.X_B1F.push_back(X_B1F[i]);
+        ab.body2.push_back(body2[i]); ab.X_B2M.push_back(X_B2M[i]);
+        ab.k.push_back(k[i]); ab.c.push_back(c[i]);
+    }
+}
+
+//--------------------- FIND AFFECTED BODIES AND MOBILITIES --------------------
+// This is called during realizeInstance() so we work from the enable flags
+// rather than the ActiveBushings cache entry. Each body is reported once.
+bool Force::BushingArrayImpl::
+findAffectedBodiesAndMobilities(const State& state,
+                                Array_<MobilizedBodyIndex>& bodies,
+                                Array_<UIndex>& mobilities) const {
+    const Array_<bool>& enabled = getEnabled(state);
+    const int first = (int)bodies.size();
+    for (int i=0; i < (int)enabled.size(); ++i)
+        if (enabled[i]) {bodies.push_back(body1[i]);
+                         bodies.push_back(body2[i]);}
+    std::sort(bodies.begin()+first, bodies.end());
+    bodies.erase(std::unique(bodies.begin()+first, bodies.end()),
+                 bodies.end());
+    return true;
+}
+
+//------------------------ ENSURE POSITION CACHE VALID -------------------------
+void Force::BushingArrayImpl::
+ensurePositionCacheValid(const State& state) const {
+    if (getForceSubsystem().isCacheValueRealized(state, positionCacheIx))
+        return;
+
+    const ActiveBushings& ab = getActiveBushings(state);
+    const int n = (int)ab.body1.size();
+    PositionCache& pc = updPositionCache(state);
+    pc.X_GF.resize(n); pc.X_GM.resize(n); pc.X_FM.resize(n);
+    pc.p_B1F_G.resize(n); pc.p_B2M_G.resize(n); pc.p_FM_G.resize(n);
+    pc.q.resize(n);
+
+    // Gather: locate the bushing frames and infer the coordinates.
+    for (int j=0; j < n; ++j) {
+        const Transform& X_GB1 =
+            matter.getMobilizedBody(ab.body1[j]).getBodyTransform(state);
+        const Transform& X_GB2 =
+            matter.getMobilizedBody(ab.body2[j]).getBodyTransform(state);
+        pc.X_GF[j] =      X_GB1  * ab.X_B1F[j];
+        pc.X_GM[j] =      X_GB2  * ab.X_B2M[j];
+        pc.X_FM[j] = ~pc.X_GF[j] * pc.X_GM[j];
+
+        pc.p_B1F_G[j] =    X_GB1.R()  * ab.X_B1F[j].p();
+        pc.p_B2M_G[j] =    X_GB2.R()  * ab.X_B2M[j].p();
+        pc.p_FM_G[j]  = pc.X_GF[j].R() * pc.X_FM[j].p();
+
+        pc.q[j].updSubVec<3>(0) =
+            pc.X_FM[j].R().convertRotationToBodyFixedXYZ();
+        pc.q[j].updSubVec<3>(3) = pc.X_FM[j].p();
+    }
+
+    // Energy; the packed 6-vectors are treated as one long array.
+    const Real* kp = n ? &ab.k[0][0] : nullptr;
+    const Real* qp = n ? &pc.q[0][0] : nullptr;
+    Real pe2 = 0;
+    for (int i=0; i < 6*n; ++i)
+        pe2 += kp[i]*qp[i]*qp[i];
+    pc.pe = pe2/2;
+
+    getForceSubsystem().markCacheValueRealized(state, positionCacheIx);
+}
+
+//--------------------- ENSURE STIFFNESS FORCE CACHE VALID ---------------------
+void Force::BushingArrayImpl::
+ensureStiffnessForceCacheValid(const State& state) const {
+    if (getForceSubsystem().isCacheValueRealized(state, stiffnessForceCacheIx))
+        return;
+
+    ensurePositionCacheValid(state);
+    const ActiveBushings& ab = getActiveBushings(state);
+    const PositionCache&  pc = getPositionCache(state);
+    const int n = (int)ab.body1.size();
+    StiffnessForceCache& sc = updStiffnessForceCache(state);
+    sc.f.resize(n);
+
+    // Generalized forces on body 2, f = -k q, as one long loop.
+    if (n) {
+        const Real* kp = &ab.k[0][0];
+        const Real* qp = &pc.q[0][0];
+        Real*       fp = &sc.f[0][0];
+        for (int i=0; i < 6*n; ++i)
+            fp[i] = -kp[i]*qp[i];
+    }
+    calcSpatialForces(pc, sc.f, sc.F_GB1, sc.F_GB2);
+
+    getForceSubsystem().markCacheValueRealized(state, stiffnessForceCacheIx);
+}
+
+//-------------------------- ENSURE FORCE CACHE VALID --------------------------
+// The total generalized forces, and the spatial forces due to damping alone.
+void Force::BushingArrayImpl::
+ensureForceCacheValid(const State& state) const {
+    if (getForceSubsystem().isCacheValueRealized(state, forceCacheIx))
+        return;
+
+    ensureStiffnessForceCacheValid(state);
+    const ActiveBushings&      ab = getActiveBushings(state);
+    const PositionCache&       pc = getPositionCache(state);
+    const StiffnessForceCache& sc = getStiffnessForceCache(state);
+    const int n = (int)ab.body1.size();
+    ForceCache& fc = updForceCache(state);
+    fc.f = sc.f;
+    if (numDamped == 0 || n == 0) {
+        getForceSubsystem().markCacheValueRealized(state, forceCacheIx);
+        return;
+    }
+
+    // Gather the coordinate derivatives.
+    fc.qdot.resize(n);
+    for (int j=0; j < n; ++j) {
+        const SpatialVec& V_GB1 =
+            matter.getMobilizedBody(ab.body1[j]).getBodyVelocity(state);
+        const SpatialVec& V_GB2 =
+            matter.getMobilizedBody(ab.body2[j]).getBodyVelocity(state);
+        const SpatialVec V_GF(V_GB1[0], V_GB1[1] + V_GB1[0]%pc.p_B1F_G[j]);
+        const SpatialVec V_GM(V_GB2[0], V_GB2[1] + V_GB2[0]%pc.p_B2M_G[j]);
+        const SpatialVec V_FM_G = V_GM - V_GF;
+        const SpatialVec V_FM = ~pc.X_GF[j].R() *
+            SpatialVec(V_FM_G[0], V_FM_G[1] - V_GF[0] % pc.p_FM_G[j]);
+        const Vec3  w_FM_M = ~pc.X_FM[j].R() * V_FM[0];
+        const Mat33 N_FM   =
+            Rotation::calcNForBodyXYZInBodyFrame(pc.q[j].getSubVec<3>(0));
+        fc.qdot[j].updSubVec<3>(0) = N_FM * w_FM_M;
+        fc.qdot[j].updSubVec<3>(3) = V_FM[1];
+    }
+
+    // Damping generalized forces -c qdot, as one long loop, added into the
+    // total and then converted to spatial forces on their own.
+    fc.fc.resize(n);
+    const Real* cp  = &ab.c[0][0];
+    const Real* qdp = &fc.qdot[0][0];
+    Real*       fcp = &fc.fc[0][0];
+    Real*       fp  = &fc.f[0][0];
+    for (int i=0; i < 6*n; ++i) {
+        fcp[i] = -cp[i]*qdp[i];
+        fp[i] += fcp[i];
+    }
+    calcSpatialForces(pc, fc.fc, fc.Fc_GB1, fc.Fc_GB2);
+
+    getForceSubsystem().markCacheValueRealized(state, forceCacheIx);
+}
+
+//--------------------------- CALC SPATIAL FORCES ------------------------------
+void Force::BushingArrayImpl::
+calcSpatialForces(const PositionCache& pc, const Array_<Vec6>& f,
+                  Array_<SpatialVec>& F_GB1, Array_<SpatialVec>& F_GB2) const {
+    const int n = (int)f.size();
+    F_GB1.resize(n); F_GB2.resize(n);
+    for (int j=0; j < n; ++j) {
+        const Vec3& fB2_q = f[j].getSubVec<3>(0); // in q basis
+        const Vec3& fM_F  = f[j].getSubVec<3>(3); // at OM, exp. in F
+        const Mat33 N_FM  =
+            Rotation::calcNForBodyXYZInBodyFrame(pc.q[j].getSubVec<3>(0));
+        const Vec3 mB2_G = pc.X_GM[j].R() * (~N_FM * fB2_q);
+        const Vec3 fM_G  = pc.X_GF[j].R() * fM_F;
+
+        const SpatialVec F_GM(  mB2_G,                          fM_G);
+        const SpatialVec F_GF(-(mB2_G + pc.p_FM_G[j] % fM_G), -fM_G);
+        F_GB2[j] = SpatialVec(F_GM[0] + pc.p_B2M_G[j] % F_GM[1], F_GM[1]);
+        F_GB1[j] = SpatialVec(F_GF[0] + pc.p_B1F_G[j] % F_GF[1], F_GF[1]);
+    }
+}
+
+//------------------------------- APPLY FORCES ---------------------------------
+void Force::BushingArrayImpl::
+applyForces(const State& state, const Array_<SpatialVec>& F_GB1,
+            const Array_<SpatialVec>& F_GB2,
+            Vector_<SpatialVec>& bodyForces) const {
+    const ActiveBushings& ab = getActiveBushings(state);
+    for (int j=0; j < (int)ab.body1.size(); ++j) {
+        bodyForces[ab.body2[j]] += F_GB2[j];
+        bodyForces[ab.body1[j]] += F_GB1[j];
+    }
+}
+
+//------------------------------- CALC FORCE -----------------------------------
+// The stiffness and damping forces are applied separately.
+void Force::BushingArrayImpl::
+calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
+          Vector_<Vec3>& particleForces, Vector& mobilityForces) const
+{
+    calcPositionOnlyPart(state, bodyForces, particleForces, mobilityForces);
+    if (numDamped)
+        calcVelocityDependentPart(state, bodyForces, particleForces,
+                                  mobilityForces);
+}
+
+void Force::BushingArrayImpl::
+calcPositionOnlyPart(const State& state, Vector_<SpatialVec>& bodyForces,
+                     Vector_<Vec3>& particleForces,
+                     Vector& mobilityForces) const
+{
+    ensureStiffnessForceCacheValid(state);
+    const StiffnessForceCache& sc = getStiffnessForceCache(state);
+    applyForces(state, sc.F_GB1, sc.F_GB2, bodyForces);
+}
+
+void Force::BushingArrayImpl::
+calcVelocityDependentPart
+   (const State& state, Vector_<SpatialVec>& bodyForces,
+    Vector_<Vec3>& particleForces, Vector& mobilityForces) const
+{
+    ensureForceCacheValid(state);
+    const ForceCache& fc = getForceCache(state);
+    applyForces(state, fc.Fc_GB1, fc.Fc_GB2, bodyForces);
+}
+
+//-------------------------- CALC POTENTIAL ENERGY -----------------------------
+Real Force::BushingArrayImpl::
+calcPotentialEnergy(const State& state) const {
+    ensurePositionCacheValid(state);
+    return getPositionCache(state).pe;
+}
+
+} // namespace SimTK
@@ -148,14 +148,23 @@ friend class Force::Gravity;
         return new GravityImpl(*this);
     }
 
-    // We are doing our own caching here, so don't override the 
-    // dependsOnlyOnPositions() method which would cause the base class also
-    // to cache the results.
+    // We do our own caching of the gravity forces so they are available
+    // from Position stage on, but GeneralForceSubsystem also caches what
+    // calcForce() adds in so that it can skip this element entirely while
+    // the configuration is unchanged. Invalidating our force cache must
+    // invalidate that one too.
+    bool dependsOnlyOnPositions() const override {return true;}
 
     void calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
                    Vector_<Vec3>& particleForces, Vector& mobilityForces) const
                    override;
     Real calcPotentialEnergy(const State& state) const override;
+    bool calcForceDerivative(const State& state, const Vector& dq,
+                             const Vector& du,
+                             const Vector_<SpatialVec>& dX_GB,
+                             const Vector_<SpatialVec>& dV_GB,
+                             Vector_<SpatialVec>& dBodyForces,
+                             Vector& dMobilityForces) const override;
 
     // Allocate the state variables and cache entries.
     void realizeTopology(State& s) const override;
@@ -179,7 +188,8 @@ friend class Force::Gravity;
     void markForceCacheValid(const State& s) const
     {   getForceSubsystem().markCacheValueRealized(s,forceCacheIx); }
     void invalidateForceCache(const State& s) const
-    {   getForceSubsystem().markCacheValueNotRealized(s,forceCacheIx); }
+    {   getForceSubsystem().markCacheValueNotRealized(s,forceCacheIx);
+        invalidateCachedForces(s); }
 
     // This method calculates gravity forces if needed, and bumps the 
     // numEvaluations counter if it has to do any work.
@@ -578,6 +588,36 @@ calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
     particleForces += fc.f_GP; }
 
 
+//--------------------------- CALC FORCE DERIVATIVE ----------------------------
+// The force at each mass center is constant; only its moment about the body
+// origin changes, as the mass center station rotates with the body.
+bool Force::GravityImpl::
+calcForceDerivative(const State& state, const Vector& dq, const Vector& du,
+                    const Vector_<SpatialVec>& dX_GB,
+                    const Vector_<SpatialVec>& dV_GB,
+                    Vector_<SpatialVec>& dBodyForces,
+                    Vector& dMobilityForces) const 
+{
+    const Parameters& p = getParameters(state);
+    if (p.g == 0) 
+        return true;
+
+    const Vec3 gravity = p.g * p.d;
+    const int nb = matter.getNumBodies();
+    for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx) {
+        if (p.mobodIsImmune[mbx])
+            continue;
+        const MobilizedBody&  mobod  = matter.getMobilizedBody(mbx);
+        const MassProperties& mprops = mobod.getBodyMassProperties(state);
+        const Vec3 p_CB_G = mobod.getBodyTransform(state).R()
+                            * mprops.getMassCenter();
+        dBodyForces[mbx][0] += (dX_GB[mbx][0] % p_CB_G) 
+                               % (mprops.getMass()*gravity);
+    }
+    return true;
+}
+
+
 //-------------------------- CALC POTENTIAL ENERGY -----------------------------
 // If the force was calculated, then the potential energy will already
 // be valid. Otherwise we'll have to calculate it.
@@ -52,11 +52,18 @@ class Force::LinearBushingImpl : public ForceImpl {
         SpatialVec V_GF, V_GM, V_FM;
         Vec6       qdot;
     };
+    // The forces due to the stiffness alone; this depends only on positions.
+    struct StiffnessForceCache {
+        SpatialVec F_GF, F_GM;      // at Bushing frames
+        SpatialVec F_GB1, F_GB2;    // at Body frames
+        Vec6       f;               // scalar generalized forces
+    };
     struct ForceCache {
         SpatialVec F_GF, F_GM;      // at Bushing frames
         SpatialVec F_GB1, F_GB2;    // at Body frames
         Vec6       f;               // scalar generalized forces
         Real       power;
+        SpatialVec Fc_GB1, Fc_GB2;  // damping part only, at Body frames
     };
 public:
     LinearBushingImpl(const MobilizedBody& body1, const Transform& frameOnB1, 
@@ -72,6 +79,26 @@ public:
                    Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
     Real calcPotentialEnergy(const State& state) const override;
 
+    // The stiffness forces are the position-only part and the damping forces
+    // the velocity-dependent part.
+    bool hasPositionOnlyPart() const override {return true;}
+    void calcPositionOnlyPart
+       (const State& state, Vector_<SpatialVec>& bodyForces,
+        Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
+    void calcVelocityDependentPart
+       (const State& state, Vector_<SpatialVec>& bodyForces,
+        Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
+
+    // calcForce() writes only to this bushing's own cache entries.
+    bool canBeCalculatedInParallel() const override {return true;}
+    Real getCostEstimate() const override {return 4;}
+    bool findAffectedBodiesAndMobilities
+       (const State& state, Array_<MobilizedBodyIndex>& bodies,
+        Array_<UIndex>& mobilities) const override {
+        bodies.push_back(body1x); bodies.push_back(body2x);
+        return true;
+    }
+
     // Allocate the position and velocity cache entries. These are all
     // lazy-evaluation entries - be sure to check whether they have already
     // been calculated; calculate them if not; and then mark them done.
@@ -92,6 +119,9 @@ public:
             Stage::Position, Stage::Infinity, new Value<PositionCache>());
         mThis->potEnergyCacheIx = getForceSubsystem().allocateCacheEntry(s,
             Stage::Position, Stage::Infinity, new Value<Real>(NaN));
+        mThis->stiffnessForceCacheIx = getForceSubsystem().allocateCacheEntry
+           (s, Stage::Position, Stage::Infinity,
+            new Value<StiffnessForceCache>());
         mThis->velocityCacheIx = getForceSubsystem().allocateCacheEntry(s,
             Stage::Velocity, Stage::Infinity, new Value<VelocityCache>());
         mThis->forceCacheIx = getForceSubsystem().allocateCacheEntry(s,
@@ -124,6 +154,9 @@ private:
     const Real& getPotentialEnergyCache(const State& s) const
     {   return Value<Real>::downcast
             (getForceSubsystem().getCacheEntry(s,potEnergyCacheIx)); }
+    const StiffnessForceCache& getStiffnessForceCache(const State& s) const
+    {   return Value<StiffnessForceCache>::downcast
+            (getForceSubsystem().getCacheEntry(s,stiffnessForceCacheIx)); }
     const VelocityCache& getVelocityCache(const State& s) const
     {   return Value<VelocityCache>::downcast
             (getForceSubsystem().getCacheEntry(s,velocityCacheIx)); }
@@ -137,6 +170,9 @@ private:
     Real& updPotentialEnergyCache(const State& s) const
     {   return Value<Real>::updDowncast
             (getForceSubsystem().updCacheEntry(s,potEnergyCacheIx)); }
+    StiffnessForceCache& updStiffnessForceCache(const State& s) const
+    {   return Value<StiffnessForceCache>::updDowncast
+            (getForceSubsystem().updCacheEntry(s,stiffnessForceCacheIx)); }
     VelocityCache& updVelocityCache(const State& s) const
     {   return Value<VelocityCache>::updDowncast
             (getForceSubsystem().updCacheEntry(s,velocityCacheIx)); }
@@ -148,6 +184,9 @@ private:
     {   return getForceSubsystem().isCacheValueRealized(s,positionCacheIx); }
     bool isPotentialEnergyValid(const State& s) const
     {   return getForceSubsystem().isCacheValueRealized(s,potEnergyCacheIx); }
+    bool isStiffnessForceCacheValid(const State& s) const
+    {   return getForceSubsystem()
+                .isCacheValueRealized(s,stiffnessForceCacheIx); }
     bool isVelocityCacheValid(const State& s) const
     {   return getForceSubsystem().isCacheValueRealized(s,velocityCacheIx); }
     bool isForceCacheValid(const State& s) const
@@ -157,6 +196,8 @@ private:
     {   getForceSubsystem().markCacheValueRealized(s,positionCacheIx); }
     void markPotentialEnergyValid(const State& s) const
     {   getForceSubsystem().markCacheValueRealized(s,potEnergyCacheIx); }
+    void markStiffnessForceCacheValid(const State& s) const
+    {   getForceSubsystem().markCacheValueRealized(s,stiffnessForceCacheIx); }
     void markVelocityCacheValid(const State& s) const
     {   getForceSubsystem().markCacheValueRealized(s,velocityCacheIx); }
     void markForceCacheValid(const State& s) const
@@ -164,9 +205,16 @@ private:
 
     void ensurePositionCacheValid(const State&) const;
     void ensurePotentialEnergyValid(const State&) const;
+    void ensureStiffnessForceCacheValid(const State&) const;
     void ensureVelocityCacheValid(const State&) const;
     void ensureForceCacheValid(const State&) const;
 
+    // Convert scalar generalized forces f on body 2 into the equivalent
+    // spatial forces at the bushing frames and at the body origins.
+    void calcSpatialForces(const PositionCache& pc, const Vec6& f,
+                           SpatialVec& F_GF, SpatialVec& F_GM,
+                           SpatialVec& F_GB1, SpatialVec& F_GB2) const;
+
     // TOPOLOGY STATE
     const SimbodyMatterSubsystem&   matter;
     MobilizedBodyIndex              body1x;
@@ -179,12 +227,14 @@ private:
     ZIndex                          dissipatedEnergyIx;
     CacheEntryIndex                 positionCacheIx;
     CacheEntryIndex                 potEnergyCacheIx;
+    CacheEntryIndex                 stiffnessForceCacheIx;
     CacheEntryIndex                 velocityCacheIx;
     CacheEntryIndex                 forceCacheIx;
 
 friend class Force::LinearBushing;
 friend std::ostream& operator<<(std::ostream&,const InstanceVars&);
 friend std::ostream& operator<<(std::ostream&,const PositionCache&);
+friend std::ostream& operator<<(std::ostream&,const StiffnessForceCache&);
 friend std::ostream& operator<<(std::ostream&,const VelocityCache&);
 friend std::ostream& operator<<(std::ostream&,const ForceCache&);
 };
@@ -196,6 +246,9 @@ inline std::ostream& operator<<
 inline std::ostream& operator<<
    (std::ostream& o, const Force::LinearBushingImpl::PositionCache& pc)
 {   assert(!"implemented"); return o; }
+inline std::ostream& operator<<
+   (std::ostream& o, const Force::LinearBushingImpl::StiffnessForceCache& sc)
+{   assert(!"implemented"); return o; }
 inline std::ostream& operator<<
    (std::ostream& o, const Force::LinearBushingImpl::VelocityCache& vc)
 {   assert(!"implemented"); return o; }
@@ -488,43 +541,20 @@ ensureVelocityCacheValid(const State& state) const {
     markVelocityCacheValid(state);
 }
 
-// This will also calculate potential energy since we can do it on the
-// cheap simultaneously with the force.
+// Calculate the forces due to stiffness alone. This will also calculate
+// potential energy since we can do it on the cheap simultaneously with the
+// force.
 void Force::LinearBushingImpl::
-ensureForceCacheValid(const State& state) const {
-    if (isForceCacheValid(state)) return;
+ensureStiffnessForceCacheValid(const State& state) const {
+    if (isStiffnessForceCacheValid(state)) return;
 
     const InstanceVars& iv = getInstanceVars(state);
-    const Transform& X_B1F = iv.X_B1F;
-    const Transform& X_B2M = iv.X_B2M;
-    const Vec6&      k     = iv.k;
-    const Vec6&      c     = iv.c;
-
-    ForceCache& fc = updForceCache(state);
+    const Vec6&         k  = iv.k;
 
     ensurePositionCacheValid(state);
     const PositionCache& pc = getPositionCache(state);
 
-    const MobilizedBody& body1 = matter.getMobilizedBody(body1x);
-    const MobilizedBody& body2 = matter.getMobilizedBody(body2x);
-
-    const Transform& X_GB1 = body1.getBodyTransform(state);
-    const Rotation&  R_GB1 = X_GB1.R();
-
-    const Transform& X_GB2 = body2.getBodyTransform(state);
-    const Rotation&  R_GB2 = X_GB2.R();
-
-    const Vec3&      p_B1F = X_B1F.p();
-    const Vec3&      p_B2M = X_B2M.p();
-
-    const Rotation&  R_GF = pc.X_GF.R();
-    const Vec3&      p_GF = pc.X_GF.p();
-
-    const Rotation&  R_GM = pc.X_GM.R();
-    const Vec3&      p_GM = pc.X_GM.p();
-
-    const Rotation&  R_FM = pc.X_FM.R();
-    const Vec3&      p_FM = pc.X_FM.p();
+    StiffnessForceCache& sc = updStiffnessForceCache(state);
 
     // Calculate stiffness generalized forces and potential
     // energy (cheap to do here).
@@ -535,6 +565,27 @@ ensureForceCacheValid(const State& state) const {
     updPotentialEnergyCache(state) = pe2/2;
     markPotentialEnergyValid(state);
 
+    sc.f = -fk; // generalized forces on body 2
+    calcSpatialForces(pc, sc.f, sc.F_GF, sc.F_GM, sc.F_GB1, sc.F_GB2);
+
+    markStiffnessForceCacheValid(state);
+}
+
+// The total force is the stiffness force plus the damping force; we keep the
+// damping part separately as well.
+void Force::LinearBushingImpl::
+ensureForceCacheValid(const State& state) const {
+    if (isForceCacheValid(state)) return;
+
+    const InstanceVars& iv = getInstanceVars(state);
+    const Vec6&         c  = iv.c;
+
+    ForceCache& fc = updForceCache(state);
+
+    ensureStiffnessForceCacheValid(state);
+    const PositionCache&       pc = getPositionCache(state);
+    const StiffnessForceCache& sc = getStiffnessForceCache(state);
+
     ensureVelocityCacheValid(state);
     const VelocityCache& vc = getVelocityCache(state);
 
@@ -543,9 +594,27 @@ ensureForceCacheValid(const State& state) const {
     for (int i=0; i<6; ++i) 
         fc.power += (fv[i]=c[i]*qd[i])*qd[i];
 
-    fc.f = -(fk+fv); // generalized forces on body 2
-    const Vec3& fB2_q = fc.f.getSubVec<3>(0); // in q basis
-    const Vec3& fM_F  = fc.f.getSubVec<3>(3); // acts at M, but exp. in F frame
+    SpatialVec Fc_GF, Fc_GM;
+    calcSpatialForces(pc, -fv, Fc_GF, Fc_GM, fc.Fc_GB1, fc.Fc_GB2);
+
+    fc.f     = sc.f     - fv; // generalized forces on body 2
+    fc.F_GF  = sc.F_GF  + Fc_GF;
+    fc.F_GM  = sc.F_GM  + Fc_GM;
+    fc.F_GB1 = sc.F_GB1 + fc.Fc_GB1;
+    fc.F_GB2 = sc.F_GB2 + fc.Fc_GB2;
+
+    markForceCacheValid(state);
+}
+
+void Force::LinearBushingImpl::
+calcSpatialForces(const PositionCache& pc, const Vec6& f,
+                  SpatialVec& F_GF, SpatialVec& F_GM,
+                  SpatialVec& F_GB1, SpatialVec& F_GB2) const {
+    const Rotation&  R_GF = pc.X_GF.R();
+    const Rotation&  R_GM = pc.X_GM.R();
+
+    const Vec3& fB2_q = f.getSubVec<3>(0); // in q basis
+    const Vec3& fM_F  = f.getSubVec<3>(3); // acts at M, but exp. in F frame
 
     // Calculate the matrix relating q-space generalized forces to a real-space
     // moment vector. We know qforce = ~H * moment (where H is the
@@ -553,7 +622,8 @@ ensureForceCacheValid(const State& state) const {
     // In that case H would be N^-1, qforce = ~(N^-1)*moment so
     // moment = ~N*qforce. Caution: our N wants the moment in the outboard
     // body frame, in this case M.
-    const Mat33 N_FM  = Rotation::calcNForBodyXYZInBodyFrame(q.getSubVec<3>(0));
+    const Mat33 N_FM  = Rotation::calcNForBodyXYZInBodyFrame
+                                                    (pc.q.getSubVec<3>(0));
     const Vec3  mB2_M = ~N_FM * fB2_q; // moment acting on body 2, exp. in M
     const Vec3  mB2_G =  R_GM * mB2_M; // moment on body 2, now exp. in G
 
@@ -563,14 +633,12 @@ ensureForceCacheValid(const State& state) const {
     // account for the moment produced by the shift from OM.
     const Vec3 fM_G = R_GF*fM_F;
 
-    fc.F_GM = SpatialVec(  mB2_G,                       fM_G);
-    fc.F_GF = SpatialVec(-(mB2_G + pc.p_FM_G % fM_G) , -fM_G);
+    F_GM = SpatialVec(  mB2_G,                       fM_G);
+    F_GF = SpatialVec(-(mB2_G + pc.p_FM_G % fM_G) , -fM_G);
 
     // Shift forces to body origins.
-    fc.F_GB2 = SpatialVec(fc.F_GM[0] + pc.p_B2M_G % fc.F_GM[1], fc.F_GM[1]);
-    fc.F_GB1 = SpatialVec(fc.F_GF[0] + pc.p_B1F_G % fc.F_GF[1], fc.F_GF[1]);
-
-    markForceCacheValid(state);
+    F_GB2 = SpatialVec(F_GM[0] + pc.p_B2M_G % F_GM[1], F_GM[1]);
+    F_GB1 = SpatialVec(F_GF[0] + pc.p_B1F_G % F_GF[1], F_GF[1]);
 }
 
 // This calculate is only performed if the PE is requested without
@@ -604,6 +672,27 @@ calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
     bodyForces[body1x] +=  fc.F_GB1; // apply forces
 }
 
+void Force::LinearBushingImpl::
+calcPositionOnlyPart(const State& state, Vector_<SpatialVec>& bodyForces, 
+                     Vector_<Vec3>& particleForces, Vector& mobilityForces) const 
+{
+    ensureStiffnessForceCacheValid(state);
+    const StiffnessForceCache& sc = getStiffnessForceCache(state);
+    bodyForces[body2x] +=  sc.F_GB2;
+    bodyForces[body1x] +=  sc.F_GB1;
+}
+
+void Force::LinearBushingImpl::
+calcVelocityDependentPart
+   (const State& state, Vector_<SpatialVec>& bodyForces, 
+    Vector_<Vec3>& particleForces, Vector& mobilityForces) const 
+{
+    ensureForceCacheValid(state);
+    const ForceCache& fc = getForceCache(state);
+    bodyForces[body2x] +=  fc.Fc_GB2;
+    bodyForces[body1x] +=  fc.Fc_GB1;
+}
+
 // If the force was calculated, then the potential energy will already
 // be valid. Otherwise we'll have to calculate it.
 Real Force::LinearBushingImpl::
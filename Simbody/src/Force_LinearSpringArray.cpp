@@ -0,0 +1,440 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+
+#include "simbody/internal/common.h"
+#include "simbody/internal/MobilizedBody.h"
+#include "simbody/internal/SimbodyMatterSubsystem.h"
+#include "simbody/internal/Force_LinearSpringArray.h"
+
+#include "ForceImpl.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SimTK {
+
+//==============================================================================
+//                     FORCE :: LINEAR SPRING ARRAY IMPL
+//==============================================================================
+// This is the hidden implementation class for Force::LinearSpringArray. The
+// spring parameters are kept one array per parameter. At Instance stage the
+// enabled springs' parameters are packed into the ActiveSprings cache entry
+// so that the force loops run over contiguous arrays with no tests for
+// disabled springs. Each calculation is done in three passes: a gather pass
+// that reads the body kinematics, an arithmetic pass over the packed arrays,
+// and a scatter pass that applies the results to the bodies.
+class Force::LinearSpringArrayImpl : public ForceImpl {
+friend class Force::LinearSpringArray;
+
+    // The enabled springs, in order, with copies of their parameters. The
+    // slot map gives each spring's position here, or -1 if it is disabled.
+    struct ActiveSprings {
+        Array_<int>                 slot;       // [nsprings]
+        Array_<MobilizedBodyIndex>  body1, body2;
+        Array_<Vec3>                station1, station2;
+        Array_<Real>                k, x0, c;
+    };
+    // Lazy, Position stage. Stations are re-expressed in Ground; d is the
+    // unit vector from point 1 to point 2 and x the distance between them.
+    struct PositionCache {
+        Array_<Vec3>    s1_G, s2_G, d_G;
+        Array_<Real>    x;
+        Array_<Real>    tk;     // tension due to stiffness alone
+        Real            pe;
+    };
+    // Lazy, Velocity stage unless no spring has damping, then Position.
+    struct ForceCache {
+        Array_<Real>    xdot;   // only if there is damping
+        Array_<Real>    tc;     // tension due to damping; ditto
+        Array_<Real>    t;      // tension
+    };
+public:
+    explicit LinearSpringArrayImpl(const SimbodyMatterSubsystem& matter)
+    :   matter(matter), numDamped(0) {}
+
+    LinearSpringArrayImpl* clone() const override {
+        return new LinearSpringArrayImpl(*this);
+    }
+    bool dependsOnlyOnPositions() const override {
+        return numDamped == 0;
+    }
+    void calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
+                   Vector_<Vec3>& particleForces,
+                   Vector& mobilityForces) const override;
+    Real calcPotentialEnergy(const State& state) const override;
+
+    // With damping, the stiffness tensions are the position-only part and the
+    // damping tensions the velocity-dependent part.
+    bool hasPositionOnlyPart() const override {return numDamped > 0;}
+    void calcPositionOnlyPart
+       (const State& state, Vector_<SpatialVec>& bodyForces,
+        Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
+    void calcVelocityDependentPart
+       (const State& state, Vector_<SpatialVec>& bodyForces,
+        Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
+
+    // calcForce() writes only to this array's own cache entries.
+    bool canBeCalculatedInParallel() const override {return true;}
+    Real getCostEstimate() const override {return (Real)body1.size();}
+    bool findAffectedBodiesAndMobilities
+       (const State& state, Array_<MobilizedBodyIndex>& bodies,
+        Array_<UIndex>& mobilities) const override;
+
+    void realizeTopology(State& s) const override;
+    void realizeInstance(const State& s) const override;
+
+    int addSpring(MobilizedBodyIndex b1, const Vec3& s1,
+                  MobilizedBodyIndex b2, const Vec3& s2,
+                  Real k_, Real x0_, Real c_) {
+        invalidateTopologyCache();
+        body1.push_back(b1); station1.push_back(s1);
+        body2.push_back(b2); station2.push_back(s2);
+        k.push_back(k_); x0.push_back(x0_); c.push_back(c_);
+        defEnabled.push_back(true);
+        if (c_ != 0) ++numDamped;
+        return (int)body1.size() - 1;
+    }
+
+private:
+    const Array_<bool>& getEnabled(const State& s) const
+    {   return Value<Array_<bool>>::downcast
+           (getForceSubsystem().getDiscreteVariable(s,enabledIx)); }
+    Array_<bool>& updEnabled(State& s) const
+    {   return Value<Array_<bool>>::updDowncast
+           (getForceSubsystem().updDiscreteVariable(s,enabledIx)); }
+
+    const ActiveSprings& getActiveSprings(const State& s) const
+    {   return Value<ActiveSprings>::downcast
+            (getForceSubsystem().getCacheEntry(s,activeSpringsIx)); }
+    ActiveSprings& updActiveSprings(const State& s) const
+    {   return Value<ActiveSprings>::updDowncast
+            (getForceSubsystem().updCacheEntry(s,activeSpringsIx)); }
+
+    const PositionCache& getPositionCache(const State& s) const
+    {   return Value<PositionCache>::downcast
+            (getForceSubsystem().getCacheEntry(s,positionCacheIx)); }
+    PositionCache& updPositionCache(const State& s) const
+    {   return Value<PositionCache>::updDowncast
+            (getForceSubsystem().updCacheEntry(s,positionCacheIx)); }
+    const ForceCache& getForceCache(const State& s) const
+    {   return Value<ForceCache>::downcast
+            (getForceSubsystem().getCacheEntry(s,forceCacheIx)); }
+    ForceCache& updForceCache(const State& s) const
+    {   return Value<ForceCache>::updDowncast
+            (getForceSubsystem().updCacheEntry(s,forceCacheIx)); }
+
+    void ensurePositionCacheValid(const State&) const;
+    void ensureForceCacheValid(const State&) const;
+
+    // Apply tension t[j] along each active spring j.
+    void applyTensions(const State& state, const Array_<Real>& t,
+                       Vector_<SpatialVec>& bodyForces) const;
+
+    // TOPOLOGY STATE
+    const SimbodyMatterSubsystem&   matter;
+    Array_<MobilizedBodyIndex>      body1, body2;
+    Array_<Vec3>                    station1, station2;
+    Array_<Real>                    k, x0, c;
+    Array_<bool>                    defEnabled;
+    int                             numDamped;
+
+    // TOPOLOGY CACHE
+    DiscreteVariableIndex           enabledIx;
+    CacheEntryIndex                 activeSpringsIx;
+    CacheEntryIndex                 positionCacheIx;
+    CacheEntryIndex                 forceCacheIx;
+};
+
+
+
+//==============================================================================
+//                         FORCE :: LINEAR SPRING ARRAY
+//==============================================================================
+
+SimTK_INSERT_DERIVED_HANDLE_DEFINITIONS(Force::LinearSpringArray,
+                                        Force::LinearSpringArrayImpl, Force);
+
+Force::LinearSpringArray::LinearSpringArray
+   (GeneralForceSubsystem& forces, const SimbodyMatterSubsystem& matter)
+:   Force(new LinearSpringArrayImpl(matter))
+{
+    updImpl().setForceSubsystem(forces, forces.adoptForce(*this));
+}
+
+int Force::LinearSpringArray::
+addSpring(const MobilizedBody& body1, const Vec3& station1,
+          const MobilizedBody& body2, const Vec3& station2,
+          Real stiffness, Real restLength, Real damping) {
+    SimTK_ERRCHK_ALWAYS(stiffness >= 0 && restLength >= 0 && damping >= 0,
+        "Force::LinearSpringArray::addSpring()",
+        "Spring stiffness, rest length, and damping must be nonnegative.");
+    return updImpl().addSpring(body1.getMobilizedBodyIndex(), station1,
+                               body2.getMobilizedBodyIndex(), station2,
+                               stiffness, restLength, damping);
+}
+
+int Force::LinearSpringArray::
+getNumSprings() const {return (int)getImpl().body1.size();}
+
+Force::LinearSpringArray& Force::LinearSpringArray::
+setSpringIsEnabledByDefault(int spring, bool enabled) {
+    SimTK_INDEXCHECK_ALWAYS(spring, getNumSprings(),
+        "Force::LinearSpringArray::setSpringIsEnabledByDefault()");
+    getImpl().invalidateTopologyCache();
+    updImpl().defEnabled[spring] = enabled;
+    return *this;
+}
+
+bool Force::LinearSpringArray::
+isSpringEnabledByDefault(int spring) const {
+    SimTK_INDEXCHECK_ALWAYS(spring, getNumSprings(),
+        "Force::LinearSpringArray::isSpringEnabledByDefault()");
+    return getImpl().defEnabled[spring];
+}
+
+void Force::LinearSpringArray::
+setSpringIsEnabled(State& state, int spring, bool enabled) const {
+    SimTK_INDEXCHECK_ALWAYS(spring, getNumSprings(),
+        "Force::LinearSpringArray::setSpringIsEnabled()");
+    getImpl().updEnabled(state)[spring] = enabled;
+}
+
+bool Force::LinearSpringArray::
+isSpringEnabled(const State& state, int spring) const {
+    SimTK_INDEXCHECK_ALWAYS(spring, getNumSprings(),
+        "Force::LinearSpringArray::isSpringEnabled()");
+    return getImpl().getEnabled(state)[spring];
+}
+
+Real Force::LinearSpringArray::
+getLength(const State& state, int spring) const {
+    SimTK_INDEXCHECK_ALWAYS(spring, getNumSprings(),
+        "Force::LinearSpringArray::getLength()");
+    const LinearSpringArrayImpl& impl = getImpl();
+    const int j = impl.getActiveSprings(state).slot[spring];
+    if (j < 0) return NaN;
+    impl.ensurePositionCacheValid(state);
+    return impl.getPositionCache(state).x[j];
+}
+
+Real Force::LinearSpringArray::
+getTension(const State& state, int spring) const {
+    SimTK_INDEXCHECK_ALWAYS(spring, getNumSprings(),
+        "Force::LinearSpringArray::getTension()");
+    const LinearSpringArrayImpl& impl = getImpl();
+    const int j = impl.getActiveSprings(state).slot[spring];
+    if (j < 0) return NaN;
+    impl.ensureForceCacheValid(state);
+    return impl.getForceCache(state).t[j];
+}
+
+
+
+//==============================================================================
+//                     FORCE :: LINEAR SPRING ARRAY IMPL
+//==============================================================================
+
+//----------------------------- REALIZE TOPOLOGY -------------------------------
+// The enable flags for all the springs share one discrete variable. The force
+// cache can be calculated as soon as positions are known if no spring has
+// damping.
+void Force::LinearSpringArrayImpl::
+realizeTopology(State& s) const {
+    LinearSpringArrayImpl* mThis = const_cast<LinearSpringArrayImpl*>(this);
+    mThis->enabledIx = getForceSubsystem().allocateDiscreteVariable
+       (s, Stage::Instance, new Value<Array_<bool>>(defEnabled));
+    mThis->activeSpringsIx = getForceSubsystem().allocateCacheEntry
+       (s, Stage::Instance, new Value<ActiveSprings>());
+    mThis->positionCacheIx = getForceSubsystem().allocateLazyCacheEntry
+       (s, Stage::Position, new Value<PositionCache>());
+    mThis->forceCacheIx = getForceSubsystem().allocateLazyCacheEntry
+       (s, numDamped ? Stage::Velocity : Stage::Position,
+        new Value<ForceCache>());
+}
+
+//----------------------------- REALIZE INSTANCE -------------------------------
+// Pack the enabled springs' parameters.
+void Force::LinearSpringArrayImpl::
+realizeInstance(const State& s) const {
+    const Array_<bool>& enabled = getEnabled(s);
+    ActiveSprings& as = updActiveSprings(s);
+    as.slot.resize(enabled.size());
+    as.body1.clear(); as.body2.clear();
+    as.station1.clear(); as.station2.clear();
+    as.k.clear(); as.x0.clear(); as.c.clear();
+    for (int i=0; i < (int)enabled.size(); ++i) {
+        if (!enabled[i]) {as.slot[i] = -1; continue;}
+        as.slot[i] = (int)as.body1.size();
+        as.body1.push_back(body1[i]); as.station1.push_back(station1[i]);
+        as.body2.push_back(body2[i]); as.station2.push_back(station2[i]);
+        as.k.push_back(k[i]); as.x0.push_back(x0[i]); as.c.push_back(c[i]);
+    }
+}
+
+//--------------------- FIND AFFECTED BODIES AND MOBILITIES --------------------
+// This is called during realizeInstance() so we work from the enable flags
+// rather than the ActiveSprings cache entry. Each body is reported once.
+bool Force::LinearSpringArrayImpl::
+findAffectedBodiesAndMobilities(const State& state,
+                                Array_<MobilizedBodyIndex>& bodies,
+                                Array_<UIndex>& mobilities) const {
+    const Array_<bool>& enabled = getEnabled(state);
+    const int first = (int)bodies.size();
+    for (int i=0; i < (int)enabled.size(); ++i)
+        if (enabled[i]) {bodies.push_back(body1[i]);
+                         bodies.push_back(body2[i]);}
+    std::sort(bodies.begin()+first, bodies.end());
+    bodies.erase(std::unique(bodies.begin()+first, bodies.end()),
+                 bodies.end());
+    return true;
+}
+
+//------------------------ ENSURE POSITION CACHE VALID -------------------------
+void Force::LinearSpringArrayImpl::
+ensurePositionCacheValid(const State& state) const {
+    if (getForceSubsystem().isCacheValueRealized(state, positionCacheIx))
+        return;
+
+    const ActiveSprings& as = getActiveSprings(state);
+    const int n = (int)as.body1.size();
+    PositionCache& pc = updPositionCache(state);
+    pc.s1_G.resize(n); pc.s2_G.resize(n); pc.d_G.resize(n); pc.x.resize(n);
+    pc.tk.resize(n);
+
+    // Gather: re-express the stations in Ground and find the vector from
+    // point 1 to point 2.
+    for (int j=0; j < n; ++j) {
+        const Transform& X_GB1 =
+            matter.getMobilizedBody(as.body1[j]).getBodyTransform(state);
+        const Transform& X_GB2 =
+            matter.getMobilizedBody(as.body2[j]).getBodyTransform(state);
+        pc.s1_G[j] = X_GB1.R() * as.station1[j];
+        pc.s2_G[j] = X_GB2.R() * as.station2[j];
+        pc.d_G[j]  = (X_GB2.p() + pc.s2_G[j]) - (X_GB1.p() + pc.s1_G[j]);
+    }
+
+    // Lengths, directions, stiffness tensions, and energy; pure arithmetic
+    // on packed arrays.
+    Real pe2 = 0;
+    for (int j=0; j < n; ++j) {
+        const Real x = std::sqrt(pc.d_G[j].normSqr());
+        const Real stretch = x - as.x0[j]; // + -> tension, - -> compression
+        pc.x[j] = x;
+        pc.d_G[j] *= 1/x;
+        pc.tk[j] = as.k[j]*stretch;
+        pe2 += pc.tk[j]*stretch;
+    }
+    pc.pe = pe2/2;
+
+    getForceSubsystem().markCacheValueRealized(state, positionCacheIx);
+}
+
+//-------------------------- ENSURE FORCE CACHE VALID --------------------------
+void Force::LinearSpringArrayImpl::
+ensureForceCacheValid(const State& state) const {
+    if (getForceSubsystem().isCacheValueRealized(state, forceCacheIx))
+        return;
+
+    ensurePositionCacheValid(state);
+    const ActiveSprings& as = getActiveSprings(state);
+    const PositionCache& pc = getPositionCache(state);
+    const int n = (int)as.body1.size();
+    ForceCache& fc = updForceCache(state);
+    fc.t.resize(n);
+
+    if (numDamped == 0) {
+        for (int j=0; j < n; ++j)
+            fc.t[j] = pc.tk[j];
+    } else {
+        // Gather the rate of separation of the two points.
+        fc.xdot.resize(n); fc.tc.resize(n);
+        for (int j=0; j < n; ++j) {
+            const SpatialVec& V_GB1 =
+                matter.getMobilizedBody(as.body1[j]).getBodyVelocity(state);
+            const SpatialVec& V_GB2 =
+                matter.getMobilizedBody(as.body2[j]).getBodyVelocity(state);
+            const Vec3 v1_G = V_GB1[1] + V_GB1[0] % pc.s1_G[j];
+            const Vec3 v2_G = V_GB2[1] + V_GB2[0] % pc.s2_G[j];
+            fc.xdot[j] = dot(v2_G - v1_G, pc.d_G[j]);
+        }
+        for (int j=0; j < n; ++j) {
+            fc.tc[j] = as.c[j]*fc.xdot[j];
+            fc.t[j]  = pc.tk[j] + fc.tc[j];
+        }
+    }
+
+    getForceSubsystem().markCacheValueRealized(state, forceCacheIx);
+}
+
+//------------------------------ APPLY TENSIONS --------------------------------
+// Scatter: the force t*d acts at point 1 and its negative at point 2.
+void Force::LinearSpringArrayImpl::
+applyTensions(const State& state, const Array_<Real>& t,
+              Vector_<SpatialVec>& bodyForces) const
+{
+    const ActiveSprings& as = getActiveSprings(state);
+    const PositionCache& pc = getPositionCache(state);
+    for (int j=0; j < (int)as.body1.size(); ++j) {
+        const Vec3 f1_G = t[j] * pc.d_G[j];
+        bodyForces[as.body1[j]] += SpatialVec(pc.s1_G[j] % f1_G, f1_G);
+        bodyForces[as.body2[j]] -= SpatialVec(pc.s2_G[j] % f1_G, f1_G);
+    }
+}
+
+//------------------------------- CALC FORCE -----------------------------------
+void Force::LinearSpringArrayImpl::
+calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
+          Vector_<Vec3>& particleForces, Vector& mobilityForces) const
+{
+    ensureForceCacheValid(state);
+    applyTensions(state, getForceCache(state).t, bodyForces);
+}
+
+void Force::LinearSpringArrayImpl::
+calcPositionOnlyPart(const State& state, Vector_<SpatialVec>& bodyForces,
+                     Vector_<Vec3>& particleForces,
+                     Vector& mobilityForces) const
+{
+    ensurePositionCacheValid(state);
+    applyTensions(state, getPositionCache(state).tk, bodyForces);
+}
+
+void Force::LinearSpringArrayImpl::
+calcVelocityDependentPart
+   (const State& state, Vector_<SpatialVec>& bodyForces,
+    Vector_<Vec3>& particleForces, Vector& mobilityForces) const
+{
+    ensureForceCacheValid(state);
+    applyTensions(state, getForceCache(state).tc, bodyForces);
+}
+
+//-------------------------- CALC POTENTIAL ENERGY -----------------------------
+Real Force::LinearSpringArrayImpl::
+calcPotentialEnergy(const State& state) const {
+    ensurePositionCacheValid(state);
+    return getPositionCache(state).pe;
+}
+
+} // namespace SimTK
@@ -0,0 +1,469 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+
+#include "simbody/internal/common.h"
+#include "simbody/internal/MobilizedBody.h"
+#include "simbody/internal/SimbodyMatterSubsystem.h"
+#include "simbody/internal/Force_UniformFluid.h"
+
+#include "ForceImpl.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SimTK {
+
+//==============================================================================
+//                        FORCE :: UNIFORM FLUID IMPL
+//==============================================================================
+// This is the hidden implementation class for Force::UniformFluid. The body
+// parameters are kept one array per parameter. At Position stage the bodies
+// are partitioned by whether their center of buoyancy is inside the region,
+// and the geometry of those inside is packed into the PositionCache so that
+// the buoyancy and drag loops run over contiguous arrays with no region
+// tests. Buoyancy is the position-only part of this force and is cached by
+// the GeneralForceSubsystem; drag is the velocity-dependent part.
+class Force::UniformFluidImpl : public ForceImpl {
+friend class Force::UniformFluid;
+
+    // The fluid properties, held in a Dynamics-stage discrete variable.
+    // Changing the density or region must also discard the cached buoyancy,
+    // and changing the region our own PositionCache.
+    struct Parameters {
+        Parameters() {}
+        Parameters(Real rho, const Vec3& v_f, const Vec3& low,
+                   const Vec3& high)
+        :   rho(rho), v_f(v_f), low(low), high(high) {}
+        Real rho;
+        Vec3 v_f;       // flow velocity in Ground
+        Vec3 low, high; // region corners in Ground
+    };
+    // Lazy, Position stage. The slot map gives each body entry's position in
+    // the packed arrays, or -1 if it is outside the region. Stations are
+    // re-expressed in Ground; p_GC is the center of buoyancy location.
+    struct PositionCache {
+        Array_<int>         slot;       // [nbodies]
+        Array_<int>         entry;      // entries inside the region
+        Array_<Rotation>    R_GB;
+        Array_<Vec3>        s_G, p_GC;
+    };
+    // Lazy, Velocity stage. Body-frame angular velocity and velocity of the
+    // center of buoyancy relative to the fluid, and the resulting drag as a
+    // spatial force at the body origin.
+    struct ForceCache {
+        Array_<Vec3>        w_B, v_B;
+        Array_<SpatialVec>  F_GB;
+    };
+public:
+    UniformFluidImpl(const SimbodyMatterSubsystem& matter,
+                     const Force::Gravity& gravity, Real density)
+    :   matter(matter), gravity(gravity), defDensity(density),
+        defFlowVelocity(0), defLow(-Infinity), defHigh(Infinity) {}
+
+    UniformFluidImpl* clone() const override {
+        return new UniformFluidImpl(*this);
+    }
+    void calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
+                   Vector_<Vec3>& particleForces,
+                   Vector& mobilityForces) const override;
+    Real calcPotentialEnergy(const State& state) const override;
+
+    // Buoyancy is the position-only part and drag the velocity-dependent part.
+    bool hasPositionOnlyPart() const override
+    {   return !gravity.isEmptyHandle(); }
+    void calcPositionOnlyPart
+       (const State& state, Vector_<SpatialVec>& bodyForces,
+        Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
+    void calcVelocityDependentPart
+       (const State& state, Vector_<SpatialVec>& bodyForces,
+        Vector_<Vec3>& particleForces, Vector& mobilityForces) const override;
+
+    // calcForce() writes only to this fluid's own cache entries.
+    bool canBeCalculatedInParallel() const override {return true;}
+    Real getCostEstimate() const override {return 2*(Real)body.size();}
+    bool findAffectedBodiesAndMobilities
+       (const State& state, Array_<MobilizedBodyIndex>& bodies,
+        Array_<UIndex>& mobilities) const override;
+
+    void realizeTopology(State& s) const override;
+
+    int addBody(MobilizedBodyIndex b, Real V, const Vec3& s_BC,
+                const Vec6& cl_, const Vec6& cq_) {
+        invalidateTopologyCache();
+        body.push_back(b); volume.push_back(V); station.push_back(s_BC);
+        cl.push_back(cl_); cq.push_back(cq_);
+        return (int)body.size() - 1;
+    }
+
+private:
+    const Parameters& getParameters(const State& s) const
+    {   return Value<Parameters>::downcast
+           (getForceSubsystem().getDiscreteVariable(s,parametersIx)); }
+    Parameters& updParameters(State& s) const
+    {   return Value<Parameters>::updDowncast
+           (getForceSubsystem().updDiscreteVariable(s,parametersIx)); }
+
+    const PositionCache& getPositionCache(const State& s) const
+    {   return Value<PositionCache>::downcast
+            (getForceSubsystem().getCacheEntry(s,positionCacheIx)); }
+    PositionCache& updPositionCache(const State& s) const
+    {   return Value<PositionCache>::updDowncast
+            (getForceSubsystem().updCacheEntry(s,positionCacheIx)); }
+    // The force cache is packed to match the position cache so it must go
+    // too.
+    void invalidatePositionCache(const State& s) const
+    {   getForceSubsystem().markCacheValueNotRealized(s,positionCacheIx);
+        invalidateForceCache(s); }
+    void invalidateForceCache(const State& s) const
+    {   getForceSubsystem().markCacheValueNotRealized(s,forceCacheIx); }
+    const ForceCache& getForceCache(const State& s) const
+    {   return Value<ForceCache>::downcast
+            (getForceSubsystem().getCacheEntry(s,forceCacheIx)); }
+    ForceCache& updForceCache(const State& s) const
+    {   return Value<ForceCache>::updDowncast
+            (getForceSubsystem().updCacheEntry(s,forceCacheIx)); }
+
+    void ensurePositionCacheValid(const State&) const;
+    void ensureForceCacheValid(const State&) const;
+
+    // TOPOLOGY STATE
+    const SimbodyMatterSubsystem&   matter;
+    Force::Gravity                  gravity;
+    Array_<MobilizedBodyIndex>      body;
+    Array_<Real>                    volume;
+    Array_<Vec3>                    station;
+    Array_<Vec6>                    cl, cq;
+    Real                            defDensity;
+    Vec3                            defFlowVelocity;
+    Vec3                            defLow, defHigh;
+
+    // TOPOLOGY CACHE
+    DiscreteVariableIndex           parametersIx;
+    CacheEntryIndex                 positionCacheIx;
+    CacheEntryIndex                 forceCacheIx;
+};
+
+//==============================================================================
+//                          FORCE :: UNIFORM FLUID
+//==============================================================================
+
+SimTK_INSERT_DERIVED_HANDLE_DEFINITIONS(Force::UniformFluid,
+                                        Force::UniformFluidImpl, Force);
+
+Force::UniformFluid::UniformFluid
+   (GeneralForceSubsystem& forces, const SimbodyMatterSubsystem& matter,
+    const Force::Gravity& gravity, Real defaultDensity)
+:   Force(new UniformFluidImpl(matter, gravity, defaultDensity))
+{
+    SimTK_ERRCHK_ALWAYS(defaultDensity >= 0,
+        "Force::UniformFluid::UniformFluid()",
+        "The fluid density must be nonnegative.");
+    updImpl().setForceSubsystem(forces, forces.adoptForce(*this));
+}
+
+int Force::UniformFluid::
+addBody(const MobilizedBody& body, Real volume, const Vec3& centerOfBuoyancy,
+        const Vec6& linearDrag, const Vec6& quadraticDrag) {
+    SimTK_ERRCHK_ALWAYS(volume >= 0,
+        "Force::UniformFluid::addBody()",
+        "The displaced volume must be nonnegative.");
+    SimTK_ERRCHK_ALWAYS(linearDrag >= 0 && quadraticDrag >= 0,
+        "Force::UniformFluid::addBody()",
+        "Drag coefficients must be nonnegative.");
+    return updImpl().addBody(body.getMobilizedBodyIndex(), volume,
+                             centerOfBuoyancy, linearDrag, quadraticDrag);
+}
+
+int Force::UniformFluid::
+getNumBodies() const {return (int)getImpl().body.size();}
+
+Force::UniformFluid& Force::UniformFluid::
+setDefaultDensity(Real density) {
+    SimTK_ERRCHK_ALWAYS(density >= 0,
+        "Force::UniformFluid::setDefaultDensity()",
+        "The fluid density must be nonnegative.");
+    getImpl().invalidateTopologyCache();
+    updImpl().defDensity = density;
+    return *this;
+}
+
+Force::UniformFluid& Force::UniformFluid::
+setDefaultFlowVelocity(const Vec3& flowVelocity) {
+    getImpl().invalidateTopologyCache();
+    updImpl().defFlowVelocity = flowVelocity;
+    return *this;
+}
+
+Force::UniformFluid& Force::UniformFluid::
+setDefaultRegion(const Vec3& low, const Vec3& high) {
+    getImpl().invalidateTopologyCache();
+    updImpl().defLow = low; updImpl().defHigh = high;
+    return *this;
+}
+
+Real Force::UniformFluid::
+getDefaultDensity() const {return getImpl().defDensity;}
+const Vec3& Force::UniformFluid::
+getDefaultFlowVelocity() const {return getImpl().defFlowVelocity;}
+void Force::UniformFluid::
+getDefaultRegion(Vec3& low, Vec3& high) const
+{   low = getImpl().defLow; high = getImpl().defHigh; }
+
+// These parameters only invalidate Dynamics stage automatically. The density
+// and region determine the buoyancy, which is cached until the configuration
+// changes, and the flow velocity and region determine the drag, which is
+// cached until the velocities change, so the setters must discard those
+// explicitly.
+
+void Force::UniformFluid::
+setDensity(State& state, Real density) const {
+    SimTK_ERRCHK_ALWAYS(density >= 0,
+        "Force::UniformFluid::setDensity()",
+        "The fluid density must be nonnegative.");
+    const UniformFluidImpl& impl = getImpl();
+    impl.invalidateCachedForces(state);
+    impl.updParameters(state).rho = density;
+}
+
+void Force::UniformFluid::
+setFlowVelocity(State& state, const Vec3& flowVelocity) const {
+    const UniformFluidImpl& impl = getImpl();
+    impl.invalidateForceCache(state);
+    impl.updParameters(state).v_f = flowVelocity;
+}
+
+void Force::UniformFluid::
+setRegion(State& state, const Vec3& low, const Vec3& high) const {
+    const UniformFluidImpl& impl = getImpl();
+    impl.invalidatePositionCache(state);
+    impl.invalidateCachedForces(state);
+    impl.updParameters(state).low  = low;
+    impl.updParameters(state).high = high;
+}
+
+Real Force::UniformFluid::
+getDensity(const State& state) const
+{   return getImpl().getParameters(state).rho; }
+const Vec3& Force::UniformFluid::
+getFlowVelocity(const State& state) const
+{   return getImpl().getParameters(state).v_f; }
+void Force::UniformFluid::
+getRegion(const State& state, Vec3& low, Vec3& high) const {
+    const UniformFluidImpl::Parameters& p = getImpl().getParameters(state);
+    low = p.low; high = p.high;
+}
+
+bool Force::UniformFluid::
+isBodyInRegion(const State& state, int entry) const {
+    SimTK_INDEXCHECK_ALWAYS(entry, getNumBodies(),
+        "Force::UniformFluid::isBodyInRegion()");
+    const UniformFluidImpl& impl = getImpl();
+    impl.ensurePositionCacheValid(state);
+    return impl.getPositionCache(state).slot[entry] >= 0;
+}
+
+int Force::UniformFluid::
+getNumBodiesInRegion(const State& state) const {
+    const UniformFluidImpl& impl = getImpl();
+    impl.ensurePositionCacheValid(state);
+    return (int)impl.getPositionCache(state).entry.size();
+}
+
+
+
+//==============================================================================
+//                        FORCE :: UNIFORM FLUID IMPL
+//==============================================================================
+
+//----------------------------- REALIZE TOPOLOGY -------------------------------
+// The position cache depends on the region in the Parameters variable as
+// well as on the configuration, so changing the region must invalidate it
+// explicitly.
+void Force::UniformFluidImpl::
+realizeTopology(State& s) const {
+    UniformFluidImpl* mThis = const_cast<UniformFluidImpl*>(this);
+    const Parameters p(defDensity, defFlowVelocity, defLow, defHigh);
+    mThis->parametersIx = getForceSubsystem().allocateDiscreteVariable
+       (s, Stage::Dynamics, new Value<Parameters>(p));
+    mThis->positionCacheIx = getForceSubsystem().allocateLazyCacheEntry
+       (s, Stage::Position, new Value<PositionCache>());
+    mThis->forceCacheIx = getForceSubsystem().allocateLazyCacheEntry
+       (s, Stage::Velocity, new Value<ForceCache>());
+}
+
+//--------------------- FIND AFFECTED BODIES AND MOBILITIES --------------------
+// Region membership changes with the configuration, so we report every
+// immersed body. Each body is reported once.
+bool Force::UniformFluidImpl::
+findAffectedBodiesAndMobilities(const State& state,
+                                Array_<MobilizedBodyIndex>& bodies,
+                                Array_<UIndex>& mobilities) const {
+    const int first = (int)bodies.size();
+    for (int i=0; i < (int)body.size(); ++i)
+        bodies.push_back(body[i]);
+    std::sort(bodies.begin()+first, bodies.end());
+    bodies.erase(std::unique(bodies.begin()+first, bodies.end()),
+                 bodies.end());
+    return true;
+}
+
+//------------------------ ENSURE POSITION CACHE VALID -------------------------
+// Partition the bodies by region, packing the geometry of those inside.
+void Force::UniformFluidImpl::
+ensurePositionCacheValid(const State& state) const {
+    if (getForceSubsystem().isCacheValueRealized(state, positionCacheIx))
+        return;
+
+    const Parameters& p = getParameters(state);
+    const int n = (int)body.size();
+    PositionCache& pc = updPositionCache(state);
+    pc.slot.resize(n);
+    pc.entry.clear(); pc.R_GB.clear(); pc.s_G.clear(); pc.p_GC.clear();
+
+    for (int i=0; i < n; ++i) {
+        const Transform& X_GB =
+            matter.getMobilizedBody(body[i]).getBodyTransform(state);
+        const Vec3 s_G  = X_GB.R() * station[i];
+        const Vec3 p_GC = X_GB.p() + s_G;
+        bool inside = true;
+        for (int k=0; k < 3; ++k)
+            inside = inside && p.low[k] <= p_GC[k] && p_GC[k] <= p.high[k];
+        if (!inside) {pc.slot[i] = -1; continue;}
+        pc.slot[i] = (int)pc.entry.size();
+        pc.entry.push_back(i); pc.R_GB.push_back(X_GB.R());
+        pc.s_G.push_back(s_G); pc.p_GC.push_back(p_GC);
+    }
+
+    getForceSubsystem().markCacheValueRealized(state, positionCacheIx);
+}
+
+//-------------------------- ENSURE FORCE CACHE VALID --------------------------
+void Force::UniformFluidImpl::
+ensureForceCacheValid(const State& state) const {
+    if (getForceSubsystem().isCacheValueRealized(state, forceCacheIx))
+        return;
+
+    ensurePositionCacheValid(state);
+    const PositionCache& pc = getPositionCache(state);
+    const Vec3& v_f = getParameters(state).v_f;
+    const int n = (int)pc.entry.size();
+    ForceCache& fc = updForceCache(state);
+    fc.w_B.resize(n); fc.v_B.resize(n); fc.F_GB.resize(n);
+
+    // Gather: body-frame angular velocity and velocity of the center of
+    // buoyancy relative to the fluid.
+    for (int j=0; j < n; ++j) {
+        const SpatialVec& V_GB =
+            matter.getMobilizedBody(body[pc.entry[j]]).getBodyVelocity(state);
+        const Vec3 v_G = V_GB[1] + V_GB[0] % pc.s_G[j] - v_f;
+        fc.w_B[j] = ~pc.R_GB[j] * V_GB[0];
+        fc.v_B[j] = ~pc.R_GB[j] * v_G;
+    }
+
+    // Drag moment and force in B, re-expressed in Ground and shifted to the
+    // body origin.
+    for (int j=0; j < n; ++j) {
+        const Vec6& l = cl[pc.entry[j]];
+        const Vec6& q = cq[pc.entry[j]];
+        const Vec3& w = fc.w_B[j];
+        const Vec3& v = fc.v_B[j];
+        Vec3 m_B, f_B;
+        for (int k=0; k < 3; ++k) {
+            m_B[k] = -(l[k]   + q[k]  *std::abs(w[k])) * w[k];
+            f_B[k] = -(l[k+3] + q[k+3]*std::abs(v[k])) * v[k];
+        }
+        const Vec3 f_G = pc.R_GB[j] * f_B;
+        fc.F_GB[j] = SpatialVec(pc.R_GB[j]*m_B + pc.s_G[j] % f_G, f_G);
+    }
+
+    getForceSubsystem().markCacheValueRealized(state, forceCacheIx);
+}
+
+//------------------------------- CALC FORCE -----------------------------------
+void Force::UniformFluidImpl::
+calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
+          Vector_<Vec3>& particleForces, Vector& mobilityForces) const
+{
+    calcPositionOnlyPart(state, bodyForces, particleForces, mobilityForces);
+    calcVelocityDependentPart(state, bodyForces, particleForces,
+                              mobilityForces);
+}
+
+// Buoyancy -rho V g acts at the center of buoyancy. Bodies excluded from the
+// Gravity element are not buoyant either.
+void Force::UniformFluidImpl::
+calcPositionOnlyPart(const State& state, Vector_<SpatialVec>& bodyForces,
+                     Vector_<Vec3>& particleForces,
+                     Vector& mobilityForces) const
+{
+    if (gravity.isEmptyHandle()) return;
+    const Vec3 rho_g =
+        getParameters(state).rho * gravity.getGravityVector(state);
+    if (rho_g == 0) return;
+
+    ensurePositionCacheValid(state);
+    const PositionCache& pc = getPositionCache(state);
+    for (int j=0; j < (int)pc.entry.size(); ++j) {
+        const int i = pc.entry[j];
+        if (gravity.getBodyIsExcluded(state, body[i]))
+            continue;
+        const Vec3 f_G = -volume[i] * rho_g;
+        bodyForces[body[i]] += SpatialVec(pc.s_G[j] % f_G, f_G);
+    }
+}
+
+void Force::UniformFluidImpl::
+calcVelocityDependentPart
+   (const State& state, Vector_<SpatialVec>& bodyForces,
+    Vector_<Vec3>& particleForces, Vector& mobilityForces) const
+{
+    ensureForceCacheValid(state);
+    const PositionCache& pc = getPositionCache(state);
+    const ForceCache& fc = getForceCache(state);
+    for (int j=0; j < (int)pc.entry.size(); ++j)
+        bodyForces[body[pc.entry[j]]] += fc.F_GB[j];
+}
+
+//-------------------------- CALC POTENTIAL ENERGY -----------------------------
+// Only buoyant bodies inside the region contribute.
+Real Force::UniformFluidImpl::
+calcPotentialEnergy(const State& state) const {
+    if (gravity.isEmptyHandle()) return 0;
+    const Vec3 rho_g =
+        getParameters(state).rho * gravity.getGravityVector(state);
+    if (rho_g == 0) return 0;
+
+    ensurePositionCacheValid(state);
+    const PositionCache& pc = getPositionCache(state);
+    Real pe = 0;
+    for (int j=0; j < (int)pc.entry.size(); ++j) {
+        const int i = pc.entry[j];
+        if (!gravity.getBodyIsExcluded(state, body[i]))
+            pe += volume[i] * dot(rho_g, pc.p_GC[j]);
+    }
+    return pe;
+}
+
+} // namespace SimTK
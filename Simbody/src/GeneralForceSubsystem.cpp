@@ -48,6 +48,63 @@ using namespace SimTK;
 const int NumNonParallelThreads = 1;
 const int NonParallelForcesIndex = 0;
 
+// The enabled parallel forces are grouped into about this many chunks per
+// thread; the executor's work stealing evens out errors in the estimates.
+const int ChunksPerThread = 4;
+
+/* Compact storage for the results of the enabled parallel forces that were
+able to report which bodies and mobilities they affect ("sparse" forces).
+Sparse force k owns the slots [bodyBegin[k],bodyBegin[k+1]) and
+[mobilityBegin[k],mobilityBegin[k+1]); a worker thread copies the force's
+contribution into those slots and the main thread then adds all the slots
+into the force arrays in force order, so the result doesn't depend on which
+thread computed which force. Forces that couldn't report what they affect
+are marked dense and accumulate into full-size per-thread arrays instead.
+While the cache of position-only forces is being filled, a force's cached
+part goes into a second set of slots with the same layout.
+
+The parallel forces are scheduled in contiguous chunks of roughly equal
+estimated cost rather than one task per force; chunk c holds forces
+[chunkBegin[c],chunkBegin[c+1]). The chunks were made for numThreads
+threads and must be remade if that changes.
+
+The layout is recalculated at Instance stage; the slot values are
+overwritten on each force evaluation. A sparse force that writes outside its
+footprint would have those entries silently dropped, so the first evaluation
+after the layout is made checks that nothing was left behind in the scratch
+arrays. Later evaluations skip the check in every build type, since it costs
+a full scan of the scratch arrays per sparse force. */
+struct ParallelForceLayout {
+    int getNumChunks() const {return std::max(0, (int)chunkBegin.size()-1);}
+
+    Array_<int>                 chunkBegin;
+    int                         numThreads = 0;
+    bool                        checkFootprints = false;
+
+    Array_<bool>                isDense;
+    Array_<int>                 bodyBegin;
+    Array_<int>                 mobilityBegin;
+    Array_<MobilizedBodyIndex>  bodies;
+    Array_<UIndex>              mobilities;
+    Array_<SpatialVec>          bodyForces;
+    Array_<Real>                mobilityForces;
+    Array_<SpatialVec>          cachedBodyForces;
+    Array_<Real>                cachedMobilityForces;
+};
+
+/* The configuration at which the cached position-only forces were calculated,
+used to decide whether they can be reused after Stage::Position has been
+invalidated. Only the Topology through Instance stage versions are recorded;
+a change in any of those invalidates the cache. The Time and Position stage
+versions change with every change of t or q, so they can't be used to notice
+a Time- or Position-stage discrete variable change; the public docs ask
+users to invalidate the cache themselves in that case. */
+struct CachedForcesKey {
+    Array_<StageVersion>    stageVersions;
+    Real                    time = NaN;
+    Vector                  q;
+};
+
 /* Base class for CalcForcesParallelTask and CalcForcesNonParallelTask - lays 
 out common methods that will be implemented to suit the parallel/non-parallel
 use cases*/
@@ -61,6 +118,7 @@ public:
             const State& s,
             const Array_<Force*>& enabledNonParallelForces,
             const Array_<Force*>& enabledParallelForces,
+            ParallelForceLayout& parallelForceLayout,
             Vector_<SpatialVec>& rigidBodyForces,
             Vector_<Vec3>& particleForces,
             Vector& mobilityForces) = 0;
@@ -68,6 +126,7 @@ public:
             const State& s,
             const Array_<Force*>& enabledNonParallelForces,
             const Array_<Force*>& enabledParallelForces,
+            ParallelForceLayout& parallelForceLayout,
             Vector_<SpatialVec>& rigidBodyForces,
             Vector_<Vec3>& particleForces,
             Vector& mobilityForces,
@@ -78,10 +137,14 @@ public:
             const State& s,
             const Array_<Force*>& enabledNonParallelForces,
             const Array_<Force*>& enabledParallelForces,
+            ParallelForceLayout& parallelForceLayout,
             Vector_<SpatialVec>& rigidBodyForces,
             Vector_<Vec3>& particleForces,
             Vector& mobilityForces) = 0;
-    
+
+    // Call this on the main thread after execution is complete to add the
+    // sparse forces' results into the force arrays.
+    virtual void addInSparseForces() = 0;
 };
 /*Calculates each enabled force's contribution in the MultibodySystem.
 CalcForcesParallelTask allows force calculations to occur in parallel with
@@ -109,6 +172,7 @@ public:
             const State& s,
             const Array_<Force*>& enabledNonParallelForces,
             const Array_<Force*>& enabledParallelForces,
+            ParallelForceLayout& parallelForceLayout,
             Vector_<SpatialVec>& rigidBodyForces,
             Vector_<Vec3>& particleForces,
             Vector& mobilityForces) override
@@ -116,6 +180,7 @@ public:
         m_state = &s;
         m_enabledNonParallelForces = &enabledNonParallelForces;
         m_enabledParallelForces = &enabledParallelForces;
+        m_parallelForceLayout = &parallelForceLayout;
         m_rigidBodyForces = &rigidBodyForces;
         m_particleForces = &particleForces;
         m_mobilityForces = &mobilityForces;
@@ -126,6 +191,7 @@ public:
             const State& s,
             const Array_<Force*>& enabledNonParallelForces,
             const Array_<Force*>& enabledParallelForces,
+            ParallelForceLayout& parallelForceLayout,
             Vector_<SpatialVec>& rigidBodyForces,
             Vector_<Vec3>& particleForces,
             Vector& mobilityForces,
@@ -136,6 +202,7 @@ public:
         m_state = s;
         m_enabledNonParallelForces = &enabledNonParallelForces;
         m_enabledParallelForces = &enabledParallelForces;
+        m_parallelForceLayout = &parallelForceLayout;
         m_rigidBodyForces = &rigidBodyForces;
         m_particleForces = &particleForces;
         m_mobilityForces = &mobilityForces;
@@ -149,6 +216,7 @@ public:
             const State& s,
             const Array_<Force*>& enabledNonParallelForces,
             const Array_<Force*>& enabledParallelForces,
+            ParallelForceLayout& parallelForceLayout,
             Vector_<SpatialVec>& rigidBodyForces,
             Vector_<Vec3>& particleForces,
             Vector& mobilityForces) override
@@ -156,6 +224,7 @@ public:
         m_state = s;
         m_enabledNonParallelForces = &enabledNonParallelForces;
         m_enabledParallelForces = &enabledParallelForces;
+        m_parallelForceLayout = &parallelForceLayout;
         m_rigidBodyForces = &rigidBodyForces;
         m_particleForces = &particleForces;
         m_mobilityForces = &mobilityForces;
@@ -163,110 +232,224 @@ public:
         m_mode = NonCached;
     }
     
-    // Set all of the local force contribution arrays to 0. This is so that
-    // each local thread can sum up it's force contribution to be later
-    // added into the total force array.
+    // Prepare this thread's local arrays. Nothing proportional to the number
+    // of bodies is done here unless it has to be: the sparse scratch arrays
+    // are kept zero between uses, and the full-size dense arrays are only
+    // cleared if this thread actually computes a dense force (see
+    // prepareDenseForces()). The particle arrays are always cleared.
     void initialize() override {
-        m_rigidBodyForcesLocalStatic.upd().resize(m_rigidBodyForces->size());
-        m_rigidBodyForcesLocalStatic.upd().setToZero();
+        m_usedDenseForcesLocalStatic.upd() = false;
+
+        Vector_<SpatialVec>& bodyScratch = m_rigidBodyScratchLocalStatic.upd();
+        Vector& mobilityScratch = m_mobilityScratchLocalStatic.upd();
+        if (!m_scratchIsZeroLocalStatic.get()
+            || bodyScratch.size() != m_rigidBodyForces->size()
+            || mobilityScratch.size() != m_mobilityForces->size()) {
+            bodyScratch.resize(m_rigidBodyForces->size());
+            bodyScratch.setToZero();
+            mobilityScratch.resize(m_mobilityForces->size());
+            mobilityScratch.setToZero();
+            m_scratchIsZeroLocalStatic.upd() = true;
+        }
+
         m_particleForcesLocalStatic.upd().resize(m_particleForces->size());
         m_particleForcesLocalStatic.upd().setToZero();
-        m_mobilityForcesLocalStatic.upd().resize(m_mobilityForces->size());
-        m_mobilityForcesLocalStatic.upd().setToZero();
-
         if (m_mode == CachedAndNonCached) {
-            m_rigidBodyForceCacheLocalStatic.upd().resize(m_rigidBodyForceCache->size());
-            m_rigidBodyForceCacheLocalStatic.upd().setToZero();
             m_particleForceCacheLocalStatic.upd().resize(m_particleForceCache->size());
             m_particleForceCacheLocalStatic.upd().setToZero();
-            m_mobilityForceCacheLocalStatic.upd().resize(m_mobilityForceCache->size());
-            m_mobilityForceCacheLocalStatic.upd().setToZero();
         }
     }
     
     // Calculate all enabled forces (taking into account mode and parallelism)
     void execute(int threadIndex) override {
-      switch (m_mode) {
-        case All:
-            if (threadIndex == NonParallelForcesIndex) {
-                // Process all non-parallel forces
-                for (Force* force : *m_enabledNonParallelForces) {
-                    force->getImpl().calcForce(*m_state, m_rigidBodyForcesLocalStatic.upd(), m_particleForcesLocalStatic.upd(), m_mobilityForcesLocalStatic.upd());
-                }
-            } else {
-                // Process a single parallel force. Subtract 1 from index b/c
-                // we use 0 for the non-parallel forces.
-                const auto& impl =
-                    m_enabledParallelForces->getElt(threadIndex-1)->getImpl();
-                impl.calcForce(*m_state, m_rigidBodyForcesLocalStatic.upd(), m_particleForcesLocalStatic.upd(), m_mobilityForcesLocalStatic.upd());
-
-            }
-            break;
-
-        case CachedAndNonCached:
-            if (threadIndex == NonParallelForcesIndex) {
-                // Process all non-parallel forces.
-                for (Force* force : *m_enabledNonParallelForces) {
-                    const auto& impl = force->getImpl();
-                    if (impl.dependsOnlyOnPositions()) {
-                        impl.calcForce(*m_state, *m_rigidBodyForceCache, *m_particleForceCache, *m_mobilityForceCache);
-                    } else { // ordinary velocity dependent force
-                        impl.calcForce(*m_state, *m_rigidBodyForces, *m_particleForces, *m_mobilityForces);
-                    }
-                }
-            } else {
-                // Process a single parallel force. Subtract 1 from threadIndex b/c
-                // we use 0 for the non-parallel forces.
-                const auto& impl =
-                    m_enabledParallelForces->getElt(threadIndex-1)->getImpl();
-                if (impl.dependsOnlyOnPositions()) {
-                    impl.calcForce(*m_state, m_rigidBodyForceCacheLocalStatic.upd(), m_particleForceCacheLocalStatic.upd(), m_mobilityForceCacheLocalStatic.upd());
-                } else { // ordinary velocity dependent force
-                    impl.calcForce(*m_state, m_rigidBodyForcesLocalStatic.upd(), m_particleForcesLocalStatic.upd(), m_mobilityForcesLocalStatic.upd());
-                }
-            }
-            break;
+        if (threadIndex == NonParallelForcesIndex) {
+            // Process all non-parallel forces.
+            for (Force* force : *m_enabledNonParallelForces)
+                calcDenseForce(force->getImpl());
+            return;
+        }
 
-        case NonCached:
-            if (threadIndex == NonParallelForcesIndex) {
-                // Process all non-parallel forces.
-                for (Force* force : *m_enabledNonParallelForces) {
-                    const auto& impl = force->getImpl();
-                    if (!impl.dependsOnlyOnPositions()) {
-                        impl.calcForce(*m_state,
-                                *m_rigidBodyForces, *m_particleForces,
-                                *m_mobilityForces);
-                    }
-                }
-            } else {
-                // Process a single parallel force. Subtract 1 from index b/c
-                // we use 0 for the non-parallel forces.
-                const auto& impl =
-                    m_enabledParallelForces->getElt(threadIndex-1)->getImpl();
-                    if (!impl.dependsOnlyOnPositions()) {
-                        impl.calcForce(*m_state,
-                                m_rigidBodyForcesLocalStatic.upd(), m_particleForcesLocalStatic.upd(),
-                                m_mobilityForcesLocalStatic.upd());
-                    }
-            }
-            break;
+        // Process a chunk of parallel forces. Subtract 1 from index b/c we
+        // use 0 for the non-parallel forces.
+        const ParallelForceLayout& layout = *m_parallelForceLayout;
+        const int chunk = threadIndex-1;
+        for (int k = layout.chunkBegin[chunk]; k < layout.chunkBegin[chunk+1];
+             ++k) {
+            const auto& impl = m_enabledParallelForces->getElt(k)->getImpl();
+            if (layout.isDense[k])
+                calcDenseForce(impl);
+            else
+                calcSparseForce(k, impl);
         }
     }
     
     //Once a thread has finished it's force calculations, we add in the thread's
     //contribution into the cached force arrays in the State
     void finish() override {
-        *m_rigidBodyForces += m_rigidBodyForcesLocalStatic.get();
         *m_particleForces += m_particleForcesLocalStatic.get();
+        if (m_mode == CachedAndNonCached)
+            *m_particleForceCache += m_particleForceCacheLocalStatic.get();
+
+        if (!m_usedDenseForcesLocalStatic.get())
+            return;
+
+        *m_rigidBodyForces += m_rigidBodyForcesLocalStatic.get();
         *m_mobilityForces += m_mobilityForcesLocalStatic.get();
 
         if (m_mode == CachedAndNonCached) {
             *m_rigidBodyForceCache += m_rigidBodyForceCacheLocalStatic.get();
-            *m_particleForceCache += m_particleForceCacheLocalStatic.get();
             *m_mobilityForceCache += m_mobilityForceCacheLocalStatic.get();
         }
     }
+
+    // Scatter the sparse forces' slots into the force arrays, in force order.
+    // The footprints have been checked once all forces got this far.
+    void addInSparseForces() override {
+        ParallelForceLayout& layout = *m_parallelForceLayout;
+        layout.checkFootprints = false;
+        for (int k = 0; k < (int)m_enabledParallelForces->size(); ++k) {
+            if (layout.isDense[k])
+                continue;
+            const auto& impl = m_enabledParallelForces->getElt(k)->getImpl();
+            if (m_mode == CachedAndNonCached && impl.hasCachedPart())
+                addInSlots(k, layout.cachedBodyForces,
+                           layout.cachedMobilityForces,
+                           *m_rigidBodyForceCache, *m_mobilityForceCache);
+            if (m_mode == All || impl.hasNonCachedPart())
+                addInSlots(k, layout.bodyForces, layout.mobilityForces,
+                           *m_rigidBodyForces, *m_mobilityForces);
+        }
+    }
 private:
+    void addInSlots(int k, const Array_<SpatialVec>& bodySlots,
+                    const Array_<Real>& mobilitySlots,
+                    Vector_<SpatialVec>& bodyForces,
+                    Vector& mobilityForces) const {
+        const ParallelForceLayout& layout = *m_parallelForceLayout;
+        for (int j = layout.bodyBegin[k]; j < layout.bodyBegin[k+1]; ++j)
+            bodyForces[layout.bodies[j]] += bodySlots[j];
+        for (int j = layout.mobilityBegin[k];
+             j < layout.mobilityBegin[k+1]; ++j)
+            mobilityForces[layout.mobilities[j]] += mobilitySlots[j];
+    }
+
+    // Clear this thread's full-size arrays the first time it needs them.
+    void prepareDenseForces() {
+        if (m_usedDenseForcesLocalStatic.get())
+            return;
+        m_rigidBodyForcesLocalStatic.upd().resize(m_rigidBodyForces->size());
+        m_rigidBodyForcesLocalStatic.upd().setToZero();
+        m_mobilityForcesLocalStatic.upd().resize(m_mobilityForces->size());
+        m_mobilityForcesLocalStatic.upd().setToZero();
+
+        if (m_mode == CachedAndNonCached) {
+            m_rigidBodyForceCacheLocalStatic.upd().resize(m_rigidBodyForceCache->size());
+            m_rigidBodyForceCacheLocalStatic.upd().setToZero();
+            m_mobilityForceCacheLocalStatic.upd().resize(m_mobilityForceCache->size());
+            m_mobilityForceCacheLocalStatic.upd().setToZero();
+        }
+        m_usedDenseForcesLocalStatic.upd() = true;
+    }
+
+    // Accumulate a force into this thread's full-size arrays. The cached part
+    // of a force goes to the cache arrays if we're filling the cache, and is
+    // skipped if the cache is already valid.
+    void calcDenseForce(const ForceImpl& impl) {
+        if (m_mode == All) {
+            prepareDenseForces();
+            impl.calcForce(*m_state, m_rigidBodyForcesLocalStatic.upd(),
+                           m_particleForcesLocalStatic.upd(),
+                           m_mobilityForcesLocalStatic.upd());
+            return;
+        }
+        if (m_mode == NonCached && !impl.hasNonCachedPart())
+            return;
+        prepareDenseForces();
+        if (m_mode == CachedAndNonCached && impl.hasCachedPart())
+            impl.calcCachedPart(*m_state,
+                                m_rigidBodyForceCacheLocalStatic.upd(),
+                                m_particleForceCacheLocalStatic.upd(),
+                                m_mobilityForceCacheLocalStatic.upd());
+        impl.calcNonCachedPart(*m_state, m_rigidBodyForcesLocalStatic.upd(),
+                               m_particleForcesLocalStatic.upd(),
+                               m_mobilityForcesLocalStatic.upd());
+    }
+
+    // Calculate sparse force k into the zeroed scratch arrays, then move just
+    // the entries it affects into its slots, leaving the scratch zero again.
+    // When filling the cache, the force's cached part is calculated and moved
+    // into the cached slots first.
+    void calcSparseForce(int k, const ForceImpl& impl) {
+        ParallelForceLayout& layout = *m_parallelForceLayout;
+        Vector_<SpatialVec>& bodyScratch = m_rigidBodyScratchLocalStatic.upd();
+        Vector& mobilityScratch = m_mobilityScratchLocalStatic.upd();
+
+        // If calcForce() throws, the scratch gets cleared next time.
+        m_scratchIsZeroLocalStatic.upd() = false;
+        if (m_mode == All) {
+            impl.calcForce(*m_state, bodyScratch,
+                           m_particleForcesLocalStatic.upd(), mobilityScratch);
+            moveScratchToSlots(k, layout.bodyForces, layout.mobilityForces);
+        } else {
+            if (m_mode == CachedAndNonCached && impl.hasCachedPart()) {
+                impl.calcCachedPart(*m_state, bodyScratch,
+                                    m_particleForceCacheLocalStatic.upd(),
+                                    mobilityScratch);
+                moveScratchToSlots(k, layout.cachedBodyForces,
+                                   layout.cachedMobilityForces);
+            }
+            if (impl.hasNonCachedPart()) {
+                impl.calcNonCachedPart(*m_state, bodyScratch,
+                                       m_particleForcesLocalStatic.upd(),
+                                       mobilityScratch);
+                moveScratchToSlots(k, layout.bodyForces,
+                                   layout.mobilityForces);
+            }
+        }
+        m_scratchIsZeroLocalStatic.upd() = true;
+    }
+
+    void moveScratchToSlots(int k, Array_<SpatialVec>& bodySlots,
+                            Array_<Real>& mobilitySlots) {
+        const ParallelForceLayout& layout = *m_parallelForceLayout;
+        Vector_<SpatialVec>& bodyScratch = m_rigidBodyScratchLocalStatic.upd();
+        Vector& mobilityScratch = m_mobilityScratchLocalStatic.upd();
+        for (int j = layout.bodyBegin[k]; j < layout.bodyBegin[k+1]; ++j) {
+            SpatialVec& F = bodyScratch[layout.bodies[j]];
+            bodySlots[j] = F;
+            F = SpatialVec(Vec3(0), Vec3(0));
+        }
+        for (int j = layout.mobilityBegin[k]; j < layout.mobilityBegin[k+1]; ++j) {
+            Real& f = mobilityScratch[layout.mobilities[j]];
+            mobilitySlots[j] = f;
+            f = 0;
+        }
+        if (layout.checkFootprints)
+            checkScratchIsZero(k);
+    }
+
+    // After force k's entries have been moved out, anything still in the
+    // scratch arrays was applied outside the footprint the force reported.
+    void checkScratchIsZero(int k) const {
+        const Vector_<SpatialVec>& bodyScratch =
+                                            m_rigidBodyScratchLocalStatic.get();
+        const Vector& mobilityScratch = m_mobilityScratchLocalStatic.get();
+        const int fx =
+            (int)m_enabledParallelForces->getElt(k)->getImpl().getForceIndex();
+        for (int b = 0; b < bodyScratch.size(); ++b)
+            SimTK_ERRCHK2_ALWAYS(bodyScratch[b] == SpatialVec(Vec3(0), Vec3(0)),
+                "GeneralForceSubsystem::realizeDynamics()",
+                "Force %d applied a force to body %d, which is not one of the "
+                "bodies it reported in findAffectedBodiesAndMobilities().",
+                fx, b);
+        for (int u = 0; u < mobilityScratch.size(); ++u)
+            SimTK_ERRCHK2_ALWAYS(mobilityScratch[u] == 0,
+                "GeneralForceSubsystem::realizeDynamics()",
+                "Force %d applied a force to mobility %d, which is not one of "
+                "the mobilities it reported in "
+                "findAffectedBodiesAndMobilities().", fx, u);
+    }
+
     Mode m_mode;
 
     ReferencePtr<const State> m_state;
@@ -276,6 +459,10 @@ private:
     ReferencePtr<const Array_<Force*>> m_enabledNonParallelForces;
     ReferencePtr<const Array_<Force*>> m_enabledParallelForces;
 
+    // State cache entry in which the sparse parallel forces leave their
+    // results; each force writes only its own layout.
+    ReferencePtr<ParallelForceLayout> m_parallelForceLayout;
+
     // ReferencePtrs that point to caches in the state; We eventually add our
     // thread-local result to these vectors.
     ReferencePtr<Vector_<SpatialVec>> m_rigidBodyForces;
@@ -296,6 +483,15 @@ private:
     static ThreadLocal<Vector_<SpatialVec>> m_rigidBodyForceCacheLocalStatic;
     static ThreadLocal<Vector_<Vec3>> m_particleForceCacheLocalStatic;
     static ThreadLocal<Vector> m_mobilityForceCacheLocalStatic;
+
+    // Whether this thread has computed a dense force during this execution.
+    static ThreadLocal<bool> m_usedDenseForcesLocalStatic;
+
+    // Full-size scratch arrays for the sparse forces. These are all zero
+    // whenever m_scratchIsZeroLocalStatic is true.
+    static ThreadLocal<Vector_<SpatialVec>> m_rigidBodyScratchLocalStatic;
+    static ThreadLocal<Vector> m_mobilityScratchLocalStatic;
+    static ThreadLocal<bool> m_scratchIsZeroLocalStatic;
 };
 
 //local declarations of static member variables
@@ -319,6 +515,20 @@ private:
                         CalcForcesParallelTask::m_mobilityForceCacheLocalStatic
                                                         = ThreadLocal<Vector>();
 
+/*static*/ ThreadLocal<bool>
+                        CalcForcesParallelTask::m_usedDenseForcesLocalStatic
+                                                   = ThreadLocal<bool>(false);
+
+/*static*/ ThreadLocal<Vector_<SpatialVec>>
+                        CalcForcesParallelTask::m_rigidBodyScratchLocalStatic
+                                           = ThreadLocal<Vector_<SpatialVec>>();
+/*static*/ ThreadLocal<Vector>
+                        CalcForcesParallelTask::m_mobilityScratchLocalStatic
+                                                        = ThreadLocal<Vector>();
+/*static*/ ThreadLocal<bool>
+                        CalcForcesParallelTask::m_scratchIsZeroLocalStatic
+                                                   = ThreadLocal<bool>(false);
+
 /* Calculates each enabled force's contribution in the MultibodySystem. These
 calculations occur on the main thread, without use of local thread variables.*/
 
@@ -344,6 +554,7 @@ public:
             const State& s,
             const Array_<Force*>& enabledNonParallelForces,
             const Array_<Force*>& enabledParallelForces,
+            ParallelForceLayout& parallelForceLayout,
             Vector_<SpatialVec>& rigidBodyForces,
             Vector_<Vec3>& particleForces,
             Vector& mobilityForces) override
@@ -361,6 +572,7 @@ public:
             const State& s,
             const Array_<Force*>& enabledNonParallelForces,
             const Array_<Force*>& enabledParallelForces,
+            ParallelForceLayout& parallelForceLayout,
             Vector_<SpatialVec>& rigidBodyForces,
             Vector_<Vec3>& particleForces,
             Vector& mobilityForces,
@@ -384,6 +596,7 @@ public:
             const State& s,
             const Array_<Force*>& enabledNonParallelForces,
             const Array_<Force*>& enabledParallelForces,
+            ParallelForceLayout& parallelForceLayout,
             Vector_<SpatialVec>& rigidBodyForces,
             Vector_<Vec3>& particleForces,
             Vector& mobilityForces) override
@@ -437,13 +650,10 @@ public:
                 // Process all non-parallel forces.
                 for (Force* force : *m_enabledNonParallelForces) {
                     const auto& impl = force->getImpl();
-                    if (impl.dependsOnlyOnPositions()) {
-                        impl.calcForce(*m_state, *m_rigidBodyForceCache,
+                    impl.calcCachedPart(*m_state, *m_rigidBodyForceCache,
                                   *m_particleForceCache, *m_mobilityForceCache);
-                    } else { // ordinary velocity dependent force
-                        impl.calcForce(*m_state, *m_rigidBodyForces,
+                    impl.calcNonCachedPart(*m_state, *m_rigidBodyForces,
                                           *m_particleForces, *m_mobilityForces);
-                    }
                 }
             }
             break;
@@ -452,12 +662,9 @@ public:
             if (threadIndex == NonParallelForcesIndex) {
                 // Process all non-parallel forces.
                 for (Force* force : *m_enabledNonParallelForces) {
-                    const auto& impl = force->getImpl();
-                    if (!impl.dependsOnlyOnPositions()) {
-                        impl.calcForce(*m_state,
+                    force->getImpl().calcNonCachedPart(*m_state,
                                 *m_rigidBodyForces, *m_particleForces,
                                 *m_mobilityForces);
-                    }
                 }
             }
             break;
@@ -477,6 +684,9 @@ public:
             *m_mobilityForceCache += m_mobilityForceCacheLocal;
         }
     }
+
+    // There are no parallel forces so nothing can be sparse.
+    void addInSparseForces() override {}
 private:
     Mode m_mode;
 
@@ -512,15 +722,18 @@ private:
 
 namespace SimTK{
 // There is some tricky caching being done here for forces that have overridden
-// dependsOnlyOnPositions() (and returned "true"). This is probably only worth
-// doing for very expensive position-only forces like atomic force fields. We
-// try not to incur any overhead if there are no such forces in the System.
-// Note in particular that Force::Gravity does its own caching so doesn't make
-// use of this service.
+// dependsOnlyOnPositions() (and returned "true"), and for the position-only
+// parts of forces that have overridden hasPositionOnlyPart(). The cached
+// forces are normally discarded when Stage::Position is invalidated; if
+// requested they are kept instead while the time, q, and Instance stage are
+// unchanged. We try not to incur any overhead if there are no such forces in
+// the System.
 class GeneralForceSubsystemRep : public ForceSubsystem::Guts {
 public:
     GeneralForceSubsystemRep()
-     : ForceSubsystemRep("GeneralForceSubsystem", "0.0.1")
+     : ForceSubsystemRep("GeneralForceSubsystem", "0.0.1"),
+       useParallelBuiltInForces(false),
+       reuseCachedForcesAtSameConfiguration(false)
     {
         //The default number of threads is the physical number of processors
         //call setNumberOfThreads() if you want to override the thread count
@@ -574,10 +787,7 @@ public:
 
             // If we're caching position-dependent forces, make sure they are
             // marked invalid here.
-            if (cachedForcesAreValidCacheIndex.isValid()) {
-                Value<bool>::updDowncast
-                   (updCacheEntry(s, cachedForcesAreValidCacheIndex)) = false;
-            }
+            invalidateCachedForces(s);
         }
     }
 
@@ -591,6 +801,38 @@ public:
       return calcForcesExecutor->getMaxThreads();
     }
 
+    void setUseParallelBuiltInForces(bool useParallel) {
+        invalidateSubsystemTopologyCache();
+        useParallelBuiltInForces = useParallel;
+    }
+
+    bool getUseParallelBuiltInForces() const {
+        return useParallelBuiltInForces;
+    }
+
+    void setReuseCachedForcesAtSameConfiguration(bool reuse) {
+        invalidateSubsystemTopologyCache();
+        reuseCachedForcesAtSameConfiguration = reuse;
+    }
+
+    bool getReuseCachedForcesAtSameConfiguration() const {
+        return reuseCachedForcesAtSameConfiguration;
+    }
+
+    void invalidateCachedForces(const State& s) const {
+        if (cachedForcesAreValidCacheIndex.isValid()) {
+            Value<bool>::updDowncast
+               (updCacheEntry(s, cachedForcesAreValidCacheIndex)) = false;
+        }
+    }
+
+    // Should this force be calculated in the parallel path?
+    bool isParallelForce(const Force& force) const {
+        const ForceImpl& impl = force.getImpl();
+        return impl.shouldBeParallelIfPossible()
+            || (useParallelBuiltInForces && impl.canBeCalculatedInParallel());
+    }
+
     // These override default implementations of virtual methods in the
     // Subsystem::Guts class.
 
@@ -601,21 +843,24 @@ public:
         forceEnabledIndex.invalidate();
         enabledParallelForcesIndex.invalidate();
         enabledNonParallelForcesIndex.invalidate();
+        parallelForceLayoutIndex.invalidate();
         cachedForcesAreValidCacheIndex.invalidate();
+        cachedForcesKeyCacheIndex.invalidate();
         rigidBodyForceCacheIndex.invalidate();
         mobilityForceCacheIndex.invalidate();
         particleForceCacheIndex.invalidate();
 
         // Some forces are disabled by default; initialize the enabled flags
         // accordingly. Also, see if we're going to need to do any caching
-        // on behalf of any forces that don't depend on velocities.
+        // on behalf of any forces that don't depend on velocities, or that
+        // have a part that doesn't.
         Array_<bool> forceEnabled(getNumForces());
         bool someForceElementNeedsCaching = false;
         for (int i = 0; i < (int)forces.size(); ++i) {
             forceEnabled[i] = !(forces[i]->isDisabledByDefault());
             if (!someForceElementNeedsCaching)
                 someForceElementNeedsCaching =
-                    forces[i]->getImpl().dependsOnlyOnPositions();
+                    forces[i]->getImpl().hasCachedPart();
         }
 
         forceEnabledIndex = allocateDiscreteVariable(s, Stage::Instance,
@@ -633,7 +878,7 @@ public:
         for (int i = 0; i < (int) forces.size(); ++i) {
             if(forceEnabled[i])
             {
-                if (forces[i]->getImpl().shouldBeParallelIfPossible())
+                if (isParallelForce(*forces[i]))
                     enabledParallelForces.push_back(forces[i]);
                 else
                     enabledNonParallelForces.push_back(forces[i]);
@@ -644,6 +889,8 @@ public:
                           new Value<Array_<Force*> >(enabledNonParallelForces));
         enabledParallelForcesIndex = allocateCacheEntry(s, Stage::Instance,
                              new Value<Array_<Force*> >(enabledParallelForces));
+        parallelForceLayoutIndex = allocateCacheEntry(s, Stage::Instance,
+                                        new Value<ParallelForceLayout>());
 
         //Determine whether the subsystem has parallel forces - if so, use the
         //parallel implementation of CalcForcesTask (even if those parallel
@@ -660,7 +907,7 @@ public:
         bool hasParallelForces = false;
         for(int x = 0; x < (int)forces.size(); ++x)
         {
-            if (forces[x]->getImpl().shouldBeParallelIfPossible())
+            if (isParallelForce(*forces[x]))
             {
                 hasParallelForces = true;
                 break;
@@ -677,6 +924,8 @@ public:
         if (someForceElementNeedsCaching) {
             cachedForcesAreValidCacheIndex =
                 allocateCacheEntry(s, Stage::Position, new Value<bool>());
+            cachedForcesKeyCacheIndex = allocateCacheEntry(s, Stage::Position,
+                new Value<CachedForcesKey>());
             rigidBodyForceCacheIndex = allocateCacheEntry(s, Stage::Dynamics,
                 new Value<Vector_<SpatialVec> >());
             mobilityForceCacheIndex = allocateCacheEntry(s, Stage::Dynamics,
@@ -725,15 +974,109 @@ public:
         for (int i = 0; i < (int) forces.size(); ++i) {
             if(forceEnabled[i])
             {
-                if (forces[i]->getImpl().shouldBeParallelIfPossible())
+                if (isParallelForce(*forces[i]))
                     enabledParallelForces.push_back(forces[i]);
                 else
                     enabledNonParallelForces.push_back(forces[i]);
             }
         }
+
+        layOutParallelForces(s, enabledParallelForces);
         return 0;
     }
 
+    // Ask each enabled parallel force which bodies and mobilities it affects
+    // and give it a compact slot for each one. A force that can't say is
+    // marked dense and gets no layout.
+    void layOutParallelForces
+       (const State& s, const Array_<Force*>& enabledParallelForces) const
+    {
+        const SimbodyMatterSubsystem& matter =
+            getMultibodySystem().getMatterSubsystem();
+        const int nb = matter.getNumBodies();
+        const int nu = matter.getNumMobilities();
+        ParallelForceLayout& layout = Value<ParallelForceLayout>::
+                            updDowncast(updCacheEntry(s, parallelForceLayoutIndex));
+
+        const int np = (int)enabledParallelForces.size();
+        layout.isDense.resize(np);
+        layout.bodyBegin.resize(np+1);
+        layout.mobilityBegin.resize(np+1);
+        layout.bodies.clear();
+        layout.mobilities.clear();
+
+        Array_<MobilizedBodyIndex> bodies;
+        Array_<UIndex> mobilities;
+        for (int k = 0; k < np; ++k) {
+            layout.bodyBegin[k] = (int)layout.bodies.size();
+            layout.mobilityBegin[k] = (int)layout.mobilities.size();
+            bodies.clear(); mobilities.clear();
+            const ForceImpl& impl = enabledParallelForces[k]->getImpl();
+            layout.isDense[k] =
+                !impl.findAffectedBodiesAndMobilities(s, bodies, mobilities);
+            if (layout.isDense[k])
+                continue;
+            for (MobilizedBodyIndex mbx : bodies) {
+                SimTK_ERRCHK3_ALWAYS(0 <= mbx && mbx < nb,
+                    "GeneralForceSubsystem::realizeInstance()",
+                    "Force %d reported that it affects body %d but there are "
+                    "only %d bodies.", (int)impl.getForceIndex(), (int)mbx, nb);
+                layout.bodies.push_back(mbx);
+            }
+            for (UIndex ux : mobilities) {
+                SimTK_ERRCHK3_ALWAYS(0 <= ux && ux < nu,
+                    "GeneralForceSubsystem::realizeInstance()",
+                    "Force %d reported that it affects mobility %d but there "
+                    "are only %d mobilities.", (int)impl.getForceIndex(),
+                    (int)ux, nu);
+                layout.mobilities.push_back(ux);
+            }
+        }
+        layout.bodyBegin[np] = (int)layout.bodies.size();
+        layout.mobilityBegin[np] = (int)layout.mobilities.size();
+        layout.bodyForces.resize(layout.bodies.size());
+        layout.mobilityForces.resize(layout.mobilities.size());
+        layout.cachedBodyForces.resize(layout.bodies.size());
+        layout.cachedMobilityForces.resize(layout.mobilities.size());
+        layout.checkFootprints = true;
+
+        chunkParallelForces(enabledParallelForces, layout);
+    }
+
+    // Split the enabled parallel forces into contiguous chunks of roughly
+    // equal estimated cost, a few per thread. A force whose cost exceeds a
+    // chunk's share gets a chunk to itself.
+    void chunkParallelForces(const Array_<Force*>& enabledParallelForces,
+                             ParallelForceLayout& layout) const
+    {
+        const int np = (int)enabledParallelForces.size();
+        const int numThreads = getNumberOfThreads();
+        const int maxChunks = std::min(np, ChunksPerThread*numThreads);
+
+        Real totalCost = 0;
+        for (const Force* force : enabledParallelForces)
+            totalCost += std::max(force->getImpl().getCostEstimate(), Real(0));
+
+        layout.chunkBegin.clear();
+        layout.chunkBegin.push_back(0);
+        Real cost = 0;
+        int nextChunk = 1; // chunk boundaries fall at nextChunk*total/max
+        for (int k = 0; k < np-1; ++k) {
+            cost += std::max(enabledParallelForces[k]->getImpl()
+                                        .getCostEstimate(), Real(0));
+            if (nextChunk < maxChunks
+                && cost >= nextChunk*totalCost/maxChunks) {
+                layout.chunkBegin.push_back(k+1);
+                while (nextChunk < maxChunks
+                       && cost >= nextChunk*totalCost/maxChunks)
+                    ++nextChunk;
+            }
+        }
+        if (np > 0)
+            layout.chunkBegin.push_back(np);
+        layout.numThreads = numThreads;
+    }
+
     int realizeSubsystemTimeImpl(const State& s) const override {
         const Array_<bool>& enabled = Value<Array_<bool> >::downcast
             (getDiscreteVariable(s, forceEnabledIndex));
@@ -746,16 +1089,45 @@ public:
         const Array_<bool>& enabled = Value<Array_<bool> >::downcast
             (getDiscreteVariable(s, forceEnabledIndex));
         // If we're caching position-dependent forces, make sure they are
-        // marked invalid here.
-        if (cachedForcesAreValidCacheIndex.isValid()) {
-            Value<bool>::updDowncast
-               (updCacheEntry(s, cachedForcesAreValidCacheIndex)) = false;
-        }
+        // marked invalid here unless we were asked to keep them while the
+        // configuration is unchanged.
+        if (cachedForcesAreValidCacheIndex.isValid()
+            && !(reuseCachedForcesAtSameConfiguration
+                 && isSameConfigurationAsCachedForces(s)))
+            invalidateCachedForces(s);
         for (int i = 0; i < (int) forces.size(); ++i)
             if (enabled[i]) forces[i]->getImpl().realizePosition(s);
         return 0;
     }
 
+    // Is the configuration in s the one at which the cached forces were
+    // calculated? This is only meaningful if the cached forces are valid. It
+    // is called while realizing Position stage, before the key's stage.
+    bool isSameConfigurationAsCachedForces(const State& s) const {
+        const CachedForcesKey& key = Value<CachedForcesKey>::updDowncast
+            (updCacheEntry(s, cachedForcesKeyCacheIndex));
+        if (key.stageVersions.empty() || s.getTime() != key.time
+            || s.getLowestSystemStageDifference(key.stageVersions)
+                    <= Stage::Instance)
+            return false;
+        const Vector& q = s.getQ();
+        if (q.size() != key.q.size())
+            return false;
+        for (int i = 0; i < q.size(); ++i)
+            if (q[i] != key.q[i])
+                return false;
+        return true;
+    }
+
+    void recordConfigurationOfCachedForces(const State& s) const {
+        CachedForcesKey& key = Value<CachedForcesKey>::updDowncast
+            (updCacheEntry(s, cachedForcesKeyCacheIndex));
+        s.getSystemStageVersions(key.stageVersions);
+        key.stageVersions.resize(Stage::Instance+1);
+        key.time = s.getTime();
+        key.q = s.getQ();
+    }
+
     int realizeSubsystemVelocityImpl(const State& s) const override {
         const Array_<bool>& enabled = Value<Array_<bool> >::downcast
             (getDiscreteVariable(s, forceEnabledIndex));
@@ -776,6 +1148,14 @@ public:
                       downcast(getCacheEntry(s, enabledNonParallelForcesIndex));
         const Array_<Force*>& enabledParallelForces = Value<Array_<Force*>>::
                          downcast(getCacheEntry(s, enabledParallelForcesIndex));
+        ParallelForceLayout& parallelForceLayout = Value<ParallelForceLayout>::
+                            updDowncast(updCacheEntry(s, parallelForceLayoutIndex));
+
+        // The thread count may have changed since Instance stage.
+        if (parallelForceLayout.numThreads != getNumberOfThreads())
+            chunkParallelForces(enabledParallelForces, parallelForceLayout);
+        const int numTasks =
+            parallelForceLayout.getNumChunks() + NumNonParallelThreads;
 
         // Get access to System-global force cache arrays.
         Vector_<SpatialVec>&   rigidBodyForces =
@@ -792,9 +1172,10 @@ public:
             // Call calcForce() on all Forces, in parallel.
             calcForcesTask->initializeAll(s,
                     enabledNonParallelForces, enabledParallelForces,
+                    parallelForceLayout,
                     rigidBodyForces, particleForces, mobilityForces);
-            calcForcesExecutor->execute(calcForcesTask.updRef(),
-                          enabledParallelForces.size() + NumNonParallelThreads);
+            calcForcesExecutor->execute(calcForcesTask.updRef(), numTasks);
+            calcForcesTask->addInSparseForces();
 
             // Allow forces to do their own realization, but wait until all
             // forces have executed calcForce(). TODO: not sure if that is
@@ -834,20 +1215,25 @@ public:
             // force arrays or indirectly into the cache as appropriate.
             calcForcesTask->initializeCachedAndNonCached(s,
                                 enabledNonParallelForces, enabledParallelForces,
+                                parallelForceLayout,
                                 rigidBodyForces, particleForces, mobilityForces,
                                 rigidBodyForceCache, particleForceCache,
                                 mobilityForceCache);
-            calcForcesExecutor->execute(calcForcesTask.updRef(),
-                          enabledParallelForces.size() + NumNonParallelThreads);
+            calcForcesExecutor->execute(calcForcesTask.updRef(), numTasks);
+            calcForcesTask->addInSparseForces();
             cachedForcesAreValid = true;
+            if (reuseCachedForcesAtSameConfiguration)
+                recordConfigurationOfCachedForces(s);
         } else {
             // Cache already valid; just need to do the non-cached ones (the
-            // ones for which dependsOnlyOnPositions is false).
+            // ones for which dependsOnlyOnPositions is false, and only the
+            // velocity-dependent parts of those that were split).
             calcForcesTask->initializeNonCached(s,
                                enabledNonParallelForces, enabledParallelForces,
+                               parallelForceLayout,
                                rigidBodyForces, particleForces, mobilityForces);
-            calcForcesExecutor->execute(calcForcesTask.updRef(),
-                          enabledParallelForces.size() + NumNonParallelThreads);
+            calcForcesExecutor->execute(calcForcesTask.updRef(), numTasks);
+            calcForcesTask->addInSparseForces();
         }
 
         // Accumulate the values from the cache into the global arrays.
@@ -875,6 +1261,21 @@ public:
         return energy;
     }
 
+    bool calcForceDerivative(const State& state, const Vector& dq,
+                             const Vector& du,
+                             const Vector_<SpatialVec>& dX_GB,
+                             const Vector_<SpatialVec>& dV_GB,
+                             Vector_<SpatialVec>& dBodyForces,
+                             Vector& dMobilityForces) const override {
+        const Array_<bool>& forceEnabled = Value<Array_<bool> >::downcast
+           (getDiscreteVariable(state, forceEnabledIndex)).get();
+        for (int i = 0; i < (int) forces.size(); ++i)
+            if (forceEnabled[i] && !forces[i]->getImpl().calcForceDerivative
+                    (state, dq, du, dX_GB, dV_GB, dBodyForces, dMobilityForces))
+                return false;
+        return true;
+    }
+
     int realizeSubsystemAccelerationImpl(const State& s) const override {
         const Array_<bool>& enabled = Value<Array_<bool> >::downcast
             (getDiscreteVariable(s, forceEnabledIndex));
@@ -909,6 +1310,15 @@ private:
     // For parallel calculation of forces.
     mutable ClonePtr<ParallelExecutor>               calcForcesExecutor;
     mutable ClonePtr<CalcForcesTask>                 calcForcesTask;
+
+    // If set, built-in force elements that are safe to calculate concurrently
+    // are calculated in the parallel path along with the Custom forces that
+    // asked for it.
+    bool                                             useParallelBuiltInForces;
+
+    // If set, the cached position-only forces are kept across realizations
+    // of Stage::Position that leave t, q and Instance stage unchanged.
+    bool                                    reuseCachedForcesAtSameConfiguration;
     
     // TOPOLOGY "CACHE"
     // These indices must be filled in during realizeTopology and treated
@@ -922,9 +1332,15 @@ private:
     mutable CacheEntryIndex   enabledParallelForcesIndex;
     mutable CacheEntryIndex   enabledNonParallelForcesIndex;
 
+    // Instance-stage layout of the compact result slots for the enabled
+    // parallel forces that report which bodies and mobilities they affect,
+    // and of the chunks in which the parallel forces are scheduled.
+    mutable CacheEntryIndex   parallelForceLayoutIndex;
+
     // This set of cache entries is allocated only if some force element
-    // overrode dependsOnlyOnPositions().
+    // overrode dependsOnlyOnPositions() or hasPositionOnlyPart().
     mutable CacheEntryIndex         cachedForcesAreValidCacheIndex;
+    mutable CacheEntryIndex         cachedForcesKeyCacheIndex;
     mutable CacheEntryIndex         rigidBodyForceCacheIndex;
     mutable CacheEntryIndex         mobilityForceCacheIndex;
     mutable CacheEntryIndex         particleForceCacheIndex;
@@ -996,6 +1412,21 @@ void GeneralForceSubsystem::setNumberOfThreads(unsigned numThreads)
 int GeneralForceSubsystem::getNumberOfThreads() const
 {   return getRep().getNumberOfThreads(); }
 
+void GeneralForceSubsystem::setUseParallelBuiltInForces(bool useParallel)
+{   updRep().setUseParallelBuiltInForces(useParallel); }
+
+bool GeneralForceSubsystem::getUseParallelBuiltInForces() const
+{   return getRep().getUseParallelBuiltInForces(); }
+
+void GeneralForceSubsystem::setReuseCachedForcesAtSameConfiguration(bool reuse)
+{   updRep().setReuseCachedForcesAtSameConfiguration(reuse); }
+
+bool GeneralForceSubsystem::getReuseCachedForcesAtSameConfiguration() const
+{   return getRep().getReuseCachedForcesAtSameConfiguration(); }
+
+void GeneralForceSubsystem::invalidateCachedForces(const State& state) const
+{   getRep().invalidateCachedForces(state); }
+
 const MultibodySystem& GeneralForceSubsystem::getMultibodySystem() const
 {   return MultibodySystem::downcast(getSystem()); }
 
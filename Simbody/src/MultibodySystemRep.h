@@ -394,6 +394,21 @@ public:
             pe += getForceSubsystem(forceSubs[i]).getRep().calcPotentialEnergy(s);
         return pe;
     }
+    // Add in the change in the forces of all the force subsystems for a change
+    // (dq,du) in the state; see ForceSubsystem::Guts::calcForceDerivative().
+    // Returns false if any subsystem couldn't do that.
+    bool calcForceDerivative(const State& s, const Vector& dq,
+                             const Vector& du,
+                             const Vector_<SpatialVec>& dX_GB,
+                             const Vector_<SpatialVec>& dV_GB,
+                             Vector_<SpatialVec>& dBodyForces,
+                             Vector& dMobilityForces) const {
+        for (int i = 0; i < (int) forceSubs.size(); ++i)
+            if (!getForceSubsystem(forceSubs[i]).getRep().calcForceDerivative
+                    (s, dq, du, dX_GB, dV_GB, dBodyForces, dMobilityForces))
+                return false;
+        return true;
+    }
 
     // These are the global subsystem cache entries at the indicated Stage.
     // This will reduce the stage of s to the previous stage.
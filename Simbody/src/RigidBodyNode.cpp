@@ -51,38 +51,47 @@ void RigidBodyNode::addChild(RigidBodyNode* child) {
 // Should be calc'd from base to tip.
 // We depend on transforms X_PB and X_GB being available.
 // Cost is 90 flops.
-void RigidBodyNode::calcJointIndependentKinematicsPos(
-    SBTreePositionCache&    pc) const
+template <class P> void 
+RigidBodyNode::calcJointIndependentKinematicsPos(
+    typename SBTreeScalar<P>::PositionCache& pc) const
 {
+    typedef SBTreeScalar<P> Scalar;
+    typedef Vec<3,P>        Vec3P;
     assert(nodeNum != 0); // Don't call this for Ground.
 
     // Re-express parent-to-child shift vector (Bo-Po) into the ground frame.
-    const Vec3 p_PB_G = getX_GP(pc).R() * getX_PB(pc).p(); // 15 flops
+    const Vec3P p_PB_G = getX_GP(pc).R() * getX_PB(pc).p(); // 15 flops
 
     // The Phi matrix conveniently performs child-to-parent (inward) shifting
     // on spatial quantities (forces); its transpose does parent-to-child
     // (outward) shifting for velocities and accelerations.
-    updPhi(pc) = PhiMatrix(p_PB_G);
+    updPhi(pc) = typename Scalar::Phi(p_PB_G);
 
     // Calculate spatial mass properties. That means we need to transform
     // the local mass moments into the Ground frame and reconstruct the
     // spatial inertia matrix Mk.
 
-    const Rotation& R_GB = getX_GB(pc).R();
-    const Vec3&     p_GB = getX_GB(pc).p();
+    const Rotation_<P>& R_GB = getX_GB(pc).R();
+    const Vec3P&        p_GB = getX_GB(pc).p();
 
     // reexpress inertia in ground (57 flops)
-    const UnitInertia G_Bo_G  = getUnitInertia_OB_B().reexpress(~R_GB);
-    const Vec3        p_BBc_G = R_GB*getCOM_B(); // 15 flops
+    const UnitInertia_<P> G_Bo_G  = 
+        Scalar::cast(getUnitInertia_OB_B()).reexpress(~R_GB);
+    const Vec3P           p_BBc_G = R_GB*Scalar::cast(getCOM_B()); // 15 flops
 
     updCOM_G(pc) = p_GB + p_BBc_G; // 3 flops
 
     // Calc Mk: the spatial inertia matrix about the body origin.
     // Note: we need to calculate this now so that we'll be able to calculate
     // kinetic energy without going past the Velocity stage.
-    updMk_G(pc) = SpatialInertia(getMass(), p_BBc_G, G_Bo_G);
+    updMk_G(pc) = SpatialInertia_<P>(P(getMass()), p_BBc_G, G_Bo_G);
 }
 
+template void RigidBodyNode::calcJointIndependentKinematicsPos<Real>
+   (SBTreePositionCache&) const;
+template void RigidBodyNode::calcJointIndependentKinematicsPos<Dual>
+   (SBTreeKinematics_<Dual>&) const;
+
 
 
 //==============================================================================
@@ -94,23 +103,25 @@ void RigidBodyNode::calcJointIndependentKinematicsPos(
 // the just-calculated cross-joint spatial velocity V_PB_G and
 // velocity-dependent acceleration remainder term VD_PB_G.
 // Cost is about 100 flops.
-void 
+template <class P> void 
 RigidBodyNode::calcJointIndependentKinematicsVel(
-    const SBTreePositionCache& pc,
-    SBTreeVelocityCache&       vc) const
+    const typename SBTreeScalar<P>::PositionCache& pc,
+    typename SBTreeScalar<P>::VelocityCache&       vc) const
 {
+    typedef Vec<3,P>        Vec3P;
+    typedef Vec<2,Vec3P>    SpatialVecP;
     assert(nodeNum != 0); // Don't call this for Ground.
 
-    const SpatialVec& V_GP   = parent->getV_GB(vc); // parent P's velocity in G
-    const SpatialVec& V_PB_G = getV_PB_G(vc); // child B's vel in P, exp. in G
-    const PhiMatrixTranspose PhiT = ~getPhi(pc); // shift outwards
+    const SpatialVecP& V_GP   = parent->getV_GB(vc); // parent P's velocity in G
+    const SpatialVecP& V_PB_G = getV_PB_G(vc); // child B's vel in P, exp. in G
+    const typename SBTreeScalar<P>::Phi& phi = getPhi(pc); // ~phi shifts outwards
 
     // calc spatial velocity of B's origin Bo in G (angular,linear)
-    const SpatialVec V_GB = PhiT*V_GP + V_PB_G; // 18 flops
+    const SpatialVecP V_GB = ~phi*V_GP + V_PB_G; // 18 flops
     updV_GB(vc) = V_GB;
 
-    const Vec3& w_GB = V_GB[0]; // for convenience
-    const Vec3& v_GB = V_GB[1];
+    const Vec3P& w_GB = V_GB[0]; // for convenience
+    const Vec3P& v_GB = V_GB[1];
 
     // Calculate gyroscopic moment and force b (48 flops). Although this is 
     // really a dynamic quantity (requires spatial inertia and is itself
@@ -118,14 +129,14 @@ RigidBodyNode::calcJointIndependentKinematicsVel(
     // it is needed in inverse dynamics but does not require articulated body 
     // inertias to be calculated. This could be deferred until needed but
     // probably isn't worth the trouble.
-    const SpatialVec b  = getMass() *                       // 6 flops
-        SpatialVec(w_GB % (getUnitInertia_OB_G(pc)*w_GB),   // moment (24 flops)
-                   w_GB % (w_GB % getCB_G(pc)));            // force  (18 flops)   
+    const SpatialVecP b = P(getMass()) *                    // 6 flops
+        SpatialVecP(w_GB % (getUnitInertia_OB_G(pc)*w_GB),  // moment (24 flops)
+                    w_GB % (w_GB % getCB_G(pc)));           // force  (18 flops)   
     updGyroscopicForce(vc) = b;
 
     // Parent velocity.
-    const Vec3& w_GP = V_GP[0]; // for convenience
-    const Vec3& v_GP = V_GP[1];
+    const Vec3P& w_GP = V_GP[0]; // for convenience
+    const Vec3P& v_GP = V_GP[1];
 
     // Calculate this mobilizer's incremental contribution to coriolis 
     // acceleration a, and this body's total coriolis acceleration A (it 
@@ -156,16 +167,16 @@ RigidBodyNode::calcJointIndependentKinematicsVel(
     //
     // Note: despite all the ground-relative velocities here, this is just
     // the contribution of the cross-joint velocity, but reexpressed in G.
-    const SpatialVec& VD_PB_G = getVD_PB_G(vc);
-    const SpatialVec  A(VD_PB_G[0], 
-                        VD_PB_G[1] + w_GP % (v_GB-v_GP)); // 15 flops
+    const SpatialVecP& VD_PB_G = getVD_PB_G(vc);
+    const SpatialVecP  A(VD_PB_G[0], 
+                         VD_PB_G[1] + w_GP % (v_GB-v_GP)); // 15 flops
     updMobilizerCoriolisAcceleration(vc) = A;
 
     // Next, the total coriolis acceleration a (normally just called "coriolis
     // acceleration"!) of body B is the total coriolis acceleration of its 
     // parent shifted outward, plus B's local contribution A that we just 
     // calculated (18 flops).
-    const SpatialVec a = PhiT * parent->getTotalCoriolisAcceleration(vc) + A;   
+    const SpatialVecP a = ~phi * parent->getTotalCoriolisAcceleration(vc) + A;
     updTotalCoriolisAcceleration(vc) = a;
 
     // Finally, calculate the total of the rotational velocity-dependent forces 
@@ -173,6 +184,11 @@ RigidBodyNode::calcJointIndependentKinematicsVel(
     updTotalCentrifugalForces(vc) =  getMk_G(pc) * a + b;
 }
 
+template void RigidBodyNode::calcJointIndependentKinematicsVel<Real>
+   (const SBTreePositionCache&, SBTreeVelocityCache&) const;
+template void RigidBodyNode::calcJointIndependentKinematicsVel<Dual>
+   (const SBTreeKinematics_<Dual>&, SBTreeKinematics_<Dual>&) const;
+
 
 
 //==============================================================================
@@ -465,6 +465,24 @@ virtual void realizePosition(
 virtual void realizeVelocity(
     const SBStateDigest&         sbs) const=0;
 
+// Batched versions of realizePosition() and realizeVelocity(). These are
+// invoked on the first node of a run of n nodes from the same level, all of
+// which have exactly the same concrete type as this one (the caller
+// guarantees that). The default implementations just make the virtual call
+// for each node; concrete node types that are wrapped in RBNodeBatched<>
+// override these with statically-dispatched loops so that the per-body
+// virtual calls disappear and the mobilizer-specific code for the whole run
+// stays hot in the instruction cache.
+virtual void realizePositionBatch(const SBStateDigest&         sbs,
+                                  const RigidBodyNode* const*  nodes,
+                                  int                          n) const
+{   for (int i=0; i < n; ++i) nodes[i]->realizePosition(sbs); }
+
+virtual void realizeVelocityBatch(const SBStateDigest&         sbs,
+                                  const RigidBodyNode* const*  nodes,
+                                  int                          n) const
+{   for (int i=0; i < n; ++i) nodes[i]->realizeVelocity(sbs); }
+
 // Calculate base-to-tip velocity-dependent terms which will be used
 // in Dynamics stage operators. Assumes realizeVelocity()
 // has already been called on all nodes, as well as any Dynamics 
@@ -574,6 +592,30 @@ virtual void calcInverseDynamicsPass2Inward(
     Real*                       allTau) const
   { SimTK_THROW2(Exception::UnimplementedVirtualMethod, "RigidBodeNode", "calcInverseDynamicsPass2Inward"); }
 
+// The position and velocity kinematics and the two inverse dynamics passes 
+// above, run on Dual numbers with an SBTreeKinematics_<Dual> in place of the
+// caches. Seeding X_FM, H_FM and the u's there with their changes along some
+// direction yields the exact derivatives of everything downstream. These 
+// require isAcrossJointVelocityJacobianConstant(): X_FM and H_FM are taken as
+// given rather than calculated from q, and HDot_FM is zero.
+virtual void realizeKinematicsDual(
+    const Dual*                     allU,
+    SBTreeKinematics_<Dual>&        kc) const
+  { SimTK_THROW2(Exception::UnimplementedVirtualMethod, "RigidBodeNode", "realizeKinematicsDual"); }
+virtual void calcBodyAccelerationsFromUdotOutwardDual(
+    const SBTreeKinematics_<Dual>&  kc,
+    const Dual*                     allUDot,
+    Vec<2,Vec<3,Dual> >*            allA_GB) const
+  { SimTK_THROW2(Exception::UnimplementedVirtualMethod, "RigidBodeNode", "calcBodyAccelerationsFromUdotOutwardDual"); }
+virtual void calcInverseDynamicsPass2InwardDual(
+    const SBTreeKinematics_<Dual>&  kc,
+    const Vec<2,Vec<3,Dual> >*      allA_GB,
+    const Dual*                     jointForces,
+    const Vec<2,Vec<3,Dual> >*      bodyForces,
+    Vec<2,Vec<3,Dual> >*            allFTmp,
+    Dual*                           allTau) const
+  { SimTK_THROW2(Exception::UnimplementedVirtualMethod, "RigidBodeNode", "calcInverseDynamicsPass2InwardDual"); }
+
 virtual void multiplyByMPass1Outward(
     const SBTreePositionCache&  pc,
     const Real*                 allUDot,
@@ -593,6 +635,11 @@ virtual const SpatialVec& getHCol(const SBTreePositionCache&, int j) const
 virtual const SpatialVec& getH_FMCol(const SBTreePositionCache&, int j) const 
 {SimTK_THROW2(Exception::UnimplementedVirtualMethod, "RigidBodeNode", "getH_FMCol");}
 
+// Return true if this mobilizer's H_FM is constant in F (so HDot_FM==0). Then
+// H changes only because F rotates with P and the vector from Mo to Bo 
+// rotates with B, so the Dual recursions above can take H_FM as given.
+virtual bool isAcrossJointVelocityJacobianConstant() const {return false;}
+
 
     // BASE CLASS METHODS //
 
@@ -656,6 +703,10 @@ SpatialInertia& toB(Array_<SpatialInertia,MobilizedBodyIndex>& m) const {return
 ArticulatedInertia& toB(Array_<ArticulatedInertia,MobilizedBodyIndex>& m) const {return m[nodeNum];}
 Vec3&       toB(Array_<Vec3,MobilizedBodyIndex>&          v) const {return v[nodeNum];}
 
+// And for the generic-scalar entries of SBTreeKinematics_<P>.
+template <class T> const T& fromB(const Array_<T,MobilizedBodyIndex>& x) const {return x[nodeNum];}
+template <class T> T&       toB  (Array_<T,MobilizedBodyIndex>&       x) const {return x[nodeNum];}
+
 // Elementwise access to Vectors is relatively expensive; use sparingly.
 const SpatialVec& fromB(const Vector_<SpatialVec>&    v) const {return v[nodeNum];}
 const SpatialMat& fromB(const Vector_<SpatialMat>&    m) const {return m[nodeNum];}
@@ -887,6 +938,51 @@ SpatialVec&       updTotalCoriolisAcceleration(SBTreeVelocityCache&       vc) co
 const SpatialVec& getTotalCentrifugalForces(const SBTreeVelocityCache& vc) const {return fromB(vc.totalCentrifugalForces);}
 SpatialVec&       updTotalCentrifugalForces(SBTreeVelocityCache&       vc) const {return toB  (vc.totalCentrifugalForces);}
 
+    // GENERIC-SCALAR KINEMATICS
+
+// The same position and velocity entries in an SBTreeKinematics_<P>, which
+// stands in for both caches when the recursions are run on scalar type P.
+template <class P> const Transform_<P>& getX_FM(const SBTreeKinematics_<P>& kc) const {return fromB(kc.bodyJointInParentJointFrame);}
+template <class P> Transform_<P>&       updX_FM(SBTreeKinematics_<P>&       kc) const {return toB  (kc.bodyJointInParentJointFrame);}
+template <class P> const Transform_<P>& getX_PB(const SBTreeKinematics_<P>& kc) const {return fromB(kc.bodyConfigInParent);}
+template <class P> Transform_<P>&       updX_PB(SBTreeKinematics_<P>&       kc) const {return toB  (kc.bodyConfigInParent);}
+template <class P> const Transform_<P>& getX_GB(const SBTreeKinematics_<P>& kc) const {return fromB(kc.bodyConfigInGround);}
+template <class P> Transform_<P>&       updX_GB(SBTreeKinematics_<P>&       kc) const {return toB  (kc.bodyConfigInGround);}
+template <class P> const Transform_<P>& getX_GP(const SBTreeKinematics_<P>& kc) const {assert(parent); return parent->getX_GB(kc);}
+
+template <class P> const PhiMatrix_<P>& getPhi(const SBTreeKinematics_<P>& kc) const {return fromB(kc.bodyToParentShift);}
+template <class P> PhiMatrix_<P>&       updPhi(SBTreeKinematics_<P>&       kc) const {return toB  (kc.bodyToParentShift);}
+
+template <class P> const SpatialInertia_<P>& getMk_G(const SBTreeKinematics_<P>& kc) const {return fromB(kc.bodySpatialInertiaInGround);}
+template <class P> SpatialInertia_<P>&       updMk_G(SBTreeKinematics_<P>&       kc) const {return toB  (kc.bodySpatialInertiaInGround);}
+template <class P> const Vec<3,P>& getCOM_G(const SBTreeKinematics_<P>& kc) const {return fromB(kc.bodyCOMInGround);}
+template <class P> Vec<3,P>&       updCOM_G(SBTreeKinematics_<P>&       kc) const {return toB  (kc.bodyCOMInGround);}
+template <class P> const Vec<3,P>& getCB_G(const SBTreeKinematics_<P>& kc) const 
+{   return getMk_G(kc).getMassCenter(); }
+template <class P> const UnitInertia_<P>& getUnitInertia_OB_G(const SBTreeKinematics_<P>& kc) const 
+{   return getMk_G(kc).getUnitInertia(); }
+
+template <class P> const Vec<2,Vec<3,P> >& getV_FM(const SBTreeKinematics_<P>& kc) const {return fromB(kc.mobilizerRelativeVelocity);}
+template <class P> Vec<2,Vec<3,P> >&       updV_FM(SBTreeKinematics_<P>&       kc) const {return toB  (kc.mobilizerRelativeVelocity);}
+template <class P> const Vec<2,Vec<3,P> >& getV_GB(const SBTreeKinematics_<P>& kc) const {return fromB(kc.bodyVelocityInGround);}
+template <class P> Vec<2,Vec<3,P> >&       updV_GB(SBTreeKinematics_<P>&       kc) const {return toB  (kc.bodyVelocityInGround);}
+template <class P> const Vec<2,Vec<3,P> >& getV_PB_G(const SBTreeKinematics_<P>& kc) const {return fromB(kc.bodyVelocityInParent);}
+template <class P> Vec<2,Vec<3,P> >&       updV_PB_G(SBTreeKinematics_<P>&       kc) const {return toB  (kc.bodyVelocityInParent);}
+template <class P> const Vec<2,Vec<3,P> >& getV_GP(const SBTreeKinematics_<P>& kc) const {assert(parent); return parent->getV_GB(kc);}
+template <class P> const Vec<2,Vec<3,P> >& getVD_PB_G(const SBTreeKinematics_<P>& kc) const 
+    {return fromB(kc.bodyVelocityInParentDerivRemainder);}
+template <class P> Vec<2,Vec<3,P> >&       updVD_PB_G(SBTreeKinematics_<P>&       kc) const 
+    {return toB  (kc.bodyVelocityInParentDerivRemainder);}
+
+template <class P> const Vec<2,Vec<3,P> >& getGyroscopicForce(const SBTreeKinematics_<P>& kc) const {return fromB(kc.gyroscopicForces);}
+template <class P> Vec<2,Vec<3,P> >&       updGyroscopicForce(SBTreeKinematics_<P>&       kc) const {return toB  (kc.gyroscopicForces);}
+template <class P> const Vec<2,Vec<3,P> >& getMobilizerCoriolisAcceleration(const SBTreeKinematics_<P>& kc) const {return fromB(kc.mobilizerCoriolisAcceleration);}
+template <class P> Vec<2,Vec<3,P> >&       updMobilizerCoriolisAcceleration(SBTreeKinematics_<P>&       kc) const {return toB  (kc.mobilizerCoriolisAcceleration);}
+template <class P> const Vec<2,Vec<3,P> >& getTotalCoriolisAcceleration(const SBTreeKinematics_<P>& kc) const {return fromB(kc.totalCoriolisAcceleration);}
+template <class P> Vec<2,Vec<3,P> >&       updTotalCoriolisAcceleration(SBTreeKinematics_<P>&       kc) const {return toB  (kc.totalCoriolisAcceleration);}
+template <class P> const Vec<2,Vec<3,P> >& getTotalCentrifugalForces(const SBTreeKinematics_<P>& kc) const {return fromB(kc.totalCentrifugalForces);}
+template <class P> Vec<2,Vec<3,P> >&       updTotalCentrifugalForces(SBTreeKinematics_<P>&       kc) const {return toB  (kc.totalCentrifugalForces);}
+
 // This requires both velocity kinematics (from SBTreeVelocityCache) and 
 // articulated body inertias (from SBArticulatedBodyInertiaCache).
 const SpatialVec& getArticulatedBodyCentrifugalForces
@@ -976,15 +1072,18 @@ Real calcKineticEnergy(
     const SBTreeVelocityCache& vc) const;   
 
 // Calculate all spatial configuration quantities, assuming availability of
-// joint-specific relative quantities.
+// joint-specific relative quantities. This and the next are templatized on
+// the scalar type; see SBTreeScalar.
+template <class P>
 void calcJointIndependentKinematicsPos(
-    SBTreePositionCache& pc) const;
+    typename SBTreeScalar<P>::PositionCache& pc) const;
 
 // Calcluate all spatial velocity quantities, assuming availability of
 // joint-specific relative quantities and all position kinematics.
+template <class P>
 void calcJointIndependentKinematicsVel(
-    const SBTreePositionCache& pc,
-    SBTreeVelocityCache&       vc) const;
+    const typename SBTreeScalar<P>::PositionCache& pc,
+    typename SBTreeScalar<P>::VelocityCache&       vc) const;
 
 // Calculate velocity-dependent quantities that involve articulated body
 // inertias and are needed for computing accelerations.
@@ -36,96 +36,29 @@ instantiations of the class for all possible values of the arguments. */
 #include "RigidBodyNodeSpec_Custom.h"
 
 //==============================================================================
-//                              CALC H_PB_G
+//                          REALIZE KINEMATICS DUAL
 //==============================================================================
-// Same for all mobilizers.
-// CAUTION: our H matrix definition is transposed from Jain and Schwieters.
-// Cost: 60 + 45*dof flops
+// This is realizePosition() and realizeVelocity() without the mobilizer-
+// specific parts, on Dual numbers. The caller supplies X_FM and H_FM in kc
+// along with the u's, and HDot_FM is zero since H_FM must be constant. Must
+// be called base to tip.
 template<int dof, bool noR_FM, bool noX_MB, bool noR_PF> void
 RigidBodyNodeSpec<dof, noR_FM, noX_MB, noR_PF>::
-calcParentToChildVelocityJacobianInGround
-   (const SBModelVars&          mv,
-    const SBTreePositionCache&  pc, 
-    HType&                      H_PB_G) const
+realizeKinematicsDual(const Dual*              allU,
+                      SBTreeKinematics_<Dual>& kc) const
 {
-    const HType& H_FM = getH_FM(pc);
-
-    // We want R_GF so we can reexpress the cross-joint velocity V_FB (==V_PB)
-    // in the ground frame, to get V_PB_G.
-
-    const Rotation& R_PF = getX_PF().R();      // fixed config of F in P
-
-    // Calculated already since we're going base to tip.
-    const Rotation& R_GP = getX_GP(pc).R(); // parent orientation in ground
-    const Rotation  R_GF = (noR_PF ? R_GP : R_GP * R_PF);     // 45 flops
-
-    if (noX_MB || noR_FM)
-        H_PB_G = R_GF * H_FM;       // 3*dof flops
-    else {
-        // want r_MB_F, that is, the vector from Mo to Bo, expressed in F
-        const Vec3&     r_MB   = getX_MB().p();     // fixed
-        const Rotation& R_FM   = getX_FM(pc).R();   // just calculated
-        const Vec3      r_MB_F = (noR_FM ? r_MB : R_FM*r_MB);       // 15 flops
-        HType H_MB_F;
-        H_MB_F[0] =  Vec3(0); // fills top row with zero
-        H_MB_F[1] = -r_MB_F % H_FM[0]; // 9*dof (negation not actually done)
-        H_PB_G = R_GF * (H_FM + H_MB_F); // 36*dof flops
-    }
-}
-
-//==============================================================================
-//                            CALC H_PB_G_DOT
-//==============================================================================
-// Same for all mobilizers.
-// CAUTION: our H matrix definition is transposed from Jain and Schwieters. 
-// Cost is 69 + 65*dof flops
-template<int dof, bool noR_FM, bool noX_MB, bool noR_PF> void
-RigidBodyNodeSpec<dof, noR_FM, noX_MB, noR_PF>::
-calcParentToChildVelocityJacobianInGroundDot(
-    const SBModelVars&          mv,
-    const SBTreePositionCache&  pc, 
-    const SBTreeVelocityCache&  vc,
-    HType&                      HDot_PB_G) const
-{
-    const HType& H_FM    = getH_FM(pc);
-    const HType& HDot_FM = getHDot_FM(vc);
-
-    // We want R_GF so we can reexpress the cross-joint velocity V_FB (==V_PB)
-    // in the ground frame, to get V_PB_G.
-
-    const Rotation& R_PF = getX_PF().R();       // fixed config of F in P
-
-    // Calculated already since we're going base to tip.
-    const Rotation& R_GP = getX_GP(pc).R();     // parent orientation in ground
-    const Rotation  R_GF = (noR_PF ? R_GP : R_GP * R_PF); // 45 flops (TODO: again??)
-
-    const Vec3& w_GF = getV_GP(vc)[0]; // F and P have same angular velocity
-
-    // Note: time derivative of R_GF is crossMat(w_GF)*R_GF.
-    //      H = H_PB_G =  R_GF * (H_FM + H_MB_F) (see above method)
-    const HType& H_PB_G = getH(pc);
-    if (noX_MB || noR_FM)
-        HDot_PB_G = R_GF * HDot_FM // 48*dof
-                  + HType(w_GF % H_PB_G[0], 
-                          w_GF % H_PB_G[1]);
-    else {
-        // want r_MB_F, that is, the vector from OM to OB, expressed in F 
-        const Vec3&     r_MB   = getX_MB().p();     // fixed
-        const Rotation& R_FM   = getX_FM(pc).R();   // just calculated
-        const Vec3      r_MB_F = (noR_FM ? r_MB : R_FM*r_MB); // 15 flops
-
-        const Vec3& w_FM = getV_FM(vc)[0]; // local angular velocity
-
-        HType HDot_MB_F;
-        HDot_MB_F[0] = Vec3(0);
-        HDot_MB_F[1] =          -r_MB_F  % HDot_FM[0] // 21*dof + 9 flops
-                       - (w_FM % r_MB_F) % H_FM[0];
-
-
-        HDot_PB_G =   R_GF * (HDot_FM + HDot_MB_F) // 54*dof
-                    + HType(w_GF % H_PB_G[0], 
-                            w_GF % H_PB_G[1]);
-    }
+    assert(isAcrossJointVelocityJacobianConstant());
+    const Vec<dof,Dual>& u = fromU(allU);
+
+    calcBodyTransforms<Dual>(kc, updX_PB(kc), updX_GB(kc));
+    calcParentToChildVelocityJacobianInGround<Dual>(kc, updH(kc));
+    calcJointIndependentKinematicsPos<Dual>(kc);
+
+    updV_FM(kc)    = getH_FM(kc) * u;
+    updV_PB_G(kc)  = getH(kc)    * u;
+    calcParentToChildVelocityJacobianInGroundDot<Dual>(kc, kc, updHDot(kc));
+    updVD_PB_G(kc) = getHDot(kc) * u;
+    calcJointIndependentKinematicsVel<Dual>(kc, kc);
 }
 
 //==============================================================================
@@ -563,6 +496,26 @@ RigidBodyNodeSpec<dof, noR_FM, noX_MB, noR_PF>::multiplyByMInvPass2Outward(
 // as pass 1 for inverse dynamics.
 //
 // This must be called base to tip. The cost is 12*dof + 18 flops.
+template<int dof, bool noR_FM, bool noX_MB, bool noR_PF> 
+template <class P> void 
+RigidBodyNodeSpec<dof, noR_FM, noX_MB, noR_PF>::
+calcBodyAccelerationsFromUdotOutwardImpl(
+    const typename SBTreeScalar<P>::PositionCache&  pc,
+    const typename SBTreeScalar<P>::VelocityCache&  vc,
+    const P*                                        allUDot,
+    Vec<2,Vec<3,P> >*                               allA_GB) const
+{
+    typedef Vec<2,Vec<3,P> > SpatialVecP;
+    const Vec<dof,P>& udot = fromU(allUDot);
+    SpatialVecP&      A_GB = allA_GB[nodeNum];
+
+    // Shift parent's A_GB outward. (Ground A_GB is zero.) 12 flops.
+    const SpatialVecP A_GP = ~getPhi(pc) * allA_GB[parent->getNodeNum()];
+
+    // 12*dof+6 flops.
+    A_GB = A_GP + getH(pc)*udot + getMobilizerCoriolisAcceleration(vc); 
+}
+
 template<int dof, bool noR_FM, bool noX_MB, bool noR_PF> void 
 RigidBodyNodeSpec<dof, noR_FM, noX_MB, noR_PF>::
 calcBodyAccelerationsFromUdotOutward(
@@ -571,14 +524,17 @@ calcBodyAccelerationsFromUdotOutward(
     const Real*                 allUDot,
     SpatialVec*                 allA_GB) const
 {
-    const Vec<dof>& udot = fromU(allUDot);
-    SpatialVec&     A_GB = allA_GB[nodeNum];
-
-    // Shift parent's A_GB outward. (Ground A_GB is zero.) 12 flops.
-    const SpatialVec A_GP = ~getPhi(pc) * allA_GB[parent->getNodeNum()];
+    calcBodyAccelerationsFromUdotOutwardImpl<Real>(pc, vc, allUDot, allA_GB);
+}
 
-    // 12*dof+6 flops.
-    A_GB = A_GP + getH(pc)*udot + getMobilizerCoriolisAcceleration(vc); 
+template<int dof, bool noR_FM, bool noX_MB, bool noR_PF> void 
+RigidBodyNodeSpec<dof, noR_FM, noX_MB, noR_PF>::
+calcBodyAccelerationsFromUdotOutwardDual(
+    const SBTreeKinematics_<Dual>&  kc,
+    const Dual*                     allUDot,
+    Vec<2,Vec<3,Dual> >*            allA_GB) const
+{
+    calcBodyAccelerationsFromUdotOutwardImpl<Dual>(kc, kc, allUDot, allA_GB);
 }
 
 
@@ -606,22 +562,24 @@ calcBodyAccelerationsFromUdotOutward(
 //      pass2: 12*dof + 75 flops
 //             -----------------
 //      total: 24*dof + 93 flops
-template<int dof, bool noR_FM, bool noX_MB, bool noR_PF> void
+template<int dof, bool noR_FM, bool noX_MB, bool noR_PF>
+template <class P> void
 RigidBodyNodeSpec<dof, noR_FM, noX_MB, noR_PF>::
-calcInverseDynamicsPass2Inward(
-    const SBTreePositionCache&  pc,
-    const SBTreeVelocityCache&  vc,
-    const SpatialVec*           allA_GB,
-    const Real*                 jointForces,
-    const SpatialVec*           bodyForces,
-    SpatialVec*                 allF,   // temp
-    Real*                       allTau) const 
+calcInverseDynamicsPass2InwardImpl(
+    const typename SBTreeScalar<P>::PositionCache&  pc,
+    const typename SBTreeScalar<P>::VelocityCache&  vc,
+    const Vec<2,Vec<3,P> >*                         allA_GB,
+    const P*                                        jointForces,
+    const Vec<2,Vec<3,P> >*                         bodyForces,
+    Vec<2,Vec<3,P> >*                               allF,   // temp
+    P*                                              allTau) const 
 {
-    const Vec<dof>&   myJointForce  = fromU(jointForces);
-    const SpatialVec& myBodyForce   = bodyForces[nodeNum];
-    const SpatialVec& A_GB          = allA_GB[nodeNum];
-    SpatialVec&       F             = allF[nodeNum];
-    Vec<dof>&         tau           = toU(allTau);
+    typedef Vec<2,Vec<3,P> > SpatialVecP;
+    const Vec<dof,P>&  myJointForce  = fromU(jointForces);
+    const SpatialVecP& myBodyForce   = bodyForces[nodeNum];
+    const SpatialVecP& A_GB          = allA_GB[nodeNum];
+    SpatialVecP&       F             = allF[nodeNum];
+    Vec<dof,P>&        tau           = toU(allTau);
 
     // Start with rigid body force from desired body acceleration and
     // gyroscopic forces due to angular velocity, minus external forces
@@ -630,8 +588,8 @@ calcInverseDynamicsPass2Inward(
 
     // Add in forces on children, shifted to this body.
     for (unsigned i=0; i<children.size(); ++i) {
-        const PhiMatrix&  phiChild  = children[i]->getPhi(pc);
-        const SpatialVec& FChild    = allF[children[i]->getNodeNum()];
+        const typename SBTreeScalar<P>::Phi& phiChild = children[i]->getPhi(pc);
+        const SpatialVecP& FChild = allF[children[i]->getNodeNum()];
         F += phiChild * FChild;         // 18 flops
     }
 
@@ -640,6 +598,35 @@ calcInverseDynamicsPass2Inward(
     tau = ~getH(pc)*F - myJointForce;   // 12*dof flops
 }
 
+template<int dof, bool noR_FM, bool noX_MB, bool noR_PF> void
+RigidBodyNodeSpec<dof, noR_FM, noX_MB, noR_PF>::
+calcInverseDynamicsPass2Inward(
+    const SBTreePositionCache&  pc,
+    const SBTreeVelocityCache&  vc,
+    const SpatialVec*           allA_GB,
+    const Real*                 jointForces,
+    const SpatialVec*           bodyForces,
+    SpatialVec*                 allF,   // temp
+    Real*                       allTau) const 
+{
+    calcInverseDynamicsPass2InwardImpl<Real>(pc, vc, allA_GB, jointForces,
+                                             bodyForces, allF, allTau);
+}
+
+template<int dof, bool noR_FM, bool noX_MB, bool noR_PF> void
+RigidBodyNodeSpec<dof, noR_FM, noX_MB, noR_PF>::
+calcInverseDynamicsPass2InwardDual(
+    const SBTreeKinematics_<Dual>&  kc,
+    const Vec<2,Vec<3,Dual> >*      allA_GB,
+    const Dual*                     jointForces,
+    const Vec<2,Vec<3,Dual> >*      bodyForces,
+    Vec<2,Vec<3,Dual> >*            allF,   // temp
+    Dual*                           allTau) const 
+{
+    calcInverseDynamicsPass2InwardImpl<Dual>(kc, kc, allA_GB, jointForces,
+                                             bodyForces, allF, allTau);
+}
+
 
 
 //==============================================================================
@@ -228,7 +228,6 @@ void realizeInstance(const SBStateDigest& sbs) const override
 // Must call base-to-tip.
 void realizePosition(const SBStateDigest& sbs) const override 
 {
-    const SBModelVars&      mv   = sbs.getModelVars();
     const SBModelCache&     mc   = sbs.getModelCache();
     const SBInstanceCache&  ic   = sbs.getInstanceCache();
     const Vector&           allQ = sbs.getQ();
@@ -268,7 +267,7 @@ void realizePosition(const SBStateDigest& sbs) const override
 
     // With X_FM in the cache, and X_GP for the parent already calculated (we're doing
     // an outward pass), we can calculate X_PB and X_GB now.
-    calcBodyTransforms(pc, updX_PB(pc), updX_GB(pc));
+    calcBodyTransforms<Real>(pc, updX_PB(pc), updX_GB(pc));
 
     // Here we do allow the mobilizer to calculate the reversed H matrix, but the
     // default implementation of the reversed method just calls the forward method
@@ -281,10 +280,10 @@ void realizePosition(const SBStateDigest& sbs) const override
     // calculated to compute H(==H_PB_G), the equivalent hinge matrix between 
     // the parent's body frame P and child's body frame B, but expressed in
     // Ground. (F is fixed on P and M is fixed on B.)
-    calcParentToChildVelocityJacobianInGround(mv,pc, updH(pc));
+    calcParentToChildVelocityJacobianInGround<Real>(pc, updH(pc));
 
     // Mobilizer independent.
-    calcJointIndependentKinematicsPos(pc);
+    calcJointIndependentKinematicsPos<Real>(pc);
 }
 
 // Set new velocities for the current configuration, and calculate
@@ -304,7 +303,6 @@ void realizePosition(const SBStateDigest& sbs) const override
 // The code is the same for all joints, although parametrized by ndof.
 void realizeVelocity(const SBStateDigest& sbs) const override
 {
-    const SBModelVars&          mv = sbs.getModelVars();
     const SBTreePositionCache&  pc = sbs.getTreePositionCache();
     SBTreeVelocityCache&        vc = sbs.updTreeVelocityCache();
     const Vector&               allU = sbs.getU();
@@ -325,13 +323,17 @@ void realizeVelocity(const SBStateDigest& sbs) const override
     // of H (==H_PB_G) between the parent's body frame P and child's body 
     // frame B. The derivative is taken in the Ground frame and the result
     // is expressed in Ground. (F is fixed on P and M is fixed on B.)
-    calcParentToChildVelocityJacobianInGroundDot(mv,pc,vc, updHDot(vc));
+    calcParentToChildVelocityJacobianInGroundDot<Real>(pc,vc, updHDot(vc));
     updVD_PB_G(vc) = getHDot(vc) * u;   // 6*dof flops
 
     // Mobilizer independent.
-    calcJointIndependentKinematicsVel(pc,vc);
+    calcJointIndependentKinematicsVel<Real>(pc,vc);
 }
 
+// The above on Dual numbers, taking X_FM and H_FM as given in kc.
+void realizeKinematicsDual(const Dual*              allU,
+                           SBTreeKinematics_<Dual>& kc) const override;
+
 void realizeDynamics(const SBStateDigest&) const override
 {
     // nothing to do
@@ -435,6 +437,38 @@ void calcInverseDynamicsPass2Inward(
     SpatialVec*                 allFTmp,
     Real*                       allTau) const override; 
 
+void calcBodyAccelerationsFromUdotOutwardDual(
+    const SBTreeKinematics_<Dual>&  kc,
+    const Dual*                     allUDot,
+    Vec<2,Vec<3,Dual> >*            allA_GB) const override;
+
+void calcInverseDynamicsPass2InwardDual(
+    const SBTreeKinematics_<Dual>&  kc,
+    const Vec<2,Vec<3,Dual> >*      allA_GB,
+    const Dual*                     jointForces,
+    const Vec<2,Vec<3,Dual> >*      bodyForces,
+    Vec<2,Vec<3,Dual> >*            allFTmp,
+    Dual*                           allTau) const override;
+
+// The scalar-generic bodies of the Real and Dual inverse dynamics passes 
+// above.
+template <class P>
+void calcBodyAccelerationsFromUdotOutwardImpl(
+    const typename SBTreeScalar<P>::PositionCache&  pc,
+    const typename SBTreeScalar<P>::VelocityCache&  vc,
+    const P*                                        allUDot,
+    Vec<2,Vec<3,P> >*                               allA_GB) const;
+
+template <class P>
+void calcInverseDynamicsPass2InwardImpl(
+    const typename SBTreeScalar<P>::PositionCache&  pc,
+    const typename SBTreeScalar<P>::VelocityCache&  vc,
+    const Vec<2,Vec<3,P> >*                         allA_GB,
+    const P*                                        jointForces,
+    const Vec<2,Vec<3,P> >*                         bodyForces,
+    Vec<2,Vec<3,P> >*                               allFTmp,
+    P*                                              allTau) const;
+
 void multiplyByMPass1Outward(
     const SBTreePositionCache&  pc,
     const Real*                 allUDot,
@@ -551,38 +585,119 @@ virtual void calcReverseMobilizerHDot_FM(
 
 // This routine is NOT joint specific, but cannot be called until the across-joint
 // transform X_FM has been calculated and is available in the State cache.
+// This and the next two are templatized on the scalar type; see SBTreeScalar.
+template <class P>
 void calcBodyTransforms(
-    const SBTreePositionCache&  pc, 
-    Transform&                  X_PB, 
-    Transform&                  X_GB) const 
+    const typename SBTreeScalar<P>::PositionCache&  pc, 
+    Transform_<P>&                                  X_PB, 
+    Transform_<P>&                                  X_GB) const 
 {
-    const Transform& X_MB = getX_MB();   // fixed
-    const Transform& X_PF = getX_PF();   // fixed
-    const Transform& X_FM = getX_FM(pc); // just calculated
-    const Transform& X_GP = getX_GP(pc); // already calculated
-
-    const Transform X_FB = (noX_MB ? X_FM                   // cheap
-                                   : X_FM*X_MB);            // 63 flops
-    X_PB = (noR_PF ? Transform(X_FB.R(), X_PF.p()+X_FB.p()) // cheap
-                   : X_PF*X_FB);                            // 63 flops
-    X_GB = X_GP * X_PB;                                     // 63 flops
+    typedef SBTreeScalar<P> Scalar;
+    const Transform_<P>& X_MB = Scalar::cast(getX_MB());   // fixed
+    const Transform_<P>& X_PF = Scalar::cast(getX_PF());   // fixed
+    const Transform_<P>& X_FM = getX_FM(pc); // just calculated
+    const Transform_<P>& X_GP = getX_GP(pc); // already calculated
+
+    const Transform_<P> X_FB = (noX_MB ? X_FM                   // cheap
+                                       : X_FM*X_MB);            // 63 flops
+    X_PB = (noR_PF ? Transform_<P>(X_FB.R(), X_PF.p()+X_FB.p()) // cheap
+                   : X_PF*X_FB);                                // 63 flops
+    X_GB = X_GP * X_PB;                                         // 63 flops
 }
 
 // Same for all mobilizers. The return matrix here is precisely the 
 // one used by Jain and Schwieters, but transposed.
+// CAUTION: our H matrix definition is transposed from Jain and Schwieters.
+// Cost: 60 + 45*dof flops
+template <class P>
 void calcParentToChildVelocityJacobianInGround(
-    const SBModelVars&          mv,
-    const SBTreePositionCache&  pc, 
-    HType&                      H_PB_G) const;
+    const typename SBTreeScalar<P>::PositionCache&  pc, 
+    Mat<2,dof,Vec<3,P> >&                           H_PB_G) const
+{
+    typedef SBTreeScalar<P>         Scalar;
+    typedef Vec<3,P>                Vec3P;
+    typedef Mat<2,dof,Vec3P>        HTypeP;
+    const HTypeP& H_FM = getH_FM(pc);
+
+    // We want R_GF so we can reexpress the cross-joint velocity V_FB (==V_PB)
+    // in the ground frame, to get V_PB_G.
+
+    const Transform_<P>& X_PF = Scalar::cast(getX_PF());
+    const Rotation_<P>&  R_PF = X_PF.R();      // fixed config of F in P
+
+    // Calculated already since we're going base to tip.
+    const Rotation_<P>& R_GP = getX_GP(pc).R(); // parent orientation in ground
+    const Rotation_<P>  R_GF = (noR_PF ? R_GP : R_GP * R_PF);     // 45 flops
+
+    if (noX_MB || noR_FM)
+        H_PB_G = R_GF * H_FM;       // 3*dof flops
+    else {
+        // want r_MB_F, that is, the vector from Mo to Bo, expressed in F
+        const Vec3P&        r_MB   = Scalar::cast(getX_MB().p()); // fixed
+        const Rotation_<P>& R_FM   = getX_FM(pc).R();   // just calculated
+        const Vec3P         r_MB_F = (noR_FM ? r_MB : R_FM*r_MB); // 15 flops
+        HTypeP H_MB_F;
+        H_MB_F[0] =  Vec3P(P(0)); // fills top row with zero
+        H_MB_F[1] = -r_MB_F % H_FM[0]; // 9*dof (negation not actually done)
+        H_PB_G = R_GF * (H_FM + H_MB_F); // 36*dof flops
+    }
+}
 
 // Same for all mobilizers. This is the time derivative of 
 // the matrix H_PB_G above, with the derivative taken in the 
 // Ground frame.
+// CAUTION: our H matrix definition is transposed from Jain and Schwieters. 
+// Cost is 69 + 65*dof flops
+template <class P>
 void calcParentToChildVelocityJacobianInGroundDot(
-    const SBModelVars&          mv,
-    const SBTreePositionCache&  pc, 
-    const SBTreeVelocityCache&  vc, 
-    HType&                      HDot_PB_G) const;
+    const typename SBTreeScalar<P>::PositionCache&  pc, 
+    const typename SBTreeScalar<P>::VelocityCache&  vc, 
+    Mat<2,dof,Vec<3,P> >&                           HDot_PB_G) const
+{
+    typedef SBTreeScalar<P>         Scalar;
+    typedef Vec<3,P>                Vec3P;
+    typedef Mat<2,dof,Vec3P>        HTypeP;
+    const HTypeP& H_FM    = getH_FM(pc);
+    const HTypeP& HDot_FM = getHDot_FM(vc);
+
+    // We want R_GF so we can reexpress the cross-joint velocity V_FB (==V_PB)
+    // in the ground frame, to get V_PB_G.
+
+    const Transform_<P>& X_PF = Scalar::cast(getX_PF());
+    const Rotation_<P>&  R_PF = X_PF.R();       // fixed config of F in P
+
+    // Calculated already since we're going base to tip.
+    const Rotation_<P>& R_GP = getX_GP(pc).R();     // parent orientation in ground
+    const Rotation_<P>  R_GF = (noR_PF ? R_GP : R_GP * R_PF); // 45 flops (TODO: again??)
+
+    const Vec3P& w_GF = getV_GP(vc)[0]; // F and P have same angular velocity
+
+    // Note: time derivative of R_GF is crossMat(w_GF)*R_GF.
+    //      H = H_PB_G =  R_GF * (H_FM + H_MB_F) (see above method)
+    const HTypeP& H_PB_G = getH(pc);
+    if (noX_MB || noR_FM)
+        HDot_PB_G = R_GF * HDot_FM // 48*dof
+                  + HTypeP(w_GF % H_PB_G[0], 
+                           w_GF % H_PB_G[1]);
+    else {
+        // want r_MB_F, that is, the vector from OM to OB, expressed in F 
+        const Vec3P&        r_MB   = Scalar::cast(getX_MB().p()); // fixed
+        const Rotation_<P>& R_FM   = getX_FM(pc).R();   // just calculated
+        const Vec3P         r_MB_F = (noR_FM ? r_MB : R_FM*r_MB); // 15 flops
+
+        const Vec3P& w_FM = getV_FM(vc)[0]; // local angular velocity
+
+        HTypeP HDot_MB_F;
+        HDot_MB_F[0] = Vec3P(P(0));
+        HDot_MB_F[1] =          -r_MB_F  % HDot_FM[0] // 21*dof + 9 flops
+                       - (w_FM % r_MB_F) % H_FM[0];
+
+
+        HDot_PB_G =   R_GF * (HDot_FM + HDot_MB_F) // 54*dof
+                    + HTypeP(w_GF % H_PB_G[0], 
+                             w_GF % H_PB_G[1]);
+    }
+}
 
 
 // Access to body-oriented state and cache entries is the same for all nodes,
@@ -602,6 +717,8 @@ const Vec<dof>&     fromQ  (const Real* q)   const {return Vec<dof>::getAs(&q[qI
 Vec<dof>&           toQ    (      Real* q)   const {return Vec<dof>::updAs(&q[qIndex]);}
 const Vec<dof>&     fromU  (const Real* u)   const {return Vec<dof>::getAs(&u[uIndex]);}
 Vec<dof>&           toU    (      Real* u)   const {return Vec<dof>::updAs(&u[uIndex]);}
+template <class P> const Vec<dof,P>& fromU(const P* u) const {return Vec<dof,P>::getAs(&u[uIndex]);}
+template <class P> Vec<dof,P>&       toU  (      P* u) const {return Vec<dof,P>::updAs(&u[uIndex]);}
 const Mat<dof,dof>& fromUSq(const Real* uSq) const {return Mat<dof,dof>::getAs(&uSq[uSqIndex]);}
 Mat<dof,dof>&       toUSq  (      Real* uSq) const {return Mat<dof,dof>::updAs(&uSq[uSqIndex]);}
 
@@ -689,6 +806,24 @@ const HType& getHDot(const SBTreeVelocityCache& vc) const
 HType&       updHDot(SBTreeVelocityCache& vc) const
 {   return HType::updAs(&vc.storageForHDot[2*uIndex]); }
 
+    // Generic-scalar kinematics
+
+// The same H matrices in an SBTreeKinematics_<P>.
+template <class P> const Mat<2,dof,Vec<3,P> >& getH_FM(const SBTreeKinematics_<P>& kc) const
+{   return Mat<2,dof,Vec<3,P> >::getAs(&kc.storageForH_FM[2*uIndex]); }
+template <class P> Mat<2,dof,Vec<3,P> >&       updH_FM(SBTreeKinematics_<P>& kc) const
+{   return Mat<2,dof,Vec<3,P> >::updAs(&kc.storageForH_FM[2*uIndex]); }
+template <class P> const Mat<2,dof,Vec<3,P> >& getH(const SBTreeKinematics_<P>& kc) const
+{   return Mat<2,dof,Vec<3,P> >::getAs(&kc.storageForH[2*uIndex]); }
+template <class P> Mat<2,dof,Vec<3,P> >&       updH(SBTreeKinematics_<P>& kc) const
+{   return Mat<2,dof,Vec<3,P> >::updAs(&kc.storageForH[2*uIndex]); }
+template <class P> const Mat<2,dof,Vec<3,P> >& getHDot_FM(const SBTreeKinematics_<P>& kc) const
+{   return Mat<2,dof,Vec<3,P> >::getAs(&kc.storageForHDot_FM[2*uIndex]); }
+template <class P> const Mat<2,dof,Vec<3,P> >& getHDot(const SBTreeKinematics_<P>& kc) const
+{   return Mat<2,dof,Vec<3,P> >::getAs(&kc.storageForHDot[2*uIndex]); }
+template <class P> Mat<2,dof,Vec<3,P> >&       updHDot(SBTreeKinematics_<P>& kc) const
+{   return Mat<2,dof,Vec<3,P> >::updAs(&kc.storageForHDot[2*uIndex]); }
+
     // Dynamics
 
 // These are calculated with articulated body inertias.
@@ -733,6 +868,41 @@ Real& upd1Epsilon(SBTreeAccelerationCache& ac) const
 
 
 
+};
+
+/**
+ * RBNodeBatched is the leaf of every RigidBodyNodeSpec-derived node that
+ * a MobilizedBody creates. It adds nothing but the batched kinematics
+ * kernels. Because this class is final, the qualified calls below are
+ * resolved statically, and once the generic realizePosition() and
+ * realizeVelocity() bodies are inlined here the compiler can also bind the
+ * mobilizer-specific hooks they call (calcX_FM(), calcQDot(), etc.)
+ * directly. The multibody tree groups the nodes of each level by concrete
+ * type so that a whole run of, say, unreversed Pins with identity frames
+ * is processed by a single call to one of these.
+ *
+ * Only the dispatch is batched. Each node still reads and writes its own
+ * entries in the per-body state caches, which stay indexed by
+ * MobilizedBodyIndex as every other consumer of those caches expects.
+ */
+template <class Concrete>
+class RBNodeBatched final : public Concrete {
+public:
+    using Concrete::Concrete;
+
+    void realizePositionBatch(const SBStateDigest&         sbs,
+                              const RigidBodyNode* const*  nodes,
+                              int                          n) const override
+    {   for (int i=0; i < n; ++i)
+            static_cast<const RBNodeBatched*>(nodes[i])
+                ->RBNodeBatched::realizePosition(sbs); }
+
+    void realizeVelocityBatch(const SBStateDigest&         sbs,
+                              const RigidBodyNode* const*  nodes,
+                              int                          n) const override
+    {   for (int i=0; i < n; ++i)
+            static_cast<const RBNodeBatched*>(nodes[i])
+                ->RBNodeBatched::realizeVelocity(sbs); }
 };
 
 #endif // SimTK_SIMBODY_RIGID_BODY_NODE_SPEC_H_
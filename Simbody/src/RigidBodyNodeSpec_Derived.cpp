@@ -52,15 +52,15 @@
     bool noR_PF = (getDefaultInboardFrame().R() == Mat33(1)); \
     if (noX_MB) { \
         if (noR_PF) \
-            return new CLASS<true, true> (__VA_ARGS__); \
+            return new RBNodeBatched< CLASS<true, true> > (__VA_ARGS__); \
         else \
-            return new CLASS<true, false> (__VA_ARGS__); \
+            return new RBNodeBatched< CLASS<true, false> > (__VA_ARGS__); \
     } \
     else { \
         if (noR_PF) \
-            return new CLASS<false, true> (__VA_ARGS__); \
+            return new RBNodeBatched< CLASS<false, true> > (__VA_ARGS__); \
         else \
-            return new CLASS<false, false> (__VA_ARGS__); \
+            return new RBNodeBatched< CLASS<false, false> > (__VA_ARGS__); \
     }
 
     /////////////////////////////////////////////////////////
@@ -258,15 +258,15 @@ RigidBodyNode* MobilizedBody::FreeLineImpl::createRigidBodyNode(
 #define INSTANTIATE_CUSTOM(DOF, ...) \
     if (noX_MB) { \
         if (noR_PF) \
-            return new RBNodeCustom<DOF, true, true> (__VA_ARGS__); \
+            return new RBNodeBatched< RBNodeCustom<DOF, true, true> > (__VA_ARGS__); \
         else \
-            return new RBNodeCustom<DOF, true, false> (__VA_ARGS__); \
+            return new RBNodeBatched< RBNodeCustom<DOF, true, false> > (__VA_ARGS__); \
     } \
     else { \
         if (noR_PF) \
-            return new RBNodeCustom<DOF, false, true> (__VA_ARGS__); \
+            return new RBNodeBatched< RBNodeCustom<DOF, false, true> > (__VA_ARGS__); \
         else \
-            return new RBNodeCustom<DOF, false, false> (__VA_ARGS__); \
+            return new RBNodeBatched< RBNodeCustom<DOF, false, false> > (__VA_ARGS__); \
     }
 
 RigidBodyNode* MobilizedBody::CustomImpl::createRigidBodyNode(
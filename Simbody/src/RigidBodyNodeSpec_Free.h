@@ -218,6 +218,10 @@ void calcAcrossJointVelocityJacobianDot(
     HDot_FM(5) = SpatialVec( Vec3(0), Vec3(0) );
 }
 
+// H_FM is constant in F, as the analytic dynamics derivatives require.
+bool isAcrossJointVelocityJacobianConstant() const override
+{   return !this->isReversed(); }
+
 
 // Calculate qdot=N(q)*u. Precalculations make this fast in Euler angle
 // mode (10 flops); quaternion mode is 27 flops.
@@ -156,6 +156,10 @@ void calcAcrossJointVelocityJacobianDot(
     HDot_FM(2) = SpatialVec( Vec3(0), Vec3(0) );
 }
 
+// H_FM is constant in F, as the analytic dynamics derivatives require.
+bool isAcrossJointVelocityJacobianConstant() const override
+{   return !this->isReversed(); }
+
 };
 
 
@@ -147,6 +147,10 @@ void calcAcrossJointVelocityJacobianDot(
     HDot_FM(0) = SpatialVec( Vec3(0), Vec3(0) );
 }
 
+// H_FM is constant in F, as the analytic dynamics derivatives require.
+bool isAcrossJointVelocityJacobianConstant() const override
+{   return !this->isReversed(); }
+
 // Override the computation of reverse-H for this simple mobilizer.
 void calcReverseMobilizerH_FM(
     const SBStateDigest& sbs,
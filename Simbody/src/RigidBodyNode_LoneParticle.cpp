@@ -467,13 +467,13 @@ RigidBodyNode* MobilizedBody::TranslationImpl::createRigidBodyNode(
     bool noR_PF = (getDefaultInboardFrame().R() == Mat33(1));
     if (noX_MB) {
         if (noR_PF)
-            return new RBNodeTranslate<true, true> (
+            return new RBNodeBatched< RBNodeTranslate<true, true> > (
                 getDefaultRigidBodyMassProperties(),
                 getDefaultInboardFrame(),getDefaultOutboardFrame(),
                 isReversed(),
                 nextUSlot,nextUSqSlot,nextQSlot);
         else
-            return new RBNodeTranslate<true, false> (
+            return new RBNodeBatched< RBNodeTranslate<true, false> > (
                 getDefaultRigidBodyMassProperties(),
                 getDefaultInboardFrame(),getDefaultOutboardFrame(),
                 isReversed(),
@@ -481,13 +481,13 @@ RigidBodyNode* MobilizedBody::TranslationImpl::createRigidBodyNode(
     }
     else {
         if (noR_PF)
-            return new RBNodeTranslate<false, true> (
+            return new RBNodeBatched< RBNodeTranslate<false, true> > (
                 getDefaultRigidBodyMassProperties(),
                 getDefaultInboardFrame(),getDefaultOutboardFrame(),
                 isReversed(),
                 nextUSlot,nextUSqSlot,nextQSlot);
         else
-            return new RBNodeTranslate<false, false> (
+            return new RBNodeBatched< RBNodeTranslate<false, false> > (
                 getDefaultRigidBodyMassProperties(),
                 getDefaultInboardFrame(),getDefaultOutboardFrame(),
                 isReversed(),
@@ -73,6 +73,7 @@ public:
     bool isUsingQuaternion(const SBStateDigest&, 
                            MobilizerQIndex& ix) const override
     {   ix.invalidate(); return false; }
+    bool isAcrossJointVelocityJacobianConstant() const override {return true;}
 
 
     int calcQPoolSize(const SBModelVars&) const override {return 0;}
@@ -282,13 +283,47 @@ public:
         const SpatialVec*           bodyForces,
         SpatialVec*                 allF,
         Real*                       allTau) const override
+    {
+        calcInverseDynamicsPass2InwardImpl<Real>(pc, bodyForces, allF);
+    }
+
+    // Ground's kinematics are set when the caches are allocated.
+    void realizeKinematicsDual(
+        const Dual*                     allU,
+        SBTreeKinematics_<Dual>&        kc) const override {}
+
+    void calcBodyAccelerationsFromUdotOutwardDual(
+        const SBTreeKinematics_<Dual>&  kc,
+        const Dual*                     allUDot,
+        Vec<2,Vec<3,Dual> >*            allA_GB) const override
+    {
+        allA_GB[0] = 0;
+    }
+
+    void calcInverseDynamicsPass2InwardDual(
+        const SBTreeKinematics_<Dual>&  kc,
+        const Vec<2,Vec<3,Dual> >*      allA_GB,
+        const Dual*                     jointForces,
+        const Vec<2,Vec<3,Dual> >*      bodyForces,
+        Vec<2,Vec<3,Dual> >*            allF,
+        Dual*                           allTau) const override
+    {
+        calcInverseDynamicsPass2InwardImpl<Dual>(kc, bodyForces, allF);
+    }
+
+    template <class P>
+    void calcInverseDynamicsPass2InwardImpl(
+        const typename SBTreeScalar<P>::PositionCache&  pc,
+        const Vec<2,Vec<3,P> >*                         bodyForces,
+        Vec<2,Vec<3,P> >*                               allF) const
     {
         allF[0] = -bodyForces[0];
 
         // Add in forces on base bodies, shifted to Ground.
         for (unsigned i=0; i<children.size(); ++i) {
-            const PhiMatrix&  phiChild  = children[i]->getPhi(pc);
-            const SpatialVec& FChild    = allF[children[i]->getNodeNum()];
+            const typename SBTreeScalar<P>::Phi& phiChild = 
+                children[i]->getPhi(pc);
+            const Vec<2,Vec<3,P> >& FChild = allF[children[i]->getNodeNum()];
             allF[0] += phiChild * FChild;
         }
 
@@ -388,44 +423,36 @@ public:
 
     void realizePosition(const SBStateDigest& sbs) const override {
         SBTreePositionCache& pc = sbs.updTreePositionCache();
-
-        const Transform& X_MB = getX_MB();   // fixed
-        const Transform& X_PF = getX_PF();   // fixed
-        const Transform& X_GP = getX_GP(pc); // already calculated
-
         updX_FM(pc).setToZero();
-        updX_PB(pc) = X_PF * X_MB;
-        updX_GB(pc) = X_GP * getX_PB(pc);
-        const Vec3 p_PB_G = getX_GP(pc).R() * getX_PB(pc).p();
-
-        // The Phi matrix conveniently performs child-to-parent (inward) shifting
-        // on spatial quantities (forces); its transpose does parent-to-child
-        // (outward) shifting for velocities.
-        updPhi(pc) = PhiMatrix(p_PB_G);
-
-        // Calculate spatial mass properties. That means we need to transform
-        // the local mass moments into the Ground frame and reconstruct the
-        // spatial inertia matrix Mk.
-
-        const Rotation& R_GB = getX_GB(pc).R();
-        const Vec3&     p_GB = getX_GB(pc).p();
-
-        // reexpress inertia in ground (57 flops)
-        const UnitInertia G_Bo_G  = getUnitInertia_OB_B().reexpress(~R_GB);
-        const Vec3        p_BBc_G = R_GB*getCOM_B(); // 15 flops
-
-        updCOM_G(pc) = p_GB + p_BBc_G; // 3 flops
-
-        // Calc Mk: the spatial inertia matrix about the body origin.
-        // Note: we need to calculate this now so that we'll be able to calculate
-        // kinetic energy without going past the Velocity stage.
-        updMk_G(pc) = SpatialInertia(getMass(), p_BBc_G, G_Bo_G);
+        realizePositionImpl<Real>(pc);
     }
     
     void realizeVelocity(const SBStateDigest& sbs) const override {
         const SBTreePositionCache& pc = sbs.getTreePositionCache();
         SBTreeVelocityCache& vc = sbs.updTreeVelocityCache();
-        calcJointIndependentKinematicsVel(pc,vc);
+        calcJointIndependentKinematicsVel<Real>(pc,vc);
+    }
+
+    // The velocity entries kept zero by realizeInstance() start out zero in
+    // kc, as does X_FM.
+    void realizeKinematicsDual(
+        const Dual*                 allU,
+        SBTreeKinematics_<Dual>&    kc) const override
+    {
+        realizePositionImpl<Dual>(kc);
+        calcJointIndependentKinematicsVel<Dual>(kc,kc);
+    }
+
+    template <class P>
+    void realizePositionImpl(typename SBTreeScalar<P>::PositionCache& pc) const {
+        typedef SBTreeScalar<P> Scalar;
+        const Transform_<P>& X_MB = Scalar::cast(getX_MB());   // fixed
+        const Transform_<P>& X_PF = Scalar::cast(getX_PF());   // fixed
+        const Transform_<P>& X_GP = getX_GP(pc); // already calculated
+
+        updX_PB(pc) = X_PF * X_MB;
+        updX_GB(pc) = X_GP * getX_PB(pc);
+        calcJointIndependentKinematicsPos<P>(pc);
     }
 
     void realizeDynamics(const SBStateDigest&) const override {
@@ -571,12 +598,7 @@ public:
         const Real*                 allUDot,
         SpatialVec*                 allA_GB) const override 
     {
-        SpatialVec& A_GB = allA_GB[nodeNum];
-
-        // Shift parent's A_GB outward. (Ground A_GB is zero.)
-        const SpatialVec A_GP = ~getPhi(pc) * allA_GB[parent->getNodeNum()];
-
-        A_GB = A_GP + getMobilizerCoriolisAcceleration(vc); // no udot for weld
+        calcBodyAccelerationsFromUdotOutwardImpl<Real>(pc, vc, allA_GB);
     }
 
     void calcInverseDynamicsPass2Inward(
@@ -588,9 +610,56 @@ public:
         SpatialVec*                 allF,
         Real*                       allTau) const override
     {
-        const SpatialVec& myBodyForce   = bodyForces[nodeNum];
-        const SpatialVec& A_GB          = allA_GB[nodeNum];
-        SpatialVec&       F             = allF[nodeNum];
+        calcInverseDynamicsPass2InwardImpl<Real>(pc, vc, allA_GB, bodyForces,
+                                                 allF);
+    }
+
+    void calcBodyAccelerationsFromUdotOutwardDual(
+        const SBTreeKinematics_<Dual>&  kc,
+        const Dual*                     allUDot,
+        Vec<2,Vec<3,Dual> >*            allA_GB) const override
+    {
+        calcBodyAccelerationsFromUdotOutwardImpl<Dual>(kc, kc, allA_GB);
+    }
+
+    void calcInverseDynamicsPass2InwardDual(
+        const SBTreeKinematics_<Dual>&  kc,
+        const Vec<2,Vec<3,Dual> >*      allA_GB,
+        const Dual*                     jointForces,
+        const Vec<2,Vec<3,Dual> >*      bodyForces,
+        Vec<2,Vec<3,Dual> >*            allF,
+        Dual*                           allTau) const override
+    {
+        calcInverseDynamicsPass2InwardImpl<Dual>(kc, kc, allA_GB, bodyForces,
+                                                 allF);
+    }
+
+    template <class P>
+    void calcBodyAccelerationsFromUdotOutwardImpl(
+        const typename SBTreeScalar<P>::PositionCache&  pc,
+        const typename SBTreeScalar<P>::VelocityCache&  vc,
+        Vec<2,Vec<3,P> >*                               allA_GB) const
+    {
+        Vec<2,Vec<3,P> >& A_GB = allA_GB[nodeNum];
+
+        // Shift parent's A_GB outward. (Ground A_GB is zero.)
+        const Vec<2,Vec<3,P> > A_GP = 
+            ~getPhi(pc) * allA_GB[parent->getNodeNum()];
+
+        A_GB = A_GP + getMobilizerCoriolisAcceleration(vc); // no udot for weld
+    }
+
+    template <class P>
+    void calcInverseDynamicsPass2InwardImpl(
+        const typename SBTreeScalar<P>::PositionCache&  pc,
+        const typename SBTreeScalar<P>::VelocityCache&  vc,
+        const Vec<2,Vec<3,P> >*                         allA_GB,
+        const Vec<2,Vec<3,P> >*                         bodyForces,
+        Vec<2,Vec<3,P> >*                               allF) const
+    {
+        const Vec<2,Vec<3,P> >& myBodyForce   = bodyForces[nodeNum];
+        const Vec<2,Vec<3,P> >& A_GB          = allA_GB[nodeNum];
+        Vec<2,Vec<3,P> >&       F             = allF[nodeNum];
 
         // Start with rigid body force from desired body acceleration and
         // gyroscopic forces due to angular velocity, minus external forces
@@ -599,8 +668,9 @@ public:
 
         // Add in forces on children, shifted to this body.
         for (unsigned i=0; i<children.size(); ++i) {
-            const PhiMatrix&  phiChild  = children[i]->getPhi(pc);
-            const SpatialVec& FChild    = allF[children[i]->getNodeNum()];
+            const typename SBTreeScalar<P>::Phi& phiChild = 
+                children[i]->getPhi(pc);
+            const Vec<2,Vec<3,P> >& FChild = allF[children[i]->getNodeNum()];
             F += phiChild * FChild;
         }
 
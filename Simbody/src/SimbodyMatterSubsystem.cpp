@@ -28,6 +28,8 @@
 
 #include "SimTKcommon.h"
 #include "simbody/internal/MobilizedBody.h"
+#include "simbody/internal/MultibodySystem.h"
+#include "simbody/internal/TaskJacobianPlan.h"
 
 #include "MobilizedBodyImpl.h"
 #include "SimbodyMatterSubsystemRep.h"
@@ -107,6 +109,95 @@ void SimbodyMatterSubsystem::setShowDefaultGeometry(bool show) {
     updRep().setShowDefaultGeometry(show);
 }
 
+bool SimbodyMatterSubsystem::getUseParallelTreeSweeps() const {
+    return getRep().getUseParallelTreeSweeps();
+}
+
+void SimbodyMatterSubsystem::setUseParallelTreeSweeps(bool useParallel) {
+    updRep().setUseParallelTreeSweeps(useParallel);
+}
+
+int SimbodyMatterSubsystem::getNumberOfThreads() const {
+    return getRep().getNumberOfThreads();
+}
+
+void SimbodyMatterSubsystem::setNumberOfThreads(int numThreads) {
+    updRep().setNumberOfThreads(numThreads);
+}
+
+bool SimbodyMatterSubsystem::getUseParallelConstraintEvaluation() const {
+    return getRep().getUseParallelConstraintEvaluation();
+}
+
+void SimbodyMatterSubsystem::
+setUseParallelConstraintEvaluation(bool useParallel) 
+{   updRep().setUseParallelConstraintEvaluation(useParallel); }
+
+bool SimbodyMatterSubsystem::getUseCholeskyForMultipliers() const {
+    return getRep().getUseCholeskyForMultipliers();
+}
+
+void SimbodyMatterSubsystem::setUseCholeskyForMultipliers(bool useCholesky) {
+    updRep().setUseCholeskyForMultipliers(useCholesky);
+}
+
+bool SimbodyMatterSubsystem::getUseIterativeMultiplierSolver() const {
+    return getRep().getUseIterativeMultiplierSolver();
+}
+
+void SimbodyMatterSubsystem::setUseIterativeMultiplierSolver(bool useIterative) 
+{   updRep().setUseIterativeMultiplierSolver(useIterative); }
+
+Real SimbodyMatterSubsystem::getIterativeMultiplierSolverTolerance() const {
+    return getRep().getIterativeMultiplierSolverTolerance();
+}
+
+void SimbodyMatterSubsystem::setIterativeMultiplierSolverTolerance(Real tol) {
+    SimTK_APIARGCHECK1_ALWAYS(tol > 0, "SimbodyMatterSubsystem",
+        "setIterativeMultiplierSolverTolerance",
+        "The tolerance must be positive but was %g.", tol);
+    updRep().setIterativeMultiplierSolverTolerance(tol);
+}
+
+bool SimbodyMatterSubsystem::getUseIncrementalPositionKinematics() const {
+    return getRep().getUseIncrementalPositionKinematics();
+}
+
+void SimbodyMatterSubsystem::
+setUseIncrementalPositionKinematics(bool useIncremental) 
+{   updRep().setUseIncrementalPositionKinematics(useIncremental); }
+
+bool SimbodyMatterSubsystem::getUseModifiedNewtonProjection() const {
+    return getRep().getUseModifiedNewtonProjection();
+}
+
+void SimbodyMatterSubsystem::
+setUseModifiedNewtonProjection(bool useModifiedNewton) 
+{   updRep().setUseModifiedNewtonProjection(useModifiedNewton); }
+
+int SimbodyMatterSubsystem::
+getNumQProjectionFactorizations(const State& state) const
+{   return getRep().getProjectionFactorizationCache(state).numQFactorizations; }
+
+int SimbodyMatterSubsystem::
+getNumQProjectionFactorizationsAvoided(const State& state) const {
+    return getRep().getProjectionFactorizationCache(state)
+                   .numQFactorizationsAvoided;
+}
+
+int SimbodyMatterSubsystem::
+getNumUProjectionFactorizations(const State& state) const
+{   return getRep().getProjectionFactorizationCache(state).numUFactorizations; }
+
+int SimbodyMatterSubsystem::
+getNumUProjectionFactorizationsAvoided(const State& state) const {
+    return getRep().getProjectionFactorizationCache(state)
+                   .numUFactorizationsAvoided;
+}
+
+void SimbodyMatterSubsystem::resetProjectionStatistics(State& state) const
+{   getRep().updProjectionFactorizationCache(state).clearStatistics(); }
+
 
 ConstraintIndex SimbodyMatterSubsystem::
 adoptConstraint(Constraint& child) {return updRep().adoptConstraint(child);}
@@ -374,6 +465,189 @@ void SimbodyMatterSubsystem::calcResidualForce
 
 
 
+//==============================================================================
+//                    CALC FORWARD DYNAMICS DERIVATIVES
+//==============================================================================
+// Unconstrained forward dynamics solves the free rows of
+//      r(q,u,udot) = M(q) udot + f_inertial(q,u) - f_applied(t,q,u) = 0
+// for udot_f. Differentiating at the solution udot with udot held fixed gives
+//      d udot_f = M_ff^-1 (d tau - d r)
+// so we need only the change in the inverse dynamics residual, never a 
+// forward dynamics solve per direction. When every mobilizer has a constant
+// H_FM, d r comes from running the O(n) kinematics and inverse dynamics 
+// recursions once on Dual numbers (see calcTreeResidualDerivative()), with 
+// the force elements supplying their own derivatives where they can. Other mobilizers 
+// don't provide the second derivatives of H that would need, so then d r is 
+// taken by central differences of the inverse dynamics operator on a scratch
+// State realized to Dynamics. Either way M_ff^-1 is then applied exactly.
+
+// Realize a scratch State through Dynamics stage and calculate the tree
+// residual at the given udot, using whatever forces the System applies there.
+static void calcTreeResidualAtFixedUDot(const SimbodyMatterSubsystem& matter,
+                                        State&                        s,
+                                        const Vector&                 udot,
+                                        Vector&                       residual)
+{
+    const MultibodySystem& mbs = MultibodySystem::downcast(matter.getSystem());
+    mbs.realize(s, Stage::Dynamics);
+    matter.calcResidualForceIgnoringConstraints(s,
+        mbs.getMobilityForces(s, Stage::Dynamics),
+        mbs.getRigidBodyForces(s, Stage::Dynamics),
+        udot, residual);
+}
+
+// Calculate the unconstrained accelerations whose residual is held fixed.
+static void calcTreeUDot(const SimbodyMatterSubsystem& matter, 
+                         const State& s, Vector& udot) 
+{
+    const MultibodySystem& mbs = MultibodySystem::downcast(matter.getSystem());
+    Vector_<SpatialVec> A_GB;
+    matter.calcAccelerationIgnoringConstraints(s,
+        mbs.getMobilityForces(s, Stage::Dynamics),
+        mbs.getRigidBodyForces(s, Stage::Dynamics),
+        udot, A_GB);
+}
+
+// Central difference step for a variable of the given magnitude.
+static Real centralDifferenceStep(Real x) 
+{   return std::cbrt(NTraits<Real>::getEps()) * std::max(Real(1), std::abs(x)); }
+
+void SimbodyMatterSubsystem::calcForwardDynamicsDerivatives
+   (const State& state,
+    Matrix&      dudot_dq,
+    Matrix&      dudot_du,
+    Matrix&      dudot_dtau) const
+{
+    const SimbodyMatterSubsystemRep& rep = getRep();
+    SimTK_STAGECHECK_GE_ALWAYS(rep.getStage(state), Stage::Dynamics,
+        "SimbodyMatterSubsystem::calcForwardDynamicsDerivatives()");
+    const int nq = rep.getNQ(state), nu = rep.getNU(state);
+
+    Vector udot;
+    calcTreeUDot(*this, state, udot);
+
+    // M_ff^-1 is written only in the free rows; prescribed rows stay zero.
+    dudot_dtau.resize(nu,nu); dudot_dtau.setToZero();
+    dudot_dq.resize(nu,nq);   dudot_dq.setToZero();
+    dudot_du.resize(nu,nu);   dudot_du.setToZero();
+
+    Vector e(nu, Real(0));
+    for (int j=0; j < nu; ++j) {
+        e[j] = 1;
+        VectorView col = dudot_dtau(j);
+        rep.multiplyByMInv(state, e, col);
+        e[j] = 0;
+    }
+
+    Vector negdr(nu);
+    if (rep.hasConstantAcrossJointVelocityJacobians()) {
+        Vector eq(nq, Real(0)), eu(nu, Real(0)), dr;
+        for (int j=0; j < nq; ++j) {
+            eq[j] = 1;
+            rep.calcTreeResidualDerivative(state, udot, eq, eu, dr);
+            eq[j] = 0;
+            dr.negateInPlace();
+            VectorView col = dudot_dq(j);
+            rep.multiplyByMInv(state, dr, col);
+        }
+        for (int j=0; j < nu; ++j) {
+            eu[j] = 1;
+            rep.calcTreeResidualDerivative(state, udot, eq, eu, dr);
+            eu[j] = 0;
+            dr.negateInPlace();
+            VectorView col = dudot_du(j);
+            rep.multiplyByMInv(state, dr, col);
+        }
+        return;
+    }
+
+    State tmp = state;
+    Vector rPlus, rMinus;
+
+    for (int j=0; j < nq; ++j) {
+        const Real q0 = getQ(state)[j], h = centralDifferenceStep(q0);
+        updQ(tmp)[j] = q0 + h; calcTreeResidualAtFixedUDot(*this,tmp,udot,rPlus);
+        updQ(tmp)[j] = q0 - h; calcTreeResidualAtFixedUDot(*this,tmp,udot,rMinus);
+        updQ(tmp)[j] = q0;
+        negdr = (rMinus - rPlus) / (2*h);
+        VectorView col = dudot_dq(j);
+        rep.multiplyByMInv(state, negdr, col);
+    }
+
+    for (int j=0; j < nu; ++j) {
+        const Real u0 = getU(state)[j], h = centralDifferenceStep(u0);
+        updU(tmp)[j] = u0 + h; calcTreeResidualAtFixedUDot(*this,tmp,udot,rPlus);
+        updU(tmp)[j] = u0 - h; calcTreeResidualAtFixedUDot(*this,tmp,udot,rMinus);
+        updU(tmp)[j] = u0;
+        negdr = (rMinus - rPlus) / (2*h);
+        VectorView col = dudot_du(j);
+        rep.multiplyByMInv(state, negdr, col);
+    }
+}
+
+void SimbodyMatterSubsystem::multiplyByForwardDynamicsDerivatives
+   (const State&  state,
+    const Vector& dq,
+    const Vector& du,
+    const Vector& dtau,
+    Vector&       dudot) const
+{
+    const SimbodyMatterSubsystemRep& rep = getRep();
+    SimTK_STAGECHECK_GE_ALWAYS(rep.getStage(state), Stage::Dynamics,
+        "SimbodyMatterSubsystem::multiplyByForwardDynamicsDerivatives()");
+    const int nq = rep.getNQ(state), nu = rep.getNU(state);
+    const char* method = 
+        "SimbodyMatterSubsystem::multiplyByForwardDynamicsDerivatives()";
+    SimTK_ERRCHK2_ALWAYS(dq.size()==0 || dq.size()==nq, method,
+        "Argument 'dq' had length %d but should be zero length or have one "
+        "entry per generalized coordinate q (%d).", dq.size(), nq);
+    SimTK_ERRCHK2_ALWAYS(du.size()==0 || du.size()==nu, method,
+        "Argument 'du' had length %d but should be zero length or have one "
+        "entry per generalized speed u (%d).", du.size(), nu);
+    SimTK_ERRCHK2_ALWAYS(dtau.size()==0 || dtau.size()==nu, method,
+        "Argument 'dtau' had length %d but should be zero length or have one "
+        "entry per mobility (%d).", dtau.size(), nu);
+
+    Vector f(nu);
+    if (dtau.size()) f = dtau; else f.setToZero();
+
+    const Real dqMax = dq.size() ? max(abs(dq)) : Real(0);
+    const Real duMax = du.size() ? max(abs(du)) : Real(0);
+    const Real dirMax = std::max(dqMax, duMax);
+    if (dirMax > 0 && rep.hasConstantAcrossJointVelocityJacobians()) {
+        Vector udot, dr;
+        calcTreeUDot(*this, state, udot);
+        rep.calcTreeResidualDerivative(state, udot, 
+            dq.size() ? dq : Vector(nq, Real(0)), 
+            du.size() ? du : Vector(nu, Real(0)), dr);
+        f -= dr;
+    } else if (dirMax > 0) {
+        // A single central difference along the combined direction (dq,du)
+        // gives the directional derivative of the residual.
+        const Real xMax = std::max(nq ? max(abs(getQ(state))) : Real(0),
+                                   nu ? max(abs(getU(state))) : Real(0));
+        const Real h = centralDifferenceStep(xMax) / dirMax;
+
+        Vector udot;
+        calcTreeUDot(*this, state, udot);
+
+        State tmp = state;
+        Vector rPlus, rMinus;
+        if (dq.size()) updQ(tmp) = getQ(state) + h*dq;
+        if (du.size()) updU(tmp) = getU(state) + h*du;
+        calcTreeResidualAtFixedUDot(*this, tmp, udot, rPlus);
+        if (dq.size()) updQ(tmp) = getQ(state) - h*dq;
+        if (du.size()) updU(tmp) = getU(state) - h*du;
+        calcTreeResidualAtFixedUDot(*this, tmp, udot, rMinus);
+        f += (rMinus - rPlus) / (2*h);
+    }
+
+    dudot.resize(nu); dudot.setToZero();
+    rep.multiplyByMInv(state, f, dudot);
+}
+
+
+
 //==============================================================================
 //                               MULTIPLY BY M
 //==============================================================================
@@ -478,6 +752,72 @@ void SimbodyMatterSubsystem::calcM(const State& s, Matrix& M) const
 void SimbodyMatterSubsystem::calcMInv(const State& s, Matrix& MInv) const 
 {   getRep().calcMInv(s, MInv); }
 
+void SimbodyMatterSubsystem::
+calcTaskSpaceInertiaInverse(const State&            s,
+                            const TaskJacobianPlan& tasks,
+                            Matrix&                 LambdaInv) const
+{   getRep().calcTaskSpaceInertiaInverse(s, tasks, LambdaInv); }
+
+void SimbodyMatterSubsystem::
+calcTaskSpaceInertiaInverse(const State&                      s,
+                            const Array_<MobilizedBodyIndex>& onBodyB,
+                            const Array_<Vec3>&               p_BS,
+                            Matrix&                           LambdaInv) const
+{
+    SimTK_ERRCHK2_ALWAYS(p_BS.size() == onBodyB.size(),
+        "SimbodyMatterSubsystem::calcTaskSpaceInertiaInverse()",
+        "The given number of task bodies (%d) and station tasks (%d) must "
+        "be the same.", (int)onBodyB.size(), (int)p_BS.size());
+    TaskJacobianPlan tasks(*this);
+    for (unsigned i=0; i < onBodyB.size(); ++i)
+        tasks.addStationTask(onBodyB[i], p_BS[i]);
+    getRep().calcTaskSpaceInertiaInverse(s, tasks, LambdaInv);
+}
+
+// Lambda^-1 is symmetric positive semidefinite; we use the QTZ pseudoinverse
+// so that redundant tasks don't cause trouble.
+void SimbodyMatterSubsystem::
+calcTaskSpaceInertia(const State&            s,
+                     const TaskJacobianPlan& tasks,
+                     Matrix&                 Lambda) const
+{
+    Matrix LambdaInv;
+    getRep().calcTaskSpaceInertiaInverse(s, tasks, LambdaInv);
+    Lambda.resize(LambdaInv.nrow(), LambdaInv.ncol());
+    if (LambdaInv.nrow())
+        FactorQTZ(LambdaInv).inverse(Lambda);
+}
+
+void SimbodyMatterSubsystem::
+calcTaskSpaceInertia(const State&                      s,
+                     const Array_<MobilizedBodyIndex>& onBodyB,
+                     const Array_<Vec3>&               p_BS,
+                     Matrix&                           Lambda) const
+{
+    SimTK_ERRCHK2_ALWAYS(p_BS.size() == onBodyB.size(),
+        "SimbodyMatterSubsystem::calcTaskSpaceInertia()",
+        "The given number of task bodies (%d) and station tasks (%d) must "
+        "be the same.", (int)onBodyB.size(), (int)p_BS.size());
+    TaskJacobianPlan tasks(*this);
+    for (unsigned i=0; i < onBodyB.size(); ++i)
+        tasks.addStationTask(onBodyB[i], p_BS[i]);
+    calcTaskSpaceInertia(s, tasks, Lambda);
+}
+
+void SimbodyMatterSubsystem::
+solveM(const State& s, const Vector& f, Vector& udot) const 
+{   getRep().solveWithMassMatrixFactorization(s, f, udot); }
+
+void SimbodyMatterSubsystem::
+solveM(const State& s, const Matrix& F, Matrix& Udot) const {
+    Udot.resize(F.nrow(), F.ncol());
+    Vector udot;
+    for (int j=0; j < F.ncol(); ++j) {
+        getRep().solveWithMassMatrixFactorization(s, F(j), udot);
+        Udot(j) = udot;
+    }
+}
+
 
 // Note: the implementation methods that generate matrices do *not* require 
 // contiguous storage, so we can just forward to them with no preliminaries.
@@ -1875,7 +2215,7 @@ void SimbodyMatterSubsystem::calcBiasForFrameJacobian
 
 void SimbodyMatterSubsystem::calcCompositeBodyInertias
    (const State& s, Array_<SpatialInertia,MobilizedBodyIndex>& R) const
-{   getRep().calcCompositeBodyInertias(s,R); }
+{   R = getRep().getCompositeBodyInertias(s); } // cached until q changes
 
 void SimbodyMatterSubsystem::calcTreeEquivalentMobilityForces
    (const State& s, const Vector_<SpatialVec>& bodyForces, 
@@ -1889,6 +2229,10 @@ void SimbodyMatterSubsystem::calcMobilizerReactionForces
    (const State& s, Vector_<SpatialVec>& forces) const 
 {   getRep().calcMobilizerReactionForces(s, forces); }
 
+const Vector_<SpatialVec>& SimbodyMatterSubsystem::
+getMobilizerReactionForces(const State& s) const 
+{   return getRep().getMobilizerReactionForces(s); }
+
 const Vector& SimbodyMatterSubsystem::
 getMotionMultipliers(const State& s) const 
 {   return getRep().getMotionMultipliers(s); }
@@ -2157,6 +2501,204 @@ void SimbodyMatterSubsystem::addInMobilityForce(const State& s, MobilizedBodyInd
     mobilityForces[uStart+which] += d;
 }
 
+
+
+//==============================================================================
+//                      BATCHED EVALUATION AT MANY STATES
+//==============================================================================
+// These check the arguments, size the outputs, and then let the Rep's 
+// evaluateForStates() driver run the single-State operator for each sample.
+// Each sample writes only its own column of the output.
+
+void SimbodyMatterSubsystem::multiplyByMForStates(const State&  state,
+                                                  const Matrix& q,
+                                                  const Matrix& a,
+                                                  Matrix&       Ma) const
+{
+    const char* method = "SimbodyMatterSubsystem::multiplyByMForStates()";
+    const SimbodyMatterSubsystemRep& rep = getRep();
+    SimTK_ERRCHK4_ALWAYS(a.nrow()==rep.getNU(state) && a.ncol()==q.ncol(),
+        method, "Argument 'a' was %dx%d but should have one row per mobility"
+        " (%d) and one column per sample (%d).", 
+        a.nrow(), a.ncol(), rep.getNU(state), q.ncol());
+
+    Ma.resize(a.nrow(), a.ncol());
+    rep.evaluateForStates(state, method, q, 0, Stage::Position,
+        [&](const State& s, int k) {
+            VectorView Ma_k = Ma(k);
+            multiplyByM(s, a(k), Ma_k);
+        });
+}
+
+void SimbodyMatterSubsystem::multiplyByMInvForStates(const State&   state,
+                                                     const Matrix&  q,
+                                                     const Matrix&  v,
+                                                     Matrix&        MInvV) const
+{
+    const char* method = "SimbodyMatterSubsystem::multiplyByMInvForStates()";
+    const SimbodyMatterSubsystemRep& rep = getRep();
+    SimTK_ERRCHK4_ALWAYS(v.nrow()==rep.getNU(state) && v.ncol()==q.ncol(),
+        method, "Argument 'v' was %dx%d but should have one row per mobility"
+        " (%d) and one column per sample (%d).", 
+        v.nrow(), v.ncol(), rep.getNU(state), q.ncol());
+
+    MInvV.resize(v.nrow(), v.ncol());
+    rep.evaluateForStates(state, method, q, 0, Stage::Position,
+        [&](const State& s, int k) {
+            VectorView MInvV_k = MInvV(k);
+            multiplyByMInv(s, v(k), MInvV_k);
+        });
+}
+
+// The tree sweeps work on raw pointers, so they need each column
+// in contiguous memory. Return the given matrix if that is already true (the
+// usual case), otherwise a column-ordered copy.
+template <class E> static const Matrix_<E>& 
+contiguousColumns(const Matrix_<E>& m, Matrix_<E>& copy) {
+    if (m.ncol()==0 || m(0).hasContiguousData())
+        return m;
+    copy.resize(m.nrow(), m.ncol());
+    for (int j=0; j < m.ncol(); ++j)
+        copy(j) = m(j);
+    return copy;
+}
+
+void SimbodyMatterSubsystem::calcAccelerationIgnoringConstraintsForStates
+   (const State&                state,
+    const Matrix&               q,
+    const Matrix&               u,
+    const Matrix&               appliedMobilityForces,
+    const Matrix_<SpatialVec>&  appliedBodyForces,
+    Matrix&                     udot) const
+{
+    const char* method = 
+        "SimbodyMatterSubsystem::calcAccelerationIgnoringConstraintsForStates()";
+    const SimbodyMatterSubsystemRep& rep = getRep();
+    const int nu = rep.getNU(state), nb = rep.getNumBodies();
+    const int nSamples = q.ncol();
+    const Matrix&              f = appliedMobilityForces;
+    const Matrix_<SpatialVec>& F = appliedBodyForces;
+    SimTK_ERRCHK4_ALWAYS(f.ncol()==0 || (f.nrow()==nu && f.ncol()==nSamples),
+        method, "Argument 'appliedMobilityForces' was %dx%d but should be "
+        "empty or have one row per mobility (%d) and one column per sample "
+        "(%d).", f.nrow(), f.ncol(), nu, nSamples);
+    SimTK_ERRCHK4_ALWAYS(F.ncol()==0 || (F.nrow()==nb && F.ncol()==nSamples),
+        method, "Argument 'appliedBodyForces' was %dx%d but should be "
+        "empty or have one row per body (%d) and one column per sample "
+        "(%d).", F.nrow(), F.ncol(), nb, nSamples);
+
+    const Matrix              noMobilityForces(nu, 1, Real(0));
+    const Matrix_<SpatialVec> noBodyForces(nb, 1, SpatialVec(Vec3(0),Vec3(0)));
+    Matrix fCopy; Matrix_<SpatialVec> FCopy;
+    const Matrix& mobForces = f.ncol() ? contiguousColumns(f, fCopy) 
+                                       : noMobilityForces;
+    const Matrix_<SpatialVec>& bodyForces = 
+        F.ncol() ? contiguousColumns(F, FCopy) : noBodyForces;
+
+    // The articulated body sweeps need the whole system realized through
+    // Dynamics stage, but they use only the forces passed in here.
+    udot.resize(nu, nSamples);
+    rep.evaluateForStates(state, method, q, &u, Stage::Dynamics,
+        [&](const State& s, int k) {
+            SBOperatorWorkspace& ws = rep.updOperatorWorkspace(s);
+            rep.calcTreeAccelerations(s, mobForces(f.ncol() ? k : 0),
+                bodyForces(F.ncol() ? k : 0), 
+                rep.getDynamicsCache(s).presUDotPool,
+                ws.treeHingeForces, ws.treeZ, ws.treeZPlus, 
+                ws.treeBodyAccelerations, ws.treeUDot, ws.treeQDotDot, 
+                ws.treePresForces);
+            udot(k) = ws.treeUDot;
+        });
+}
+
+void SimbodyMatterSubsystem::calcStationLocationsForStates
+   (const State&                        state,
+    const Matrix&                       q,
+    const Array_<MobilizedBodyIndex>&   onBodyB,
+    const Array_<Vec3>&                 stationPinB,
+    Matrix_<Vec3>&                      locationsInG) const
+{
+    const char* method = 
+        "SimbodyMatterSubsystem::calcStationLocationsForStates()";
+    const int nStations = (int)onBodyB.size();
+    SimTK_ERRCHK2_ALWAYS((int)stationPinB.size() == nStations, method,
+        "The number of bodies (%d) must match the number of stations (%d).",
+        nStations, (int)stationPinB.size());
+
+    locationsInG.resize(nStations, q.ncol());
+    getRep().evaluateForStates(state, method, q, 0, Stage::Position,
+        [&](const State& s, int k) {
+            for (int i=0; i < nStations; ++i)
+                locationsInG(i,k) = getMobilizedBody(onBodyB[i])
+                    .findStationLocationInGround(s, stationPinB[i]);
+        });
+}
+
+// Only the kinematics needed for the inverse dynamics sweeps are realized 
+// for each frame. Missing force matrices are replaced by a single zero column
+// so that no frame needs to allocate anything.
+void SimbodyMatterSubsystem::calcResidualForceIgnoringConstraintsForStates
+   (const State&                state,
+    const Matrix&               q,
+    const Matrix&               u,
+    const Matrix&               knownUdot,
+    const Matrix&               appliedMobilityForces,
+    const Matrix_<SpatialVec>&  appliedBodyForces,
+    Matrix&                     residualMobilityForces) const
+{
+    const char* method = "SimbodyMatterSubsystem::"
+                         "calcResidualForceIgnoringConstraintsForStates()";
+    const SimbodyMatterSubsystemRep& rep = getRep();
+    const int nu = rep.getNU(state), nb = rep.getNumBodies();
+    const int nFrames = q.ncol();
+    const Matrix&              f = appliedMobilityForces;
+    const Matrix_<SpatialVec>& F = appliedBodyForces;
+    SimTK_ERRCHK4_ALWAYS(knownUdot.nrow()==nu && knownUdot.ncol()==nFrames,
+        method, "Argument 'knownUdot' was %dx%d but should have one row per "
+        "mobility (%d) and one column per sample (%d).", 
+        knownUdot.nrow(), knownUdot.ncol(), nu, nFrames);
+    SimTK_ERRCHK4_ALWAYS(f.ncol()==0 || (f.nrow()==nu && f.ncol()==nFrames),
+        method, "Argument 'appliedMobilityForces' was %dx%d but should be "
+        "empty or have one row per mobility (%d) and one column per sample "
+        "(%d).", f.nrow(), f.ncol(), nu, nFrames);
+    SimTK_ERRCHK4_ALWAYS(F.ncol()==0 || (F.nrow()==nb && F.ncol()==nFrames),
+        method, "Argument 'appliedBodyForces' was %dx%d but should be "
+        "empty or have one row per body (%d) and one column per sample "
+        "(%d).", F.nrow(), F.ncol(), nb, nFrames);
+
+    const Matrix              noMobilityForces(nu, 1, Real(0));
+    const Matrix_<SpatialVec> noBodyForces(nb, 1, SpatialVec(Vec3(0),Vec3(0)));
+    Matrix fCopy, udotCopy; Matrix_<SpatialVec> FCopy;
+    const Matrix& mobForces = f.ncol() ? contiguousColumns(f, fCopy) 
+                                       : noMobilityForces;
+    const Matrix_<SpatialVec>& bodyForces = 
+        F.ncol() ? contiguousColumns(F, FCopy) : noBodyForces;
+    const Matrix& udot = contiguousColumns(knownUdot, udotCopy);
+
+    residualMobilityForces.resize(nu, nFrames);
+    Matrix residCopy;
+    const bool copyBack = 
+        nFrames && !residualMobilityForces(0).hasContiguousData();
+    if (copyBack) residCopy.resize(nu, nFrames);
+    Matrix& resid = copyBack ? residCopy : residualMobilityForces;
+
+    rep.evaluateForStatesUsing(state, method, q, &u,
+        [&](const State& s) {
+            rep.realizePositionKinematics(s);
+            rep.realizeVelocityKinematics(s);
+        },
+        [&](const State& s, int k) {
+            VectorView resid_k = resid(k);
+            rep.calcTreeResidualForces(s, mobForces(f.ncol() ? k : 0), 
+                bodyForces(F.ncol() ? k : 0), udot(k), 
+                rep.updOperatorWorkspace(s).residualBodyAccelerations, 
+                resid_k);
+        });
+
+    if (copyBack)
+        residualMobilityForces = residCopy;
+}
+
 Vector_<Vec3>& SimbodyMatterSubsystem::updAllParticleLocations(State& s) const {
     return getRep().updAllParticleLocations(s);
 }
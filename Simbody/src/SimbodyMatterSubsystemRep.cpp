@@ -25,8 +25,10 @@
 
 #include "SimTKcommon.h"
 #include "SimTKmath.h"
+#include "SimTKlapack.h"
 #include "simbody/internal/common.h"
 #include "simbody/internal/ConditionalConstraint.h"
+#include "simbody/internal/TaskJacobianPlan.h"
 
 #include "SimbodyMatterSubsystemRep.h"
 #include "SimbodyTreeState.h"
@@ -37,6 +39,9 @@
 
 #include <string>
 #include <iostream>
+#include <queue>
+#include <typeinfo>
+#include <algorithm>
 using std::cout; using std::endl;
 
 SimbodyMatterSubsystemRep::SimbodyMatterSubsystemRep
@@ -102,6 +107,10 @@ void SimbodyMatterSubsystemRep::clearTopologyCache() {
     // be deleted when the MobilizedBodyImpl objects are.
     rbNodeLevels.clear();
     nodeNum2NodeMap.clear();
+    rbTrunkNodes.clear();
+    rbNodePartitions.clear();
+    rbNodeLevelsByType.clear();
+    rbNodeRunStarts.clear();
 
     showDefaultGeometry = true;
 }
@@ -291,6 +300,9 @@ void SimbodyMatterSubsystemRep::endConstruction(State& s) {
         DOFTotal += ndof; SqDOFTotal += ndof*ndof;
         maxNQTotal += n.getMaxNQ();
     }
+
+    partitionTreeForParallelSweeps();
+    groupNodesByTypeForBatching();
     
     // Order doesn't matter for constraints as long as the bodies are already 
     // there. Quaternion normalization constraints exist only at the 
@@ -329,6 +341,216 @@ void SimbodyMatterSubsystemRep::endConstruction(State& s) {
     }
 }
 
+//==============================================================================
+//                   PARTITION TREE FOR PARALLEL SWEEPS
+//==============================================================================
+// Split the tree into a serial trunk and a set of balanced partitions of 
+// independent subtrees. We start with each base body's subtree as a unit, then
+// repeatedly break up the largest unit by moving its root body into the trunk
+// and making each of its children's subtrees a unit of its own, until no unit 
+// is big enough to dominate a sweep. That handles both "many branches off
+// Ground" (nothing to split) and "one free base body with many limbs" (the
+// base goes to the trunk). The units are then dealt out largest-first to the
+// least-loaded partition. Everything here depends only on the topology and 
+// the thread count, so the assignment (and hence the order of every 
+// calculation) is reproducible.
+void SimbodyMatterSubsystemRep::partitionTreeForParallelSweeps() {
+    rbTrunkNodes.clear();
+    rbNodePartitions.clear();
+
+    const int nb = getNumMobilizedBodies();
+    if (nb == 0)
+        return;
+
+    // Number of bodies in the subtree rooted at each body, including itself.
+    Array_<int,MobilizedBodyIndex> subtreeSize(nb, 1);
+    for (int i=(int)rbNodeLevels.size()-1; i > 0; --i)
+        for (int j=0; j < (int)rbNodeLevels[i].size(); ++j) {
+            const RigidBodyNode& node = *rbNodeLevels[i][j];
+            subtreeSize[node.getParent()->getNodeNum()] += 
+                subtreeSize[node.getNodeNum()];
+        }
+
+    const int nThreads = std::max(1, treeSweepExecutor->getMaxThreads());
+    const int maxUnitSize = std::max(1, nb/(2*nThreads));
+
+    // Priority is (size, -index) so that ties are broken consistently.
+    typedef std::pair<int,int> Unit;
+    std::priority_queue<Unit> units;
+    Array_<bool,MobilizedBodyIndex> isTrunk(nb, false);
+    const RigidBodyNode& ground = *rbNodeLevels[0][0];
+    isTrunk[ground.getNodeNum()] = true;
+    for (int c=0; c < ground.getNumChildren(); ++c) {
+        const MobilizedBodyIndex mbx = ground.getChild(c)->getNodeNum();
+        units.push(Unit(subtreeSize[mbx], -mbx));
+    }
+    while (!units.empty() && units.top().first > maxUnitSize) {
+        const MobilizedBodyIndex mbx(-units.top().second);
+        units.pop();
+        isTrunk[mbx] = true;
+        const RigidBodyNode& node = getRigidBodyNode(mbx);
+        for (int c=0; c < node.getNumChildren(); ++c) {
+            const MobilizedBodyIndex child = node.getChild(c)->getNodeNum();
+            units.push(Unit(subtreeSize[child], -child));
+        }
+    }
+
+    const int nPartitions = std::min((int)units.size(), 2*nThreads);
+    Array_<int,MobilizedBodyIndex> partitionOf(nb, -1);
+    if (nPartitions > 1) {
+        Array_<int> load(nPartitions, 0);
+        while (!units.empty()) { // largest first
+            const int p = (int)(std::min_element(load.begin(), load.end()) 
+                                - load.begin());
+            load[p] += units.top().first;
+            partitionOf[MobilizedBodyIndex(-units.top().second)] = p;
+            units.pop();
+        }
+        rbNodePartitions.resize(nPartitions);
+    }
+
+    // Fill in the node lists in level order. A non-trunk body that wasn't
+    // assigned a partition above belongs to its parent's partition.
+    for (int i=0; i < (int)rbNodeLevels.size(); ++i)
+        for (int j=0; j < (int)rbNodeLevels[i].size(); ++j) {
+            const RigidBodyNode* node = rbNodeLevels[i][j];
+            const MobilizedBodyIndex mbx = node->getNodeNum();
+            if (isTrunk[mbx] || nPartitions <= 1) {
+                rbTrunkNodes.push_back(node);
+                continue;
+            }
+            if (partitionOf[mbx] < 0)
+                partitionOf[mbx] = partitionOf[node->getParent()->getNodeNum()];
+            rbNodePartitions[partitionOf[mbx]].push_back(node);
+        }
+}
+
+template <class Visitor> void SimbodyMatterSubsystemRep::
+sweepOutward(const Visitor& visit) const {
+    if (!useParallelTreeSweeps || rbNodePartitions.size() < 2) {
+        for (int i=0 ; i<(int)rbNodeLevels.size() ; ++i) 
+            for (int j=0 ; j<(int)rbNodeLevels[i].size() ; ++j)
+                visit(*rbNodeLevels[i][j]);
+        return;
+    }
+
+    for (const RigidBodyNode* node : rbTrunkNodes)
+        visit(*node);
+    treeSweepExecutor->parallelFor(0, (int)rbNodePartitions.size(), 
+        [&](int p) {
+            for (const RigidBodyNode* node : rbNodePartitions[p])
+                visit(*node);
+        });
+}
+
+template <class Visitor> void SimbodyMatterSubsystemRep::
+sweepInward(const Visitor& visit) const {
+    if (!useParallelTreeSweeps || rbNodePartitions.size() < 2) {
+        for (int i=(int)rbNodeLevels.size()-1 ; i>=0 ; --i) 
+            for (int j=0 ; j<(int)rbNodeLevels[i].size() ; ++j)
+                visit(*rbNodeLevels[i][j]);
+        return;
+    }
+
+    treeSweepExecutor->parallelFor(0, (int)rbNodePartitions.size(), 
+        [&](int p) {
+            const RBNodePtrList& nodes = rbNodePartitions[p];
+            for (int k=(int)nodes.size()-1; k >= 0; --k)
+                visit(*nodes[k]);
+        });
+    for (int k=(int)rbTrunkNodes.size()-1; k >= 0; --k)
+        visit(*rbTrunkNodes[k]);
+}
+
+//==============================================================================
+//                     GROUP NODES BY TYPE FOR BATCHING
+//==============================================================================
+// Nodes on the same level don't depend on one another so we're free to 
+// process them in any order. Here we reorder each level so that nodes of 
+// exactly the same concrete type (mobilizer, reversal, and frame 
+// specializations) are contiguous, keeping the types in order of first 
+// appearance and the nodes within a type in their original order so the 
+// result is reproducible.
+void SimbodyMatterSubsystemRep::groupNodesByTypeForBatching() {
+    const int nLevels = (int)rbNodeLevels.size();
+    rbNodeLevelsByType.clear(); rbNodeLevelsByType.resize(nLevels);
+    rbNodeRunStarts.clear();    rbNodeRunStarts.resize(nLevels);
+
+    for (int i=0; i < nLevels; ++i) {
+        const RBNodePtrList& level = rbNodeLevels[i];
+        Array_<const std::type_info*>   types;
+        Array_<RBNodePtrList>           nodesOfType;
+        for (const RigidBodyNode* node : level) {
+            const std::type_info& type = typeid(*node);
+            int t = 0;
+            while (t < (int)types.size() && *types[t] != type)
+                ++t;
+            if (t == (int)types.size()) {
+                types.push_back(&type);
+                nodesOfType.push_back();
+            }
+            nodesOfType[t].push_back(node);
+        }
+        for (const RBNodePtrList& run : nodesOfType) {
+            rbNodeRunStarts[i].push_back((int)rbNodeLevelsByType[i].size());
+            rbNodeLevelsByType[i].insert(rbNodeLevelsByType[i].end(),
+                                         run.begin(), run.end());
+        }
+        rbNodeRunStarts[i].push_back((int)rbNodeLevelsByType[i].size());
+    }
+}
+
+// In the parallel case each partition's nodes are in level order but not 
+// grouped, so we just hand them over one at a time.
+template <class BatchVisitor> void SimbodyMatterSubsystemRep::
+sweepOutwardBatched(const BatchVisitor& visitRun) const {
+    if (!useParallelTreeSweeps || rbNodePartitions.size() < 2) {
+        for (int i=0 ; i<(int)rbNodeLevelsByType.size() ; ++i) {
+            const RBNodePtrList& nodes = rbNodeLevelsByType[i];
+            const Array_<int>&   runs  = rbNodeRunStarts[i];
+            for (int r=0; r < (int)runs.size()-1; ++r)
+                visitRun(&nodes[runs[r]], runs[r+1]-runs[r]);
+        }
+        return;
+    }
+
+    sweepOutward([&](const RigidBodyNode& node) {
+        const RigidBodyNode* const p = &node;
+        visitRun(&p, 1);
+    });
+}
+
+//==============================================================================
+//                          FOR EACH CONSTRAINT BLOCK
+//==============================================================================
+// Evaluating a single Constraint's errors or forces is cheap, so we don't 
+// bother going parallel unless each block gets at least this many.
+static const int MinConstraintsPerBlock = 16;
+
+int SimbodyMatterSubsystemRep::getNumConstraintBlocks() const {
+    const int nc = (int)constraints.size();
+    if (!useParallelConstraintEvaluation || nc < 2*MinConstraintsPerBlock)
+        return 1;
+    const int nThreads = std::max(1, treeSweepExecutor->getMaxThreads());
+    return std::min(nc/MinConstraintsPerBlock, 2*nThreads);
+}
+
+template <class Visitor> void SimbodyMatterSubsystemRep::
+forEachConstraintBlock(const Visitor& visit) const {
+    const int nc      = (int)constraints.size();
+    const int nBlocks = getNumConstraintBlocks();
+    if (nBlocks == 1) {
+        visit(0, ConstraintIndex(0), ConstraintIndex(nc));
+        return;
+    }
+
+    treeSweepExecutor->parallelFor(0, nBlocks, 
+        [&](int b) {
+            visit(b, ConstraintIndex((b*nc)/nBlocks), 
+                     ConstraintIndex(((b+1)*nc)/nBlocks));
+        });
+}
+
 int SimbodyMatterSubsystemRep::realizeSubsystemTopologyImpl(State& s) const {
     SimTK_STAGECHECK_EQ_ALWAYS(getStage(s), Stage::Empty, 
         "SimbodyMatterSubsystem::realizeTopology()");
@@ -419,6 +641,30 @@ int SimbodyMatterSubsystemRep::realizeSubsystemTopologyImpl(State& s) const {
         {CacheEntryKey(getMySubsystemIndex(), tc.treePositionCacheIndex)},
         new Value<SBArticulatedBodyInertiaCache>());
 
+    // The mass matrix (dense and sparse), its factorization, and its inverse
+    // are formed only on request but then reused until the positions change;
+    // see calcM(), calcMInv(), and getMassMatrixFactorization().
+    tc.massMatrixCacheIndex = s.allocateCacheEntryWithPrerequisites
+       (getMySubsystemIndex(), Stage::Instance, Stage::Infinity,
+        false /*q*/, false /*u*/, false /*z*/, {} /*dv*/, 
+        {CacheEntryKey(getMySubsystemIndex(), tc.treePositionCacheIndex)},
+        new Value<Matrix>());
+    tc.massMatrixInverseCacheIndex = s.allocateCacheEntryWithPrerequisites
+       (getMySubsystemIndex(), Stage::Instance, Stage::Infinity,
+        false /*q*/, false /*u*/, false /*z*/, {} /*dv*/, 
+        {CacheEntryKey(getMySubsystemIndex(), tc.treePositionCacheIndex)},
+        new Value<Matrix>());
+    tc.sparseMassMatrixCacheIndex = s.allocateCacheEntryWithPrerequisites
+       (getMySubsystemIndex(), Stage::Instance, Stage::Infinity,
+        false /*q*/, false /*u*/, false /*z*/, {} /*dv*/, 
+        {CacheEntryKey(getMySubsystemIndex(), tc.treePositionCacheIndex)},
+        new Value<SBSparseMassMatrix>());
+    tc.massMatrixFactorizationCacheIndex = s.allocateCacheEntryWithPrerequisites
+       (getMySubsystemIndex(), Stage::Instance, Stage::Infinity,
+        false /*q*/, false /*u*/, false /*z*/, {} /*dv*/, 
+        {CacheEntryKey(getMySubsystemIndex(), tc.treePositionCacheIndex)},
+        new Value<SBSparseMassMatrix>());
+
     // Basic tree velocity kinematics can be calculated any time after Instance
     // stage, provided PositionKinematics have been realized, or unconditionally
     // after stage Position. These should be filled in first during 
@@ -455,6 +701,57 @@ int SimbodyMatterSubsystemRep::realizeSubsystemTopologyImpl(State& s) const {
                        tc.articulatedBodyInertiaCacheIndex)},
         new Value<SBArticulatedBodyVelocityCache>());
 
+    // The factored G*M^-1*~G matrix is only calculated when needed, and is
+    // then reused until time, q, or an Instance-stage variable changes. It 
+    // must also be recalculated when u changes if any constraint could
+    // produce nonholonomic or acceleration-only equations since their G rows
+    // may depend on u. See SBConstraintFactorizationCache.
+    bool gDependsOnU = false;
+    for (ConstraintIndex cx(0); cx < getNumConstraints(); ++cx) {
+        int mp, mv, ma;
+        getConstraint(cx).getImpl().getDefaultNumConstraintEquations(mp,mv,ma);
+        if (mv || ma) {gDependsOnU = true; break;}
+    }
+    tc.constraintFactorizationCacheIndex = 
+        s.allocateCacheEntryWithPrerequisites
+       (getMySubsystemIndex(), Stage::Time, Stage::Infinity,
+        true /*q*/, gDependsOnU /*u*/, false /*z*/, {} /*dv*/, {} /*ce*/,
+        new Value<SBConstraintFactorizationCache>());
+
+    // The diagonal of G*M^-1*~G, used to precondition the iterative 
+    // multiplier solver, has the same dependencies as its factorization.
+    tc.multiplierPreconditionerCacheIndex = 
+        s.allocateCacheEntryWithPrerequisites
+       (getMySubsystemIndex(), Stage::Time, Stage::Infinity,
+        true /*q*/, gDependsOnU /*u*/, false /*z*/, {} /*dv*/, {} /*ce*/,
+        new Value<Vector>());
+
+    // Multipliers from the most recent solve, which are the starting guess
+    // for the next iterative one. This survives changes to q and u but not
+    // to Instance-stage variables; see SBMultiplierWarmStartCache.
+    tc.multiplierWarmStartCacheIndex = 
+        allocateLazyCacheEntry(s, Stage::Instance, 
+                               new Value<SBMultiplierWarmStartCache>());
+
+    // Scratch space for the acceleration operators; also never valid.
+    tc.operatorWorkspaceCacheIndex = 
+        allocateLazyCacheEntry(s, Stage::Instance, 
+                               new Value<SBOperatorWorkspace>());
+
+    // The q's at which the TreePositionCache was last calculated, for
+    // incremental position kinematics. This survives changes to q but not
+    // to Instance-stage variables.
+    tc.positionKinematicsRecordCacheIndex = 
+        allocateLazyCacheEntry(s, Stage::Instance, 
+                               new Value<SBPositionKinematicsRecord>());
+
+    // Factorizations left by the last projections, which may be reused by 
+    // later ones at different q's and u's. This survives changes to q and u
+    // but not to Instance-stage variables.
+    tc.projectionFactorizationCacheIndex = 
+        allocateLazyCacheEntry(s, Stage::Instance, 
+                               new Value<SBProjectionFactorizationCache>());
+
     tc.dynamicsCacheIndex = 
         allocateCacheEntry(s, Stage::Dynamics, 
                            new Value<SBDynamicsCache>());
@@ -477,6 +774,12 @@ int SimbodyMatterSubsystemRep::realizeSubsystemTopologyImpl(State& s) const {
         allocateLazyCacheEntry(s, Stage::Dynamics,
                                new Value<SBConstrainedAccelerationCache>());
 
+    // Mobilizer reaction forces are derived from the acceleration results but
+    // are not needed internally, so we calculate them only if someone asks.
+    tc.mobilizerReactionForcesCacheIndex =
+        allocateLazyCacheEntry(s, Stage::Acceleration,
+                               new Value< Vector_<SpatialVec> >());
+
     tc.valid = true;
 
     // Allocate a cache entry for the topologyCache, and save a copy there.
@@ -968,6 +1271,7 @@ realizeSubsystemInstanceImpl(const State& s) const {
     for (ConstraintIndex cx(0); cx < constraints.size(); ++cx)
         getConstraint(cx).getImpl().realizeInstance(s);
 
+    calcConstraintCouplingStructure(ic);
 
     // Quaternion errors are located after last holonomic constraint error; 
     // see diagram above.
@@ -1000,6 +1304,7 @@ realizeSubsystemInstanceImpl(const State& s) const {
     updDynamicsCache(s).allocate(topologyCache, mc, ic);
     updTreeAccelerationCache(s).allocate(topologyCache, mc, ic);
     updConstrainedAccelerationCache(s).allocate(topologyCache, mc, ic);
+    updMultiplierWarmStartCache(s).allocate(topologyCache, mc, ic);
 
     // Now let the implementing RigidBodyNodes do their realization.
     SBStateDigest stateDigest(s, *this, Stage::Instance);
@@ -1012,6 +1317,157 @@ realizeSubsystemInstanceImpl(const State& s) const {
 
 
 
+//==============================================================================
+//                   CALC CONSTRAINT COUPLING STRUCTURE
+//==============================================================================
+// Ground is immobile so M^-1 is block diagonal, with one block for each 
+// subtree rooted at a base body. A Constraint's rows of G and columns of ~G 
+// involve only mobilities on the paths from its constrained bodies and 
+// constrained mobilizers to Ground, so block (i,j) of G*M^-1*~G can be 
+// nonzero only if Constraints i and j reach a common base body. We record
+// that coupling here, then color the Constraints greedily so that no two 
+// Constraints of the same color are coupled to a common Constraint (a 
+// distance-2 coloring), and choose a reverse Cuthill-McKee ordering of the
+// multipliers to keep the profile of a sparse Cholesky factor small.
+// For lattices and other systems built from many small subtrees the number
+// of colors is independent of the number of Constraints.
+void SimbodyMatterSubsystemRep::
+calcConstraintCouplingStructure(SBInstanceCache& ic) const {
+    const int nc = getNumConstraints();
+    const int nb = getNumBodies();
+
+    // Find the base body of each mobilized body other than Ground.
+    Array_<MobilizedBodyIndex,MobilizedBodyIndex> baseOf(nb);
+    for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx) {
+        const RigidBodyNode* node = &getRigidBodyNode(mbx);
+        while (!node->isBaseNode()) node = node->getParent();
+        baseOf[mbx] = node->getNodeNum();
+    }
+
+    // Find the Constraints that reach each base body.
+    Array_<Array_<ConstraintIndex>,MobilizedBodyIndex> constraintsOnBase(nb);
+    Array_<Array_<MobilizedBodyIndex>,ConstraintIndex> basesOfConstraint(nc);
+    for (ConstraintIndex cx(0); cx < nc; ++cx) {
+        if (ic.getNumConstraintEquationsInUse(cx) == 0) continue;
+        const ConstraintImpl& crep = getConstraint(cx).getImpl();
+        Array_<MobilizedBodyIndex>& bases = basesOfConstraint[cx];
+        for (ConstrainedBodyIndex cbx(0); 
+             cbx < crep.getNumConstrainedBodies(); ++cbx) {
+            const MobilizedBodyIndex mbx = 
+                crep.getMobilizedBodyIndexOfConstrainedBody(cbx);
+            if (mbx != GroundIndex) bases.push_back(baseOf[mbx]);
+        }
+        for (ConstrainedMobilizerIndex cmx(0); 
+             cmx < crep.getNumConstrainedMobilizers(); ++cmx) {
+            const MobilizedBodyIndex mbx = 
+                crep.getMobilizedBodyIndexOfConstrainedMobilizer(cmx);
+            if (mbx != GroundIndex) bases.push_back(baseOf[mbx]);
+        }
+        std::sort(bases.begin(), bases.end());
+        bases.erase(std::unique(bases.begin(), bases.end()), bases.end());
+        for (unsigned i=0; i < bases.size(); ++i)
+            constraintsOnBase[bases[i]].push_back(cx);
+    }
+
+    // Two Constraints are coupled if they share a base body. A Constraint 
+    // is always coupled to itself, even if it involves only Ground.
+    Array_<int,ConstraintIndex> mark(nc, -1);
+    for (ConstraintIndex cx(0); cx < nc; ++cx) {
+        if (ic.getNumConstraintEquationsInUse(cx) == 0) continue;
+        Array_<ConstraintIndex>& coupled = ic.coupledConstraints[cx];
+        coupled.push_back(cx); mark[cx] = cx;
+        const Array_<MobilizedBodyIndex>& bases = basesOfConstraint[cx];
+        for (unsigned i=0; i < bases.size(); ++i) {
+            const Array_<ConstraintIndex>& onBase = constraintsOnBase[bases[i]];
+            for (unsigned j=0; j < onBase.size(); ++j)
+                if (mark[onBase[j]] != cx) 
+                {   coupled.push_back(onBase[j]); mark[onBase[j]] = cx; }
+        }
+    }
+
+    // Greedy distance-2 coloring: a Constraint may not share a color with
+    // any Constraint that is coupled to one of its own coupled Constraints.
+    Array_<int,ConstraintIndex> color(nc, -1);
+    Array_<int> forbiddenBy; // color -> last Constraint that ruled it out
+    for (ConstraintIndex cx(0); cx < nc; ++cx) {
+        const Array_<ConstraintIndex>& coupled = ic.coupledConstraints[cx];
+        if (coupled.empty()) continue;
+        for (unsigned i=0; i < coupled.size(); ++i) {
+            const Array_<ConstraintIndex>& coupled2 = 
+                ic.coupledConstraints[coupled[i]];
+            for (unsigned j=0; j < coupled2.size(); ++j)
+                if (color[coupled2[j]] >= 0) 
+                    forbiddenBy[color[coupled2[j]]] = cx;
+        }
+        int k = 0;
+        while (k < (int)forbiddenBy.size() && forbiddenBy[k] == cx) ++k;
+        if (k == (int)forbiddenBy.size()) {
+            forbiddenBy.push_back(-1);
+            ic.constraintColors.push_back(Array_<ConstraintIndex>());
+        }
+        color[cx] = k;
+        ic.constraintColors[k].push_back(cx);
+    }
+
+    // Reverse Cuthill-McKee ordering of the Constraints, starting each 
+    // connected component from a Constraint of least coupling.
+    Array_<ConstraintIndex> byDegree;
+    for (ConstraintIndex cx(0); cx < nc; ++cx)
+        if (!ic.coupledConstraints[cx].empty()) byDegree.push_back(cx);
+    std::stable_sort(byDegree.begin(), byDegree.end(), 
+        [&ic](ConstraintIndex a, ConstraintIndex b) 
+        {   return ic.coupledConstraints[a].size() 
+                   < ic.coupledConstraints[b].size(); });
+
+    Array_<ConstraintIndex> order; order.reserve(byDegree.size());
+    Array_<bool,ConstraintIndex> placed(nc, false);
+    Array_<ConstraintIndex> neighbors;
+    for (unsigned start=0; start < byDegree.size(); ++start) {
+        if (placed[byDegree[start]]) continue;
+        order.push_back(byDegree[start]); placed[byDegree[start]] = true;
+        for (unsigned next=order.size()-1; next < order.size(); ++next) {
+            const Array_<ConstraintIndex>& coupled = 
+                ic.coupledConstraints[order[next]];
+            neighbors.clear();
+            for (unsigned i=0; i < coupled.size(); ++i)
+                if (!placed[coupled[i]]) 
+                {   neighbors.push_back(coupled[i]); placed[coupled[i]]=true; }
+            std::stable_sort(neighbors.begin(), neighbors.end(), 
+                [&ic](ConstraintIndex a, ConstraintIndex b) 
+                {   return ic.coupledConstraints[a].size() 
+                           < ic.coupledConstraints[b].size(); });
+            order.insert(order.end(), neighbors.begin(), neighbors.end());
+        }
+    }
+    std::reverse(order.begin(), order.end());
+
+    // Expand to multipliers; each Constraint's equations stay together.
+    Array_<int,ConstraintIndex> firstRow(nc, -1);
+    for (unsigned i=0; i < order.size(); ++i) {
+        const ConstraintIndex cx = order[i];
+        firstRow[cx] = (int)ic.multiplierOrder.size();
+        for (int k=0; k < ic.getNumConstraintEquationsInUse(cx); ++k)
+            ic.multiplierOrder.push_back(ic.getMultiplierIndex(cx, k));
+    }
+
+    ic.multiplierProfileFirst.resize(ic.multiplierOrder.size());
+    ic.multiplierProfileSize = 0;
+    for (unsigned i=0; i < order.size(); ++i) {
+        const ConstraintIndex cx = order[i];
+        const Array_<ConstraintIndex>& coupled = ic.coupledConstraints[cx];
+        int first = firstRow[cx];
+        for (unsigned j=0; j < coupled.size(); ++j)
+            first = std::min(first, firstRow[coupled[j]]);
+        for (int k=0; k < ic.getNumConstraintEquationsInUse(cx); ++k) {
+            const int row = firstRow[cx] + k;
+            ic.multiplierProfileFirst[row] = first;
+            ic.multiplierProfileSize += row - first + 1;
+        }
+    }
+}
+
+
+
 //==============================================================================
 //                                REALIZE TIME
 //==============================================================================
@@ -1081,20 +1537,24 @@ int SimbodyMatterSubsystemRep::realizeSubsystemPositionImpl(const State& s) cons
         getMobilizedBody(mbx).getImpl().realizePosition(stateDigest);
 
 
-    // Put position constraint equation errors in qErr
+    // Put position constraint equation errors in qErr. Each Constraint writes
+    // only its own segment so blocks of them can be done concurrently.
     Vector& qErr = stateDigest.updQErr();
-    for (ConstraintIndex cx(0); cx < constraints.size(); ++cx) {
-        if (isConstraintDisabled(s,cx))
-            continue;
-        const SBInstancePerConstraintInfo& 
-            cInfo = ic.getConstraintInstanceInfo(cx);
-        const Segment& pseg = cInfo.holoErrSegment;
-        if (pseg.length) {
-            Real* perrp = &qErr[pseg.offset];
-            ArrayView_<Real> perr(perrp, perrp+pseg.length);
-            constraints[cx]->getImpl().calcPositionErrorsFromState(s, perr);
+    forEachConstraintBlock([&](int, ConstraintIndex first, ConstraintIndex last)
+    {
+        for (ConstraintIndex cx = first; cx < last; ++cx) {
+            if (isConstraintDisabled(s,cx))
+                continue;
+            const SBInstancePerConstraintInfo& 
+                cInfo = ic.getConstraintInstanceInfo(cx);
+            const Segment& pseg = cInfo.holoErrSegment;
+            if (pseg.length) {
+                Real* perrp = &qErr[pseg.offset];
+                ArrayView_<Real> perr(perrp, perrp+pseg.length);
+                constraints[cx]->getImpl().calcPositionErrorsFromState(s, perr);
+            }
         }
-    }
+    });
 
     // Now we're done with the ConstrainedPositionCache.
     markCacheValueRealized(s, topologyCache.constrainedPositionCacheIndex);
@@ -1130,9 +1590,22 @@ realizePositionKinematics(const State& state) const {
     // Any body which is using quaternions should calculate the quaternion
     // constraint here and put it in the appropriate slot of qErr.
     // Set generalized coordinates: sweep from base to tips.
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++)
-            rbNodeLevels[i][j]->realizePosition(stateDigest); 
+    if (!(useIncrementalPositionKinematics 
+          && realizeChangedPositionKinematics(state, stateDigest)))
+        sweepOutwardBatched([&](const RigidBodyNode* const* nodes, int n) 
+        {   nodes[0]->realizePositionBatch(stateDigest, nodes, n); });
+
+    // Remember these q's for next time. If we're not doing that, make sure
+    // an old record can't be used should incremental kinematics be turned 
+    // on later.
+    const CacheEntryIndex recx = 
+        topologyCache.positionKinematicsRecordCacheIndex;
+    if (useIncrementalPositionKinematics) {
+        Value<SBPositionKinematicsRecord>::updDowncast
+            (updCacheEntry(state, recx)).upd().q = stateDigest.getQ();
+        markCacheValueRealized(state, recx);
+    } else
+        markCacheValueNotRealized(state, recx);
 
     // Ask the constraints to calculate ancestor-relative kinematics (still 
     // goes in TreePositionCache).
@@ -1143,6 +1616,55 @@ realizePositionKinematics(const State& state) const {
     markCacheValueRealized(state, tpcx);
 }
 
+// If the TreePositionCache was last calculated at q's that differ from the
+// current ones only in the coordinates of a few mobilizers, recalculate just
+// the bodies outboard of those mobilizers, whose entries are the only ones 
+// that can have changed. Return false without doing anything if there is no
+// record of the previous q's or if too many bodies would have to be
+// recalculated for this to be worthwhile; then the caller must do the full
+// sweep. Quaternion errors for the bodies we skip are still in qErr.
+bool SimbodyMatterSubsystemRep::
+realizeChangedPositionKinematics(const State&         state,
+                                 const SBStateDigest& stateDigest) const {
+    const CacheEntryIndex recx = 
+        topologyCache.positionKinematicsRecordCacheIndex;
+    if (!isCacheValueRealized(state, recx))
+        return false;
+
+    SBPositionKinematicsRecord& rec = Value<SBPositionKinematicsRecord>::
+        updDowncast(updCacheEntry(state, recx)).upd();
+    const Vector& q = stateDigest.getQ();
+    if (rec.q.size() != q.size())
+        return false;
+
+    const SBModelVars& mv = stateDigest.getModelVars();
+    const int nb = getNumBodies();
+    rec.mustRecalculate.resize(nb);
+    rec.mustRecalculate[MobilizedBodyIndex(0)] = false; // Ground
+
+    // A body must be recalculated if its own q's changed or its parent's 
+    // must be. Levels are in base-to-tip order so parents are seen first.
+    int nChanged = 0;
+    for (int i=1; i < (int)rbNodeLevels.size(); ++i)
+        for (const RigidBodyNode* node : rbNodeLevels[i]) {
+            bool changed = rec.mustRecalculate[node->getParent()->getNodeNum()];
+            const int qx = node->getQIndex(), nq = node->getNQInUse(mv);
+            for (int k=0; k < nq && !changed; ++k)
+                changed = (q[qx+k] != rec.q[qx+k]);
+            rec.mustRecalculate[node->getNodeNum()] = changed;
+            if (changed) ++nChanged;
+        }
+
+    if (2*nChanged > nb)
+        return false; // cheaper to do them all
+
+    for (int i=1; i < (int)rbNodeLevels.size(); ++i)
+        for (const RigidBodyNode* node : rbNodeLevels[i])
+            if (rec.mustRecalculate[node->getNodeNum()])
+                node->realizePosition(stateDigest);
+    return true;
+}
+
 // Position kinematics is realized only if 
 //  - we are currently at Stage::Position or later
 //      OR
@@ -1238,9 +1760,8 @@ realizeArticulatedBodyInertias(const State& state) const {
     SBArticulatedBodyInertiaCache&  abc = updArticulatedBodyInertiaCache(state);
 
     // tip-to-base sweep
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; --i) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; ++j)
-            rbNodeLevels[i][j]->realizeArticulatedBodyInertiasInward(ic,tpc,abc);
+    sweepInward([&](const RigidBodyNode& node) 
+    {   node.realizeArticulatedBodyInertiasInward(ic,tpc,abc); });
 
     markCacheValueRealized(state, abx);
 }
@@ -1306,29 +1827,33 @@ int SimbodyMatterSubsystemRep::realizeSubsystemVelocityImpl(const State& s) cons
     for (MobilizedBodyIndex mbx(0); mbx < mobilizedBodies.size(); ++mbx)
         getMobilizedBody(mbx).getImpl().realizeVelocity(stateDigest);
 
-    // Put velocity constraint equation errors in uErr
+    // Put velocity constraint equation errors in uErr. As for positions, 
+    // blocks of Constraints can be done concurrently.
     Vector& uErr = stateDigest.updUErr();
-    for (ConstraintIndex cx(0); cx < constraints.size(); ++cx) {
-        if (isConstraintDisabled(s,cx))
-            continue;
-        const SBInstancePerConstraintInfo& 
-            cInfo = ic.getConstraintInstanceInfo(cx);
-
-        const Segment& holoseg    = cInfo.holoErrSegment; // for derivs of holo constraints
-        const Segment& nonholoseg = cInfo.nonholoErrSegment; // includes holo+nonholo
-        const int mHolo = holoseg.length, mNonholo = nonholoseg.length;
-        if (mHolo) {
-            Real* pverrp = &uErr[holoseg.offset];
-            ArrayView_<Real> pverr(pverrp, pverrp+mHolo);
-            constraints[cx]->getImpl().calcPositionDotErrorsFromState(s, pverr);
-        }
-        if (mNonholo) {
-            Real* verrp = &uErr[ic.totalNHolonomicConstraintEquationsInUse 
-                                + nonholoseg.offset];
-            ArrayView_<Real> verr(verrp, verrp+mNonholo);
-            constraints[cx]->getImpl().calcVelocityErrorsFromState(s, verr);
+    forEachConstraintBlock([&](int, ConstraintIndex first, ConstraintIndex last)
+    {
+        for (ConstraintIndex cx = first; cx < last; ++cx) {
+            if (isConstraintDisabled(s,cx))
+                continue;
+            const SBInstancePerConstraintInfo& 
+                cInfo = ic.getConstraintInstanceInfo(cx);
+
+            const Segment& holoseg    = cInfo.holoErrSegment; // for derivs of holo constraints
+            const Segment& nonholoseg = cInfo.nonholoErrSegment; // includes holo+nonholo
+            const int mHolo = holoseg.length, mNonholo = nonholoseg.length;
+            if (mHolo) {
+                Real* pverrp = &uErr[holoseg.offset];
+                ArrayView_<Real> pverr(pverrp, pverrp+mHolo);
+                constraints[cx]->getImpl().calcPositionDotErrorsFromState(s, pverr);
+            }
+            if (mNonholo) {
+                Real* verrp = &uErr[ic.totalNHolonomicConstraintEquationsInUse 
+                                    + nonholoseg.offset];
+                ArrayView_<Real> verr(verrp, verrp+mNonholo);
+                constraints[cx]->getImpl().calcVelocityErrorsFromState(s, verr);
+            }
         }
-    }
+    });
 
     // Now we're done with the ConstrainedVelocityCache.
     markCacheValueRealized(s, topologyCache.constrainedVelocityCacheIndex);
@@ -1374,9 +1899,8 @@ realizeVelocityKinematics(const State& state) const {
     // and all global velocities relative to Ground (G). Also computes qdots.
 
     // Set generalized speeds: sweep from base to tips.
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; ++i) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; ++j)
-            rbNodeLevels[i][j]->realizeVelocity(stateDigest); 
+    sweepOutwardBatched([&](const RigidBodyNode* const* nodes, int n) 
+    {   nodes[0]->realizeVelocityBatch(stateDigest, nodes, n); });
 
     // Ask the constraints to calculate ancestor-relative velocity kinematics 
     // (still goes in TreeVelocityCache).
@@ -1452,11 +1976,11 @@ realizeArticulatedBodyVelocity(const State& state) const {
                                 abvc = updArticulatedBodyVelocityCache(state);
 
     // Order doesn't matter for this calculation. Ground's entries are
-    // precalculated so start at level 1.
-    for (int i=1 ; i<(int)rbNodeLevels.size() ; i++) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++)
-            rbNodeLevels[i][j]->realizeArticulatedBodyVelocityCache
-                                                            (tpc,tvc,abc,abvc);
+    // precalculated so skip level 0.
+    sweepOutward([&](const RigidBodyNode& node) {
+        if (node.getLevel() > 0)
+            node.realizeArticulatedBodyVelocityCache(tpc,tvc,abc,abvc);
+    });
 
     markCacheValueRealized(state, abvx);
 }
@@ -2248,77 +2772,106 @@ calcConstraintForcesFromMultipliers
     bodyForcesInG.resize(getNumBodies()); bodyForcesInG.setToZero();
     mobilityForces.resize(getNU(s));      mobilityForces.setToZero();
 
-    // These Arrays are for one constraint at a time.
-    Array_<Real> lambdap, lambdav, lambdaa; // multipliers
-
-    // Loop over all enabled constraints, ask them to generate forces, and
-    // accumulate the results in the global problem return vectors.
-    for (ConstraintIndex cx(0); cx < constraints.size(); ++cx) {
-        if (isConstraintDisabled(s,cx))
-            continue;
-
-        const ConstraintImpl& crep = constraints[cx]->getImpl();
-
-        // No heap allocation is being done here. These are views directly
-        // into the proper segment of the longer array.
-        ArrayView_<SpatialVec,ConstrainedBodyIndex> bodyF1_G = 
-            crep.updConstrainedBodyForces(s, consBodyForcesInG);
-        ArrayView_<Real,ConstrainedUIndex>          mobilityF1 = 
-            crep.updConstrainedMobilityForces(s, consMobilityForces);
-
-        const int ncb = bodyF1_G.size();
-        const int ncu = mobilityF1.size();
+    // Constraints are processed in blocks, concurrently if parallel constraint
+    // evaluation was requested. Each block has its own temporaries in the
+    // State's workspace to avoid heap allocation. The first block accumulates
+    // forces directly into the return vectors; any others accumulate into 
+    // their own vectors which are then added in block order below so that 
+    // the result doesn't depend on thread scheduling.
+    SBOperatorWorkspace& ws = updOperatorWorkspace(s);
+    const int nBlocks = getNumConstraintBlocks();
+    ws.constraintBlocks.resize(nBlocks);
+
+    forEachConstraintBlock([&](int b, ConstraintIndex first, ConstraintIndex last)
+    {
+        SBConstraintBlockWorkspace& cbw = ws.constraintBlocks[b];
+        Array_<Real>& lambdap = cbw.lambdap; // multipliers for one constraint
+        Array_<Real>& lambdav = cbw.lambdav;
+        Array_<Real>& lambdaa = cbw.lambdaa;
+
+        Vector_<SpatialVec>& bodyF_G   = 
+            b==0 ? bodyForcesInG  : cbw.bodyForcesInG;
+        Vector&              mobilityF = 
+            b==0 ? mobilityForces : cbw.mobilityForces;
+        if (b != 0) {
+            bodyF_G.resize(getNumBodies()); bodyF_G.setToZero();
+            mobilityF.resize(getNU(s));     mobilityF.setToZero();
+        }
 
-        // These have to be zeroed because a Constraint force method is not
-        // *required* to apply forces to all its bodies and mobilities.
-        bodyF1_G.fill(SpatialVec(Vec3(0), Vec3(0)));
-        mobilityF1.fill(Real(0));
+        // Loop over enabled constraints in this block, ask them to generate
+        // forces, and accumulate the results.
+        for (ConstraintIndex cx = first; cx < last; ++cx) {
+            if (isConstraintDisabled(s,cx))
+                continue;
 
-        const SBInstancePerConstraintInfo& 
-                              cInfo = ic.getConstraintInstanceInfo(cx);
+            const ConstraintImpl& crep = constraints[cx]->getImpl();
+
+            // No heap allocation is being done here. These are views directly
+            // into the proper segment of the longer array.
+            ArrayView_<SpatialVec,ConstrainedBodyIndex> bodyF1_G = 
+                crep.updConstrainedBodyForces(s, consBodyForcesInG);
+            ArrayView_<Real,ConstrainedUIndex>          mobilityF1 = 
+                crep.updConstrainedMobilityForces(s, consMobilityForces);
+
+            const int ncb = bodyF1_G.size();
+            const int ncu = mobilityF1.size();
+
+            // These have to be zeroed because a Constraint force method is not
+            // *required* to apply forces to all its bodies and mobilities.
+            bodyF1_G.fill(SpatialVec(Vec3(0), Vec3(0)));
+            mobilityF1.fill(Real(0));
+
+            const SBInstancePerConstraintInfo& 
+                                  cInfo = ic.getConstraintInstanceInfo(cx);
+
+            // Find this Constraint's multipliers within the global array.
+            const Segment& holoSeg    = cInfo.holoErrSegment;
+            const Segment& nonholoSeg = cInfo.nonholoErrSegment;
+            const Segment& accOnlySeg = cInfo.accOnlyErrSegment;
+            const int mp=holoSeg.length, mv=nonholoSeg.length, 
+                      ma=accOnlySeg.length;
+
+            // Pack the multipliers into small arrays lambdap for holonomic 2nd 
+            // derivs, labmdav for nonholonomic 1st derivs, and lambda for
+            // acceleration-only.
+            // Note: these lengths are *very* small integers!
+            lambdap.resize(mp); lambdav.resize(mv); lambdaa.resize(ma);
+            for (int i=0; i<mp; ++i) 
+                lambdap[i] = lambda[                 holoSeg.offset    + i];
+            for (int i=0; i<mv; ++i) 
+                lambdav[i] = lambda[mHolo          + nonholoSeg.offset + i];
+            for (int i=0; i<ma; ++i) 
+                lambdaa[i] = lambda[mHolo+mNonholo + accOnlySeg.offset + i];
+
+            // Generate forces for this Constraint. Body forces will come back
+            // in the A frame; if that's not Ground then we have to re-express
+            // them in Ground before moving on.
+            crep.calcConstraintForcesFromMultipliers
+                            (s, lambdap, lambdav, lambdaa, bodyF1_G, mobilityF1);
+            if (crep.isAncestorDifferentFromGround()) {
+                const Rotation& R_GA = 
+                    crep.getAncestorMobilizedBody().getBodyRotation(s);
+                for (ConstrainedBodyIndex cbx(0); cbx < ncb; ++cbx)
+                    bodyF1_G[cbx] = R_GA*bodyF1_G[cbx];  // 30 flops
+            }
 
-        // Find this Constraint's multipliers within the global array.
-        const Segment& holoSeg    = cInfo.holoErrSegment;
-        const Segment& nonholoSeg = cInfo.nonholoErrSegment;
-        const Segment& accOnlySeg = cInfo.accOnlyErrSegment;
-        const int mp=holoSeg.length, mv=nonholoSeg.length, 
-                  ma=accOnlySeg.length;
-
-        // Pack the multipliers into small arrays lambdap for holonomic 2nd 
-        // derivs, labmdav for nonholonomic 1st derivs, and lambda for
-        // acceleration-only.
-        // Note: these lengths are *very* small integers!
-        lambdap.resize(mp); lambdav.resize(mv); lambdaa.resize(ma);
-        for (int i=0; i<mp; ++i) 
-            lambdap[i] = lambda[                 holoSeg.offset    + i];
-        for (int i=0; i<mv; ++i) 
-            lambdav[i] = lambda[mHolo          + nonholoSeg.offset + i];
-        for (int i=0; i<ma; ++i) 
-            lambdaa[i] = lambda[mHolo+mNonholo + accOnlySeg.offset + i];
-
-        // Generate forces for this Constraint. Body forces will come back
-        // in the A frame; if that's not Ground then we have to re-express
-        // them in Ground before moving on.
-        crep.calcConstraintForcesFromMultipliers
-                        (s, lambdap, lambdav, lambdaa, bodyF1_G, mobilityF1);
-        if (crep.isAncestorDifferentFromGround()) {
-            const Rotation& R_GA = 
-                crep.getAncestorMobilizedBody().getBodyRotation(s);
+            // Unpack constrained body forces and add them to the proper slots 
+            // in the global body forces array. They are already expressed in
+            // the Ground frame.
             for (ConstrainedBodyIndex cbx(0); cbx < ncb; ++cbx)
-                bodyF1_G[cbx] = R_GA*bodyF1_G[cbx];  // 30 flops
-        }
+                bodyF_G[crep.getMobilizedBodyIndexOfConstrainedBody(cbx)] 
+                    += bodyF1_G[cbx];       // 6 flops
 
-        // Unpack constrained body forces and add them to the proper slots 
-        // in the global body forces array. They are already expressed in
-        // the Ground frame.
-        for (ConstrainedBodyIndex cbx(0); cbx < ncb; ++cbx)
-            bodyForcesInG[crep.getMobilizedBodyIndexOfConstrainedBody(cbx)] 
-                += bodyF1_G[cbx];       // 6 flops
+            // Unpack constrained mobility forces and add them into global array.
+            for (ConstrainedUIndex cux(0); cux < ncu; ++cux) 
+                mobilityF[cInfo.getUIndexFromConstrainedU(cux)] 
+                    += mobilityF1[cux];     // 1 flop
+        }
+    });
 
-        // Unpack constrained mobility forces and add them into global array.
-        for (ConstrainedUIndex cux(0); cux < ncu; ++cux) 
-            mobilityForces[cInfo.getUIndexFromConstrainedU(cux)] 
-                += mobilityF1[cux];     // 1 flop
+    for (int b=1; b < nBlocks; ++b) {
+        bodyForcesInG  += ws.constraintBlocks[b].bodyForcesInG;
+        mobilityForces += ws.constraintBlocks[b].mobilityForces;
     }
 }
 
@@ -3470,6 +4023,71 @@ calcPVA(const State&     s,
 
 
 
+// =============================================================================
+//                          VISIT G MInv G^T ENTRIES
+// =============================================================================
+// This is the column-at-a-time calculation described for calcGMInvGt() below,
+// except that we set lambda_j=1 for one equation of every Constraint in a
+// color group at once (see calcConstraintCouplingStructure()). Since no 
+// Constraint is coupled to two Constraints of the same group, each entry of
+// the resulting column belongs to exactly one of the columns we asked for 
+// and we can scatter it to the right place. The bias is the same for every 
+// column because the operators are linear once it is removed.
+template <class Visitor> void SimbodyMatterSubsystemRep::
+visitGMInvGtEntries(const State& s, const Visitor& visit) const {
+    const SBInstanceCache& ic = getInstanceCache(s);
+
+    // Global problem dimensions.
+    const int mHolo    = ic.totalNHolonomicConstraintEquationsInUse;
+    const int mNonholo = ic.totalNNonholonomicConstraintEquationsInUse;
+    const int mAccOnly = ic.totalNAccelerationOnlyConstraintEquationsInUse;
+    const int m        = mHolo+mNonholo+mAccOnly;  
+    const int nu       = getNU(s);
+    if (m==0) return;
+
+    Vector Gtcol(nu), MInvGtcol(nu), GMInvGtcol(m);
+
+    // Precalculate bias so we can perform multiplication by G efficiently.
+    Vector bias(m);
+    calcBiasForMultiplyByPVA(s,true,true,true,bias);
+
+    Vector lambda(m, Real(0));
+    for (unsigned c=0; c < ic.constraintColors.size(); ++c) {
+        const Array_<ConstraintIndex>& group = ic.constraintColors[c];
+        int maxEq = 0;
+        for (unsigned i=0; i < group.size(); ++i)
+            maxEq = std::max(maxEq, ic.getNumConstraintEquationsInUse(group[i]));
+
+        for (int k=0; k < maxEq; ++k) {
+            for (unsigned i=0; i < group.size(); ++i)
+                if (k < ic.getNumConstraintEquationsInUse(group[i]))
+                    lambda[ic.getMultiplierIndex(group[i], k)] = 1;
+
+            multiplyByPVATranspose(s, true, true, true, lambda, Gtcol);
+            multiplyByMInv(s, Gtcol, MInvGtcol);
+            multiplyByPVA(s, true, true, true, bias, MInvGtcol, GMInvGtcol);
+
+            for (unsigned i=0; i < group.size(); ++i) {
+                if (k >= ic.getNumConstraintEquationsInUse(group[i])) continue;
+                const int j = ic.getMultiplierIndex(group[i], k);
+                lambda[j] = 0;
+                const Array_<ConstraintIndex>& coupled = 
+                    ic.coupledConstraints[group[i]];
+                for (unsigned ci=0; ci < coupled.size(); ++ci) {
+                    const ConstraintIndex cx = coupled[ci];
+                    const int mc = ic.getNumConstraintEquationsInUse(cx);
+                    for (int ki=0; ki < mc; ++ki) {
+                        const int row = ic.getMultiplierIndex(cx, ki);
+                        visit(row, j, GMInvGtcol[row]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+
 // =============================================================================
 //                            CALC G MInv G^T
 // =============================================================================
@@ -3495,14 +4113,12 @@ calcPVA(const State&     s,
 // removing the Gp columns of G in the final operation. Note: the resulting
 // matrix is *not* a submatrix of G*M^-1*~G!
 //
-// Note that we do not require contiguous storage for GMInvGt's columns, 
-// although we'll take advantage of it if they are. If not, we'll work in
-// a contiguous temp and then copy back. This is because we want to allow
-// any matrix at the Simbody API level and we don't want to force the API
-// method to have to allocate a whole new mXm matrix when all we need for
-// a temporary here is an m-length temporary.
+// The columns are computed by visitGMInvGtEntries(), which handles a whole 
+// group of uncoupled Constraints with each operator sequence. We only have
+// to zero the result first and scatter the structural nonzeros into it, so
+// we don't need contiguous storage for GMInvGt's columns.
 //
-// Complexity is O(m^2 + m*n) = O(m*n).
+// Complexity is O(m^2 + ncolors*n), which is O(m*n) at worst.
 //
 // TODO: as long as the force transmission matrix for all constraints is G^T
 // the resulting matrix is symmetric. But (a) I don't know how to take 
@@ -3520,81 +4136,387 @@ calcGMInvGt(const State&   s,
     const int mNonholo = ic.totalNNonholonomicConstraintEquationsInUse;
     const int mAccOnly = ic.totalNAccelerationOnlyConstraintEquationsInUse;
     const int m        = mHolo+mNonholo+mAccOnly;  
-    const int nu       = getNU(s);
 
     GMInvGt.resize(m,m);
     if (m==0) return;
 
-    // If the output matrix doesn't have columns in contiguous memory, we'll
-    // allocate a contiguous-memory temp that we can use to hold one column
-    // at a time as we compute them.
-    const bool columnsAreContiguous = GMInvGt(0).hasContiguousData();
-    Vector GMInvGt_j(columnsAreContiguous ? 0 : m);
+    // Entries that aren't visited are structurally zero.
+    GMInvGt.setToZero();
+    visitGMInvGtEntries(s, [&GMInvGt](int i, int j, Real value) 
+                           {   GMInvGt(i,j) = value; });
+} 
 
-    // These two temporaries are always needed to hold one column of Gt,
-    // then one column of M^-1 * Gt.
-    Vector Gtcol(nu), MInvGtcol(nu);
 
-    // Precalculate bias so we can perform multiplication by G efficiently.
-    Vector bias(m);
-    calcBiasForMultiplyByPVA(s,true,true,true,bias);
-   
-    // Lambda is used to pluck out one column at a time of Gt. Exactly one
-    // element at a time of lambda will be 1, the rest are 0.
-    Vector lambda(m, Real(0));
 
-    for (int j=0; j < m; ++j) {
-        lambda[j] = 1;
-        multiplyByPVATranspose(s, true, true, true, lambda, Gtcol);
-        lambda[j] = 0;
-        multiplyByMInv(s, Gtcol, MInvGtcol);
-        if (columnsAreContiguous)
-            multiplyByPVA(s, true, true, true, bias, MInvGtcol, GMInvGt(j));
-        else {
-            multiplyByPVA(s, true, true, true, bias, MInvGtcol, GMInvGt_j);
-            GMInvGt(j) = GMInvGt_j;
+// =============================================================================
+//                        GET CONSTRAINT FACTORIZATION
+// =============================================================================
+// Form and factor G*M^-1*~G if the cached factorization isn't valid for this
+// State (or was made with a different choice of factorization method).
+const SBConstraintFactorizationCache& SimbodyMatterSubsystemRep::
+getConstraintFactorization(const State& s) const {
+    const CacheEntryIndex cfx = topologyCache.constraintFactorizationCacheIndex;
+    if (isCacheValueRealized(s, cfx)) {
+        const SBConstraintFactorizationCache& cfc = 
+            getConstraintFactorizationCache(s);
+        if (cfc.choleskyRequested == useCholeskyForMultipliers)
+            return cfc;
+    }
+
+    SBConstraintFactorizationCache& cfc = updConstraintFactorizationCache(s);
+    const SBInstanceCache& ic = getInstanceCache(s);
+    const int m = ic.totalNHolonomicConstraintEquationsInUse
+                + ic.totalNNonholonomicConstraintEquationsInUse
+                + ic.totalNAccelerationOnlyConstraintEquationsInUse;
+
+    // Conditioning tolerance. This determines when we'll drop a 
+    // constraint. 
+    // TODO: this is probably too tight; should depend on constraint 
+    // tolerance and should be consistent with position and velocity 
+    // projection ranks. Tricky here because conditioning depends on mass
+    // matrix as well as constraints.
+    const Real conditioningTol = m 
+        //* SignificantReal;
+        * SqrtEps*std::sqrt(SqrtEps); // Eps^(3/4)
+
+    cfc.choleskyRequested = useCholeskyForMultipliers;
+    cfc.usingCholesky = cfc.usingSparseCholesky = false;
+    cfc.choleskyFactor.clear();
+    cfc.profileRowStart.clear(); cfc.profileL.clear();
+
+    // If the Constraints are sparsely coupled we can form and factor 
+    // G*M^-1*~G directly in its profile, without ever allocating an mXm 
+    // matrix. That is only worth doing if the profile is well under half 
+    // of the dense lower triangle. If the sparse factorization fails we'll
+    // go straight to QTZ since dense Cholesky would fail too.
+    const bool trySparse = useCholeskyForMultipliers && m > 0 
+        && 4*(double)ic.multiplierProfileSize < (double)m*(m+1);
+    if (trySparse) {
+        cfc.usingSparseCholesky = 
+            factorGMInvGtProfileCholesky(s, conditioningTol, cfc);
+        if (!cfc.usingSparseCholesky)
+        {   cfc.profileRowStart.clear(); cfc.profileL.clear(); }
+    }
+
+    if (!cfc.usingSparseCholesky) {
+        // The method here calculates the mXm matrix G*M^-1*G^T as fast as 
+        // I know how to do, O(m*n) with O(n) temporary memory, using a series
+        // of O(n) operators. Then we'll factor it here in O(m^3) time. 
+        Matrix GMInvGt;
+        calcGMInvGt(s, GMInvGt);
+
+        if (useCholeskyForMultipliers && m > 0 && !trySparse) {
+            // LAPACK factors in place; info > 0 means the matrix was not 
+            // positive definite. Redundant constraints can still squeak 
+            // through with tiny pivots due to roundoff, so we also reject the
+            // factorization if the pivots suggest the matrix is worse 
+            // conditioned than QTZ would accept. Either way we'll use QTZ 
+            // instead.
+            cfc.choleskyFactor = GMInvGt;
+            int info;
+            dpotrf_('L', m, &cfc.choleskyFactor(0,0), m, info);
+            if (info == 0) {
+                Real minPivot = Infinity, maxPivot = 0;
+                for (int i=0; i < m; ++i) {
+                    const Real d = square(cfc.choleskyFactor(i,i));
+                    minPivot = std::min(minPivot, d);
+                    maxPivot = std::max(maxPivot, d);
+                }
+                cfc.usingCholesky = minPivot > conditioningTol*maxPivot;
+            }
+        }
+
+        if (!cfc.usingCholesky) {
+            cfc.choleskyFactor.clear();
+            // specify 1/cond at which we declare rank deficiency
+            cfc.qtz.factor(GMInvGt, conditioningTol); 
+
+            //printf("fwdDynamics: m=%d condTol=%g rank=%d rcond=%g\n",
+            //    GMInvGt.nrow(), conditioningTol, cfc.qtz.getRank(),
+            //    cfc.qtz.getRCondEstimate());
         }
     }
-} 
+
+    markCacheValueRealized(s, cfx);
+    return cfc;
+}
 
 
 
 // =============================================================================
-//                     SOLVE FOR CONSTRAINT IMPULSES
+//                   FACTOR G MInv G^T PROFILE CHOLESKY
 // =============================================================================
-// Current implementation computes G*M^-1*~G, factors it, and does a single
-// solve all at great expense.
-// TODO: should realize factored matrix if needed and reuse if possible.
-void SimbodyMatterSubsystemRep::
-solveForConstraintImpulses(const State&     state,
-                           const Vector&    deltaV,
-                           Vector&          impulse) const
+// Form G*M^-1*~G in the multiplier order and profile chosen at Instance stage
+// and factor it in place as L*~L, where row i of L has nonzeros only in 
+// columns first[i] through i. Fill-in can't escape the profile, so this is an
+// ordinary envelope Cholesky factorization costing O(sum(rowLength^2)) 
+// rather than O(m^3). Returns false if the matrix isn't positive definite 
+// or its pivots indicate conditioning worse than conditioningTol, in which 
+// case the contents of cfc's profile arrays are garbage.
+bool SimbodyMatterSubsystemRep::
+factorGMInvGtProfileCholesky(const State&                    s,
+                             Real                            conditioningTol,
+                             SBConstraintFactorizationCache& cfc) const
 {
-    Matrix GMInvGt;
-    calcGMInvGt(state, GMInvGt);
-    // MUST DUPLICATE SIMBODY'S METHOD HERE:
-    const Real conditioningTol = GMInvGt.nrow() 
-                                    * SqrtEps*std::sqrt(SqrtEps); // Eps^(3/4)
-    FactorQTZ qtz(GMInvGt, conditioningTol); 
-    qtz.solve(deltaV, impulse);
+    const SBInstanceCache& ic    = getInstanceCache(s);
+    const Array_<int>&     order = ic.multiplierOrder;
+    const Array_<int>&     first = ic.multiplierProfileFirst;
+    const int m = (int)order.size();
+
+    Array_<int>&  rowStart = cfc.profileRowStart;
+    Array_<Real>& L        = cfc.profileL;
+    rowStart.resize(m+1);
+    rowStart[0] = 0;
+    for (int i=0; i < m; ++i)
+        rowStart[i+1] = rowStart[i] + (i - first[i] + 1);
+    L.assign(rowStart[m], Real(0));
+
+    // Map from multiplier index to row of the reordered matrix.
+    Array_<int> rowOf(m);
+    for (int i=0; i < m; ++i) rowOf[order[i]] = i;
+
+    // Scatter the lower triangle into the profile.
+    visitGMInvGtEntries(s, [&](int i, int j, Real value) {
+        const int r = rowOf[i], c = rowOf[j];
+        if (c <= r) L[rowStart[r] + (c - first[r])] = value;
+    });
+
+    Real minPivot = Infinity, maxPivot = 0;
+    for (int i=0; i < m; ++i) {
+        Real* Li = &L[rowStart[i]]; // Li[0] is column first[i]
+        for (int j=first[i]; j < i; ++j) {
+            const Real* Lj = &L[rowStart[j]];
+            const int k0 = std::max(first[i], first[j]);
+            Real sum = Li[j-first[i]];
+            for (int k=k0; k < j; ++k)
+                sum -= Li[k-first[i]] * Lj[k-first[j]];
+            Li[j-first[i]] = sum / Lj[j-first[j]];
+        }
+        Real d = Li[i-first[i]];
+        for (int k=first[i]; k < i; ++k)
+            d -= square(Li[k-first[i]]);
+        if (!(d > 0)) return false;
+        minPivot = std::min(minPivot, d);
+        maxPivot = std::max(maxPivot, d);
+        Li[i-first[i]] = std::sqrt(d);
+    }
+    return minPivot > conditioningTol*maxPivot;
 }
 
 
 
 // =============================================================================
-//                     CALC BODY ACCELERATION FROM UDOT
+//                    SOLVE WITH CONSTRAINT FACTORIZATION
 // =============================================================================
-// Input and output vectors must use contiguous storage.
-// The knownUDot argument must be of length nu; the output argument will be
-// resized if necessary to length nb.
-// Cost is 12*nu + 18*nb flops.
 void SimbodyMatterSubsystemRep::
-calcBodyAccelerationFromUDot(const State&           s,
-                             const Vector&          knownUDot,
-                             Vector_<SpatialVec>&   A_GB) const {
-    const int nu = getNU(s);
-    const int nb = getNumBodies();
-    A_GB.resize(nb); // always at least Ground
+solveWithConstraintFactorization(const State&   s,
+                                 const Vector&  rhs,
+                                 Vector&        x) const
+{
+    const SBConstraintFactorizationCache& cfc = getConstraintFactorization(s);
+    if (cfc.usingSparseCholesky) {
+        const SBInstanceCache& ic    = getInstanceCache(s);
+        const Array_<int>&     order = ic.multiplierOrder;
+        const Array_<int>&     first = ic.multiplierProfileFirst;
+        const Array_<int>&     rowStart = cfc.profileRowStart;
+        const Array_<Real>&    L     = cfc.profileL;
+        const int m = (int)order.size();
+        assert(rhs.size() == m);
+
+        // Permute, then solve L*y=P*rhs and ~L*z=y, then unpermute.
+        Vector& y = updOperatorWorkspace(s).multiplierRhs;
+        y.resize(m);
+        for (int i=0; i < m; ++i) y[i] = rhs[order[i]];
+        for (int i=0; i < m; ++i) {
+            const Real* Li = &L[rowStart[i]];
+            Real sum = y[i];
+            for (int k=first[i]; k < i; ++k)
+                sum -= Li[k-first[i]] * y[k];
+            y[i] = sum / Li[i-first[i]];
+        }
+        for (int i=m-1; i >= 0; --i) {
+            const Real* Li = &L[rowStart[i]];
+            y[i] /= Li[i-first[i]];
+            for (int k=first[i]; k < i; ++k)
+                y[k] -= Li[k-first[i]] * y[i];
+        }
+        x.resize(m);
+        for (int i=0; i < m; ++i) x[order[i]] = y[i];
+        return;
+    }
+
+    if (!cfc.usingCholesky) {
+        cfc.qtz.solve(rhs, x);
+        return;
+    }
+
+    const int m = cfc.choleskyFactor.nrow();
+    assert(rhs.size() == m);
+    x.resize(m);
+    if (m == 0) return;
+
+    // Solve in place in contiguous memory from the workspace.
+    Vector& xc = updOperatorWorkspace(s).multiplierRhs;
+    xc = rhs;
+    int info;
+    dpotrs_('L', m, 1, &cfc.choleskyFactor(0,0), m, &xc[0], m, info);
+    assert(info == 0);
+    x = xc;
+}
+
+
+
+// =============================================================================
+//                       GET MULTIPLIER PRECONDITIONER
+// =============================================================================
+// Return the Jacobi preconditioner for the iterative multiplier solver, that
+// is, the diagonal of G*M^-1*~G, calculating it if necessary. Using the
+// constraint coloring the diagonal costs one operator pass per color and 
+// equation; if the Constraints are so densely coupled that this would be 
+// a large fraction of the m passes needed to form the whole matrix we don't
+// precondition at all (the diagonal is returned as all ones).
+const Vector& SimbodyMatterSubsystemRep::
+getMultiplierPreconditioner(const State& s) const {
+    const CacheEntryIndex mpx = topologyCache.multiplierPreconditionerCacheIndex;
+    Vector& diag = Value<Vector>::updDowncast(updCacheEntry(s, mpx)).upd();
+    if (isCacheValueRealized(s, mpx))
+        return diag;
+
+    const SBInstanceCache& ic = getInstanceCache(s);
+    const int m = (int)ic.multiplierOrder.size();
+    int nPasses = 0;
+    for (unsigned c=0; c < ic.constraintColors.size(); ++c) {
+        int maxEq = 0;
+        for (unsigned i=0; i < ic.constraintColors[c].size(); ++i)
+            maxEq = std::max(maxEq, ic.getNumConstraintEquationsInUse
+                                        (ic.constraintColors[c][i]));
+        nPasses += maxEq;
+    }
+
+    diag.resize(m);
+    diag = 1;
+    if (4*nPasses <= m) {
+        visitGMInvGtEntries(s, [&diag](int i, int j, Real value) 
+                               {   if (i==j) diag[i] = value; });
+        // Guard against zero or negative entries from degenerate 
+        // Constraints; CG will notice the problem if there is one.
+        for (int i=0; i < m; ++i)
+            if (!(diag[i] > 0)) diag[i] = 1;
+    }
+
+    markCacheValueRealized(s, mpx);
+    return diag;
+}
+
+
+
+// =============================================================================
+//                    SOLVE FOR MULTIPLIERS ITERATIVELY
+// =============================================================================
+// Solve (G M^-1 ~G) lambda = aerr by preconditioned conjugate gradients 
+// without ever forming G M^-1 ~G. Each iteration applies the matrix to a 
+// vector with the O(n) operators multiplyByPVATranspose(), multiplyByMInv()
+// and multiplyByPVA(), so k iterations cost O(k*n) time and O(m+n) memory.
+// We start from the multipliers of the previous solve (typically from the
+// previous integrator stage, which makes an excellent guess) and stop when 
+// the residual norm is below the tolerance times the norm of aerr. Returns
+// false if that doesn't happen in a generous number of iterations or if the
+// matrix turns out not to be positive definite (e.g. with redundant or 
+// working constraints); the caller should then use the direct solver.
+bool SimbodyMatterSubsystemRep::
+solveForMultipliersIteratively(const State&  s,
+                               const Vector& aerr,
+                               Vector&       lambda) const
+{
+    const int m  = aerr.size();
+    const int nu = getNU(s);
+
+    SBMultiplierWarmStartCache& wsc = updMultiplierWarmStartCache(s);
+    lambda.resize(m);
+    if (isCacheValueRealized(s, topologyCache.multiplierWarmStartCacheIndex))
+        lambda = wsc.lambda;
+    else
+        lambda.setToZero();
+
+    const Real aerrNorm = aerr.norm();
+    if (aerrNorm == 0) {lambda.setToZero(); return true;}
+    const Real tol = iterativeMultiplierSolverTolerance * aerrNorm;
+
+    const Vector& diag = getMultiplierPreconditioner(s);
+
+    // Precalculate bias so we can perform multiplication by G efficiently.
+    Vector& bias = wsc.bias;
+    calcBiasForMultiplyByPVA(s, true, true, true, bias);
+    Vector &r = wsc.r, &z = wsc.z, &p = wsc.p, &Ap = wsc.Ap;
+
+    // Ax = G M^-1 ~G x
+    auto multiplyByGMInvGt = [&](const Vector& x, Vector& Ax) {
+        multiplyByPVATranspose(s, true, true, true, x, wsc.Gtx);
+        multiplyByMInv(s, wsc.Gtx, wsc.MInvGtx);
+        multiplyByPVA(s, true, true, true, bias, wsc.MInvGtx, Ax);
+    };
+
+    multiplyByGMInvGt(lambda, Ap);
+    r = aerr; r -= Ap;
+
+    const int MaxIterations = 2*m + 10;
+    Real rz = 0;
+    for (int its=0; its < MaxIterations; ++its) {
+        if (r.norm() <= tol) 
+            return true;
+
+        for (int i=0; i < m; ++i) z[i] = r[i] / diag[i];
+        const Real rzPrev = rz;
+        rz = ~r*z;
+        if (its == 0) p = z;
+        else {p *= rz/rzPrev; p += z;}
+
+        multiplyByGMInvGt(p, Ap);
+        const Real pAp = ~p*Ap;
+        if (!(pAp > 0)) 
+            return false; // not positive definite
+
+        const Real alpha = rz/pAp;
+        for (int i=0; i < m; ++i) {
+            lambda[i] += alpha*p[i];
+            r[i]      -= alpha*Ap[i];
+        }
+    }
+    return r.norm() <= tol;
+}
+
+
+
+// =============================================================================
+//                     SOLVE FOR CONSTRAINT IMPULSES
+// =============================================================================
+// This uses the same factorization of G*M^-1*~G (and hence the same handling
+// of constraint redundancies) as loop forward dynamics, and shares the cached
+// factorization with it.
+void SimbodyMatterSubsystemRep::
+solveForConstraintImpulses(const State&     state,
+                           const Vector&    deltaV,
+                           Vector&          impulse) const
+{
+    solveWithConstraintFactorization(state, deltaV, impulse);
+}
+
+
+
+// =============================================================================
+//                     CALC BODY ACCELERATION FROM UDOT
+// =============================================================================
+// Input and output vectors must use contiguous storage.
+// The knownUDot argument must be of length nu; the output argument will be
+// resized if necessary to length nb.
+// Cost is 12*nu + 18*nb flops.
+void SimbodyMatterSubsystemRep::
+calcBodyAccelerationFromUDot(const State&           s,
+                             const Vector&          knownUDot,
+                             Vector_<SpatialVec>&   A_GB) const {
+    const int nu = getNU(s);
+    const int nb = getNumBodies();
+    A_GB.resize(nb); // always at least Ground
 
     // Should have been checked before we got here.
     assert(knownUDot.size() == nu);
@@ -3689,78 +4611,87 @@ calcConstraintAccelerationErrors
     ArrayView_<Real>                    allAerr (&pvaerr[0],  &pvaerr[0]  + m );
 
     // These arrays will be resized and filled with the input needs of each 
-    // Constraint in turn. We're declaring them outside the loop to minimize 
-    // heap allocation (resizing down doesn't normally free heap space). 
-    Array_<SpatialVec,ConstrainedBodyIndex> A_AB;
-    Array_<Real,ConstrainedQIndex> qdd; // holonomic only
-    Array_<Real,ConstrainedUIndex> ud;  // nonholonomic or acc-only
+    // Constraint in turn. They live in the State's workspace so that once 
+    // they have grown large enough there is no more heap allocation (resizing
+    // down doesn't free heap space). Each block of Constraints has its own.
+    SBOperatorWorkspace& ws = updOperatorWorkspace(s);
+    ws.constraintBlocks.resize(getNumConstraintBlocks());
 
     // Loop over all enabled constraints, ask them to generate constraint
-    // errors, and collect those in the output argument pvaerr.
-    for (ConstraintIndex cx(0); cx < constraints.size(); ++cx) {
-        if (isConstraintDisabled(s,cx))
-            continue;
-
-        const SBInstancePerConstraintInfo& 
-            cInfo = ic.getConstraintInstanceInfo(cx);
-        // Find this Constraint's err segments within the global array.
-        const Segment& holoSeg    = cInfo.holoErrSegment;
-        const Segment& nonholoSeg = cInfo.nonholoErrSegment;
-        const Segment& accOnlySeg = cInfo.accOnlyErrSegment;
-        const int mp = holoSeg.length;
-        const int mv = nonholoSeg.length;
-        const int ma = accOnlySeg.length;
-
-        const ConstraintImpl& crep = constraints[cx]->getImpl();
-
-        // Now fill in accelerations. If the Ancestor is Ground
-        // we're just reordering. If it isn't Ground we have to transform
-        // the accelerations from Ground to Ancestor, at a cost
-        // of 105 flops/constrained body (not just re-expressing).
-        crep.convertBodyAccelToConstrainedBodyAccel(s, allA_GB, A_AB);
-
-        // At this point A_AB holds the accelerations of each
-        // constrained body in A.
-
-
-        if (mp) { // holonomic
-            // Now pack together the appropriate qdotdots.
-            const int ncq = cInfo.getNumConstrainedQ();
-            qdd.resize(ncq);
-            for (ConstrainedQIndex cqx(0); cqx < ncq; ++cqx)
-                qdd[cqx] = qddArray[cInfo.getQIndexFromConstrainedQ(cqx)];
-
-            // The error slots start at the beginning of the pvaerr array.
-            const int start = holoSeg.offset;
-            ArrayView_<Real>  paerr = allAerr(start, mp);
-            crep.calcPositionDotDotErrors(s, A_AB, qdd, paerr);
-        }
+    // errors, and collect those in the output argument pvaerr. Each writes
+    // only its own segments so blocks of them can be done concurrently.
+    forEachConstraintBlock([&](int b, ConstraintIndex first, ConstraintIndex last)
+    {
+        SBConstraintBlockWorkspace& cbw = ws.constraintBlocks[b];
+        Array_<SpatialVec,ConstrainedBodyIndex>& A_AB = cbw.A_AB;
+        Array_<Real,ConstrainedQIndex>& qdd = cbw.qdotdot; // holonomic only
+        Array_<Real,ConstrainedUIndex>& ud  = cbw.udot;    // nonholo or acc-only
 
-        if (!(mv || ma))
-            continue; // nothing else to do here
+        for (ConstraintIndex cx = first; cx < last; ++cx) {
+            if (isConstraintDisabled(s,cx))
+                continue;
 
-        // Now pack together the appropriate udots.
-        const int ncu = cInfo.getNumConstrainedU();
-        ud.resize(ncu);
-        for (ConstrainedUIndex cux(0); cux < ncu; ++cux)
-            ud[cux] = udArray[cInfo.getUIndexFromConstrainedU(cux)];
+            const SBInstancePerConstraintInfo& 
+                cInfo = ic.getConstraintInstanceInfo(cx);
+            // Find this Constraint's err segments within the global array.
+            const Segment& holoSeg    = cInfo.holoErrSegment;
+            const Segment& nonholoSeg = cInfo.nonholoErrSegment;
+            const Segment& accOnlySeg = cInfo.accOnlyErrSegment;
+            const int mp = holoSeg.length;
+            const int mv = nonholoSeg.length;
+            const int ma = accOnlySeg.length;
+
+            const ConstraintImpl& crep = constraints[cx]->getImpl();
+
+            // Now fill in accelerations. If the Ancestor is Ground
+            // we're just reordering. If it isn't Ground we have to transform
+            // the accelerations from Ground to Ancestor, at a cost
+            // of 105 flops/constrained body (not just re-expressing).
+            crep.convertBodyAccelToConstrainedBodyAccel(s, allA_GB, A_AB);
+
+            // At this point A_AB holds the accelerations of each
+            // constrained body in A.
+
+
+            if (mp) { // holonomic
+                // Now pack together the appropriate qdotdots.
+                const int ncq = cInfo.getNumConstrainedQ();
+                qdd.resize(ncq);
+                for (ConstrainedQIndex cqx(0); cqx < ncq; ++cqx)
+                    qdd[cqx] = qddArray[cInfo.getQIndexFromConstrainedQ(cqx)];
+
+                // The error slots start at the beginning of the pvaerr array.
+                const int start = holoSeg.offset;
+                ArrayView_<Real>  paerr = allAerr(start, mp);
+                crep.calcPositionDotDotErrors(s, A_AB, qdd, paerr);
+            }
 
-        if (mv) {   // non-holonomic constraints
-            // The error slots begin after skipping the holonomic part of
-            // the arrays.
-            const int start = mHolo + nonholoSeg.offset;
-            ArrayView_<Real> vaerr = allAerr(start, mv);
-            crep.calcVelocityDotErrors(s, A_AB, ud, vaerr);
-        }
+            if (!(mv || ma))
+                continue; // nothing else to do here
+
+            // Now pack together the appropriate udots.
+            const int ncu = cInfo.getNumConstrainedU();
+            ud.resize(ncu);
+            for (ConstrainedUIndex cux(0); cux < ncu; ++cux)
+                ud[cux] = udArray[cInfo.getUIndexFromConstrainedU(cux)];
+
+            if (mv) {   // non-holonomic constraints
+                // The error slots begin after skipping the holonomic part of
+                // the arrays.
+                const int start = mHolo + nonholoSeg.offset;
+                ArrayView_<Real> vaerr = allAerr(start, mv);
+                crep.calcVelocityDotErrors(s, A_AB, ud, vaerr);
+            }
 
-        if (ma) {   // acceleration-only constraints
-            // The error slots begin after skipping the holonomic and 
-            // non-holonomic parts of the arrays.
-            const int start = mHolo+mNonholo+accOnlySeg.offset;
-            ArrayView_<Real> aerr = allAerr(start, ma);
-            crep.calcAccelerationErrors(s, A_AB, ud, aerr);
+            if (ma) {   // acceleration-only constraints
+                // The error slots begin after skipping the holonomic and 
+                // non-holonomic parts of the arrays.
+                const int start = mHolo+mNonholo+accOnlySeg.offset;
+                ArrayView_<Real> aerr = allAerr(start, ma);
+                crep.calcAccelerationErrors(s, A_AB, ud, aerr);
+            }
         }
-    }
+    });
 }
 
 
@@ -4093,6 +5024,30 @@ void SimbodyMatterSubsystemRep::enforcePositionConstraints
 //   multiplying these matrices by columns, but not for producing Wq so we 
 //   just create it operationally as we go.
 
+// With modified Newton projection we keep using an old factorization only 
+// while each iteration reduces the constraint error norm by at least this 
+// factor.
+static const Real MaxModifiedNewtonRate = Real(0.25);
+
+static bool isSameVector(const VectorBase<Real>& a, 
+                         const VectorBase<Real>& b) {
+    if (a.size() != b.size()) return false;
+    for (int i=0; i < a.size(); ++i)
+        if (a[i] != b[i]) return false;
+    return true;
+}
+
+SBProjectionFactorizationCache& SimbodyMatterSubsystemRep::
+updProjectionFactorizations(const State& s) const {
+    SBProjectionFactorizationCache& pfc = updProjectionFactorizationCache(s);
+    const CacheEntryIndex pfcx = topologyCache.projectionFactorizationCacheIndex;
+    if (!isCacheValueRealized(s, pfcx)) {
+        pfc.pqIsValid = pfc.pvIsValid = false;
+        markCacheValueRealized(s, pfcx);
+    }
+    return pfc;
+}
+
 int SimbodyMatterSubsystemRep::projectQ
    (State&                  s, 
     Vector&                 qErrest, // q error estimate or empty 
@@ -4201,9 +5156,10 @@ int SimbodyMatterSubsystemRep::projectQ
     // initialization.
     const bool localOnly = opts.isOptionSet(ProjectOptions::LocalOnly);
     // We are permitted to use an out-of-date Jacobian for projection unless
-    // this is set. TODO: always using full Newton at the moment.
+    // this is set. We only do so if modified Newton projection was requested.
     const bool forceFullNewton =
         opts.isOptionSet(ProjectOptions::ForceFullNewton);
+    const bool modifiedNewton = useModifiedNewtonProjection && !forceFullNewton;
 
     // Get problem dimensions.
     const SBInstanceCache& ic = getInstanceCache(s);
@@ -4229,11 +5185,14 @@ int SimbodyMatterSubsystemRep::projectQ
     // (diagonal weights are symmetric). We only retain rows that 
     // correspond to free (non prescribed) q's.
     //
-    // This is a nonlinear least squares problem. Below is a full Newton 
-    // iteration since we recalculate the iteration matrix each time around the
-    // loop. TODO: a solution could be found using the same iteration matrix, 
-    // since we are projecting from (presumably) not too far away. Q1: will it
-    // be the same solution? Q2: if not, does it matter?
+    // This is a nonlinear least squares problem. Normally we use a full 
+    // Newton iteration, recalculating the iteration matrix each time around 
+    // the loop. With modified Newton we instead keep using the last 
+    // factorization, even one left by an earlier projection at a different 
+    // q, since we are projecting from (presumably) not too far away. We 
+    // refactor if a step with an old factorization makes the errors worse or
+    // reduces them too slowly. This finds a q that satisfies the constraints
+    // but it can be slightly different from the one full Newton would find.
 
     // These will be updated as we go.
     Real perrNormAchieved = perrNormOnEntry;
@@ -4261,19 +5220,35 @@ int SimbodyMatterSubsystemRep::projectQ
     // if the attempts here make the constraint norm worse.
     const Vector saveQ = getQ(s);
 
-    Matrix Pqwrt(nfq,mHolo);
+    // An existing factorization can be used only if it was formed with the
+    // same weights.
+    SBProjectionFactorizationCache& pfc = updProjectionFactorizations(s);
+    bool mustFactor = !(modifiedNewton && pfc.pqIsValid
+                        && isSameVector(pfc.pqErrWeights, perrWeights)
+                        && isSameVector(pfc.pqUScale, uAbsScale));
+
+    Matrix Pqwrt; // only formed when we factor
     Vector dfq_WLS(nfq), du(nu), dq(nq); // = Wq^+ dq_WLS
     Vector udfq_WLS(hasPrescribedMotion ? nq : 0); // unpacked if needed
     udfq_WLS.setToZero(); // must initialize unwritten elements
-    FactorQTZ Pqwr_qtz;
+    FactorQTZ& Pqwr_qtz = pfc.pqQtz;
     Real prevPerrNormAchieved = perrNormAchieved; // watch for divergence
     bool diverged = false;
+    bool anyStepKept = false; // if not, undoing a step restores saveQ
     const int MaxIterations  = 20;
     do {
-        calcWeightedPqrTranspose(s, perrWeights, uAbsScale, Pqwrt);//nfq X mp
+        const bool reusingFactorization = !mustFactor;
+        if (mustFactor) {
+            calcWeightedPqrTranspose(s, perrWeights, uAbsScale, Pqwrt);//nfq X mp
 
-        // This factorization acts like a pseudoinverse.
-        Pqwr_qtz.factor<Real>(~Pqwrt, conditioningTol); 
+            // This factorization acts like a pseudoinverse.
+            Pqwr_qtz.factor<Real>(~Pqwrt, conditioningTol); 
+            pfc.pqIsValid    = true;
+            pfc.pqErrWeights = perrWeights;
+            pfc.pqUScale     = uAbsScale;
+            ++pfc.numQFactorizations;
+            mustFactor = !modifiedNewton;
+        }
 
         //printf("projectQ %d: m=%d condTol=%g rank=%d rcond=%g\n",
         //    nItsUsed, Pqwrt.ncol(), conditioningTol, Pqwr_qtz.getRank(),
@@ -4308,10 +5283,26 @@ int SimbodyMatterSubsystemRep::projectQ
                                       : scaledPerrs.normRMS();
         ++nItsUsed;
 
+        if (reusingFactorization && perrNormAchieved > prevPerrNormAchieved) {
+            // The old factorization made it worse; undo the step and try 
+            // again with a fresh one. If no step has been kept, put back the
+            // exact starting q so the caller sees no change.
+            if (anyStepKept) updQ(s) += dq;
+            else {updQ(s) = saveQ; results.setAnyChangeMade(false);}
+            realizeSubsystemPosition(s); // pErrs changes here
+            scaledPerrs = pErrs.rowScale(perrWeights);
+            perrNormAchieved = prevPerrNormAchieved;
+            mustFactor = true;
+            continue;
+        }
+        if (reusingFactorization) // the old factorization did its job
+            ++pfc.numQFactorizationsAvoided;
+
         if (localOnly && nItsUsed >= 2 
             && perrNormAchieved > prevPerrNormAchieved) {
             // perr norm got worse; restore to end of previous iteration
-            updQ(s) += dq;
+            if (anyStepKept) updQ(s) += dq;
+            else {updQ(s) = saveQ; results.setAnyChangeMade(false);}
             realizeSubsystemPosition(s); // pErrs changes here
             scaledPerrs = pErrs.rowScale(perrWeights);
             perrNormAchieved = useNormInf ? scaledPerrs.normInf()
@@ -4320,7 +5311,13 @@ int SimbodyMatterSubsystemRep::projectQ
             break; // diverging -- quit now to prevent a bad solution
         }
 
+        // Slow convergence means the factorization is too far out of date.
+        if (modifiedNewton 
+            && perrNormAchieved > MaxModifiedNewtonRate*prevPerrNormAchieved)
+            mustFactor = true;
+
         prevPerrNormAchieved = perrNormAchieved;
+        anyStepKept = true;
 
     } while (perrNormAchieved > consAccuracyToTryFor
                 && nItsUsed < MaxIterations);
@@ -4336,6 +5333,7 @@ int SimbodyMatterSubsystemRep::projectQ
     if (perrNormAchieved > consAccuracy) {
         if (perrNormAchieved >= perrNormOnEntry) { // made it worse
             updQ(s) = saveQ; // revert
+            results.setAnyChangeMade(false);
             realizeSubsystemPosition(s);
             perrNormAchieved = perrNormOnEntry;
         }
@@ -4663,6 +5661,16 @@ void SimbodyMatterSubsystemRep::enforceVelocityConstraints
 //==============================================================================
 //                                 PROJECT U
 //==============================================================================
+// Relative scaling for changes to u: max(unit error, |u|) (that's 1/Eu).
+static void calcURelScale(const Vector& u, const Vector& uWeights, 
+                          Vector& uRelScale) {
+    for (int i=0; i<u.size(); ++i) {
+        const Real ui = std::abs(u[i]);
+        const Real wi = uWeights[i];
+        uRelScale[i] = ui*wi > 1 ? ui : 1/wi;
+    }
+}
+
 int SimbodyMatterSubsystemRep::projectU
    (State&                  s, 
     Vector&                 uErrest,        // u error estimate or empty 
@@ -4744,9 +5752,12 @@ int SimbodyMatterSubsystemRep::projectU
     // initialization.
     const bool localOnly = opts.isOptionSet(ProjectOptions::LocalOnly);
     // We are permitted to use an out-of-date Jacobian for projection unless
-    // this is set. TODO: always using modified Newton at the moment.
+    // this is set. Within one call we always use modified Newton (see below);
+    // we only reuse a factorization from an earlier call if modified Newton
+    // projection was requested.
     const bool forceFullNewton =
         opts.isOptionSet(ProjectOptions::ForceFullNewton);
+    const bool modifiedNewton = useModifiedNewtonProjection && !forceFullNewton;
 
     // Get problem dimensions.
     const SBInstanceCache& ic = getInstanceCache(s);
@@ -4774,14 +5785,9 @@ int SimbodyMatterSubsystemRep::projectU
 
 
     // Calculate relative scaling for changes to u.
-    const Vector& u = getU(s);
     const Vector& uWeights = getUWeights(s); // 1/unit change (Wu)
     Vector uRelScale(nu);
-    for (int i=0; i<nu; ++i) {
-        const Real ui = std::abs(u[i]);
-        const Real wi = uWeights[i];
-        uRelScale[i] = ui*wi > 1 ? ui : 1/wi; // max(unit error, u) (1/Eu)
-    }
+    calcURelScale(getU(s), uWeights, uRelScale);
 
     Real lastChangeMadeWRMS = 0;
     int nItsUsed = 0;
@@ -4798,27 +5804,53 @@ int SimbodyMatterSubsystemRep::projectU
     // if the attempts here make the constraint norm worse.
     const Vector saveU = getU(s);
 
-    Matrix PVwrt(nfu, mHolo+mNonholo);
+    Matrix PVwrt; // only formed when we factor
     Vector dfu_WLS(nfu);
     Vector du(nu); // unpacked into here if necessary
     if (hasPrescribedMotion)
         du.setToZero(); // must initialize unwritten elements
 
-    calcWeightedPVrTranspose(s, pverrWeights, uRelScale, PVwrt);
-    // PVwrt is now Eu^-1 (Pt Vt) Tpv
-
-    // Calculate pseudoinverse (just once)
-    FactorQTZ PVwr_qtz;
-    PVwr_qtz.factor<Real>(~PVwrt, conditioningTol);
-
-    //printf("projectU m=%d condTol=%g rank=%d rcond=%g\n",
-    //    PVwrt.ncol(), conditioningTol, PVwr_qtz.getRank(),
-    //    PVwr_qtz.getRCondEstimate());
-
+    // With modified Newton, start with the factorization left by the last 
+    // projection if it was formed with the same constraint weights. Then we
+    // must also use the u scaling it was formed with. If a step with that
+    // factorization makes the errors worse or reduces them too slowly, we
+    // refactor here as usual.
+    SBProjectionFactorizationCache& pfc = updProjectionFactorizations(s);
+    bool mustFactor = !(modifiedNewton && pfc.pvIsValid
+                        && isSameVector(pfc.pvErrWeights, pverrWeights)
+                        && pfc.pvUScale.size() == nu);
+    if (!mustFactor)
+        uRelScale = pfc.pvUScale;
+
+    FactorQTZ& PVwr_qtz = pfc.pvQtz;
     Real prevPVerrNormAchieved = pverrNormAchieved; // watch for divergence
     bool diverged = false;
+    bool anyStepKept = false; // if not, undoing a step restores saveU
+    bool reusingFactorization = !mustFactor;
     const int MaxIterations  = 7;
     do {
+        if (mustFactor) {
+            if (reusingFactorization) { // back to our own scaling
+                calcURelScale(saveU, uWeights, uRelScale);
+                reusingFactorization = false;
+            }
+
+            calcWeightedPVrTranspose(s, pverrWeights, uRelScale, PVwrt);
+            // PVwrt is now Eu^-1 (Pt Vt) Tpv
+
+            // Calculate pseudoinverse.
+            PVwr_qtz.factor<Real>(~PVwrt, conditioningTol);
+            pfc.pvIsValid    = true;
+            pfc.pvErrWeights = pverrWeights;
+            pfc.pvUScale     = uRelScale;
+            ++pfc.numUFactorizations;
+            mustFactor = false;
+
+            //printf("projectU m=%d condTol=%g rank=%d rcond=%g\n",
+            //    PVwrt.ncol(), conditioningTol, PVwr_qtz.getRank(),
+            //    PVwr_qtz.getRCondEstimate());
+        }
+
         PVwr_qtz.solve(scaledPVerrs, dfu_WLS);
         lastChangeMadeWRMS = dfu_WLS.normRMS(); // change in weighted norm
 
@@ -4839,10 +5871,26 @@ int SimbodyMatterSubsystemRep::projectU
                                        : scaledPVerrs.normRMS();
         ++nItsUsed;
 
+        if (reusingFactorization && pverrNormAchieved > prevPVerrNormAchieved) 
+        {   // The old factorization made it worse; undo the step and try
+            // again with a fresh one. If no step has been kept, put back the
+            // exact starting u so the caller sees no change.
+            if (anyStepKept) updU(s) += du;
+            else {updU(s) = saveU; results.setAnyChangeMade(false);}
+            realizeSubsystemVelocity(s); // pvErrs changes here
+            scaledPVerrs = pvErrs.rowScale(pverrWeights);
+            pverrNormAchieved = prevPVerrNormAchieved;
+            mustFactor = true;
+            continue;
+        }
+        if (reusingFactorization && nItsUsed == 1) // old one did its job
+            ++pfc.numUFactorizationsAvoided;
+
         if (localOnly && nItsUsed >= 2 
             && pverrNormAchieved > prevPVerrNormAchieved) {
             // Velocity norm worse -- restore to end of previous iteration.
-            updU(s) += du;
+            if (anyStepKept) updU(s) += du;
+            else {updU(s) = saveU; results.setAnyChangeMade(false);}
             realizeSubsystemVelocity(s); // pvErrs changes here
             scaledPVerrs = pvErrs.rowScale(pverrWeights);
             pverrNormAchieved = useNormInf ? scaledPVerrs.normInf()
@@ -4851,7 +5899,14 @@ int SimbodyMatterSubsystemRep::projectU
             break; // diverging -- quit now to prevent a bad solution
         }
 
+        // Slow convergence means the old factorization is too far out of 
+        // date.
+        if (reusingFactorization 
+            && pverrNormAchieved > MaxModifiedNewtonRate*prevPVerrNormAchieved)
+            mustFactor = true;
+
         prevPVerrNormAchieved = pverrNormAchieved;
+        anyStepKept = true;
 
     } while (pverrNormAchieved > consAccuracyToTryFor
                 && nItsUsed < MaxIterations);
@@ -4865,6 +5920,7 @@ int SimbodyMatterSubsystemRep::projectU
     if (pverrNormAchieved > consAccuracy) {
         if (pverrNormAchieved >= pverrNormOnEntry) { // made it worse
             updU(s) = saveU; // revert
+            results.setAnyChangeMade(false);
             realizeSubsystemVelocity(s);
             pverrNormAchieved = pverrNormOnEntry;
         }
@@ -4986,8 +6042,11 @@ void SimbodyMatterSubsystemRep::calcTreeForwardDynamicsOperator(
     udot.resize(topologyCache.nDOFs);
     qdotdot.resize(topologyCache.maxNQs);
 
-    Vector              totalMobilityForces;
-    Vector_<SpatialVec> totalBodyForces;
+    // Combined forces are formed in place in the State's workspace so that
+    // we don't allocate heap memory on every call.
+    SBOperatorWorkspace& ws                  = updOperatorWorkspace(s);
+    Vector&              totalMobilityForces = ws.totalMobilityForces;
+    Vector_<SpatialVec>& totalBodyForces     = ws.totalBodyForces;
 
     // inputs
 
@@ -4996,12 +6055,14 @@ void SimbodyMatterSubsystemRep::calcTreeForwardDynamicsOperator(
     const Vector_<SpatialVec>* bodyForcesToUse      = &bodyForces;
 
     if (extraMobilityForces) {
-        totalMobilityForces = mobilityForces - *extraMobilityForces; // note sign
+        totalMobilityForces = mobilityForces;
+        totalMobilityForces -= *extraMobilityForces; // note sign
         mobilityForcesToUse = &totalMobilityForces;
     }
 
     if (extraBodyForces) {
-        totalBodyForces = bodyForces - *extraBodyForces;    // note sign
+        totalBodyForces = bodyForces;
+        totalBodyForces -= *extraBodyForces;    // note sign
         bodyForcesToUse = &totalBodyForces;
     }
 
@@ -5107,37 +6168,26 @@ void SimbodyMatterSubsystemRep::calcLoopForwardDynamicsOperator
     if (m==0) return;
     if (nu==0) {multipliers.setToZero(); return;}
 
-    // Conditioning tolerance. This determines when we'll drop a 
-    // constraint. 
-    // TODO: this is probably too tight; should depend on constraint tolerance
-    // and should be consistent with position and velocity projection ranks.
-    // Tricky here because conditioning depends on mass matrix as well as
-    // constraints.
-    const Real conditioningTol = m 
-        //* SignificantReal;
-        * SqrtEps*std::sqrt(SqrtEps); // Eps^(3/4)
-
     // Calculate multipliers lambda as
     //     (G M^-1 ~G) lambda = aerr
-    // The method here calculates the mXm matrix G*M^-1*G^T as fast as 
-    // I know how to do, O(m*n) with O(n) temporary memory, using a series
-    // of O(n) operators. Then we'll factor it here in O(m^3) time. 
-    Matrix GMInvGt(m,m);
-    calcGMInvGt(s, GMInvGt);
-    
-    // specify 1/cond at which we declare rank deficiency
-    FactorQTZ qtz(GMInvGt, conditioningTol); 
-
-    //printf("fwdDynamics: m=%d condTol=%g rank=%d rcond=%g\n",
-    //    GMInvGt.nrow(), conditioningTol, qtz.getRank(),
-    //    qtz.getRCondEstimate());
-
-    qtz.solve(udotErr, multipliers);
+    // The mXm matrix G*M^-1*G^T is formed and factored only if the cached
+    // factorization is out of date, so repeated evaluations at the same 
+    // configuration cost only O(m^2) here. If requested, we first try to 
+    // solve iteratively without forming the matrix at all, falling back to
+    // the factorization if that doesn't converge.
+    if (useIterativeMultiplierSolver) {
+        if (!solveForMultipliersIteratively(s, udotErr, multipliers))
+            solveWithConstraintFactorization(s, udotErr, multipliers);
+        updMultiplierWarmStartCache(s).lambda = multipliers;
+        markCacheValueRealized(s, topologyCache.multiplierWarmStartCacheIndex);
+    } else
+        solveWithConstraintFactorization(s, udotErr, multipliers);
 
     // We have the multipliers, now turn them into forces.
 
-    Vector_<SpatialVec> bodyForcesInG;
-    Vector              mobilityF;
+    SBOperatorWorkspace& ws            = updOperatorWorkspace(s);
+    Vector_<SpatialVec>& bodyForcesInG = ws.constraintBodyForcesInG;
+    Vector&              mobilityF     = ws.constraintMobilityForces;
     calcConstraintForcesFromMultipliers(s,multipliers,bodyForcesInG,mobilityF,
         cac.constrainedBodyForcesInG, cac.constraintMobilityForces);
     // Note that constraint forces have the opposite sign from applied forces
@@ -5324,22 +6374,18 @@ void SimbodyMatterSubsystemRep::calcTreeAccelerations(const State& s,
     for (int i=0; i < (int)ic.zeroUDot.size(); ++i)
         udotPtr[ic.zeroUDot[i]] = 0;
 
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcUDotPass1Inward(ic,tpc,abc,abvc,
-                mobilityForcePtr, bodyForcePtr, udotPtr, zPtr, zPlusPtr,
-                hingeForcePtr);
-        }
+    sweepInward([&](const RigidBodyNode& node) {
+        node.calcUDotPass1Inward(ic,tpc,abc,abvc,
+            mobilityForcePtr, bodyForcePtr, udotPtr, zPtr, zPlusPtr,
+            hingeForcePtr);
+    });
 
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcUDotPass2Outward(ic,tpc,abc,tvc,dc, 
-                hingeForcePtr, aPtr, udotPtr, tauPtr);
-            node.calcQDotDot(sbs, &udotPtr[node.getUIndex()], 
-                             &qdotdotPtr[node.getQIndex()]);
-        }
+    sweepOutward([&](const RigidBodyNode& node) {
+        node.calcUDotPass2Outward(ic,tpc,abc,tvc,dc, 
+            hingeForcePtr, aPtr, udotPtr, tauPtr);
+        node.calcQDotDot(sbs, &udotPtr[node.getUIndex()], 
+                         &qdotdotPtr[node.getQIndex()]);
+    });
 }
 //......................... CALC TREE ACCELERATIONS ............................
 
@@ -5384,19 +6430,15 @@ void SimbodyMatterSubsystemRep::multiplyByMInv(const State& s,
     const Real* fPtr     = &f[0];       
     Real*       MInvfPtr = &MInvf[0];
 
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.multiplyByMInvPass1Inward(ic,tpc,abc,
-                fPtr, z.begin(), zPlus.begin(), eps.begin());
-        }
+    sweepInward([&](const RigidBodyNode& node) {
+        node.multiplyByMInvPass1Inward(ic,tpc,abc,
+            fPtr, z.begin(), zPlus.begin(), eps.begin());
+    });
 
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.multiplyByMInvPass2Outward(ic,tpc,abc, 
-                eps.cbegin(), A_GB.begin(), MInvfPtr);
-        }
+    sweepOutward([&](const RigidBodyNode& node) {
+        node.multiplyByMInvPass2Outward(ic,tpc,abc, 
+            eps.cbegin(), A_GB.begin(), MInvfPtr);
+    });
 }
 //............................. CALC M INVERSE F ...............................
 
@@ -5433,17 +6475,11 @@ void SimbodyMatterSubsystemRep::multiplyByM(const State&    s,
     const Real* aPtr    = &a[0];       
     Real*       MaPtr   = &Ma[0];
 
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.multiplyByMPass1Outward(tpc, aPtr, A_GB.begin());
-        }
+    sweepOutward([&](const RigidBodyNode& node) 
+    {   node.multiplyByMPass1Outward(tpc, aPtr, A_GB.begin()); });
 
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.multiplyByMPass2Inward(tpc,A_GB.cbegin(),fTmp.begin(),MaPtr);
-        }
+    sweepInward([&](const RigidBodyNode& node) 
+    {   node.multiplyByMPass2Inward(tpc,A_GB.cbegin(),fTmp.begin(),MaPtr); });
 }
 
 
@@ -5451,32 +6487,303 @@ void SimbodyMatterSubsystemRep::multiplyByM(const State&    s,
 //==============================================================================
 //                                  CALC M
 //==============================================================================
-// Calculate the mass matrix M in O(n^2) time. This Subsystem must already have
-// been realized to Position stage.
+// Return the mass matrix M in O(n^2) time. This Subsystem must already have
+// been realized to Position stage. The result is cached so that subsequent 
+// calls at the same configuration just copy it out, even if u has changed.
 // It is OK if M's data is not contiguous.
 void SimbodyMatterSubsystemRep::calcM(const State& s, Matrix& M) const {
-    const int nu = getTotalDOF();
+    M = getMassMatrix(s);
+}
+
+// The dense M is just the sparse one with the structural zeroes filled in and
+// the upper triangle copied from the lower one.
+const Matrix& SimbodyMatterSubsystemRep::getMassMatrix(const State& s) const {
+    const CacheEntryIndex mmx = topologyCache.massMatrixCacheIndex;
+    Matrix& M = Value<Matrix>::updDowncast(updCacheEntry(s, mmx)).upd();
+    if (isCacheValueRealized(s, mmx))
+        return M;
+
+    const SBSparseMassMatrix& Msparse = getSparseMassMatrix(s);
+    const int nu = Msparse.size();
     M.resize(nu,nu);
-    if (nu==0) return;
+    M.setToZero();
+    for (int i=0; i < nu; ++i)
+        for (int j=i; j >= 0; j=Msparse.parent[j])
+            M(i,j) = M(j,i) = Msparse.get(i,j);
 
-    // This could be calculated much faster by doing it directly and calculating
-    // only half of it. As a placeholder, however, we're doing this with 
-    // repeated O(n) calls to multiplyByM() to get M one column at a time.
+    markCacheValueRealized(s, mmx);
+    return M;
+}
 
-    // If M's columns are contiguous we can avoid copying.
-    const bool isContiguous = M(0).hasContiguousData();
-    Vector contig_col(isContiguous ? 0 : nu);
 
-    Vector v(nu); v.setToZero();
-    for (int i=0; i < nu; ++i) {
-        v[i] = 1;
-        if (isContiguous) {
-            multiplyByM(s, v, M(i));
+
+//==============================================================================
+//                           GET SPARSE MASS MATRIX
+//==============================================================================
+// Fill in the structure of an SBSparseMassMatrix from the tree topology. 
+// Mobilities are numbered in MobilizedBodyIndex order, so a body's ancestors'
+// mobilities always come before its own.
+void SimbodyMatterSubsystemRep::
+calcSparseMassMatrixStructure(const State& s, SBSparseMassMatrix& M) const {
+    const int nu = getNU(s);
+    M.parent.resize(nu); M.depth.resize(nu); M.rowStart.resize(nu+1);
+    for (MobilizedBodyIndex mbx(1); mbx < getNumBodies(); ++mbx) {
+        const RigidBodyNode& node = getRigidBodyNode(mbx);
+        // Find the nearest ancestor that has mobilities, if any.
+        const RigidBodyNode* p = node.getParent();
+        while (!p->isGroundNode() && p->getDOF() == 0)
+            p = p->getParent();
+        int prev = p->isGroundNode() ? -1 : p->getUIndex() + p->getDOF() - 1;
+        for (int k=0; k < node.getDOF(); ++k) {
+            const int i = node.getUIndex() + k;
+            M.parent[i] = prev;
+            M.depth[i]  = prev < 0 ? 0 : M.depth[prev] + 1;
+            prev = i;
+        }
+    }
+    M.rowStart[0] = 0;
+    for (int i=0; i < nu; ++i)
+        M.rowStart[i+1] = M.rowStart[i] + M.depth[i] + 1;
+    M.value.resize(M.rowStart[nu]);
+}
+
+// Calculate M with the composite rigid body method (Featherstone's CRBA), 
+// filling in only the lower triangle and only its structural nonzeroes. For
+// each mobility k of body B we form the spatial force F = R_B*H_B(k) needed 
+// to accelerate B's composite body along that mobility, then carry it inward
+// toward Ground, projecting onto the H columns of each body along the way.
+// Cost is O(n*d) for tree depth d, and the composite body inertias are
+// realized first if necessary.
+const SBSparseMassMatrix& SimbodyMatterSubsystemRep::
+getSparseMassMatrix(const State& s) const {
+    const CacheEntryIndex smx = topologyCache.sparseMassMatrixCacheIndex;
+    SBSparseMassMatrix& M = 
+        Value<SBSparseMassMatrix>::updDowncast(updCacheEntry(s, smx)).upd();
+    if (isCacheValueRealized(s, smx))
+        return M;
+
+    const Array_<SpatialInertia,MobilizedBodyIndex>& R = 
+        getCompositeBodyInertias(s);
+    const SBTreePositionCache& tpc = getTreePositionCache(s);
+
+    calcSparseMassMatrixStructure(s, M);
+    for (MobilizedBodyIndex mbx(1); mbx < getNumBodies(); ++mbx) {
+        const RigidBodyNode& node = getRigidBodyNode(mbx);
+        const int u0 = node.getUIndex();
+        for (int k=0; k < node.getDOF(); ++k) {
+            SpatialVec F = R[mbx] * node.getHCol(tpc, k);
+            for (int j=0; j <= k; ++j)
+                M.upd(u0+k, u0+j) = ~node.getHCol(tpc, j) * F;
+
+            const RigidBodyNode* child = &node;
+            for (const RigidBodyNode* p = node.getParent(); !p->isGroundNode();
+                 child = p, p = p->getParent()) 
+            {
+                F = child->getPhi(tpc) * F; // shift to parent's origin
+                for (int j=0; j < p->getDOF(); ++j)
+                    M.upd(u0+k, p->getUIndex()+j) = ~p->getHCol(tpc, j) * F;
+            }
+        }
+    }
+
+    markCacheValueRealized(s, smx);
+    return M;
+}
+
+
+
+//==============================================================================
+//                        GET MASS MATRIX FACTORIZATION
+//==============================================================================
+// Factor M = ~L D L in place in the branch-induced sparse format using 
+// Featherstone's LTDL algorithm (RBDA section 6.5). Working from the last 
+// mobility back, each row only updates rows of its preceding mobilities, and
+// only at columns already in their structure, so there is no fill-in. Cost 
+// is O(n*d^2) for tree depth d.
+const SBSparseMassMatrix& SimbodyMatterSubsystemRep::
+getMassMatrixFactorization(const State& s) const {
+    const CacheEntryIndex mfx = topologyCache.massMatrixFactorizationCacheIndex;
+    SBSparseMassMatrix& L = 
+        Value<SBSparseMassMatrix>::updDowncast(updCacheEntry(s, mfx)).upd();
+    if (isCacheValueRealized(s, mfx))
+        return L;
+
+    L = getSparseMassMatrix(s);
+    for (int k=L.size()-1; k >= 0; --k) {
+        SimTK_ERRCHK1_ALWAYS(L.get(k,k) > 0,
+            "SimbodyMatterSubsystem::getMassMatrixFactorization()",
+            "The mass matrix is singular at mobility %d; there is probably a "
+            "massless body at the end of a branch.", k);
+        for (int i=L.parent[k]; i >= 0; i=L.parent[i]) {
+            const Real a = L.get(k,i) / L.get(k,k);
+            for (int j=i; j >= 0; j=L.parent[j])
+                L.upd(i,j) -= a*L.get(k,j);
+            L.upd(k,i) = a;
+        }
+    }
+
+    markCacheValueRealized(s, mfx);
+    return L;
+}
+
+
+
+//==============================================================================
+//                      SOLVE WITH MASS MATRIX FACTORIZATION
+//==============================================================================
+// Solve M*udot = f for udot using ~L D L from getMassMatrixFactorization(). 
+// Each of the three passes costs O(n*d). Unlike multiplyByMInv() this uses the
+// whole mass matrix, including prescribed mobilities.
+void SimbodyMatterSubsystemRep::
+solveWithMassMatrixFactorization(const State&  s,
+                                 const Vector& f,
+                                 Vector&       udot) const
+{
+    const SBSparseMassMatrix& L = getMassMatrixFactorization(s);
+    const int nu = L.size();
+    SimTK_ERRCHK2_ALWAYS(f.size() == nu,
+        "SimbodyMatterSubsystem::solveM()",
+        "The right hand side had length %d but there are %d mobilities.",
+        f.size(), nu);
+
+    udot = f;
+    for (int i=nu-1; i >= 0; --i)       // ~L^-1
+        for (int j=L.parent[i]; j >= 0; j=L.parent[j])
+            udot[j] -= L.get(i,j) * udot[i];
+    for (int i=0; i < nu; ++i)          // D^-1
+        udot[i] /= L.get(i,i);
+    for (int i=0; i < nu; ++i)          // L^-1
+        for (int j=L.parent[i]; j >= 0; j=L.parent[j])
+            udot[i] -= L.get(i,j) * udot[j];
+}
+
+
+
+//==============================================================================
+//                      CALC TASK SPACE INERTIA INVERSE
+//==============================================================================
+// Return a SpatialMat as an ordinary 6x6 matrix.
+static Mat66 toMat66(const SpatialMat& S) {
+    Mat66 M;
+    for (int i=0; i < 2; ++i)
+        for (int j=0; j < 2; ++j)
+            M.updSubMat<3,3>(3*i, 3*j) = S(i,j);
+    return M;
+}
+
+// Consider a spatial force F applied at body B's origin, with no other 
+// forces and zero velocities. The articulated body method carries F inward 
+// to B's parent P as the articulated force Q_B*F, where 
+//      Q_B = Phi_B (1 - G_B ~H_B)
+// (just Phi_B if B's mobilities are prescribed), and the resulting 
+// acceleration of B is 
+//      A_B = ~Q_B A_P + H_B DI_B ~H_B F.
+// Since A_P is just P's response to the shifted force, we have 
+//      Omega_B = ~Q_B Omega_P Q_B + H_B DI_B ~H_B,     Omega_Ground = 0
+// for the acceleration of B per unit force on B. A force on any body outboard
+// of B reaches B as the product of the Q's along the path, and B's response 
+// reaches outboard bodies through the transposes. So for tasks s and t whose
+// nearest common ancestor is C, with K_t(C) the Q-shifted map from task t's
+// force to a spatial force at C, 
+//      Lambda^-1(s,t) = ~K_s(C) Omega_C K_t(C).
+// This is the extended-force-propagator form of the operational-space inertia
+// algorithm. We work with generic 6x6 matrices here so that the mobilizer-
+// specific code isn't needed; H's unused columns are zero and D is padded 
+// with the identity.
+void SimbodyMatterSubsystemRep::
+calcTaskSpaceInertiaInverse(const State&            s,
+                            const TaskJacobianPlan& tasks,
+                            Matrix&                 LambdaInv) const
+{
+    const SBInstanceCache&      ic  = getInstanceCache(s);
+    const SBTreePositionCache&  tpc = getTreePositionCache(s);
+    realizeArticulatedBodyInertias(s); // (may already have been realized)
+    const SBArticulatedBodyInertiaCache& abc = 
+        getArticulatedBodyInertiaCache(s);
+
+    const int nb = getNumBodies();
+    const int nt = tasks.getNumTasks();
+
+    // Only bodies on a task's path are needed; paths include all ancestors.
+    Array_<bool,MobilizedBodyIndex> isOnPath(nb, false);
+    int nPathEntries = 0;
+    for (int t=0; t < nt; ++t) {
+        const ArrayViewConst_<MobilizedBodyIndex> path = tasks.getPath(t);
+        for (unsigned i=0; i < path.size(); ++i) isOnPath[path[i]] = true;
+        nPathEntries += path.size();
+    }
+
+    // Outward pass to get Q_B and Omega_B for bodies on paths. Parents are
+    // numbered before children.
+    Array_<Mat66,MobilizedBodyIndex> Q(nb), Omega(nb);
+    for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx) {
+        if (!isOnPath[mbx]) continue;
+        const RigidBodyNode& node = getRigidBodyNode(mbx);
+        const Mat66 Phi = toMat66(node.getPhi(tpc).toSpatialMat());
+        const int dof = node.getDOF();
+        if (dof == 0 || node.isUDotKnown(ic)) {
+            Q[mbx] = Phi;
+            Omega[mbx] = 0;
         } else {
-            multiplyByM(s, v, contig_col);
-            M(i) = contig_col;
+            Mat66 H(0);
+            for (int j=0; j < dof; ++j) {
+                const SpatialVec& Hj = node.getHCol(tpc, j);
+                for (int k=0; k < 3; ++k) {H(k,j) = Hj[0][k]; H(3+k,j) = Hj[1][k];}
+            }
+            const Mat66 PH = toMat66(node.getP(abc).toSpatialMat()) * H;
+            Mat66 D = ~H*PH;
+            for (int j=dof; j < 6; ++j) D(j,j) = 1;
+            const Mat66 DI = D.invert();
+            Q[mbx] = Phi * (Mat66(1) - PH*DI*~H);
+            Omega[mbx] = H*DI*~H;
+        }
+        const MobilizedBodyIndex px(node.getParent()->getNodeNum());
+        if (px != GroundIndex)
+            Omega[mbx] += ~Q[mbx] * Omega[px] * Q[mbx];
+    }
+
+    // Carry each task's force map inward along its path. K[first] shifts
+    // forces at the task station to the task body's origin.
+    Array_<int> firstK(nt);
+    Array_<Mat66> K(nPathEntries);
+    for (int t=0, nxt=0; t < nt; ++t) {
+        const ArrayViewConst_<MobilizedBodyIndex> path = tasks.getPath(t);
+        firstK[t] = nxt;
+        if (path.empty()) continue; // task is on Ground
+        const Vec3 p_BS_G = getBodyTransform(s, tasks.getTaskBody(t)).R()
+                            * tasks.getTaskStation(t);
+        K[nxt] = toMat66(PhiMatrix(p_BS_G).toSpatialMat());
+        for (unsigned i=1; i < path.size(); ++i)
+            K[nxt+i] = Q[path[i-1]] * K[nxt+i-1];
+        nxt += path.size();
+    }
+
+    // Fill in Lambda^-1 one pair of tasks at a time, using symmetry. Station
+    // tasks use only the linear (bottom) half of their rows and columns.
+    LambdaInv.resize(tasks.getNumRows(), tasks.getNumRows());
+    LambdaInv.setToZero();
+    for (int si=0; si < nt; ++si) {
+        const ArrayViewConst_<MobilizedBodyIndex> spath = tasks.getPath(si);
+        const int srow = tasks.getFirstRow(si);
+        const int s0 = tasks.isFrameTask(si) ? 0 : 3;
+        for (int ti=si; ti < nt; ++ti) {
+            const ArrayViewConst_<MobilizedBodyIndex> tpath = tasks.getPath(ti);
+            // Find the nearest common ancestor, working out from the bases.
+            int is = (int)spath.size()-1, it = (int)tpath.size()-1;
+            if (is < 0 || it < 0 || spath[is] != tpath[it])
+                continue; // not coupled
+            while (is > 0 && it > 0 && spath[is-1] == tpath[it-1]) 
+            {   --is; --it; }
+            const Mat66 Lst = ~K[firstK[si]+is] * Omega[spath[is]] 
+                              * K[firstK[ti]+it];
+
+            const int trow = tasks.getFirstRow(ti);
+            const int t0 = tasks.isFrameTask(ti) ? 0 : 3;
+            for (int i=s0; i < 6; ++i)
+                for (int j=t0; j < 6; ++j)
+                    LambdaInv(srow+i-s0, trow+j-t0) = 
+                        LambdaInv(trow+j-t0, srow+i-s0) = Lst(i,j);
         }
-        v[i] = 0;
     }
 }
 
@@ -5486,32 +6793,42 @@ void SimbodyMatterSubsystemRep::calcM(const State& s, Matrix& M) const {
 //                                CALC MInv
 //==============================================================================
 // Calculate the mass matrix inverse MInv(=M^-1) in O(n^2) time. This Subsystem
-// must already have been realized to Position stage.
+// must already have been realized to Position stage. As for M, the result
+// is cached and reused until the configuration changes.
 // It is OK if MInv's data is not contiguous.
 void SimbodyMatterSubsystemRep::calcMInv(const State& s, Matrix& MInv) const {
+    MInv = getMassMatrixInverse(s);
+}
+
+const Matrix& SimbodyMatterSubsystemRep::
+getMassMatrixInverse(const State& s) const {
+    const CacheEntryIndex mix = topologyCache.massMatrixInverseCacheIndex;
+    Matrix& MInv = Value<Matrix>::updDowncast(updCacheEntry(s, mix)).upd();
+    if (isCacheValueRealized(s, mix))
+        return MInv;
+
     const int nu = getTotalDOF();
     MInv.resize(nu,nu);
-    if (nu==0) return;
+
+    // Rows and columns for prescribed mobilities are zero. multiplyByMInv()
+    // writes zeroes into the prescribed rows of each column it computes, but
+    // we have to clear the prescribed columns ourselves since we skip them.
+    MInv.setToZero();
 
     // This could probably be calculated faster by doing it directly and
     // filling in only half. For now we're doing it with repeated calls to
-    // the O(n) operator multiplyByMInv().
-
-    // If M's columns are contiguous we can avoid copying.
-    const bool isContiguous = MInv(0).hasContiguousData();
-    Vector contig_col(isContiguous ? 0 : nu);
-
+    // the O(n) operator multiplyByMInv(), which itself uses the cached
+    // articulated body inertias.
+    const Array_<UIndex>& freeUDot = getInstanceCache(s).freeUDot;
     Vector f(nu); f.setToZero();
-    for (int i=0; i < nu; ++i) {
+    for (UIndex i : freeUDot) {
         f[i] = 1;
-        if (isContiguous) {
-            multiplyByMInv(s, f, MInv(i));
-        } else {
-            multiplyByMInv(s, f, contig_col);
-            MInv(i) = contig_col;
-        }
+        multiplyByMInv(s, f, MInv(i));
         f[i] = 0;
     }
+
+    markCacheValueRealized(s, mix);
+    return MInv;
 }
 
 
@@ -5584,8 +6901,9 @@ void SimbodyMatterSubsystemRep::calcTreeResidualForces(const State& s,
     assert(residualMobilityForces.hasContiguousData());
 
 
-    // Allocate temporary.
-    Vector_<SpatialVec> allFTmp(getNumBodies());
+    // Temporary, kept in the State so that repeated calls don't allocate.
+    Vector_<SpatialVec>& allFTmp = updOperatorWorkspace(s).residualBodyForces;
+    allFTmp.resize(getNumBodies());
 
     // Make pointers to (contiguous) Vector data for fast access.
     const Real* knownUdotPtr = &(*pKnownUdot)[0];
@@ -5598,23 +6916,214 @@ void SimbodyMatterSubsystemRep::calcTreeResidualForces(const State& s,
                         ? &residualMobilityForces[0] : NULL;
     SpatialVec* tempPtr = allFTmp.size() ? &allFTmp[0] : NULL;
 
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcBodyAccelerationsFromUdotOutward
-               (tpc,tvc,knownUdotPtr,aPtr);
+    sweepOutward([&](const RigidBodyNode& node) {
+        node.calcBodyAccelerationsFromUdotOutward
+           (tpc,tvc,knownUdotPtr,aPtr);
+    });
+
+    sweepInward([&](const RigidBodyNode& node) {
+        node.calcInverseDynamicsPass2Inward(
+            tpc,tvc,aPtr,
+            mobilityForcePtr,bodyForcePtr,
+            tempPtr,residualPtr);
+    });
+}
+//........................ CALC TREE RESIDUAL FORCES ...........................
+
+
+
+//==============================================================================
+//                        CALC TREE RESIDUAL DERIVATIVE
+//==============================================================================
+bool SimbodyMatterSubsystemRep::hasConstantAcrossJointVelocityJacobians() const
+{
+    for (int i=0; i<(int)rbNodeLevels.size(); ++i)
+        for (const RigidBodyNode* node : rbNodeLevels[i])
+            if (!node->isAcrossJointVelocityJacobianConstant())
+                return false;
+    return true;
+}
+
+// A change dq moves the bodies as would speeds w = N^-1 dq. Quaternions are
+// normalized before use and NInv is linear in q, so dividing a quaternion's
+// dq by |q|^2 gives the w of the normalized quaternion.
+void SimbodyMatterSubsystemRep::calcVirtualSpeeds
+   (const State& s, const Vector& dq, Vector& w) const
+{
+    Vector dqNorm = dq;
+    const SBStateDigest sbs(s, *this, Stage(Stage::Position).next());
+    for (int i=1; i<(int)rbNodeLevels.size(); ++i)
+        for (const RigidBodyNode* node : rbNodeLevels[i]) {
+            MobilizerQIndex startOfQuaternion;
+            if (!node->isUsingQuaternion(sbs, startOfQuaternion))
+                continue;
+            const int qx = node->getQIndex() + startOfQuaternion;
+            const Vec4& quat = Vec4::getAs(&getQ(s)[qx]);
+            Vec4::updAs(&dqNorm[qx]) /= quat.normSqr();
+        }
+    multiplyByNInv(s, false, dqNorm, w);
+}
+
+// Central difference of the System's applied forces along (dq,du), used when
+// some force element can't supply its own derivative.
+static void differenceAppliedForces(const MultibodySystem&    mbs,
+                                    const Subsystem::Guts&    matter,
+                                    const State&              s,
+                                    const Vector&             dq,
+                                    const Vector&             du,
+                                    Vector_<SpatialVec>&      dBodyForces,
+                                    Vector&                   dMobilityForces)
+{
+    dBodyForces = SpatialVec(Vec3(0),Vec3(0));
+    dMobilityForces = 0;
+    const Vector& q = matter.getQ(s);
+    const Vector& u = matter.getU(s);
+    const Real dirMax = std::max(dq.size() ? max(abs(dq)) : Real(0),
+                                 du.size() ? max(abs(du)) : Real(0));
+    if (dirMax == 0) 
+        return;
+    const Real xMax = std::max(q.size() ? max(abs(q)) : Real(0),
+                               u.size() ? max(abs(u)) : Real(0));
+    const Real h = std::cbrt(NTraits<Real>::getEps()) 
+                   * std::max(Real(1), xMax) / dirMax;
+
+    State tmp = s;
+    for (Real sign=1; sign >= -1; sign -= 2) {
+        matter.updQ(tmp) = q + (sign*h)*dq;
+        matter.updU(tmp) = u + (sign*h)*du;
+        mbs.realize(tmp, Stage::Dynamics);
+        dBodyForces     += sign*mbs.getRigidBodyForces(tmp, Stage::Dynamics);
+        dMobilityForces += sign*mbs.getMobilityForces(tmp, Stage::Dynamics);
+    }
+    dBodyForces     /= 2*h;
+    dMobilityForces /= 2*h;
+}
+
+// Dual-number spatial vectors carrying a value and its derivative, and the 
+// derivative part of one.
+static Vec<2,Vec<3,Dual> > makeDual(const SpatialVec& v, const SpatialVec& d) {
+    Vec<2,Vec<3,Dual> > out;
+    for (int k=0; k < 2; ++k)
+        for (int r=0; r < 3; ++r)
+            out[k][r] = Dual(v[k][r], d[k][r]);
+    return out;
+}
+
+static SpatialVec derivOf(const Vec<2,Vec<3,Dual> >& v) {
+    SpatialVec out;
+    for (int k=0; k < 2; ++k)
+        for (int r=0; r < 3; ++r)
+            out[k][r] = v[k][r].deriv();
+    return out;
+}
+
+// The tree kinematics and inverse dynamics recursions are run once on Dual
+// numbers. Each mobilizer's X_FM is seeded with its change H_FM*w as a twist 
+// in F, and each u with du; the recursions then carry the derivatives through 
+// every composition exactly. The applied forces' derivatives come from the 
+// force elements where they can supply them, otherwise from central 
+// differences.
+void SimbodyMatterSubsystemRep::calcTreeResidualDerivative
+   (const State&  s,
+    const Vector& knownUdot,
+    const Vector& dq,
+    const Vector& du,
+    Vector&       dResidual) const
+{
+    assert(hasConstantAcrossJointVelocityJacobians());
+    const MultibodySystem&     mbs = getMultibodySystem();
+    const SBTreePositionCache& tpc = getTreePositionCache(s);
+    const int nb = getNumBodies(), nu = getNumMobilities();
+    assert(knownUdot.size()==nu && dq.size()==getNQ(s) && du.size()==nu);
+
+    Vector w(nu);
+    calcVirtualSpeeds(s, dq, w);
+
+    SBTreeKinematics_<Dual> kc;
+    kc.allocate(nb, nu);
+    for (int i=0; i < 2*nu; ++i)
+        kc.storageForH_FM[i] = Vec<3,Dual>(tpc.storageForH_FM[i]);
+
+    for (int i=1; i<(int)rbNodeLevels.size(); ++i)
+        for (const RigidBodyNode* node : rbNodeLevels[i]) {
+            SpatialVec T_FM(Vec3(0), Vec3(0));
+            for (int j=0; j < node->getDOF(); ++j)
+                T_FM += w[node->getUIndex()+j] * node->getH_FMCol(tpc, j);
+            const Transform& X = node->getX_FM(tpc);
+            const Mat33 dR = crossMat(T_FM[0]) * X.R().asMat33();
+            Mat<3,3,Dual> R;
+            Vec<3,Dual>   p;
+            for (int r=0; r < 3; ++r) {
+                for (int c=0; c < 3; ++c)
+                    R(r,c) = Dual(X.R().asMat33()(r,c), dR(r,c));
+                p[r] = Dual(X.p()[r], T_FM[1][r]);
+            }
+            kc.bodyJointInParentJointFrame[node->getNodeNum()] = 
+                Transform_<Dual>(Rotation_<Dual>(R,true), p);
         }
 
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcInverseDynamicsPass2Inward(
-                tpc,tvc,aPtr,
-                mobilityForcePtr,bodyForcePtr,
-                tempPtr,residualPtr);
+    const Vector& u = getU(s);
+    Array_<Dual> uDual(nu), udotDual(nu), tauApp(nu), tau(nu);
+    for (int i=0; i < nu; ++i) {
+        uDual[i]    = Dual(u[i], du[i]);
+        udotDual[i] = Dual(knownUdot[i]);
+    }
+
+    Array_< Vec<2,Vec<3,Dual> > > A_GB(nb), bodyF(nb), F(nb);
+    const Dual* uPtr    = nu ? &uDual[0] : NULL;
+    const Dual* udotPtr = nu ? &udotDual[0] : NULL;
+
+    sweepOutward([&](const RigidBodyNode& node) {
+        node.realizeKinematicsDual(uPtr, kc);
+        node.calcBodyAccelerationsFromUdotOutwardDual(kc, udotPtr, 
+                                                      A_GB.begin());
+    });
+
+    // Each body's change of pose as a twist in G, and of velocity.
+    Vector_<SpatialVec> T_GB(nb), dV_GB(nb);
+    for (MobilizedBodyIndex b(0); b < nb; ++b) {
+        const Transform_<Dual>& X_GB = kc.bodyConfigInGround[b];
+        Mat33 R0, dR;
+        Vec3  dp;
+        for (int r=0; r < 3; ++r) {
+            for (int c=0; c < 3; ++c) {
+                R0(r,c) = X_GB.R().asMat33()(r,c).value();
+                dR(r,c) = X_GB.R().asMat33()(r,c).deriv();
+            }
+            dp[r] = X_GB.p()[r].deriv();
         }
+        const Mat33 W = dR * ~R0;
+        T_GB[b]  = SpatialVec(Vec3(W(2,1)-W(1,2), W(0,2)-W(2,0), 
+                                   W(1,0)-W(0,1)) / 2, dp);
+        dV_GB[b] = derivOf(kc.bodyVelocityInGround[b]);
+    }
+
+    // Applied forces and their change along this direction.
+    const Vector_<SpatialVec>& F_app = mbs.getRigidBodyForces(s,Stage::Dynamics);
+    const Vector&            tau_app = mbs.getMobilityForces(s,Stage::Dynamics);
+    Vector_<SpatialVec> dF_app(nb, SpatialVec(Vec3(0),Vec3(0)));
+    Vector              dTau_app(nu, Real(0));
+    if (!mbs.getRep().calcForceDerivative(s, dq, du, T_GB, dV_GB, 
+                                          dF_app, dTau_app))
+        differenceAppliedForces(mbs, *this, s, dq, du, 
+                                dF_app, dTau_app);
+
+    for (int b=0; b < nb; ++b)
+        bodyF[b] = makeDual(F_app[b], dF_app[b]);
+    for (int i=0; i < nu; ++i)
+        tauApp[i] = Dual(tau_app[i], dTau_app[i]);
+    const Dual* mobPtr = nu ? &tauApp[0] : NULL;
+    Dual*       tauPtr = nu ? &tau[0] : NULL;
+
+    sweepInward([&](const RigidBodyNode& node) {
+        node.calcInverseDynamicsPass2InwardDual(kc, A_GB.cbegin(), mobPtr,
+            bodyF.cbegin(), F.begin(), tauPtr);
+    });
+
+    dResidual.resize(nu);
+    for (int i=0; i < nu; ++i)
+        dResidual[i] = tau[i].deriv();
 }
-//........................ CALC TREE RESIDUAL FORCES ...........................
 
 
 
@@ -5783,10 +7292,37 @@ void SimbodyMatterSubsystemRep::multiplyByNInv
 // the reaction forces.
 //
 // Cost is 114 flops/body plus lots of memory access to dredge up the 
-// already-calculated goodies. If you don't need all the reactions, you can 
-// calculate them one at a time as needed just as efficiently.
+// already-calculated goodies. Each body needs only its parent's acceleration,
+// so this is a single pass over the bodies in any order. The result is kept
+// in a lazy cache entry so that repeated requests at the same Acceleration
+// stage (for example, for several reporters) don't redo the calculation.
+const Vector_<SpatialVec>& SimbodyMatterSubsystemRep::
+getMobilizerReactionForces(const State& s) const {
+    const CacheEntryIndex mrx = topologyCache.mobilizerReactionForcesCacheIndex;
+    if (!isCacheValueRealized(s, mrx)) {
+        SimTK_STAGECHECK_GE_ALWAYS(getStage(s), Stage::Acceleration,
+            "SimbodyMatterSubsystem::getMobilizerReactionForces()");
+        Vector_<SpatialVec>& FM_G = Value< Vector_<SpatialVec> >::
+                                        updDowncast(updCacheEntry(s, mrx));
+        calcMobilizerReactionForcesFromCache(s, FM_G);
+        markCacheValueRealized(s, mrx);
+    }
+    return Value< Vector_<SpatialVec> >::downcast(getCacheEntry(s, mrx));
+}
+
+// Copy the cached reactions into the caller's Vector; no heap allocation
+// occurs if it is already the right size (or is a view of the right size).
 void SimbodyMatterSubsystemRep::calcMobilizerReactionForces
    (const State& s, Vector_<SpatialVec>& FM_G) const 
+{
+    FM_G = getMobilizerReactionForces(s);
+}
+
+// This does the work, writing into the given Vector which is resized if
+// necessary. We work directly from the tree caches rather than going through
+// MobilizedBody handles.
+void SimbodyMatterSubsystemRep::calcMobilizerReactionForcesFromCache
+   (const State& s, Vector_<SpatialVec>& FM_G) const 
 {
     const int nb = getNumBodies();
     // We're going to work with forces in Ground, applied at the body frame
@@ -5794,27 +7330,28 @@ void SimbodyMatterSubsystemRep::calcMobilizerReactionForces
     // (though still expressed in Ground).
     FM_G.resize(nb);
 
+    const SBTreePositionCache&     tpc = getTreePositionCache(s);
+    const SBTreeAccelerationCache& tac = getTreeAccelerationCache(s);
     const Array_<ArticulatedInertia,MobilizedBodyIndex>& PPlus = 
                                             getArticulatedBodyInertiasPlus(s);
-    const Array_<SpatialVec,MobilizedBodyIndex>& zPlus =
-                                            getArticulatedBodyForcesPlus(s);
+    const Array_<SpatialVec,MobilizedBodyIndex>& zPlus = tac.zPlus;
 
     for (MobodIndex mbx(0); mbx < nb; ++mbx) {
-        const MobilizedBody& body = getMobilizedBody(mbx);
-        const Transform& X_GB = body.getBodyTransform(s);
+        const RigidBodyNode& node = getRigidBodyNode(mbx);
+        const Transform& X_GB = tpc.getX_GB(mbx);
      
         SpatialVec FB_G = zPlus[mbx];
         if (mbx != GroundIndex) {
-            const MobilizedBody& parent = body.getParentMobilizedBody();
-            const Transform&  X_GP = parent.getBodyTransform(s);
-            const SpatialVec& A_GP = parent.getBodyAcceleration(s);
+            const MobodIndex  px   = node.getParent()->getNodeNum();
+            const Transform&  X_GP = tpc.getX_GB(px);
+            const SpatialVec& A_GP = tac.getA_GB(px);
             const Vec3& p_PB_G = X_GB.p() - X_GP.p(); // 3 flops
             SpatialVec APlus( A_GP[0],
                               A_GP[1] + A_GP[0] % p_PB_G ); // 12 flops
             FB_G += PPlus[mbx]*APlus; // 72 flops
         }
         // Shift to M
-        const Vec3&      p_BM   = body.getOutboardFrame(s).p();
+        const Vec3&      p_BM   = node.getX_BM().p();
         const Vec3       p_BM_G = X_GB.R()*p_BM; // p_BM in G, 15 flops
         FM_G[mbx] = shiftForceBy(FB_G, p_BM_G);  // 12 flops
     }
@@ -5841,13 +7378,15 @@ void SimbodyMatterSubsystemRep::calcMobilizerReactionForcesUsingFreebodyMethod
     // Find the body forces on every body from all sources *other* than 
     // mobilizer reaction forces; we accumulate them in otherForces_G.
     
-    // First, get the applied body forces (at Bo).
-    Vector_<SpatialVec> otherFB_G = 
-        getMultibodySystem().getRigidBodyForces(s, Stage::Dynamics);
+    // First, get the applied body forces (at Bo). We use the operator
+    // workspace for the temporaries to avoid heap allocation.
+    SBOperatorWorkspace& ws = updOperatorWorkspace(s);
+    Vector_<SpatialVec>& otherFB_G = ws.residualBodyForces;
+    otherFB_G = getMultibodySystem().getRigidBodyForces(s, Stage::Dynamics);
 
     // Plus body forces applied by constraints (watch the sign).
-    Vector_<SpatialVec> constrainedBodyForces_G(getNumBodies());
-    Vector constrainedMobilizerForces(s.getNU());
+    Vector_<SpatialVec>& constrainedBodyForces_G = ws.constraintBodyForcesInG;
+    Vector& constrainedMobilizerForces = ws.constraintMobilityForces;
     calcConstraintForcesFromMultipliers(s, s.getMultipliers(), 
         constrainedBodyForces_G, constrainedMobilizerForces);
     otherFB_G -= constrainedBodyForces_G;
@@ -6397,6 +7936,14 @@ void SimbodyMatterSubsystemRep::setShowDefaultGeometry(bool show) {
     showDefaultGeometry = show;
 }
 
+// The partitioning depends on the thread count so we have to redo topology.
+void SimbodyMatterSubsystemRep::setNumberOfThreads(int numThreads) {
+    SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "SimbodyMatterSubsystemRep",
+                "setNumberOfThreads", "Number of threads must be positive");
+    invalidateSubsystemTopologyCache();
+    treeSweepExecutor = new ParallelExecutor(numThreads);
+}
+
 std::ostream& operator<<(std::ostream& o, const SimbodyMatterSubsystemRep& tree) {
     o << "SimbodyMatterSubsystemRep has " << tree.getNumBodies() << " bodies (incl. G) in "
       << tree.rbNodeLevels.size() << " levels." << std::endl;
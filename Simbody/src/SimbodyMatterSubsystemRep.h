@@ -39,6 +39,7 @@
 #include <set>
 #include <map>
 #include <utility> // std::pair
+#include <cstdint>
 using std::pair;
 
 
@@ -141,7 +142,14 @@ private:
 class SimbodyMatterSubsystemRep : public SimTK::Subsystem::Guts {
 public:
     SimbodyMatterSubsystemRep() 
-      : Subsystem::Guts("SimbodyMatterSubsystem", "0.7.1")
+      : Subsystem::Guts("SimbodyMatterSubsystem", "0.7.1"),
+        useParallelTreeSweeps(false),
+        treeSweepExecutor(new ParallelExecutor()),
+        useCholeskyForMultipliers(false), useIterativeMultiplierSolver(false),
+        iterativeMultiplierSolverTolerance(1e-10),
+        useIncrementalPositionKinematics(false),
+        useModifiedNewtonProjection(false),
+        useParallelConstraintEvaluation(false)
     { 
         clearTopologyCache();
     }
@@ -496,6 +504,8 @@ public:
     // Call at Instance Stage or later. Depends on q; automatically realized
     // at Stage::Position.
     void realizePositionKinematics(const State&) const;
+    bool realizeChangedPositionKinematics(const State&, 
+                                          const SBStateDigest&) const;
 
     // Call at Instance + PositionKinematics Stage or later. Depends on u;
     // automatically realized at Stage::Velocity.
@@ -608,6 +618,35 @@ public:
     // are not written.
     void calcMInv(const State& s, Matrix& MInv) const;
 
+    // Return the mass matrix or its inverse from the cache, calculating it
+    // first if the configuration has changed since it was last calculated.
+    // Requires PositionKinematics.
+    const Matrix& getMassMatrix(const State& s) const;
+    const Matrix& getMassMatrixInverse(const State& s) const;
+
+    // The lower triangle of M in branch-induced sparse form, calculated by
+    // the composite rigid body method, and its ~L D L factorization in the
+    // same form. Both are cached like getMassMatrix(). 
+    const SBSparseMassMatrix& getSparseMassMatrix(const State& s) const;
+    const SBSparseMassMatrix& getMassMatrixFactorization(const State& s) const;
+    void calcSparseMassMatrixStructure(const State& s, 
+                                       SBSparseMassMatrix& M) const;
+
+    // Solve M*udot=f using the cached factorization. Unlike multiplyByMInv()
+    // this involves all the mobilities, whether prescribed or not.
+    void solveWithMassMatrixFactorization(const State&  s,
+                                          const Vector& f,
+                                          Vector&       udot) const;
+
+    // Calculate J M^-1 ~J for the tasks in the given plan using articulated 
+    // body quantities rather than forming J or M^-1.
+    void calcTaskSpaceInertiaInverse(const State&            s,
+                                     const TaskJacobianPlan& tasks,
+                                     Matrix&                 LambdaInv) const;
+
+    // Tree inverse dynamics. The body force temporary lives in the State's 
+    // operator workspace, so although the State is const this is not 
+    // reentrant: don't call it concurrently on the same State.
     void calcTreeResidualForces(const State&,
         const Vector&               appliedMobilityForces,
         const Vector_<SpatialVec>&  appliedBodyForces,
@@ -615,6 +654,28 @@ public:
         Vector_<SpatialVec>&        A_GB,
         Vector&                     residualMobilityForces) const;
 
+    // True if every mobilizer has a constant H_FM, so that 
+    // calcTreeResidualDerivative() can be used.
+    bool hasConstantAcrossJointVelocityJacobians() const;
+
+    // Calculate the change in the calcTreeResidualForces() residual, using the
+    // forces the System applies at Dynamics stage and fixed udot, for a 
+    // change (dq,du) in the state. The kinematics and inverse dynamics 
+    // recursions are run once on Dual numbers; force elements supply their own
+    // derivatives where they can, otherwise theirs are found by central 
+    // differences. Requires hasConstantAcrossJointVelocityJacobians() and 
+    // Stage::Dynamics. All Vectors must be full length and contiguous.
+    void calcTreeResidualDerivative(const State&  s,
+                                    const Vector& knownUdot,
+                                    const Vector& dq,
+                                    const Vector& du,
+                                    Vector&       dResidual) const;
+
+    // Calculate the virtual speeds w=N^-1*dq that move the bodies as a change
+    // dq in q would, allowing for the normalization of quaternions. Requires
+    // Stage::Position.
+    void calcVirtualSpeeds(const State& s, const Vector& dq, Vector& w) const;
+
 
 
     // Must be in Stage::Position to calculate out_q = N(q)*in_u (e.g., qdot=N*u)
@@ -752,7 +813,11 @@ public:
     void calcAccelerationOnlyConstraintMatrixA (const State&, Matrix&) const; // ma X nu
     void calcAccelerationOnlyConstraintMatrixAt(const State&, Matrix&) const; // nu X ma
 
+    // Mobilizer reaction forces are calculated at most once per Acceleration
+    // stage and cached; the calc version copies them into the given Vector.
+    const Vector_<SpatialVec>& getMobilizerReactionForces(const State& s) const;
     void calcMobilizerReactionForces(const State& s, Vector_<SpatialVec>& forces) const;
+    void calcMobilizerReactionForcesFromCache(const State& s, Vector_<SpatialVec>& forces) const;
     // This alternative is for debugging and testing; it is slow but should
     // produce the same answers as calcMobilizerReactionForces().
     void calcMobilizerReactionForcesUsingFreebodyMethod(const State& s, Vector_<SpatialVec>& forces) const;
@@ -937,6 +1002,15 @@ public:
     void calcGMInvGt(const State&   state,
                      Matrix&        GMInvGt) const;
 
+    // Visit the entries of G * M^-1 * G^T that are structurally nonzero 
+    // according to the constraint coupling recorded in the InstanceCache,
+    // calling visit(i,j,value) for each. Columns are computed for a whole 
+    // group of mutually uncoupled Constraints at once, so the cost is
+    // O(ncolors*maxEq*n) rather than O(m*n) and no mXm storage is needed.
+    template <class Visitor>
+    void visitGMInvGtEntries(const State&   state,
+                             const Visitor& visit) const;
+
     // Use factored GMInvGt to solve GMinvGt*impulse=deltaV. The main benefit
     // of this method is that it promises to use the same method Simbody does
     // to deal with constraint redundancies.
@@ -944,6 +1018,36 @@ public:
                                     const Vector&    deltaV,
                                     Vector&          impulse) const;
 
+    // Return the factored GMInvGt, forming and factoring it first if the
+    // cached factorization isn't valid for this State. Requires Stage::Position
+    // (and Stage::Velocity if any constraint has velocity-dependent G).
+    const SBConstraintFactorizationCache& 
+    getConstraintFactorization(const State& state) const;
+
+    // Solve GMInvGt*lambda = aerr by preconditioned conjugate gradients 
+    // using only O(n) operators, starting from the previous solution. Returns
+    // false if that fails, leaving lambda unspecified.
+    bool solveForMultipliersIteratively(const State&  state,
+                                        const Vector& aerr,
+                                        Vector&       lambda) const;
+
+    // Return the diagonal preconditioner for the iterative solver, 
+    // calculating it first if necessary.
+    const Vector& getMultiplierPreconditioner(const State& state) const;
+
+    // Form G*M^-1*~G directly in the sparse profile recorded in the 
+    // InstanceCache and factor it with an envelope Cholesky factorization
+    // into cfc. Returns false if that fails or is poorly conditioned.
+    bool factorGMInvGtProfileCholesky(const State&  state,
+                                      Real          conditioningTol,
+                                      SBConstraintFactorizationCache& cfc) const;
+
+    // Solve GMInvGt*x = rhs for x using the cached factorization, in the 
+    // least squares sense if GMInvGt is rank deficient.
+    void solveWithConstraintFactorization(const State&   state,
+                                          const Vector&  rhs,
+                                          Vector&        x) const;
+
     // Given an array of nu udots, return nb body accelerations in G (including
     // Ground as the 0th body with A_GB[0]=0). The returned accelerations are
     // A = J*udot + Jdot*u, with the Jdot*u (coriolis acceleration) term
@@ -1110,6 +1214,53 @@ public:
                 topologyCache.articulatedBodyVelocityCacheIndex)).upd();
     }
 
+    const SBConstraintFactorizationCache& 
+    getConstraintFactorizationCache(const State& state) const {
+        return Value<SBConstraintFactorizationCache>::downcast
+           (state.getCacheEntry(getMySubsystemIndex(),
+                topologyCache.constraintFactorizationCacheIndex)).get();
+    }
+
+    SBConstraintFactorizationCache& 
+    updConstraintFactorizationCache(const State& state) const { //mutable
+        return Value<SBConstraintFactorizationCache>::updDowncast
+            (state.updCacheEntry(getMySubsystemIndex(),
+                topologyCache.constraintFactorizationCacheIndex)).upd();
+    }
+
+    SBOperatorWorkspace& updOperatorWorkspace(const State& state) const { //mutable
+        return Value<SBOperatorWorkspace>::updDowncast
+            (state.updCacheEntry(getMySubsystemIndex(),
+                topologyCache.operatorWorkspaceCacheIndex)).upd();
+    }
+
+    SBMultiplierWarmStartCache& 
+    updMultiplierWarmStartCache(const State& state) const { //mutable
+        return Value<SBMultiplierWarmStartCache>::updDowncast
+            (state.updCacheEntry(getMySubsystemIndex(),
+                topologyCache.multiplierWarmStartCacheIndex)).upd();
+    }
+
+    // The projection statistics stay meaningful after an Instance-stage 
+    // change discards the factorizations themselves, so this reads the entry
+    // without requiring it to be current.
+    const SBProjectionFactorizationCache& 
+    getProjectionFactorizationCache(const State& state) const {
+        return updProjectionFactorizationCache(state);
+    }
+    SBProjectionFactorizationCache& 
+    updProjectionFactorizationCache(const State& state) const { //mutable
+        return Value<SBProjectionFactorizationCache>::updDowncast
+            (state.updCacheEntry(getMySubsystemIndex(),
+                topologyCache.projectionFactorizationCacheIndex)).upd();
+    }
+
+    // Return the projection factorizations for use by projectQ() or 
+    // projectU(), first discarding any that were formed before the most 
+    // recent Instance-stage change. Requires Stage::Instance.
+    SBProjectionFactorizationCache& 
+    updProjectionFactorizations(const State& state) const;
+
     const SBDynamicsCache& getDynamicsCache(const State& s, bool realizingDynamics=false) const {
         const AbstractValue& cacheEntry = 
             realizingDynamics ? (const AbstractValue&)s.updCacheEntry(getMySubsystemIndex(),topologyCache.dynamicsCacheIndex)
@@ -1210,6 +1361,96 @@ public:
     bool getShowDefaultGeometry() const;
     void setShowDefaultGeometry(bool show);
 
+    bool getUseParallelTreeSweeps() const {return useParallelTreeSweeps;}
+    void setUseParallelTreeSweeps(bool useParallel) 
+    {   useParallelTreeSweeps = useParallel; }
+    void setNumberOfThreads(int numThreads);
+    int getNumberOfThreads() const
+    {   return treeSweepExecutor->getMaxThreads(); }
+
+    bool getUseParallelConstraintEvaluation() const 
+    {   return useParallelConstraintEvaluation; }
+    void setUseParallelConstraintEvaluation(bool useParallel)
+    {   useParallelConstraintEvaluation = useParallel; }
+
+    bool getUseCholeskyForMultipliers() const 
+    {   return useCholeskyForMultipliers; }
+    void setUseCholeskyForMultipliers(bool useCholesky)
+    {   useCholeskyForMultipliers = useCholesky; }
+
+    bool getUseIterativeMultiplierSolver() const 
+    {   return useIterativeMultiplierSolver; }
+    void setUseIterativeMultiplierSolver(bool useIterative)
+    {   useIterativeMultiplierSolver = useIterative; }
+    Real getIterativeMultiplierSolverTolerance() const 
+    {   return iterativeMultiplierSolverTolerance; }
+    void setIterativeMultiplierSolverTolerance(Real tol)
+    {   iterativeMultiplierSolverTolerance = tol; }
+
+    bool getUseIncrementalPositionKinematics() const 
+    {   return useIncrementalPositionKinematics; }
+    void setUseIncrementalPositionKinematics(bool useIncremental)
+    {   useIncrementalPositionKinematics = useIncremental; }
+
+    bool getUseModifiedNewtonProjection() const 
+    {   return useModifiedNewtonProjection; }
+    void setUseModifiedNewtonProjection(bool useModifiedNewton)
+    {   useModifiedNewtonProjection = useModifiedNewton; }
+
+    // Driver for the batched multi-State operators. For each sample k
+    // (column of q, and of u if given) this sets q and u in a private copy of
+    // the template state, realizes the system through the given stage, and
+    // calls calc(s, k). Samples are dealt out in contiguous blocks, one per
+    // thread, each block with its own State copy so the results don't depend
+    // on the thread count. Nested tree sweeps run inline on the workers.
+    template <class Calc>
+    void evaluateForStates(const State& state, const char* methodName,
+                           const Matrix& q, const Matrix* u, Stage stage,
+                           const Calc& calc) const
+    {
+        const System& system = getSystem();
+        evaluateForStatesUsing(state, methodName, q, u,
+            [&](const State& s) {system.realize(s, stage);}, calc);
+    }
+
+    // Same, but calls realizeSample(s) instead of realizing the whole system
+    // for each sample, for operators that need only some of this subsystem's
+    // kinematics.
+    template <class Realize, class Calc>
+    void evaluateForStatesUsing(const State& state, const char* methodName,
+                                const Matrix& q, const Matrix* u, 
+                                const Realize& realizeSample,
+                                const Calc& calc) const
+    {
+        SimTK_STAGECHECK_GE_ALWAYS(getStage(state), Stage::Instance,
+                                   methodName);
+        const int nq = getNQ(state), nu = getNU(state);
+        const int nSamples = q.ncol();
+        SimTK_ERRCHK2_ALWAYS(q.nrow() == nq, methodName,
+            "Argument 'q' had %d rows but should have one per generalized "
+            "coordinate q (%d).", q.nrow(), nq);
+        SimTK_ERRCHK4_ALWAYS(!u || (u->nrow() == nu && u->ncol() == nSamples),
+            methodName, "Argument 'u' was %dx%d but should have one row per "
+            "generalized speed u (%d) and one column per sample (%d).",
+            u->nrow(), u->ncol(), nu, nSamples);
+        if (nSamples == 0)
+            return;
+
+        const int nBlocks =
+            std::min(nSamples, std::max(1, treeSweepExecutor->getMaxThreads()));
+        treeSweepExecutor->parallelFor(0, nBlocks, [&](int b) {
+            const int first = int((std::int64_t(nSamples)*b)/nBlocks);
+            const int last  = int((std::int64_t(nSamples)*(b+1))/nBlocks);
+            State s(state);
+            for (int k=first; k < last; ++k) {
+                s.updQ() = q(k);
+                if (u) s.updU() = (*u)(k);
+                realizeSample(s);
+                calc(s, k);
+            }
+        });
+    }
+
     void calcTreeForwardDynamicsOperator(const State&,
         const Vector&                   mobilityForces,
         const Vector_<Vec3>&            particleForces,
@@ -1364,8 +1605,61 @@ private:
     // Map nodeNum (a.k.a. MobilizedBodyIndex) to (level,offset).
     Array_<RigidBodyNodeIndex,MobilizedBodyIndex> nodeNum2NodeMap;
 
+    // For parallel tree sweeps we split the tree into a serial "trunk" that
+    // contains Ground and any bodies too close to the root to split further,
+    // and a set of partitions each consisting of whole subtrees hanging off
+    // the trunk. Partitions are independent of one another so can be swept
+    // concurrently once the trunk is done (base-to-tip) or before the trunk
+    // is done (tip-to-base). Each list is in base-to-tip order. These are 
+    // calculated by partitionTreeForParallelSweeps() during endConstruction().
+    RBNodePtrList           rbTrunkNodes;
+    Array_<RBNodePtrList>   rbNodePartitions;
+
+    void partitionTreeForParallelSweeps();
+
+    // Apply visit(const RigidBodyNode&) to every node such that parents are
+    // visited before their children (outward) or after them (inward), in
+    // parallel if that has been requested and the tree is suitable.
+    template <class Visitor> void sweepOutward(const Visitor& visit) const;
+    template <class Visitor> void sweepInward (const Visitor& visit) const;
+
+    // The nodes of each level regrouped so that nodes of identical concrete
+    // type are adjacent; rbNodeRunStarts[i] gives the index within
+    // rbNodeLevelsByType[i] at which each run begins, plus a final entry for
+    // the end of the level. Calculated by groupNodesByTypeForBatching() 
+    // during endConstruction().
+    Array_<RBNodePtrList>   rbNodeLevelsByType;
+    Array_< Array_<int> >   rbNodeRunStarts;
+
+    void groupNodesByTypeForBatching();
+
+    // Like sweepOutward() but calls visitRun(nodes, n) with runs of nodes
+    // that have the same concrete type so they can be handed to one of the 
+    // RigidBodyNode batch kernels.
+    template <class BatchVisitor> 
+    void sweepOutwardBatched(const BatchVisitor& visitRun) const;
+
         // Constraints
 
+    // Split the Constraints into contiguous blocks of ConstraintIndex and call
+    // visit(block, first, last) for each, where the block covers Constraints
+    // first <= cx < last. The blocks are run in parallel if that has been 
+    // requested and there are enough Constraints to make it worthwhile; 
+    // otherwise there is a single block 0. The number of blocks depends only
+    // on the number of Constraints and threads, so results that are reduced
+    // in block order are reproducible. Blocks run concurrently call the
+    // Functions of CoordinateCoupler, SpeedCoupler, and PrescribedMotion
+    // Constraints concurrently, so those must be thread-safe (documented at
+    // setUseParallelConstraintEvaluation()).
+    int getNumConstraintBlocks() const;
+    template <class Visitor> 
+    void forEachConstraintBlock(const Visitor& visit) const;
+
+    // Fill in the G*M^-1*~G sparsity structure in the InstanceCache (coupled
+    // Constraints, coloring, and multiplier ordering) once the enabled
+    // Constraints' equations have been counted in realizeInstance().
+    void calcConstraintCouplingStructure(SBInstanceCache& ic) const;
+
     // Here we sort the above constraints by branch (ancestor's base body), then by
     // level within that branch. That is, each constraint is addressed
     // by three indices [branch][levelOfAncestor][offset]
@@ -1436,6 +1730,31 @@ private:
     
     // Specifies whether default decorative geometry should be shown.
     bool showDefaultGeometry;
+
+    // Specifies whether tree sweeps should be run across multiple threads.
+    bool useParallelTreeSweeps;
+    mutable ClonePtr<ParallelExecutor> treeSweepExecutor;
+
+    // Specifies whether to try a Cholesky factorization of GMInvGt before
+    // falling back to QTZ.
+    bool useCholeskyForMultipliers;
+
+    // Options for solving for multipliers with conjugate gradients instead
+    // of factoring G*M^-1*~G; the tolerance is on the relative residual.
+    bool useIterativeMultiplierSolver;
+    Real iterativeMultiplierSolverTolerance;
+
+    // Specifies whether position kinematics should recalculate only the
+    // bodies outboard of mobilizers whose q's changed.
+    bool useIncrementalPositionKinematics;
+
+    // Specifies whether projectQ() and projectU() may reuse an earlier
+    // factorization of the constraint Jacobian.
+    bool useModifiedNewtonProjection;
+
+    // Specifies whether per-Constraint errors and forces should be evaluated
+    // in blocks across multiple threads (using treeSweepExecutor).
+    bool useParallelConstraintEvaluation;
 };
 
 std::ostream& operator<<(std::ostream&, const SimbodyMatterSubsystemRep&);
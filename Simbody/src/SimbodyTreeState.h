@@ -63,6 +63,7 @@ receive a state evaluated to stage Whatever-1 equipped with values for stage
 Whatever so that it can calculate results and put them in the cache (which is 
 allocated if necessary), and then advance to stage Whatever. */
 
+#include "SimTKmath.h"
 #include "simbody/internal/common.h"
 #include "simbody/internal/Motion.h"
 
@@ -86,12 +87,18 @@ class SBTimeCache;
 class SBTreePositionCache;
 class SBConstrainedPositionCache;
 class SBCompositeBodyInertiaCache;
+class SBSparseMassMatrix;
 class SBArticulatedBodyInertiaCache;
 class SBTreeVelocityCache;
 class SBConstrainedVelocityCache;
+class SBConstraintFactorizationCache;
 class SBDynamicsCache;
 class SBTreeAccelerationCache;
 class SBConstrainedAccelerationCache;
+class SBOperatorWorkspace;
+class SBMultiplierWarmStartCache;
+class SBPositionKinematicsRecord;
+class SBProjectionFactorizationCache;
 
 class SBModelVars;
 class SBInstanceVars;
@@ -152,11 +159,21 @@ public:
                           treePositionCacheIndex, constrainedPositionCacheIndex,
                           compositeBodyInertiaCacheIndex, 
                           articulatedBodyInertiaCacheIndex,
+                          massMatrixCacheIndex, massMatrixInverseCacheIndex,
+                          sparseMassMatrixCacheIndex,
+                          massMatrixFactorizationCacheIndex,
                           treeVelocityCacheIndex, constrainedVelocityCacheIndex,
                           articulatedBodyVelocityCacheIndex,
+                          constraintFactorizationCacheIndex,
+                          multiplierPreconditionerCacheIndex,
+                          multiplierWarmStartCacheIndex,
+                          operatorWorkspaceCacheIndex,
+                          positionKinematicsRecordCacheIndex,
+                          projectionFactorizationCacheIndex,
                           dynamicsCacheIndex, 
                           treeAccelerationCacheIndex, 
-                          constrainedAccelerationCacheIndex;
+                          constrainedAccelerationCacheIndex,
+                          mobilizerReactionForcesCacheIndex;
 
 
     // These are instance variables that exist regardless of modeling
@@ -572,6 +589,48 @@ public:
     int totalNConstrainedMobilizersInUse;
     int totalNConstrainedQInUse; // q,u from the constrained mobilizers
     int totalNConstrainedUInUse; 
+
+    // Sparsity structure of G*M^-1*~G. M^-1 does not couple the subtrees 
+    // rooted at different base bodies, so two Constraints can produce a 
+    // nonzero block only if they act on a common base body subtree. For each
+    // enabled Constraint with equations in use, coupledConstraints lists those
+    // Constraints (including itself); it is empty for the others. 
+    // constraintColors groups the Constraints so that no two in a group are 
+    // coupled to a common Constraint; one column of every Constraint in a 
+    // group can then be obtained with a single pass through the O(n) 
+    // operators.
+    Array_<Array_<ConstraintIndex>,ConstraintIndex> coupledConstraints;
+    Array_< Array_<ConstraintIndex> >               constraintColors;
+
+    // Symmetric reordering of the multipliers used for a sparse factorization
+    // of G*M^-1*~G: row i of the reordered matrix is multiplier 
+    // multiplierOrder[i], and its nonzeros lie in columns 
+    // multiplierProfileFirst[i] through i. multiplierProfileSize is the total
+    // number of entries in that lower triangular profile.
+    Array_<int> multiplierOrder;
+    Array_<int> multiplierProfileFirst;
+    int         multiplierProfileSize;
+
+    // Return the index of equation k of Constraint cx within the multipliers,
+    // counting its holonomic equations first, then nonholonomic, then
+    // acceleration-only ones.
+    int getMultiplierIndex(ConstraintIndex cx, int k) const {
+        const SBInstancePerConstraintInfo& cInfo = constraintInstanceInfo[cx];
+        const int mh = cInfo.holoErrSegment.length;
+        const int mn = cInfo.nonholoErrSegment.length;
+        if (k < mh) return cInfo.holoErrSegment.offset + k;
+        if (k < mh+mn) 
+            return totalNHolonomicConstraintEquationsInUse 
+                   + cInfo.nonholoErrSegment.offset + (k-mh);
+        return totalNHolonomicConstraintEquationsInUse 
+               + totalNNonholonomicConstraintEquationsInUse
+               + cInfo.accOnlyErrSegment.offset + (k-mh-mn);
+    }
+    int getNumConstraintEquationsInUse(ConstraintIndex cx) const {
+        const SBInstancePerConstraintInfo& cInfo = constraintInstanceInfo[cx];
+        return cInfo.holoErrSegment.length + cInfo.nonholoErrSegment.length
+               + cInfo.accOnlyErrSegment.length;
+    }
 public:
     void allocate(const SBTopologyCache& topo,
                   const SBModelCache&    model) 
@@ -595,6 +654,13 @@ public:
         totalNConstrainedMobilizersInUse = 0;
         totalNConstrainedQInUse          = 0;
         totalNConstrainedUInUse          = 0; 
+
+        coupledConstraints.clear();
+        coupledConstraints.resize(topo.nConstraints);
+        constraintColors.clear();
+        multiplierOrder.clear();
+        multiplierProfileFirst.clear();
+        multiplierProfileSize = 0;
     }
 
 };
@@ -820,6 +886,49 @@ public:
 
 
 
+// =============================================================================
+//                          SPARSE MASS MATRIX CACHES
+// =============================================================================
+// The nu X nu mass matrix M and its inverse are never needed internally (we 
+// use O(n) operators instead) but some users ask for them repeatedly at a 
+// fixed configuration, for example in inverse dynamics or control loops. 
+// Like composite body inertias each gets its own lazy cache entry, realized
+// only on request, which depends only on Instance-stage variables and 
+// PositionKinematics. So changes to u, forces, or anything else computed at
+// Velocity stage or later leave them valid, while any change to q or to an
+// Instance variable (e.g. a mass property) invalidates them. The dense M and
+// M^-1 are plain Matrix objects; M is formed from the SBSparseMassMatrix 
+// below, which has a cache entry of its own with the same rules, as does its
+// factorization (stored in the same format).
+//
+// SBSparseMassMatrix holds the lower triangle of M with the sparsity induced
+// by the tree: M(i,j) can be nonzero only if mobilities i and j belong to the
+// same mobilized body or one's body is an ancestor of the other's. Ancestors'
+// mobilities are numbered first, so row i consists of the diagonal followed
+// by the entries for the chain of preceding mobilities parent[i], 
+// parent[parent[i]], ... back to a base body. Factoring M = ~L D L 
+// (Featherstone's LTDL) causes no fill-in in this structure; the factored
+// form keeps D on the diagonal and the strictly lower part of unit lower
+// triangular L elsewhere.
+class SBSparseMassMatrix {
+public:
+    Array_<int>  parent;   // nu; preceding mobility toward Ground, or -1
+    Array_<int>  depth;    // nu; number of preceding mobilities
+    Array_<int>  rowStart; // nu+1; start of each row in value
+    Array_<Real> value;    // row i: (i,i), (i,parent[i]), ...
+
+    int size() const {return (int)parent.size();}
+
+    // j must be i or one of its preceding mobilities.
+    Real get(int i, int j) const 
+    {   return value[rowStart[i] + depth[i]-depth[j]]; }
+    Real& upd(int i, int j) 
+    {   return value[rowStart[i] + depth[i]-depth[j]]; }
+};
+//......................... SPARSE MASS MATRIX CACHES ..........................
+
+
+
 // =============================================================================
 //                       ARTICULATED BODY INERTIA CACHE
 // =============================================================================
@@ -1014,6 +1123,163 @@ public:
 
 
 
+// =============================================================================
+//                        GENERIC-SCALAR TREE KINEMATICS
+// =============================================================================
+// The tree's kinematic and inverse dynamics recursions are templatized on the
+// scalar type P. For P=Real they work in the SBTreePositionCache and 
+// SBTreeVelocityCache above. For other scalars, such as the Dual numbers used
+// to differentiate the recursions, an SBTreeKinematics_<P> object takes the
+// place of both caches, holding the entries the recursions use under the
+// same names. SBTreeScalar<P> selects the cache types, and converts the
+// Real-valued frames and mass properties of each body to P.
+
+template <class P> class PhiMatrixTranspose_;
+
+// This is PhiMatrix for scalar type P, supporting just the spatial vector
+// shifts needed by the recursions.
+template <class P>
+class PhiMatrix_ {
+public:
+    PhiMatrix_() {}
+    explicit PhiMatrix_(const Vec<3,P>& l) : l_(l) {}
+
+    void setToZero() { l_ = P(0); }
+
+    const Vec<3,P>& l() const { return l_; }
+private:
+    Vec<3,P> l_;
+};
+
+template <class P>
+class PhiMatrixTranspose_ {
+public:
+    explicit PhiMatrixTranspose_(const PhiMatrix_<P>& phi) : phi(phi) {}
+
+    const Vec<3,P>& l() const {return phi.l();}
+private:
+    const PhiMatrix_<P>& phi;
+};
+
+template <class P> inline PhiMatrixTranspose_<P>
+operator~(const PhiMatrix_<P>& phi) {return PhiMatrixTranspose_<P>(phi);}
+
+template <class P> inline Vec<2,Vec<3,P> >
+operator*(const PhiMatrix_<P>& phi, const Vec<2,Vec<3,P> >& v)
+{   return Vec<2,Vec<3,P> >(v[0] + phi.l() % v[1], v[1]); }
+
+template <class P> inline Vec<2,Vec<3,P> >
+operator*(const PhiMatrixTranspose_<P>& phiT, const Vec<2,Vec<3,P> >& v)
+{   return Vec<2,Vec<3,P> >(v[0], v[1] + v[0] % phiT.l()); }
+
+template <class P>
+class SBTreeKinematics_ {
+public:
+    typedef Vec<3,P>        Vec3P;
+    typedef Vec<2,Vec3P>    SpatialVecP;
+
+        // Position kinematics, as in SBTreePositionCache.
+
+    Array_<Vec3P> storageForH_FM; // 2 x ndof (H_FM)
+    Array_<Vec3P> storageForH;    // 2 x ndof (H_PB_G)
+
+    Array_<Transform_<P>,MobilizedBodyIndex>  bodyJointInParentJointFrame; // nb (X_FM)
+    Array_<Transform_<P>,MobilizedBodyIndex>  bodyConfigInParent;          // nb (X_PB)
+    Array_<Transform_<P>,MobilizedBodyIndex>  bodyConfigInGround;          // nb (X_GB)
+    Array_<PhiMatrix_<P>,MobilizedBodyIndex>  bodyToParentShift;           // nb (phi)
+    Array_<SpatialInertia_<P>,MobilizedBodyIndex> bodySpatialInertiaInGround; // nb (Mk_G)
+    Array_<Vec3P,MobilizedBodyIndex>          bodyCOMInGround;             // nb (p_GBc)
+
+        // Velocity kinematics, as in SBTreeVelocityCache.
+
+    Array_<SpatialVecP,MobilizedBodyIndex> mobilizerRelativeVelocity; // nb (V_FM)
+    Array_<SpatialVecP,MobilizedBodyIndex> bodyVelocityInParent;      // nb (V_PB)
+    Array_<SpatialVecP,MobilizedBodyIndex> bodyVelocityInGround;      // nb (V_GB)
+
+    Array_<Vec3P> storageForHDot_FM;  // 2 x ndof (HDot_FM)
+    Array_<Vec3P> storageForHDot;     // 2 x ndof (HDot_PB_G)
+
+    // nb (VB_PB_G=HDot_PB_G*u)
+    Array_<SpatialVecP,MobilizedBodyIndex> bodyVelocityInParentDerivRemainder; 
+
+    Array_<SpatialVecP,MobilizedBodyIndex> gyroscopicForces;              // nb (b)
+    Array_<SpatialVecP,MobilizedBodyIndex> mobilizerCoriolisAcceleration; // nb (a)
+    Array_<SpatialVecP,MobilizedBodyIndex> totalCoriolisAcceleration;     // nb (A)
+    Array_<SpatialVecP,MobilizedBodyIndex> totalCentrifugalForces;        // nb (M*A+b)
+
+public:
+    // Ground entries are set as in the caches. The velocity entries and
+    // HDot_FM start out zero, which is what an immobile body or a mobilizer
+    // with constant H_FM leaves them.
+    void allocate(int nBodies, int nDofs) {
+        const Vec3P       zero(P(0));
+        const SpatialVecP SVZero(zero, zero);
+
+        storageForH_FM.resize(2*nDofs);
+        storageForH.resize(2*nDofs);
+
+        bodyJointInParentJointFrame.resize(nBodies);
+        bodyJointInParentJointFrame[GroundIndex].setToZero();
+
+        bodyConfigInParent.resize(nBodies);
+        bodyConfigInParent[GroundIndex].setToZero();
+
+        bodyConfigInGround.resize(nBodies);
+        bodyConfigInGround[GroundIndex].setToZero();
+
+        bodyToParentShift.resize(nBodies);
+        bodyToParentShift[GroundIndex].setToZero();
+
+        bodySpatialInertiaInGround.resize(nBodies);
+        bodySpatialInertiaInGround[GroundIndex] = SpatialInertia_<P>
+           (P(Infinity), zero, UnitInertia_<P>(P(Infinity)));
+
+        bodyCOMInGround.resize(nBodies);
+        bodyCOMInGround[GroundIndex] = zero;
+
+        mobilizerRelativeVelocity.resize(nBodies, SVZero);
+        bodyVelocityInParent.resize(nBodies, SVZero);
+        bodyVelocityInGround.resize(nBodies, SVZero);
+
+        storageForHDot_FM.resize(2*nDofs, zero);
+        storageForHDot.resize(2*nDofs);
+
+        bodyVelocityInParentDerivRemainder.resize(nBodies, SVZero);
+        gyroscopicForces.resize(nBodies, SVZero);
+        mobilizerCoriolisAcceleration.resize(nBodies, SVZero);
+        totalCoriolisAcceleration.resize(nBodies, SVZero);
+        totalCentrifugalForces.resize(nBodies, SVZero);
+    }
+};
+
+template <class P>
+struct SBTreeScalar {
+    typedef SBTreeKinematics_<P>    PositionCache;
+    typedef SBTreeKinematics_<P>    VelocityCache;
+    typedef PhiMatrix_<P>           Phi;
+
+    static Transform_<P> cast(const Transform& X)
+    {   return Transform_<P>(Rotation_<P>(Mat<3,3,P>(X.R().asMat33()), true),
+                             Vec<3,P>(X.p())); }
+    static Vec<3,P> cast(const Vec3& v) {return Vec<3,P>(v);}
+    static UnitInertia_<P> cast(const UnitInertia& G)
+    {   return UnitInertia_<P>(SymMat<3,P>(G.asSymMat33())); }
+};
+
+template <>
+struct SBTreeScalar<Real> {
+    typedef SBTreePositionCache     PositionCache;
+    typedef SBTreeVelocityCache     VelocityCache;
+    typedef PhiMatrix               Phi;
+
+    static const Transform&   cast(const Transform& X)   {return X;}
+    static const Vec3&        cast(const Vec3& v)        {return v;}
+    static const UnitInertia& cast(const UnitInertia& G) {return G;}
+};
+//........................ GENERIC-SCALAR TREE KINEMATICS ......................
+
+
+
 // =============================================================================
 //                         CONSTRAINED VELOCITY CACHE 
 // =============================================================================
@@ -1084,6 +1350,50 @@ public:
 //...................... ARTICULATED BODY VELOCITY CACHE .......................
 
 
+
+// =============================================================================
+//                      CONSTRAINT FACTORIZATION CACHE
+// =============================================================================
+/* This holds the factored m X m matrix G M^-1 ~G that is used to calculate
+the constraint multipliers in loop forward dynamics and the constraint 
+impulses during impact handling. Forming and factoring it costs O(m*n + m^3),
+which dominates an acceleration evaluation for mechanisms with many 
+constraint equations, so we calculate it only when asked for and then reuse it
+until something it depends on changes. G M^-1 ~G depends on time, q, and the
+Instance-stage mass properties and enabled constraints; it also depends on u
+if there are any nonholonomic or acceleration-only constraints. So this cache
+entry has depends-on stage Time, a prerequisite on the q's (and u's if 
+needed), and computed-by stage Infinity since it is never realized unless 
+needed. That lets it survive velocity-only changes and be reused across 
+repeated operator calls at the same configuration.
+
+Normally we use a rank-revealing QTZ factorization. When requested, we try 
+the cheaper Cholesky factorization instead, which is valid when the matrix is
+symmetric and positive definite (the constraints are independent and all of 
+them transmit forces through ~G); if that fails we fall back to QTZ. */
+class SBConstraintFactorizationCache {
+public:
+    SBConstraintFactorizationCache() 
+    :   choleskyRequested(false), usingCholesky(false), 
+        usingSparseCholesky(false) {}
+
+    bool        choleskyRequested;  // the option in effect when factored
+    bool        usingCholesky;      // if both false, use qtz
+    bool        usingSparseCholesky;
+
+    Matrix      choleskyFactor;     // m X m, L in the lower triangle
+    FactorQTZ   qtz;                // rank-revealing fallback
+
+    // Sparse Cholesky factor stored by rows in the profile given by 
+    // SBInstanceCache::multiplierProfileFirst; row i occupies 
+    // profileRowStart[i] .. profileRowStart[i+1]-1 of profileL and ends with
+    // the diagonal element.
+    Array_<int>     profileRowStart;
+    Array_<Real>    profileL;
+};
+//...................... CONSTRAINT FACTORIZATION CACHE ........................
+
+
 // =============================================================================
 //                                DYNAMICS CACHE
 // =============================================================================
@@ -1230,6 +1540,176 @@ public:
 
 
 
+// =============================================================================
+//                         CONSTRAINT BLOCK WORKSPACE
+// =============================================================================
+// Scratch space used while evaluating one block of Constraints. The small 
+// arrays are sized for one Constraint at a time. The body and mobility forces
+// are used only by blocks after the first when Constraints are evaluated in
+// parallel; each such block accumulates its own forces here, and these are 
+// then added to the first block's in block order.
+class SBConstraintBlockWorkspace {
+public:
+    Array_<SpatialVec,ConstrainedBodyIndex> A_AB;
+    Array_<Real,ConstrainedQIndex>          qdotdot;
+    Array_<Real,ConstrainedUIndex>          udot;
+    Array_<Real>                            lambdap, lambdav, lambdaa;
+
+    Vector_<SpatialVec>                     bodyForcesInG;  // [nb]
+    Vector                                  mobilityForces; // [nu]
+};
+//.......................... CONSTRAINT BLOCK WORKSPACE ........................
+
+
+
+// =============================================================================
+//                            OPERATOR WORKSPACE
+// =============================================================================
+// Scratch space for the forward dynamics operators, kept in a lazy cache 
+// entry so that each State (and thus each thread) has its own. Nothing here
+// is ever valid; the only point is that the heap space, once it has grown
+// to the needed size, is reused by later calls so that a steady-state 
+// realize(Acceleration) performs no heap allocation.
+class SBOperatorWorkspace {
+public:
+    // calcTreeForwardDynamicsOperator(): applied minus constraint forces.
+    Vector              totalMobilityForces;        // [nu]
+    Vector_<SpatialVec> totalBodyForces;            // [nb]
+
+    // calcLoopForwardDynamicsOperator(): constraint forces from multipliers.
+    Vector_<SpatialVec> constraintBodyForcesInG;    // [nb]
+    Vector              constraintMobilityForces;   // [nu]
+
+    // Contiguous right hand side for the multiplier solve.
+    Vector              multiplierRhs;              // [m]
+
+    // Temporaries for calcConstraintAccelerationErrors() and 
+    // calcConstraintForcesFromMultipliers(), one set per block of Constraints
+    // so that blocks can be evaluated concurrently. There is just one block
+    // unless parallel constraint evaluation is enabled.
+    Array_<SBConstraintBlockWorkspace>      constraintBlocks;
+
+    // calcTreeResidualForces(): body forces carried inward during the sweep,
+    // and body accelerations for callers that don't want them returned.
+    Vector_<SpatialVec> residualBodyForces;         // [nb]
+    Vector_<SpatialVec> residualBodyAccelerations;  // [nb]
+
+    // calcTreeAccelerations() outputs that calcAccelerationIgnoringConstraints
+    // ForStates() doesn't return.
+    Vector                                  treeHingeForces;    // [nu]
+    Array_<SpatialVec,MobilizedBodyIndex>   treeZ, treeZPlus;   // [nb]
+    Vector_<SpatialVec>                     treeBodyAccelerations; // [nb]
+    Vector                                  treeUDot;           // [nu]
+    Vector                                  treeQDotDot;        // [nq]
+    Vector                                  treePresForces;     // [npres]
+};
+//............................ OPERATOR WORKSPACE ..............................
+
+
+
+// =============================================================================
+//                         MULTIPLIER WARM START CACHE
+// =============================================================================
+// The multipliers from the most recent constraint multiplier solve, which are
+// the starting guess for the next iterative solve, kept in a lazy cache entry
+// that depends only on Instance stage so that they survive changes to q and u.
+// The entry is marked valid once multipliers have been stored for the current
+// Instance stage; until then the iterative solver starts from zero. The 
+// conjugate gradient temporaries live here too. Everything is sized at 
+// Instance stage so the solver itself never resizes anything.
+class SBMultiplierWarmStartCache {
+public:
+    Vector  lambda;                 // [m]
+
+    // Conjugate gradient scratch.
+    Vector  bias, r, z, p, Ap;      // [m]
+    Vector  Gtx, MInvGtx;           // [nu]
+
+public:
+    void allocate(const SBTopologyCache& tree,
+                  const SBModelCache&    model,
+                  const SBInstanceCache& instance) 
+    {
+        const int nDofs = tree.nDOFs;   // this is the number of u's (nu)
+        const int m = instance.totalNHolonomicConstraintEquationsInUse
+                    + instance.totalNNonholonomicConstraintEquationsInUse
+                    + instance.totalNAccelerationOnlyConstraintEquationsInUse;
+        lambda.resize(m);
+        bias.resize(m); r.resize(m); z.resize(m); p.resize(m); Ap.resize(m);
+        Gtx.resize(nDofs); MInvGtx.resize(nDofs);
+    }
+};
+//......................... MULTIPLIER WARM START CACHE ........................
+
+
+
+// =============================================================================
+//                        POSITION KINEMATICS RECORD
+// =============================================================================
+// The generalized coordinates q for which the TreePositionCache contents were
+// last calculated, kept in a lazy cache entry that depends only on Instance
+// stage so it survives changes to q. When incremental position kinematics is
+// enabled, realizePositionKinematics() compares the current q's against 
+// these to find the mobilizers that moved, and recalculates only the bodies
+// outboard of them; everything else in the TreePositionCache (and the 
+// quaternion errors in qErr) is still correct from last time. This is marked
+// valid after the first complete calculation.
+class SBPositionKinematicsRecord {
+public:
+    Vector q;                                   // [nq]
+
+    // Scratch: which mobilized bodies must be recalculated this time.
+    Array_<bool,MobilizedBodyIndex> mustRecalculate;    // [nb]
+};
+//......................... POSITION KINEMATICS RECORD .........................
+
+
+
+// =============================================================================
+//                       PROJECTION FACTORIZATION CACHE
+// =============================================================================
+/* The factored, weighted constraint Jacobians last used by projectQ() 
+(Tp Pq Wq^+, free q's only) and projectU() (Tpv [P;V] Eu^-1, free u's only),
+kept in a lazy cache entry that depends only on Instance stage so that they
+survive changes to q and u. When modified Newton projection is enabled, a 
+projection starts from the factorization left here by the previous one rather
+than forming and factoring a new matrix, and refactors only if the iteration
+converges too slowly. A factorization is reusable only with the same 
+constraint error weights; the column scaling used to form it is kept too 
+since the solution must be unscaled the same way. The entry is marked valid 
+once the flags below have been cleared for the current Instance stage.
+
+The counters are not affected by invalidation. "Avoided" counts the 
+factorizations that the default method would have performed but that were 
+skipped because an existing factorization was reused: one per iteration in
+projectQ() and one per call in projectU(). */
+class SBProjectionFactorizationCache {
+public:
+    SBProjectionFactorizationCache() 
+    :   pqIsValid(false), pvIsValid(false) {clearStatistics();}
+
+    void clearStatistics() {
+        numQFactorizations = numQFactorizationsAvoided = 0;
+        numUFactorizations = numUFactorizationsAvoided = 0;
+    }
+
+    bool        pqIsValid;
+    FactorQTZ   pqQtz;
+    Vector      pqErrWeights;       // Tp when factored [mp]
+    Vector      pqUScale;           // Wu^-1 when factored [nu]
+
+    bool        pvIsValid;
+    FactorQTZ   pvQtz;
+    Vector      pvErrWeights;       // Tpv when factored [mp+mv]
+    Vector      pvUScale;           // Eu^-1 when factored [nu]
+
+    int numQFactorizations, numQFactorizationsAvoided;
+    int numUFactorizations, numUFactorizationsAvoided;
+};
+//...................... PROJECTION FACTORIZATION CACHE ........................
+
+
+
 
 /* 
  * Generalized state variable collection for a SimbodyMatterSubsystem. 
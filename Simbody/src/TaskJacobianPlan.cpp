@@ -0,0 +1,246 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ *
+ * Implementation of TaskJacobianPlan.
+ */
+
+#include "SimTKcommon.h"
+#include "simbody/internal/TaskJacobianPlan.h"
+#include "simbody/internal/SimbodyMatterSubsystem.h"
+#include "simbody/internal/MobilizedBody.h"
+
+#include "SimbodyMatterSubsystemRep.h"
+#include "RigidBodyNode.h"
+
+using namespace SimTK;
+
+void TaskJacobianPlan::clear() {
+    numRows = 0;
+    tasks.clear();
+    paths.clear();
+    tasksOnBody.clear();
+    p_GS.clear();
+}
+
+int TaskJacobianPlan::
+addStationTask(MobilizedBodyIndex body, const Vec3& p_BS) 
+{   return addTask(body, p_BS, false); }
+
+int TaskJacobianPlan::
+addFrameTask(MobilizedBodyIndex body, const Vec3& p_BA) 
+{   return addTask(body, p_BA, true); }
+
+// Record the task's path inward to Ground, and add the task to the list of
+// each body on that path. Mobilized bodies are numbered so that a parent 
+// always precedes its children, but we don't rely on that here.
+int TaskJacobianPlan::
+addTask(MobilizedBodyIndex body, const Vec3& station, bool isFrame) {
+    const SimbodyMatterSubsystem& matter = getMatterSubsystem();
+    SimTK_INDEXCHECK_ALWAYS(body, matter.getNumBodies(),
+        "TaskJacobianPlan::addTask()");
+
+    const int taskIndex = getNumTasks();
+    Task task;
+    task.body           = body;
+    task.station        = station;
+    task.isFrame        = isFrame;
+    task.firstRow       = numRows;
+    task.firstPathEntry = (int)paths.size();
+
+    if (tasksOnBody.size() <= body)
+        tasksOnBody.resize(body+1);
+    for (MobilizedBodyIndex mbx = body; mbx != GroundIndex; 
+         mbx = matter.getMobilizedBody(mbx).getParentMobilizedBody()
+                                           .getMobilizedBodyIndex())
+    {   paths.push_back(mbx);
+        tasksOnBody[mbx].push_back(taskIndex); }
+
+    task.numPathEntries = (int)paths.size() - task.firstPathEntry;
+    tasks.push_back(task);
+    numRows += isFrame ? 6 : 3;
+    return taskIndex;
+}
+
+const SimbodyMatterSubsystem& TaskJacobianPlan::getMatterSubsystem() const {
+    SimTK_ERRCHK_ALWAYS(matter != nullptr,
+        "TaskJacobianPlan::getMatterSubsystem()",
+        "This TaskJacobianPlan has not been associated with a "
+        "SimbodyMatterSubsystem.");
+    return *matter;
+}
+
+// Cost is 18 flops per task.
+void TaskJacobianPlan::calcTaskStationLocations(const State& state) const {
+    const SimbodyMatterSubsystemRep& rep = getMatterSubsystem().getRep();
+    p_GS.resize(getNumTasks()); // no reallocation after the first time
+    for (int t=0; t < getNumTasks(); ++t)
+        p_GS[t] = rep.getBodyTransform(state, tasks[t].body) 
+                  * tasks[t].station;
+}
+
+
+
+//==============================================================================
+//                               CALC JACOBIAN
+//==============================================================================
+// Each column of J for mobility k of body B is the hinge matrix column 
+// H_k = [w_k, v_k] (in Ground, at Bo) shifted to each task station outboard of
+// B: [w_k, v_k + w_k X (p_GS - p_GB)]. Cost is 12 flops per path mobility per
+// task, plus zeroing J.
+void TaskJacobianPlan::calcJacobian(const State& state, Matrix& J) const {
+    const SimbodyMatterSubsystemRep& rep = getMatterSubsystem().getRep();
+    const SBTreePositionCache& tpc = rep.getTreePositionCache(state);
+    calcTaskStationLocations(state);
+
+    J.resize(numRows, rep.getNumMobilities());
+    J.setToZero();
+    for (MobilizedBodyIndex mbx(1); mbx < tasksOnBody.size(); ++mbx) {
+        const Array_<int>& onBody = tasksOnBody[mbx];
+        if (onBody.empty()) continue;
+        const RigidBodyNode& node = rep.getRigidBodyNode(mbx);
+        const Vec3& p_GB = node.getX_GB(tpc).p();
+        for (int k=0; k < node.getDOF(); ++k) {
+            const SpatialVec& H = node.getHCol(tpc, k);
+            const int col = node.getUIndex() + k;
+            for (int t : onBody) {
+                const Task& task = tasks[t];
+                const Vec3 v = H[1] + H[0] % (p_GS[t] - p_GB);
+                int row = task.firstRow;
+                if (task.isFrame)
+                    for (int i=0; i < 3; ++i) J(row++, col) = H[0][i];
+                for (int i=0; i < 3; ++i) J(row++, col) = v[i];
+            }
+        }
+    }
+}
+
+
+
+//==============================================================================
+//                           MULTIPLY BY JACOBIAN
+//==============================================================================
+// Same sweep as calcJacobian() but accumulating J*u instead of storing J.
+// It is OK for u and Ju to be non-contiguous.
+void TaskJacobianPlan::multiplyByJacobian(const State& state, const Vector& u,
+                                          Vector& Ju) const {
+    const SimbodyMatterSubsystemRep& rep = getMatterSubsystem().getRep();
+    const SBTreePositionCache& tpc = rep.getTreePositionCache(state);
+    const int nu = rep.getNumMobilities();
+    SimTK_ERRCHK2_ALWAYS(u.size() == nu,
+        "TaskJacobianPlan::multiplyByJacobian()",
+        "The supplied u-space Vector had length %d; expected %d.",u.size(),nu);
+    calcTaskStationLocations(state);
+
+    Ju.resize(numRows);
+    Ju.setToZero();
+    for (MobilizedBodyIndex mbx(1); mbx < tasksOnBody.size(); ++mbx) {
+        const Array_<int>& onBody = tasksOnBody[mbx];
+        if (onBody.empty()) continue;
+        const RigidBodyNode& node = rep.getRigidBodyNode(mbx);
+        const Vec3& p_GB = node.getX_GB(tpc).p();
+        for (int k=0; k < node.getDOF(); ++k) {
+            const Real uk = u[node.getUIndex() + k];
+            if (uk == 0) continue;
+            const SpatialVec Hu = node.getHCol(tpc, k) * uk;
+            for (int t : onBody) {
+                const Task& task = tasks[t];
+                const Vec3 v = Hu[1] + Hu[0] % (p_GS[t] - p_GB);
+                int row = task.firstRow;
+                if (task.isFrame)
+                    for (int i=0; i < 3; ++i) Ju[row++] += Hu[0][i];
+                for (int i=0; i < 3; ++i) Ju[row++] += v[i];
+            }
+        }
+    }
+}
+
+
+
+//==============================================================================
+//                       MULTIPLY BY JACOBIAN TRANSPOSE
+//==============================================================================
+// Each generalized force is the dot product of a column of J with the task
+// forces: f_k = sum_t ~w_k*M_t + ~(v_k + w_k X r_t)*F_t for the tasks t 
+// outboard of mobility k. It is OK for F and f to be non-contiguous.
+void TaskJacobianPlan::
+multiplyByJacobianTranspose(const State& state, const Vector& F, 
+                            Vector& f) const {
+    const SimbodyMatterSubsystemRep& rep = getMatterSubsystem().getRep();
+    const SBTreePositionCache& tpc = rep.getTreePositionCache(state);
+    SimTK_ERRCHK2_ALWAYS(F.size() == numRows,
+        "TaskJacobianPlan::multiplyByJacobianTranspose()",
+        "The supplied task force Vector had length %d; expected %d.",
+        F.size(), numRows);
+    calcTaskStationLocations(state);
+
+    f.resize(rep.getNumMobilities());
+    f.setToZero();
+    for (MobilizedBodyIndex mbx(1); mbx < tasksOnBody.size(); ++mbx) {
+        const Array_<int>& onBody = tasksOnBody[mbx];
+        if (onBody.empty()) continue;
+        const RigidBodyNode& node = rep.getRigidBodyNode(mbx);
+        const Vec3& p_GB = node.getX_GB(tpc).p();
+        for (int k=0; k < node.getDOF(); ++k) {
+            const SpatialVec& H = node.getHCol(tpc, k);
+            Real fk = 0;
+            for (int t : onBody) {
+                const Task& task = tasks[t];
+                const Vec3 v = H[1] + H[0] % (p_GS[t] - p_GB);
+                int row = task.firstRow;
+                if (task.isFrame)
+                    for (int i=0; i < 3; ++i) fk += H[0][i]*F[row++];
+                for (int i=0; i < 3; ++i) fk += v[i]*F[row++];
+            }
+            f[node.getUIndex() + k] = fk;
+        }
+    }
+}
+
+
+
+//==============================================================================
+//                                 CALC BIAS
+//==============================================================================
+// Shift each task body's total Coriolis acceleration to the task station, as
+// in calcBiasForFrameJacobian(). Cost is 33 flops per task.
+void TaskJacobianPlan::calcBias(const State& state, Vector& JDotu) const {
+    const SimbodyMatterSubsystemRep& rep = getMatterSubsystem().getRep();
+    const SBTreeVelocityCache& vc = rep.getTreeVelocityCache(state);
+    calcTaskStationLocations(state);
+
+    JDotu.resize(numRows);
+    for (int t=0; t < getNumTasks(); ++t) {
+        const Task& task = tasks[t];
+        const Vec3& p_GB = rep.getBodyTransform(state, task.body).p();
+        const Vec3& w_GB = rep.getBodyVelocity(state, task.body)[0];
+        const SpatialVec A_GS = 
+            shiftAccelerationBy(vc.totalCoriolisAcceleration[task.body], 
+                                w_GB, p_GS[t] - p_GB);
+        int row = task.firstRow;
+        if (task.isFrame)
+            for (int i=0; i < 3; ++i) JDotu[row++] = A_GS[0][i];
+        for (int i=0; i < 3; ++i) JDotu[row++] = A_GS[1][i];
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef SimTK_SIMBODY_HEAP_ALLOCATION_COUNTER_H_
+#define SimTK_SIMBODY_HEAP_ALLOCATION_COUNTER_H_
+
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Counts heap allocations so that a test can check that an operation
+allocates nothing once its workspace has grown to size. This replaces the
+global operator new and operator delete, so include it in exactly one source
+file of a test program. Every allocation made with new, including those made
+by the library and by std containers, is counted. */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<long long> numHeapAllocations(0);
+
+void* operator new(std::size_t size) {
+    ++numHeapAllocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {std::free(p);}
+
+// Return the number of heap allocations made while calling f().
+template <class F>
+long long countHeapAllocations(const F& f) {
+    const long long before = numHeapAllocations;
+    f();
+    return numHeapAllocations - before;
+}
+
+#endif // SimTK_SIMBODY_HEAP_ALLOCATION_COUNTER_H_
@@ -0,0 +1,243 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that the batched multi-State operators give the same answers as 
+// setting each sample into a State and calling the single-State operator,
+// and that the answers don't depend on the number of threads.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+#include <stdexcept>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+const int NSamples = 13; // deliberately not a multiple of the thread count
+
+static void buildModel(MultibodySystem& system, SimbodyMatterSubsystem& matter,
+                       GeneralForceSubsystem& forces)
+{
+    Force::Gravity(forces, matter, -YAxis, 9.8);
+    Body::Rigid body(MassProperties(1.5, Vec3(.1,.2,0), 
+                                    UnitInertia(.3,.2,.1,.01,.02,.03)));
+    MobilizedBody::Free base(matter.Ground(), body);
+    MobilizedBody::Pin arm(base, Vec3(0,-.5,0), body, Vec3(0,.5,0));
+    MobilizedBody::Ball wrist(arm, Vec3(0,-.5,0), body, Vec3(0,.5,0));
+    MobilizedBody::Slider finger(wrist, Vec3(.1,0,0), body, Vec3(0,.2,0));
+    MobilizedBody::Universal leg(base, Vec3(0,.5,0), body, Vec3(0,-.5,0));
+}
+
+static void makeSamples(const State& state, Matrix& q, Matrix& u, Matrix& v) {
+    Random::Uniform random(-1, 1);
+    random.setSeed(17);
+    q.resize(state.getNQ(), NSamples);
+    u.resize(state.getNU(), NSamples);
+    v.resize(state.getNU(), NSamples);
+    for (int k=0; k < NSamples; ++k) {
+        for (int i=0; i < q.nrow(); ++i) q(i,k) = random.getValue();
+        for (int i=0; i < u.nrow(); ++i) u(i,k) = random.getValue();
+        for (int i=0; i < v.nrow(); ++i) v(i,k) = random.getValue();
+    }
+}
+
+void testAgainstSingleState() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildModel(system, matter, forces);
+    State state = system.realizeTopology();
+    system.realize(state, Stage::Instance);
+
+    Matrix q, u, v;
+    makeSamples(state, q, u, v);
+    const Matrix_<SpatialVec> noBodyForces;
+    const Array_<MobilizedBodyIndex> bodies{MobilizedBodyIndex(2), 
+                                            MobilizedBodyIndex(4)};
+    const Array_<Vec3> stations{Vec3(.1,.2,.3), Vec3(0,-1,0)};
+
+    Matrix Mv, MInvV, udot;
+    Matrix_<Vec3> locations;
+    matter.multiplyByMForStates(state, q, v, Mv);
+    matter.multiplyByMInvForStates(state, q, v, MInvV);
+    matter.calcAccelerationIgnoringConstraintsForStates
+       (state, q, u, v, noBodyForces, udot);
+    matter.calcStationLocationsForStates(state, q, bodies, stations, 
+                                         locations);
+    SimTK_TEST(Mv.ncol() == NSamples && MInvV.ncol() == NSamples);
+    SimTK_TEST(udot.ncol() == NSamples && locations.ncol() == NSamples);
+
+    State s = state;
+    for (int k=0; k < NSamples; ++k) {
+        s.updQ() = q(k); s.updU() = u(k);
+        system.realize(s, Stage::Dynamics);
+
+        Vector Mv_k, MInvV_k, udot_k;
+        Vector_<SpatialVec> A_GB;
+        matter.multiplyByM(s, v(k), Mv_k);
+        matter.multiplyByMInv(s, v(k), MInvV_k);
+        matter.calcAccelerationIgnoringConstraints(s, v(k), 
+            Vector_<SpatialVec>(matter.getNumBodies(), SpatialVec(Vec3(0),Vec3(0))),
+            udot_k, A_GB);
+        SimTK_TEST_EQ(Mv(k), Mv_k);
+        SimTK_TEST_EQ(MInvV(k), MInvV_k);
+        SimTK_TEST_EQ(udot(k), udot_k);
+        for (int i=0; i < (int)bodies.size(); ++i)
+            SimTK_TEST_EQ(locations(i,k), matter.getMobilizedBody(bodies[i])
+                          .findStationLocationInGround(s, stations[i]));
+    }
+
+    // The template state must not have been touched.
+    SimTK_TEST(state.getSystemStage() == Stage::Instance);
+}
+
+// Inverse dynamics along a trajectory, with the trajectory stored one frame
+// per row as it usually comes from motion capture.
+void testTrajectoryInverseDynamics() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildModel(system, matter, forces);
+    State state = system.realizeTopology();
+    system.realize(state, Stage::Instance);
+    const int nb = matter.getNumBodies();
+
+    Matrix q, u, udot;
+    makeSamples(state, q, u, udot);
+    const Matrix qFrames = ~q, uFrames = ~u, udotFrames = ~udot;
+    Matrix_<SpatialVec> F(nb, NSamples);
+    for (int k=0; k < NSamples; ++k)
+        for (int b=0; b < nb; ++b)
+            F(b,k) = SpatialVec(Vec3(k,b,1), Vec3(-b,.5,k));
+
+    Matrix resid, residNoForces;
+    matter.calcResidualForceIgnoringConstraintsForStates
+       (state, ~qFrames, ~uFrames, ~udotFrames, udot, F, resid);
+    matter.calcResidualForceIgnoringConstraintsForStates
+       (state, q, u, udot, Matrix(), Matrix_<SpatialVec>(), residNoForces);
+    SimTK_TEST(resid.nrow() == state.getNU() && resid.ncol() == NSamples);
+
+    State s = state;
+    for (int k=0; k < NSamples; ++k) {
+        s.updQ() = q(k); s.updU() = u(k);
+        system.realize(s, Stage::Velocity);
+        Vector resid_k, residNoForces_k;
+        matter.calcResidualForceIgnoringConstraints(s, udot(k), F(k), udot(k),
+                                                    resid_k);
+        matter.calcResidualForceIgnoringConstraints(s, Vector(), 
+            Vector_<SpatialVec>(), udot(k), residNoForces_k);
+        SimTK_TEST_EQ(resid(k), resid_k);
+        SimTK_TEST_EQ(residNoForces(k), residNoForces_k);
+    }
+
+    Matrix_<SpatialVec> wrongF(nb, NSamples-1);
+    SimTK_TEST_MUST_THROW(matter.calcResidualForceIgnoringConstraintsForStates
+       (state, q, u, udot, Matrix(), wrongF, resid));
+    SimTK_TEST_MUST_THROW(matter.calcResidualForceIgnoringConstraintsForStates
+       (state, q, u, qFrames, Matrix(), F, resid));
+}
+
+void testThreadCountIndependence() {
+    Matrix results[2];
+    for (int t=0; t < 2; ++t) {
+        MultibodySystem system;
+        SimbodyMatterSubsystem matter(system);
+        GeneralForceSubsystem forces(system);
+        buildModel(system, matter, forces);
+        matter.setNumberOfThreads(t == 0 ? 1 : 4);
+        State state = system.realizeTopology();
+        system.realize(state, Stage::Instance);
+
+        Matrix q, u, v;
+        makeSamples(state, q, u, v);
+        matter.calcAccelerationIgnoringConstraintsForStates
+           (state, q, u, v, Matrix_<SpatialVec>(), results[t]);
+    }
+    SimTK_TEST(results[0].nrow() == results[1].nrow());
+    for (int k=0; k < NSamples; ++k)
+        for (int i=0; i < results[0].nrow(); ++i)
+            SimTK_TEST(results[0](i,k) == results[1](i,k));
+}
+
+// A force element that fails to realize Position stage for some samples.
+class PickyForce : public Force::Custom::Implementation {
+public:
+    void calcForce(const State&, Vector_<SpatialVec>&, Vector_<Vec3>&,
+                   Vector&) const override {}
+    Real calcPotentialEnergy(const State&) const override {return 0;}
+    void realizePosition(const State& state) const override {
+        if (state.getQ()[0] > Real(.5))
+            throw std::runtime_error("PickyForce: q0 out of range");
+    }
+};
+
+// An exception thrown while evaluating a sample on a worker thread must
+// reach the caller rather than leave that sample's column unset.
+void testSampleExceptionPropagates() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildModel(system, matter, forces);
+    Force::Custom(forces, new PickyForce);
+    matter.setNumberOfThreads(4);
+    State state = system.realizeTopology();
+    system.realize(state, Stage::Instance);
+
+    Matrix q, u, v, Mv;
+    makeSamples(state, q, u, v);
+    for (int k=0; k < NSamples; ++k)
+        q(0,k) = Real(0);
+    matter.multiplyByMForStates(state, q, v, Mv);
+    q(0,NSamples-2) = Real(1);
+    SimTK_TEST_MUST_THROW_EXC(matter.multiplyByMForStates(state, q, v, Mv),
+                              std::runtime_error);
+}
+
+void testBadArguments() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildModel(system, matter, forces);
+    State state = system.realizeTopology();
+
+    Matrix q(state.getNQ(), 3, Real(0)), v(state.getNU(), 3, Real(0)), Mv;
+    // Not yet realized through Instance stage.
+    SimTK_TEST_MUST_THROW(matter.multiplyByMForStates(state, q, v, Mv));
+    system.realize(state, Stage::Instance);
+    matter.multiplyByMForStates(state, q, v, Mv);
+    Matrix wrongV(state.getNU(), 2, Real(0));
+    SimTK_TEST_MUST_THROW(matter.multiplyByMForStates(state, q, wrongV, Mv));
+    Matrix wrongQ(state.getNQ()+1, 3, Real(0));
+    SimTK_TEST_MUST_THROW(matter.multiplyByMForStates(state, wrongQ, v, Mv));
+}
+
+int main() {
+    SimTK_START_TEST("TestBatchedStates");
+        SimTK_SUBTEST(testAgainstSingleState);
+        SimTK_SUBTEST(testTrajectoryInverseDynamics);
+        SimTK_SUBTEST(testThreadCountIndependence);
+        SimTK_SUBTEST(testSampleExceptionPropagates);
+        SimTK_SUBTEST(testBadArguments);
+    SimTK_END_TEST();
+}
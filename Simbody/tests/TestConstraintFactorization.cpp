@@ -0,0 +1,337 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that the cached factorization of G*M^-1*~G used for constraint 
+// multipliers gives the same answers as a freshly calculated one, both when
+// it is reused across velocity changes and when it is invalidated, and that 
+// the optional Cholesky factorization (dense or sparse) and iterative solver 
+// agree with the default QTZ one. Also check modified Newton projection,
+// which reuses factorizations of the constraint Jacobian.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// A chain of pins whose tip is tied back to Ground with a ball constraint,
+// making a closed loop. Optionally add a redundant constraint that duplicates
+// one of the ball's equations, or a nonholonomic constraint, so that G has 
+// velocity-dependent rows.
+static void buildLoop(MultibodySystem& system, SimbodyMatterSubsystem& matter,
+                      GeneralForceSubsystem& forces,
+                      bool redundant, bool nonholonomic) 
+{
+    Force::Gravity(forces, matter, -YAxis, 9.8);
+    Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(.1,.2,.3)));
+    MobilizedBody* outer = &matter.Ground();
+    for (int i=0; i < 5; ++i) {
+        MobilizedBody::Ball link(*outer, Vec3(0,-.5,0), body, Vec3(0,.5,0));
+        outer = &matter.updMobilizedBody(link.getMobilizedBodyIndex());
+    }
+    Constraint::Ball(matter.Ground(), Vec3(1,-1.5,0), 
+                     *outer, Vec3(0,-.5,0));
+    if (redundant)
+        Constraint::PointInPlane(matter.Ground(), UnitVec3(XAxis), 1,
+                                 *outer, Vec3(0,-.5,0));
+    if (nonholonomic)
+        Constraint::NoSlip1D(matter.Ground(), Vec3(0), UnitVec3(ZAxis),
+                             matter.Ground(), 
+                             matter.updMobilizedBody(MobilizedBodyIndex(2)));
+}
+
+static void setState(const MultibodySystem& system, State& state, int seed) {
+    Random::Uniform random(-1, 1);
+    random.setSeed(seed);
+    for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] = random.getValue();
+    for (int i=0; i < state.getNU(); ++i) state.updU()[i] = random.getValue();
+    system.realize(state, Stage::Position);
+    system.projectQ(state, 1e-12);
+}
+
+static void checkAgainstFresh(const MultibodySystem& system,
+                              const State& state) 
+{
+    // A fresh copy of the state variables, with no cache contents.
+    State fresh = system.getDefaultState();
+    fresh.updQ() = state.getQ(); fresh.updU() = state.getU();
+    system.realize(fresh, Stage::Acceleration);
+    SimTK_TEST_EQ(state.getUDot(), fresh.getUDot());
+    SimTK_TEST_EQ(state.getMultipliers(), fresh.getMultipliers());
+    SimTK_TEST_EQ_TOL(state.getUDotErr(), Vector(state.getNUDotErr(), 0.), 
+                      1e-10);
+}
+
+void testReuseAndInvalidation(bool redundant, bool nonholonomic) {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildLoop(system, matter, forces, redundant, nonholonomic);
+    State state = system.realizeTopology();
+
+    setState(system, state, 3);
+    system.realize(state, Stage::Acceleration);
+    checkAgainstFresh(system, state);
+
+    // Velocity-only change.
+    state.updU() *= -2;
+    system.realize(state, Stage::Acceleration);
+    checkAgainstFresh(system, state);
+
+    // Position change.
+    setState(system, state, 5);
+    system.realize(state, Stage::Acceleration);
+    checkAgainstFresh(system, state);
+}
+
+void testReuse() {
+    testReuseAndInvalidation(false, false);
+    testReuseAndInvalidation(false, true);
+    testReuseAndInvalidation(true,  false);
+}
+
+// Cholesky should agree with QTZ, and fall back to it for redundant 
+// constraints.
+void testCholesky(bool redundant) {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildLoop(system, matter, forces, redundant, false);
+    State state = system.realizeTopology();
+    setState(system, state, 7);
+
+    system.realize(state, Stage::Acceleration);
+    const Vector udotQTZ = state.getUDot();
+    const Vector multQTZ = state.getMultipliers();
+
+    matter.setUseCholeskyForMultipliers(true);
+    SimTK_TEST(matter.getUseCholeskyForMultipliers());
+    state.invalidateAllCacheAtOrAbove(Stage::Acceleration);
+    system.realize(state, Stage::Acceleration);
+    SimTK_TEST_EQ_TOL(state.getUDot(), udotQTZ, 1e-10);
+    if (!redundant) // multipliers aren't unique otherwise
+        SimTK_TEST_EQ_TOL(state.getMultipliers(), multQTZ, 1e-10);
+    SimTK_TEST_EQ_TOL(state.getUDotErr(), Vector(state.getNUDotErr(), 0.), 
+                      1e-10);
+}
+
+void testCholeskyFactorization() {
+    testCholesky(false);
+    testCholesky(true);
+}
+
+// A lattice of particles, each on its own Translation mobilizer, joined to
+// their neighbors by rods. Every rod couples only two of the many independent
+// subtrees, so G*M^-1*~G is sparse and the Cholesky option uses the sparse
+// profile factorization.
+static void buildLattice(MultibodySystem& system, 
+                         SimbodyMatterSubsystem& matter, 
+                         GeneralForceSubsystem& forces, int N) 
+{
+    Force::Gravity(forces, matter, -YAxis, 9.8);
+    Body::Rigid particle(MassProperties(1, Vec3(0), UnitInertia(1)));
+
+    Random::Uniform random(-.1, .1);
+    random.setSeed(11);
+    Array_<MobilizedBodyIndex> node;
+    Array_<Vec3> where;
+    for (int i=0; i < N; ++i)
+        for (int j=0; j < N; ++j) {
+            where.push_back(Vec3(i, j, 0) + Vec3(random.getValue(), 
+                            random.getValue(), random.getValue()));
+            node.push_back(MobilizedBody::Translation(matter.Ground(), 
+                where.back(), particle, Vec3(0)).getMobilizedBodyIndex());
+        }
+    for (int i=0; i < N; ++i)
+        for (int j=0; j < N; ++j) {
+            const int k = i*N + j;
+            if (i+1 < N) Constraint::Rod(matter.updMobilizedBody(node[k]), 
+                Vec3(0), matter.updMobilizedBody(node[k+N]), Vec3(0), 
+                (where[k+N]-where[k]).norm());
+            if (j+1 < N) Constraint::Rod(matter.updMobilizedBody(node[k]), 
+                Vec3(0), matter.updMobilizedBody(node[k+1]), Vec3(0), 
+                (where[k+1]-where[k]).norm());
+        }
+}
+
+void testSparseLattice() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildLattice(system, matter, forces, 8);
+
+    State state = system.realizeTopology();
+    Random::Uniform random(-.1, .1);
+    for (int i=0; i < state.getNU(); ++i) state.updU()[i] = random.getValue();
+    system.realize(state, Stage::Velocity);
+
+    // The sparse assembly must agree with the brute force product.
+    Matrix G, MInv, GMInvGt;
+    matter.calcG(state, G);
+    matter.calcMInv(state, MInv);
+    matter.calcProjectedMInv(state, GMInvGt);
+    SimTK_TEST_EQ_TOL(GMInvGt, G*MInv*~G, 1e-12);
+
+    system.realize(state, Stage::Acceleration);
+    const Vector udotQTZ = state.getUDot();
+    const Vector multQTZ = state.getMultipliers();
+
+    matter.setUseCholeskyForMultipliers(true);
+    state.invalidateAllCacheAtOrAbove(Stage::Acceleration);
+    system.realize(state, Stage::Acceleration);
+    SimTK_TEST_EQ_TOL(state.getUDot(), udotQTZ, 1e-10);
+    SimTK_TEST_EQ_TOL(state.getMultipliers(), multQTZ, 1e-10);
+    SimTK_TEST_EQ_TOL(state.getUDotErr(), Vector(state.getNUDotErr(), 0.), 
+                      1e-10);
+}
+
+// The iterative solver should agree with the direct one, reuse its previous
+// solution, and fall back to the direct solver when the constraints are 
+// redundant.
+void testIterativeOn(MultibodySystem& system, SimbodyMatterSubsystem& matter,
+                     State& state, bool unique) 
+{
+    system.realize(state, Stage::Acceleration);
+    const Vector udotDirect = state.getUDot();
+    const Vector multDirect = state.getMultipliers();
+
+    matter.setUseIterativeMultiplierSolver(true);
+    SimTK_TEST(matter.getUseIterativeMultiplierSolver());
+    state.invalidateAllCacheAtOrAbove(Stage::Acceleration);
+    system.realize(state, Stage::Acceleration);
+    SimTK_TEST_EQ_TOL(state.getUDot(), udotDirect, 1e-8);
+    if (unique)
+        SimTK_TEST_EQ_TOL(state.getMultipliers(), multDirect, 1e-8);
+    SimTK_TEST_EQ_TOL(state.getUDotErr(), Vector(state.getNUDotErr(), 0.), 
+                      1e-8);
+
+    // Now warm started from the previous solution.
+    state.updU() *= 1.01;
+    system.realize(state, Stage::Acceleration);
+    SimTK_TEST_EQ_TOL(state.getUDotErr(), Vector(state.getNUDotErr(), 0.), 
+                      1e-8);
+
+    // After a small change in u the previous multipliers already meet a 
+    // loose tolerance, so they are returned untouched.
+    const Vector prev = state.getMultipliers();
+    const Real tol = matter.getIterativeMultiplierSolverTolerance();
+    matter.setIterativeMultiplierSolverTolerance(1e-2);
+    state.updU() *= 1.0001;
+    system.realize(state, Stage::Acceleration);
+    for (int i=0; i < prev.size(); ++i)
+        SimTK_TEST(state.getMultipliers()[i] == prev[i]);
+    matter.setIterativeMultiplierSolverTolerance(tol);
+    matter.setUseIterativeMultiplierSolver(false);
+}
+
+void testIterativeSolver() {
+    for (int redundant=0; redundant <= 1; ++redundant) {
+        MultibodySystem system;
+        SimbodyMatterSubsystem matter(system);
+        GeneralForceSubsystem forces(system);
+        buildLoop(system, matter, forces, redundant != 0, false);
+        State state = system.realizeTopology();
+        setState(system, state, 9);
+        testIterativeOn(system, matter, state, !redundant);
+    }
+
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildLattice(system, matter, forces, 8);
+    matter.setIterativeMultiplierSolverTolerance(1e-12);
+    SimTK_TEST(matter.getIterativeMultiplierSolverTolerance() == 1e-12);
+    SimTK_TEST_MUST_THROW(matter.setIterativeMultiplierSolverTolerance(0));
+    State state = system.realizeTopology();
+    testIterativeOn(system, matter, state, true);
+}
+
+// Modified Newton projection should satisfy the constraints just as well as
+// full Newton while factoring much less often during a simulation.
+void testModifiedNewtonProjection() {
+    int numQFactorizations[2], numUFactorizations[2];
+    for (int modified=0; modified <= 1; ++modified) {
+        MultibodySystem system;
+        SimbodyMatterSubsystem matter(system);
+        GeneralForceSubsystem forces(system);
+        buildLoop(system, matter, forces, false, false);
+        matter.setUseModifiedNewtonProjection(modified != 0);
+        SimTK_TEST(matter.getUseModifiedNewtonProjection() == (modified!=0));
+        State state = system.realizeTopology();
+        setState(system, state, 13);
+        system.projectU(state, 1e-12);
+
+        RungeKuttaMersonIntegrator integ(system);
+        integ.setAccuracy(1e-4);
+        integ.setConstraintTolerance(1e-5);
+        integ.setReturnEveryInternalStep(true);
+        integ.initialize(state);
+        while (integ.getTime() < 2) {
+            integ.stepTo(2);
+            const State& s = integ.getState();
+            SimTK_TEST_EQ_TOL(s.getQErr(), Vector(s.getNQErr(), 0.), 1e-4);
+            SimTK_TEST_EQ_TOL(s.getUErr(), Vector(s.getNUErr(), 0.), 1e-4);
+        }
+
+        const State& s = integ.getState();
+        numQFactorizations[modified] = matter.getNumQProjectionFactorizations(s);
+        numUFactorizations[modified] = matter.getNumUProjectionFactorizations(s);
+        if (modified) {
+            SimTK_TEST(matter.getNumQProjectionFactorizationsAvoided(s) > 0);
+            SimTK_TEST(matter.getNumUProjectionFactorizationsAvoided(s) > 0);
+        } else {
+            SimTK_TEST(matter.getNumQProjectionFactorizationsAvoided(s) == 0);
+            SimTK_TEST(matter.getNumUProjectionFactorizationsAvoided(s) == 0);
+        }
+
+        // ForceFullNewton must refactor every time.
+        State sCopy = s;
+        matter.resetProjectionStatistics(sCopy);
+        SimTK_TEST(matter.getNumQProjectionFactorizations(sCopy) == 0);
+        sCopy.updQ() *= 1.001;
+        system.realize(sCopy, Stage::Position);
+        Vector noErrest;
+        ProjectOptions opts(1e-10);
+        opts.setOption(ProjectOptions::ForceFullNewton);
+        ProjectResults results;
+        system.projectQ(sCopy, noErrest, opts, results);
+        SimTK_TEST(results.getExitStatus() == ProjectResults::Succeeded);
+        SimTK_TEST(matter.getNumQProjectionFactorizations(sCopy) 
+                   == results.getNumIterations());
+        SimTK_TEST(matter.getNumQProjectionFactorizationsAvoided(sCopy) == 0);
+    }
+    SimTK_TEST(numQFactorizations[1] < numQFactorizations[0]);
+    SimTK_TEST(numUFactorizations[1] < numUFactorizations[0]);
+}
+
+int main() {
+    SimTK_START_TEST("TestConstraintFactorization");
+        SimTK_SUBTEST(testReuse);
+        SimTK_SUBTEST(testCholeskyFactorization);
+        SimTK_SUBTEST(testSparseLattice);
+        SimTK_SUBTEST(testIterativeSolver);
+        SimTK_SUBTEST(testModifiedNewtonProjection);
+    SimTK_END_TEST();
+}
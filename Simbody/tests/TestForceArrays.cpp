@@ -0,0 +1,237 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that Force::LinearSpringArray and Force::BushingArray produce the
+// same forces and energy as the equivalent individual force elements, and
+// that enabling and disabling elements within an array works.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+const int NBodies = 12, NElements = 60;
+
+// A chain of ball-jointed bodies.
+static void buildBodies(SimbodyMatterSubsystem& matter) {
+    Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    MobilizedBody* parent = &matter.updGround();
+    for (int i=0; i < NBodies; ++i)
+        parent = &matter.updMobilizedBody(MobilizedBody::Ball(*parent,
+            Vec3(0,-1,0), body, Vec3(0)).getMobilizedBodyIndex());
+}
+
+// Pick the bodies and parameters for element e.
+static void pickElement(int e, MobilizedBodyIndex& b1, MobilizedBodyIndex& b2,
+                        Vec3& s1, Vec3& s2, Real& k, Real& x0, Real& c) {
+    const int i1 = e % NBodies;
+    const int i2 = (i1 + 1 + (7*e) % (NBodies-1)) % NBodies;
+    b1 = MobilizedBodyIndex(1+i1); b2 = MobilizedBodyIndex(1+i2);
+    s1 = Vec3(.1*(e%3), .05, 0); s2 = Vec3(0, -.1, .02*(e%5));
+    k = 1 + e%4; x0 = .2*(e%3); c = e%2 ? .3 : 0;
+}
+
+void testLinearSpringArray() {
+    MultibodySystem arraySys, eltSys;
+    SimbodyMatterSubsystem arrayMatter(arraySys), eltMatter(eltSys);
+    GeneralForceSubsystem arrayForces(arraySys), eltForces(eltSys);
+    buildBodies(arrayMatter); buildBodies(eltMatter);
+
+    Force::LinearSpringArray springs(arrayForces, arrayMatter);
+    Array_<ForceIndex> springElts, damperElts;
+    for (int e=0; e < NElements; ++e) {
+        MobilizedBodyIndex b1, b2; Vec3 s1, s2; Real k, x0, c;
+        pickElement(e, b1, b2, s1, s2, k, x0, c);
+        SimTK_TEST(springs.addSpring(arrayMatter.getMobilizedBody(b1), s1,
+                   arrayMatter.getMobilizedBody(b2), s2, k, x0, c) == e);
+        springElts.push_back(Force::TwoPointLinearSpring(eltForces,
+            eltMatter.getMobilizedBody(b1), s1,
+            eltMatter.getMobilizedBody(b2), s2, k, x0).getForceIndex());
+        damperElts.push_back(Force::TwoPointLinearDamper(eltForces,
+            eltMatter.getMobilizedBody(b1), s1,
+            eltMatter.getMobilizedBody(b2), s2, c).getForceIndex());
+    }
+    SimTK_TEST(springs.getNumSprings() == NElements);
+    SimTK_TEST_MUST_THROW(springs.addSpring(arrayMatter.Ground(), Vec3(0),
+        arrayMatter.Ground(), Vec3(1), -1, 0));
+
+    // Start with one spring disabled by default.
+    springs.setSpringIsEnabledByDefault(3, false);
+    eltForces.updForce(springElts[3]).setDisabledByDefault(true);
+    eltForces.updForce(damperElts[3]).setDisabledByDefault(true);
+    SimTK_TEST(!springs.isSpringEnabledByDefault(3));
+
+    State as = arraySys.realizeTopology();
+    State es = eltSys.realizeTopology();
+    as.updQ() += .5*Test::randVector(as.getNQ());
+    as.updU() = .5*Test::randVector(as.getNU());
+    es.updQ() = as.getQ(); es.updU() = as.getU();
+
+    for (int pass=0; pass < 3; ++pass) {
+        arraySys.realize(as, Stage::Acceleration);
+        eltSys.realize(es, Stage::Acceleration);
+        SimTK_TEST_EQ_TOL(arraySys.getRigidBodyForces(as, Stage::Dynamics),
+                    eltSys.getRigidBodyForces(es, Stage::Dynamics), 1e-12);
+        SimTK_TEST_EQ_TOL(arraySys.calcPotentialEnergy(as),
+                          eltSys.calcPotentialEnergy(es), 1e-12);
+        SimTK_TEST_EQ_TOL(as.getUDot(), es.getUDot(), 1e-10);
+
+        // Check the reported length and tension of an enabled spring.
+        const int e = 4 + pass;
+        MobilizedBodyIndex b1, b2; Vec3 s1, s2; Real k, x0, c;
+        pickElement(e, b1, b2, s1, s2, k, x0, c);
+        const MobilizedBody& body1 = arrayMatter.getMobilizedBody(b1);
+        const MobilizedBody& body2 = arrayMatter.getMobilizedBody(b2);
+        const Vec3 r = body2.findStationLocationInGround(as, s2)
+                     - body1.findStationLocationInGround(as, s1);
+        const Vec3 v = body2.findStationVelocityInGround(as, s2)
+                     - body1.findStationVelocityInGround(as, s1);
+        const Real x = r.norm();
+        SimTK_TEST_EQ(springs.getLength(as, e), x);
+        SimTK_TEST_EQ(springs.getTension(as, e),
+                      k*(x-x0) + c*dot(v, r/x));
+        SimTK_TEST(isNaN(springs.getLength(as, 3)));
+
+        // Toggle some springs in each system.
+        for (int s = pass; s < NElements; s += 4) {
+            const bool enable = !springs.isSpringEnabled(as, s);
+            springs.setSpringIsEnabled(as, s, enable);
+            eltForces.setForceIsDisabled(es, springElts[s], !enable);
+            eltForces.setForceIsDisabled(es, damperElts[s], !enable);
+        }
+        SimTK_TEST(as.getSystemStage() < Stage::Instance);
+    }
+}
+
+void testBushingArray() {
+    MultibodySystem arraySys, eltSys;
+    SimbodyMatterSubsystem arrayMatter(arraySys), eltMatter(eltSys);
+    GeneralForceSubsystem arrayForces(arraySys), eltForces(eltSys);
+    buildBodies(arrayMatter); buildBodies(eltMatter);
+
+    Force::BushingArray bushings(arrayForces, arrayMatter);
+    Array_<Force::LinearBushing> elts;
+    for (int e=0; e < NElements; ++e) {
+        MobilizedBodyIndex b1, b2; Vec3 s1, s2; Real k, x0, c;
+        pickElement(e, b1, b2, s1, s2, k, x0, c);
+        const Transform X_B1F(Rotation(.1*e, XAxis), s1);
+        const Transform X_B2M(Rotation(-.2*e, ZAxis), s2);
+        const Vec6 stiffness = k*Vec6(1,2,3,4,5,6);
+        const Vec6 damping = c*Vec6(.1,.2,.3,.4,.5,.6);
+        SimTK_TEST(bushings.addBushing(arrayMatter.getMobilizedBody(b1), X_B1F,
+            arrayMatter.getMobilizedBody(b2), X_B2M, stiffness, damping) == e);
+        elts.push_back(Force::LinearBushing(eltForces,
+            eltMatter.getMobilizedBody(b1), X_B1F,
+            eltMatter.getMobilizedBody(b2), X_B2M, stiffness, damping));
+    }
+    SimTK_TEST(bushings.getNumBushings() == NElements);
+
+    State as = arraySys.realizeTopology();
+    State es = eltSys.realizeTopology();
+    Random::Uniform rand(-.1,.1); rand.setSeed(29);
+    for (int i=0; i < as.getNQ(); ++i)
+        es.updQ()[i] = (as.updQ()[i] += rand.getValue());
+    for (int i=0; i < as.getNU(); ++i)
+        es.updU()[i] = (as.updU()[i] = rand.getValue());
+
+    for (int pass=0; pass < 3; ++pass) {
+        arraySys.realize(as, Stage::Acceleration);
+        eltSys.realize(es, Stage::Acceleration);
+        SimTK_TEST_EQ_TOL(arraySys.getRigidBodyForces(as, Stage::Dynamics),
+                    eltSys.getRigidBodyForces(es, Stage::Dynamics), 1e-12);
+        SimTK_TEST_EQ_TOL(arraySys.calcPotentialEnergy(as),
+                          eltSys.calcPotentialEnergy(es), 1e-12);
+        SimTK_TEST_EQ_TOL(as.getUDot(), es.getUDot(), 1e-10);
+
+        const int e = 2 + 3*pass; // still enabled
+        SimTK_TEST_EQ(bushings.getQ(as, e), elts[e].getQ(es));
+        SimTK_TEST_EQ(bushings.getF(as, e), elts[e].getF(es));
+
+        for (int b = pass; b < NElements; b += 3) {
+            const bool enable = !bushings.isBushingEnabled(as, b);
+            bushings.setBushingIsEnabled(as, b, enable);
+            eltForces.setForceIsDisabled(es, elts[b].getForceIndex(), !enable);
+        }
+        if (pass == 0) { // bushing 0 is now disabled
+            arraySys.realize(as, Stage::Position);
+            SimTK_TEST(isNaN(bushings.getQ(as, 0)[0]));
+        }
+    }
+}
+
+// Without damping the arrays depend only on positions, so their forces are
+// cached; they must also give the same answers when calculated in parallel.
+void testCachedAndParallel() {
+    MultibodySystem serialSys, parallelSys;
+    SimbodyMatterSubsystem serial(serialSys), parallel(parallelSys);
+    GeneralForceSubsystem serialForces(serialSys), parallelForces(parallelSys);
+    buildBodies(serial); buildBodies(parallel);
+
+    Force::LinearSpringArray serialSprings(serialForces, serial);
+    Force::LinearSpringArray parallelSprings(parallelForces, parallel);
+    Force::BushingArray serialBushings(serialForces, serial);
+    Force::BushingArray parallelBushings(parallelForces, parallel);
+    for (int e=0; e < NElements; ++e) {
+        MobilizedBodyIndex b1, b2; Vec3 s1, s2; Real k, x0, c;
+        pickElement(e, b1, b2, s1, s2, k, x0, c);
+        serialSprings.addSpring(serial.getMobilizedBody(b1), s1,
+                                serial.getMobilizedBody(b2), s2, k, x0);
+        parallelSprings.addSpring(parallel.getMobilizedBody(b1), s1,
+                                  parallel.getMobilizedBody(b2), s2, k, x0);
+        serialBushings.addBushing(serial.getMobilizedBody(b1),
+            serial.getMobilizedBody(b2), Vec6(k), Vec6(0));
+        parallelBushings.addBushing(parallel.getMobilizedBody(b1),
+            parallel.getMobilizedBody(b2), Vec6(k), Vec6(0));
+    }
+    Force::Gravity(serialForces, serial, -YAxis, 9.8);
+    Force::Gravity(parallelForces, parallel, -YAxis, 9.8);
+    parallelForces.setNumberOfThreads(3);
+    parallelForces.setUseParallelBuiltInForces(true);
+
+    State ss = serialSys.realizeTopology();
+    State ps = parallelSys.realizeTopology();
+    ss.updQ() += .5*Test::randVector(ss.getNQ());
+    ss.updU() = .5*Test::randVector(ss.getNU());
+    ps.updQ() = ss.getQ(); ps.updU() = ss.getU();
+    for (int pass=0; pass < 2; ++pass) {
+        serialSys.realize(ss, Stage::Acceleration);
+        parallelSys.realize(ps, Stage::Acceleration);
+        SimTK_TEST_EQ_TOL(serialSys.getRigidBodyForces(ss, Stage::Dynamics),
+                    parallelSys.getRigidBodyForces(ps, Stage::Dynamics), 1e-12);
+        SimTK_TEST_EQ_TOL(ss.getUDot(), ps.getUDot(), 1e-10);
+
+        // A velocity change reuses the cached position-only forces.
+        ss.updU()[0] += .1; ps.updU()[0] += .1;
+    }
+}
+
+int main() {
+    SimTK_START_TEST("TestForceArrays");
+        SimTK_SUBTEST(testLinearSpringArray);
+        SimTK_SUBTEST(testBushingArray);
+        SimTK_SUBTEST(testCachedAndParallel);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,268 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check the forward dynamics derivatives d udot/dq, d udot/du and
+// d udot/dtau against the closed form for a damped pendulum and against
+// finite differences of complete realizations to Acceleration stage, for the
+// analytic recursion, for a force element that has to be differenced, and for
+// a mobilizer that makes the whole residual be differenced. Also check that
+// the directional form agrees with the dense one, and that the Dual number
+// recursions handle every mobilizer with a constant H_FM.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// Unconstrained accelerations at the given q and u, with extra generalized
+// forces tau, found by complete realization.
+static Vector calcUDot(const MultibodySystem& system,
+                       const Force::DiscreteForces& extra,
+                       State& state, const Vector& q, const Vector& u,
+                       const Vector& tau)
+{
+    state.updQ() = q; state.updU() = u;
+    extra.setAllMobilityForces(state, tau);
+    system.realize(state, Stage::Acceleration);
+    return state.getUDot();
+}
+
+// A point mass m on a massless rod of length L swinging about a pin, with
+// damping c and gravity g, has
+//      m L^2 qdotdot = -m g L sin(q) - c qdot + tau.
+void testPendulum() {
+    const Real m = 2, L = .7, g = 9.8, c = .3;
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::Gravity(forces, matter, -YAxis, g);
+    Force::DiscreteForces extra(forces, matter);
+    const Vec3 com(0,-L,0);
+    MobilizedBody::Pin pendulum(matter.Ground(), Vec3(0),
+        Body::Rigid(MassProperties(m, com, UnitInertia::pointMassAt(com))),
+        Vec3(0));
+    Force::MobilityLinearDamper(forces, pendulum, MobilizerUIndex(0), c);
+
+    State state = system.realizeTopology();
+    pendulum.setOneQ(state, 0, .6); pendulum.setOneU(state, 0, -1.3);
+    extra.setAllMobilityForces(state, Vector(1, 2.5));
+    system.realize(state, Stage::Dynamics);
+
+    Matrix dudot_dq, dudot_du, dudot_dtau;
+    matter.calcForwardDynamicsDerivatives(state, dudot_dq, dudot_du,
+                                          dudot_dtau);
+    SimTK_TEST_EQ(dudot_dq(0,0), -g/L*std::cos(.6));
+    SimTK_TEST_EQ(dudot_du(0,0), -c/(m*L*L));
+    SimTK_TEST_EQ(dudot_dtau(0,0), 1/(m*L*L));
+
+    Vector dudot;
+    matter.multiplyByForwardDynamicsDerivatives(state, Vector(1, 2.),
+        Vector(1, 3.), Vector(1, 5.), dudot);
+    SimTK_TEST_EQ(dudot[0], -2*g/L*std::cos(.6) - 3*c/(m*L*L) + 5/(m*L*L));
+}
+
+// A force element that supplies no derivative of its own.
+class Twister : public Force::Custom::Implementation {
+public:
+    explicit Twister(const MobilizedBody& mobod) : mobod(mobod) {}
+    void calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
+                   Vector_<Vec3>&, Vector& mobilityForces) const override {
+        const Rotation& R_GB = mobod.getBodyRotation(state);
+        const Vec3& w = mobod.getBodyAngularVelocity(state);
+        mobod.applyBodyTorque(state, R_GB*Vec3(.2,.1,-.3) - .4*w, bodyForces);
+    }
+    Real calcPotentialEnergy(const State&) const override {return 0;}
+private:
+    const MobilizedBody& mobod;
+};
+
+// How the residual derivative is found.
+enum Path {Analytic, DifferencedForce, DifferencedResidual};
+
+void testAgainstFiniteDifferences(Path path) {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::Gravity(forces, matter, -YAxis, 9.8);
+    Force::DiscreteForces extra(forces, matter);
+
+    Body::Rigid body(MassProperties(1.5, Vec3(.1,.2,0),
+                                    UnitInertia(.3,.2,.1,.01,.02,.03)));
+    MobilizedBody::Pin link1(matter.Ground(), Vec3(0), body, Vec3(0,.5,0));
+    MobilizedBody::Ball link2(link1, Vec3(0,-.5,0), body, Vec3(0,.5,0));
+    MobilizedBody::Slider link3(link2, Vec3(.1,-.5,0), body, Vec3(0,.2,0));
+    // A Universal joint's H_FM varies with q; a Cylinder's doesn't.
+    MobilizedBody side;
+    if (path == DifferencedResidual)
+        side = MobilizedBody::Universal(link1, Vec3(.3,0,0), body, 
+                                        Vec3(0,.4,0));
+    else
+        side = MobilizedBody::Cylinder(link1, Vec3(.3,0,0), body, 
+                                       Vec3(0,.4,0));
+    MobilizedBody::Pin tip(side, Vec3(0,-.5,0), body, Vec3(0,.5,0));
+    MobilizedBody::Free loose(link3, Vec3(0,-.3,0), body, Vec3(.1,.2,.3));
+    if (path == DifferencedForce)
+        Force::Custom(forces, new Twister(loose));
+
+    // Position and velocity dependent forces.
+    Force::MobilityLinearSpring(forces, link3, 0, 20, .1);
+    Force::MobilityLinearDamper(forces, link1, 0, 3);
+    Force::TwoPointLinearSpring(forces, matter.Ground(), Vec3(1,0,0),
+                                tip, Vec3(0,-.5,0), 30, .5);
+    Force::TwoPointLinearDamper(forces, link2, Vec3(.2,0,0),
+                                side, Vec3(0), 4);
+    Force::ConstantForce(forces, loose, Vec3(.1,0,.2), Vec3(1,2,3));
+    Force::GlobalDamper(forces, matter, .2);
+    // A prescribed acceleration, whose udot row must come out zero.
+    Motion::Steady(tip, .7);
+
+    State state = system.realizeTopology();
+    const int nq = state.getNQ(), nu = state.getNU();
+    Random::Uniform random(-1, 1); random.setSeed(3);
+    for (int i=0; i < nq; ++i) state.updQ()[i] = random.getValue();
+    for (int i=0; i < nu; ++i) state.updU()[i] = random.getValue();
+    Vector tau(nu);
+    for (int i=0; i < nu; ++i) tau[i] = random.getValue();
+    extra.setAllMobilityForces(state, tau);
+    system.realize(state, Stage::Dynamics);
+
+    Matrix dudot_dq, dudot_du, dudot_dtau;
+    matter.calcForwardDynamicsDerivatives(state, dudot_dq, dudot_du,
+                                          dudot_dtau);
+    SimTK_TEST(dudot_dq.nrow()==nu && dudot_dq.ncol()==nq);
+    SimTK_TEST(dudot_du.nrow()==nu && dudot_du.ncol()==nu);
+    SimTK_TEST(dudot_dtau.nrow()==nu && dudot_dtau.ncol()==nu);
+
+    // Finite differences of complete realizations.
+    const Vector q0 = state.getQ(), u0 = state.getU();
+    State tmp = state;
+    const Real h = 1e-5;
+    Matrix fd_dq(nu,nq), fd_du(nu,nu), fd_dtau(nu,nu);
+    for (int j=0; j < nq; ++j) {
+        Vector qp = q0, qm = q0; qp[j] += h; qm[j] -= h;
+        fd_dq(j) = (calcUDot(system,extra,tmp,qp,u0,tau)
+                    - calcUDot(system,extra,tmp,qm,u0,tau)) / (2*h);
+    }
+    for (int j=0; j < nu; ++j) {
+        Vector up = u0, um = u0; up[j] += h; um[j] -= h;
+        fd_du(j) = (calcUDot(system,extra,tmp,q0,up,tau)
+                    - calcUDot(system,extra,tmp,q0,um,tau)) / (2*h);
+        Vector tp = tau, tm = tau; tp[j] += h; tm[j] -= h;
+        fd_dtau(j) = (calcUDot(system,extra,tmp,q0,u0,tp)
+                      - calcUDot(system,extra,tmp,q0,u0,tm)) / (2*h);
+    }
+
+    // The prescribed udot is constant, so its finite difference row is
+    // zero as well.
+    SimTK_TEST_EQ_TOL(dudot_dq, fd_dq, 1e-6);
+    SimTK_TEST_EQ_TOL(dudot_du, fd_du, 1e-6);
+    SimTK_TEST_EQ_TOL(dudot_dtau, fd_dtau, 1e-6);
+
+    const UIndex tipU = tip.getFirstUIndex(state);
+    SimTK_TEST(dudot_dq[tipU].norm() == 0);
+    SimTK_TEST(dudot_dtau[tipU].norm() == 0);
+
+    // Directional derivatives.
+    Vector dq(nq), du(nu), dtau(nu), dudot;
+    for (int i=0; i < nq; ++i) dq[i] = random.getValue();
+    for (int i=0; i < nu; ++i) du[i] = random.getValue();
+    for (int i=0; i < nu; ++i) dtau[i] = random.getValue();
+
+    matter.multiplyByForwardDynamicsDerivatives(state, dq, du, dtau, dudot);
+    SimTK_TEST_EQ_TOL(dudot, dudot_dq*dq + dudot_du*du + dudot_dtau*dtau,
+                      1e-6);
+    matter.multiplyByForwardDynamicsDerivatives(state, dq, Vector(),
+                                                Vector(), dudot);
+    SimTK_TEST_EQ_TOL(dudot, dudot_dq*dq, 1e-6);
+    matter.multiplyByForwardDynamicsDerivatives(state, Vector(), Vector(),
+                                                dtau, dudot);
+    SimTK_TEST_EQ_TOL(dudot, dudot_dtau*dtau, 1e-12);
+
+    // The State we were given is untouched.
+    SimTK_TEST_EQ(state.getQ(), q0); SimTK_TEST_EQ(state.getU(), u0);
+    SimTK_TEST(state.getSystemStage() >= Stage::Dynamics);
+
+    SimTK_TEST_MUST_THROW(matter.multiplyByForwardDynamicsDerivatives
+        (state, Vector(nq+1, Real(1)), Vector(), Vector(), dudot));
+}
+
+// The analytic path runs the tree recursions on Dual numbers; check it for 
+// every mobilizer with a constant H_FM, with general frames on both sides, 
+// against finite differences along a random direction.
+void testConstantHMobilizers() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::Gravity(forces, matter, -YAxis, 9.8);
+    Force::DiscreteForces extra(forces, matter);
+
+    Body::Rigid body(MassProperties(1.5, Vec3(.1,.2,0),
+                                    UnitInertia(.3,.2,.1,.01,.02,.03)));
+    const Transform X_PF(Rotation(.3, ZAxis), Vec3(.1,-.5,.2));
+    const Transform X_BM(Rotation(-.2, XAxis), Vec3(0,.4,.1));
+    MobilizedBody::Pin link1(matter.Ground(), X_PF, body, X_BM);
+    MobilizedBody::Ball link2(link1, X_PF, body, X_BM);
+    MobilizedBody::Slider link3(link2, X_PF, body, X_BM);
+    MobilizedBody::Cylinder link4(link3, X_PF, body, X_BM);
+    MobilizedBody::Free link5(link4, X_PF, body, X_BM);
+    MobilizedBody::Weld link6(link5, X_PF, body, X_BM);
+    MobilizedBody::Planar link7(link6, X_PF, body, X_BM);
+    MobilizedBody::Screw side1(link2, X_PF, body, X_BM, .3);
+    MobilizedBody::Translation side2(side1, X_PF, body, X_BM);
+    Force::TwoPointLinearSpring(forces, link7, Vec3(.1,0,0),
+                                side2, Vec3(0,.2,0), 10, .3);
+
+    State state = system.realizeTopology();
+    const int nq = state.getNQ(), nu = state.getNU();
+    Random::Uniform random(-1, 1); random.setSeed(7);
+    Vector dq(nq), du(nu), tau(nu, Real(0)), dudot;
+    for (int i=0; i < nq; ++i) state.updQ()[i] = random.getValue();
+    for (int i=0; i < nu; ++i) state.updU()[i] = random.getValue();
+    for (int i=0; i < nq; ++i) dq[i] = random.getValue();
+    for (int i=0; i < nu; ++i) du[i] = random.getValue();
+    system.realize(state, Stage::Dynamics);
+
+    matter.multiplyByForwardDynamicsDerivatives(state, dq, du, Vector(), 
+                                                dudot);
+
+    const Vector q0 = state.getQ(), u0 = state.getU();
+    State tmp = state;
+    const Real h = 1e-5;
+    const Vector fd = (calcUDot(system,extra,tmp,q0+h*dq,u0+h*du,tau)
+                       - calcUDot(system,extra,tmp,q0-h*dq,u0-h*du,tau)) 
+                      / (2*h);
+    SimTK_TEST_EQ_TOL(dudot, fd, 1e-6);
+}
+
+int main() {
+    SimTK_START_TEST("TestForwardDynamicsDerivatives");
+        SimTK_SUBTEST(testPendulum);
+        SimTK_SUBTEST1(testAgainstFiniteDifferences, Analytic);
+        SimTK_SUBTEST1(testAgainstFiniteDifferences, DifferencedForce);
+        SimTK_SUBTEST1(testAgainstFiniteDifferences, DifferencedResidual);
+        SimTK_SUBTEST(testConstantHMobilizers);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,128 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that incremental position kinematics, which recalculates only the
+// bodies outboard of mobilizers whose q's changed, gives the same results as
+// recalculating everything.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// Compare everything calculated at Position and Acceleration stage in 
+// "state" against a from-scratch realization of a copy of it.
+static void checkAgainstFullRealization(const MultibodySystem& system,
+                                        const SimbodyMatterSubsystem& matter,
+                                        State& state) 
+{
+    system.realize(state, Stage::Acceleration);
+
+    State full = state;
+    full.invalidateAllCacheAtOrAbove(Stage::Instance);
+    system.realize(full, Stage::Acceleration);
+
+    for (MobilizedBodyIndex mbx(0); mbx < matter.getNumBodies(); ++mbx) {
+        const MobilizedBody& mobod = matter.getMobilizedBody(mbx);
+        SimTK_TEST_EQ(mobod.getBodyTransform(state), 
+                      mobod.getBodyTransform(full));
+        SimTK_TEST_EQ(mobod.getMobilizerTransform(state), 
+                      mobod.getMobilizerTransform(full));
+        SimTK_TEST_EQ(mobod.getBodyMassCenterStation(state), 
+                      mobod.getBodyMassCenterStation(full));
+    }
+    SimTK_TEST_EQ(state.getQErr(), full.getQErr());
+    SimTK_TEST_EQ(state.getUDot(), full.getUDot());
+}
+
+void testIncremental() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::Gravity(forces, matter, -YAxis, 9.8);
+
+    // Two arms on a common torso; the right arm has a ball shoulder (with a
+    // quaternion) and the left one is tied to Ground with a constraint.
+    Body::Rigid body(MassProperties(1, Vec3(.1,0,0), UnitInertia(.1,.2,.3)));
+    MobilizedBody::Free torso(matter.Ground(), Vec3(0), body, Vec3(0));
+    MobilizedBody::Ball rShoulder(torso, Vec3(.5,0,0), body, Vec3(0,.5,0));
+    MobilizedBody::Pin rElbow(rShoulder, Vec3(0,-.5,0), body, Vec3(0,.5,0));
+    MobilizedBody::Universal rWrist(rElbow, Vec3(0,-.5,0), 
+                                    body, Vec3(0,.1,0));
+    MobilizedBody::Pin lShoulder(torso, Vec3(-.5,0,0), body, Vec3(0,.5,0));
+    MobilizedBody::Pin lElbow(lShoulder, Vec3(0,-.5,0), body, Vec3(0,.5,0));
+    MobilizedBody::Gimbal lWrist(lElbow, Vec3(0,-.5,0), body, Vec3(0,.1,0));
+    MobilizedBody::Weld lHand(lWrist, Vec3(0,-.1,0), body, Vec3(0));
+    Constraint::Ball(matter.Ground(), Vec3(-1,-1,0), lHand, Vec3(0));
+
+    matter.setUseIncrementalPositionKinematics(true);
+    SimTK_TEST(matter.getUseIncrementalPositionKinematics());
+
+    State state = system.realizeTopology();
+    Random::Uniform random(-1, 1); random.setSeed(5);
+    for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] = random.getValue();
+    for (int i=0; i < state.getNU(); ++i) state.updU()[i] = random.getValue();
+    checkAgainstFullRealization(system, matter, state);
+
+    // Change only the wrists.
+    rWrist.setOneQ(state, 1, .3);
+    lWrist.setQ(state, Vec3(.1,.2,-.3));
+    checkAgainstFullRealization(system, matter, state);
+
+    // A quaternion, which also has a normalization error in qErr.
+    rShoulder.setQ(state, Vec4(1,2,3,4));
+    checkAgainstFullRealization(system, matter, state);
+    SimTK_TEST(state.getQErr().normInf() > 0.1);
+
+    // Nothing changed, but the cache was invalidated anyway.
+    state.invalidateAllCacheAtOrAbove(Stage::Position);
+    checkAgainstFullRealization(system, matter, state);
+
+    // Changing the torso moves everything, so this takes the full sweep.
+    torso.setQToFitTranslation(state, Vec3(.1,.2,.3));
+    checkAgainstFullRealization(system, matter, state);
+
+    // After running with the option off the old record must not be used.
+    matter.setUseIncrementalPositionKinematics(false);
+    rElbow.setOneQ(state, 0, -.4);
+    checkAgainstFullRealization(system, matter, state);
+    matter.setUseIncrementalPositionKinematics(true);
+    lElbow.setOneQ(state, 0, .6);
+    checkAgainstFullRealization(system, matter, state);
+    rElbow.setOneQ(state, 0, .2);
+    checkAgainstFullRealization(system, matter, state);
+
+    // Projection modifies q's in place.
+    system.projectQ(state, 1e-10);
+    checkAgainstFullRealization(system, matter, state);
+    SimTK_TEST(state.getQErr().normInf() < 1e-9);
+}
+
+int main() {
+    SimTK_START_TEST("TestIncrementalPositionKinematics");
+        SimTK_SUBTEST(testIncremental);
+    SimTK_END_TEST();
+}
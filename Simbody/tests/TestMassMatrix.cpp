@@ -31,6 +31,7 @@
 #include "SimTKsimbody.h"
 #include "SimTKcommon/Testing.h"
 
+#include <algorithm>
 #include <iostream>
 
 using namespace SimTK;
@@ -1042,6 +1043,143 @@ void testCompositeBodyInertia() {
     SimTK_TEST(!pend.isCompositeBodyInertiasRealized(state));
 }
 
+// M, M^-1 and the composite body inertias are cached across velocity 
+// changes but must be recalculated when q changes.
+void testMassMatrixCaching() {
+    MultibodySystem         mbs;
+    SimbodyMatterSubsystem  matter(mbs);
+    Body::Rigid body(MassProperties(1, Vec3(.1,.2,.3), UnitInertia(1,2,3)));
+    MobilizedBody::Pin   body1(matter.Ground(), Vec3(0), body, Vec3(1,0,0));
+    MobilizedBody::Ball  body2(body1, Vec3(0), body, Vec3(1,0,0));
+    MobilizedBody::Slider body3(body2, Vec3(0), body, Vec3(1,0,0));
+
+    State state = mbs.realizeTopology();
+    state.updQ() = Test::randVector(state.getNQ());
+    mbs.realize(state, Stage::Position);
+
+    // Explicit column-at-a-time calculations to check against.
+    const int nu = state.getNU();
+    Matrix Mexp(nu,nu), MInvExp(nu,nu);
+    Vector e(nu, 0.);
+    for (int i=0; i < nu; ++i) {
+        e[i] = 1;
+        Vector col;
+        matter.multiplyByM(state, e, col);    Mexp(i)    = col;
+        matter.multiplyByMInv(state, e, col); MInvExp(i) = col;
+        e[i] = 0;
+    }
+
+    SimTK_TEST(!matter.isCompositeBodyInertiasRealized(state));
+    Array_<SpatialInertia,MobilizedBodyIndex> R;
+    matter.calcCompositeBodyInertias(state, R);
+    SimTK_TEST(matter.isCompositeBodyInertiasRealized(state));
+
+    Matrix M, MInv;
+    matter.calcM(state, M);
+    matter.calcMInv(state, MInv);
+    SimTK_TEST_EQ(M, Mexp);
+    SimTK_TEST_EQ(MInv, MInvExp);
+
+    // Velocity changes don't invalidate anything.
+    state.updU() = Test::randVector(nu);
+    mbs.realize(state, Stage::Velocity);
+    SimTK_TEST(matter.isCompositeBodyInertiasRealized(state));
+    Matrix M2, MInv2;
+    matter.calcM(state, M2);
+    matter.calcMInv(state, MInv2);
+    SimTK_TEST_EQ(M2, M);
+    SimTK_TEST_EQ(MInv2, MInv);
+
+    // Position changes do.
+    state.updQ() = Test::randVector(state.getNQ());
+    mbs.realize(state, Stage::Position);
+    SimTK_TEST(!matter.isCompositeBodyInertiasRealized(state));
+    for (int i=0; i < nu; ++i) {
+        e[i] = 1;
+        Vector col;
+        matter.multiplyByM(state, e, col);    Mexp(i)    = col;
+        matter.multiplyByMInv(state, e, col); MInvExp(i) = col;
+        e[i] = 0;
+    }
+    matter.calcM(state, M2);
+    matter.calcMInv(state, MInv2);
+    SimTK_TEST_EQ(M2, Mexp);
+    SimTK_TEST_EQ(MInv2, MInvExp);
+    Matrix identity(nu,nu); identity = 1;
+    SimTK_TEST_EQ(M2*MInv2, identity);
+
+    // A locked mobilizer's rows and columns of M^-1 are zero.
+    body1.lock(state);
+    mbs.realize(state, Stage::Position);
+    for (int i=0; i < nu; ++i) {
+        e[i] = 1;
+        Vector col;
+        matter.multiplyByMInv(state, e, col); MInvExp(i) = col;
+        e[i] = 0;
+    }
+    matter.calcMInv(state, MInv2);
+    SimTK_TEST_EQ(MInv2, MInvExp);
+    for (int i=0; i < nu; ++i)
+        SimTK_TEST(MInv2(0,i) == 0 && MInv2(i,0) == 0);
+}
+
+// A branched tree with a weld and a massless interior body, to exercise the
+// sparse composite body mass matrix and its LTDL factorization.
+void testSparseMassMatrix() {
+    MultibodySystem         mbs;
+    SimbodyMatterSubsystem  matter(mbs);
+    Body::Rigid body(MassProperties(1, Vec3(.1,.2,.3), UnitInertia(1,2,3)));
+    Body::Rigid massless(MassProperties(0, Vec3(0), UnitInertia(0)));
+    MobilizedBody::Free   torso(matter.Ground(), Vec3(0), body, Vec3(0));
+    MobilizedBody::Weld   pelvis(torso, Vec3(0,-1,0), body, Vec3(0));
+    MobilizedBody::Ball   hipL(pelvis, Vec3(-.2,0,0), body, Vec3(0,1,0));
+    MobilizedBody::Pin    kneeL(hipL, Vec3(0), body, Vec3(0,1,0));
+    MobilizedBody::Ball   hipR(pelvis, Vec3(.2,0,0), body, Vec3(0,1,0));
+    MobilizedBody::Pin    kneeR(hipR, Vec3(0), body, Vec3(0,1,0));
+    MobilizedBody::Pin    wrist(torso, Vec3(.5,0,0), massless, Vec3(0));
+    MobilizedBody::Slider hand(wrist, Vec3(.1,0,0), body, Vec3(0));
+
+    State state = mbs.realizeTopology();
+    state.updQ() = Test::randVector(state.getNQ());
+    mbs.realize(state, Stage::Position);
+
+    const int nu = state.getNU();
+    Matrix Mexp(nu,nu);
+    Vector e(nu, 0.);
+    for (int i=0; i < nu; ++i) {
+        e[i] = 1;
+        Vector col;
+        matter.multiplyByM(state, e, col); Mexp(i) = col;
+        e[i] = 0;
+    }
+
+    Matrix M;
+    matter.calcM(state, M);
+    SimTK_TEST_EQ(M, Mexp);
+    // Left and right legs don't interact.
+    SimTK_TEST(M(hipL.getFirstUIndex(state), kneeR.getFirstUIndex(state)) == 0);
+
+    const Vector x = Test::randVector(nu);
+    Vector udot;
+    matter.solveM(state, M*x, udot);
+    SimTK_TEST_EQ_TOL(udot, x, 1e-10);
+
+    Matrix X(nu, 3);
+    for (int j=0; j < 3; ++j) X(j) = Test::randVector(nu);
+    Matrix Udot;
+    matter.solveM(state, M*X, Udot);
+    SimTK_TEST_EQ_TOL(Udot, X, 1e-10);
+
+    // With nothing prescribed, solveM() agrees with the O(n) operator.
+    const Vector f = Test::randVector(nu);
+    Vector MInvf;
+    matter.multiplyByMInv(state, f, MInvf);
+    matter.solveM(state, f, udot);
+    SimTK_TEST_EQ_TOL(udot, MInvf, 1e-10);
+
+    SimTK_TEST_MUST_THROW(matter.solveM(state, Vector(nu+1, 1.), udot));
+}
+
 // Currently just testing validity/invalidation, not correctness.
 void testArticulatedBodyInertia() {
     MultibodySystem mbs;
@@ -1344,6 +1482,148 @@ void testTaskJacobians() {
     SimTK_TEST_EQ_TOL(JFmat2, JFmat, SignificantReal);
 }
 
+// A TaskJacobianPlan with mixed station and frame tasks must reproduce the
+// rows calculated by the general station and frame Jacobian methods.
+void testTaskJacobianPlan() {
+    MultibodySystem system;
+    MyForceImpl* frcp;
+    makeSystem(false, system, frcp);
+    const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
+
+    State state = system.realizeTopology();
+    const int nu = state.getNU();
+    const int nb = matter.getNumBodies();
+    const Real Slop = nu*SignificantReal;
+
+    state.updQ() = Test::randVector(state.getNQ());
+    state.updU() = Test::randVector(nu);
+    system.realize(state, Stage::Velocity);
+
+    TaskJacobianPlan plan(matter);
+    Array_<MobilizedBodyIndex> stationBodies, frameBodies;
+    Array_<Vec3> stations, frames;
+    for (int i=0; i < 2*nb; ++i) {
+        const MobilizedBodyIndex mbx((i*7) % nb);
+        const Vec3 p = 10.*Test::randVec3();
+        if (i % 3 == 0) {
+            SimTK_TEST(plan.addFrameTask(mbx, p) == i);
+            frameBodies.push_back(mbx); frames.push_back(p);
+        } else {
+            SimTK_TEST(plan.addStationTask(mbx, p) == i);
+            stationBodies.push_back(mbx); stations.push_back(p);
+        }
+    }
+    SimTK_TEST(plan.getNumTasks() == 2*nb);
+    SimTK_TEST(plan.getNumRows() == 3*stations.size() + 6*frames.size());
+
+    // Assemble the expected J and JDot*u from the general methods.
+    Matrix JS, JF;
+    Vector JSDotu, JFDotu;
+    matter.calcStationJacobian(state, stationBodies, stations, JS);
+    matter.calcFrameJacobian(state, frameBodies, frames, JF);
+    matter.calcBiasForStationJacobian(state, stationBodies, stations, JSDotu);
+    matter.calcBiasForFrameJacobian(state, frameBodies, frames, JFDotu);
+    Matrix Jexp(plan.getNumRows(), nu);
+    Vector JDotuExp(plan.getNumRows());
+    int nxtS = 0, nxtF = 0;
+    for (int t=0; t < plan.getNumTasks(); ++t) {
+        const int row = plan.getFirstRow(t);
+        if (plan.isFrameTask(t)) {
+            Jexp(row,0,6,nu) = JF(6*nxtF,0,6,nu);
+            JDotuExp(row,6) = JFDotu(6*nxtF++,6);
+        } else {
+            Jexp(row,0,3,nu) = JS(3*nxtS,0,3,nu);
+            JDotuExp(row,3) = JSDotu(3*nxtS++,3);
+        }
+        // Nothing outside the task's path can move it.
+        const ArrayViewConst_<MobilizedBodyIndex> path = plan.getPath(t);
+        for (MobilizedBodyIndex mbx(1); mbx < nb; ++mbx) {
+            if (std::find(path.begin(), path.end(), mbx) != path.end())
+                continue;
+            const MobilizedBody& mobod = matter.getMobilizedBody(mbx);
+            for (int k=0; k < mobod.getNumU(state); ++k)
+                SimTK_TEST(Jexp(row, mobod.getFirstUIndex(state)+k) == 0);
+        }
+    }
+
+    Matrix J;
+    plan.calcJacobian(state, J);
+    SimTK_TEST_EQ_TOL(J, Jexp, Slop);
+
+    Vector JDotu;
+    plan.calcBias(state, JDotu);
+    SimTK_TEST_EQ_TOL(JDotu, JDotuExp, Slop);
+
+    const Vector u = Test::randVector(nu);
+    Vector Ju;
+    plan.multiplyByJacobian(state, u, Ju);
+    SimTK_TEST_EQ_TOL(Ju, Jexp*u, Slop);
+
+    const Vector F = Test::randVector(plan.getNumRows());
+    Vector f;
+    plan.multiplyByJacobianTranspose(state, F, f);
+    SimTK_TEST_EQ_TOL(f, ~Jexp*F, Slop);
+
+    SimTK_TEST_MUST_THROW(plan.multiplyByJacobian(state, Vector(nu+1,0.), Ju));
+    TaskJacobianPlan unattached;
+    SimTK_TEST_MUST_THROW(unattached.addStationTask(MobilizedBodyIndex(1), 
+                                                    Vec3(0)));
+}
+
+// The task-space inertia inverse J M^-1 ~J must match the explicit product,
+// including with a prescribed mobilizer and with tasks on separate branches.
+void testTaskSpaceInertia() {
+    MultibodySystem         mbs;
+    SimbodyMatterSubsystem  matter(mbs);
+    Body::Rigid body(MassProperties(1, Vec3(.1,.2,.3), UnitInertia(1,2,3)));
+    MobilizedBody::Free   torso(matter.Ground(), Vec3(0), body, Vec3(0));
+    MobilizedBody::Weld   pelvis(torso, Vec3(0,-1,0), body, Vec3(0));
+    MobilizedBody::Ball   hipL(pelvis, Vec3(-.2,0,0), body, Vec3(0,1,0));
+    MobilizedBody::Pin    kneeL(hipL, Vec3(0), body, Vec3(0,1,0));
+    MobilizedBody::Ball   hipR(pelvis, Vec3(.2,0,0), body, Vec3(0,1,0));
+    MobilizedBody::Pin    kneeR(hipR, Vec3(0), body, Vec3(0,1,0));
+    MobilizedBody::Pin    wrist(torso, Vec3(.5,0,0), body, Vec3(0));
+    MobilizedBody::Slider hand(wrist, Vec3(.1,0,0), body, Vec3(0));
+    Motion::Steady(kneeR, 0.5);
+
+    State state = mbs.realizeTopology();
+    state.updQ() = Test::randVector(state.getNQ());
+    mbs.realize(state, Stage::Position);
+
+    TaskJacobianPlan tasks(matter);
+    tasks.addStationTask(kneeL, Vec3(.1,-.5,0));
+    tasks.addFrameTask(hand, Vec3(.2,.3,0));
+    tasks.addStationTask(kneeR, Vec3(0,-.5,.1));
+    tasks.addStationTask(MobilizedBodyIndex(0), Vec3(1,2,3)); // Ground
+    const int nr = tasks.getNumRows();
+
+    Matrix J, MInv;
+    tasks.calcJacobian(state, J);
+    matter.calcMInv(state, MInv);
+    const Matrix LambdaInvExp = J*MInv*~J;
+
+    Matrix LambdaInv;
+    matter.calcTaskSpaceInertiaInverse(state, tasks, LambdaInv);
+    SimTK_TEST_EQ_TOL(LambdaInv, LambdaInvExp, 1e-10);
+
+    // Lambda is the inverse on the tasks that can move (Ground's can't).
+    Matrix Lambda;
+    matter.calcTaskSpaceInertia(state, tasks, Lambda);
+    const int nm = nr-3;
+    Matrix identity(nm,nm); identity = 1;
+    SimTK_TEST_EQ_TOL(Lambda(0,0,nm,nm)*LambdaInv(0,0,nm,nm), identity, 1e-8);
+
+    // Station-only signature.
+    Array_<MobilizedBodyIndex> onBodyB;
+    Array_<Vec3> p_BS;
+    onBodyB.push_back(kneeL); p_BS.push_back(Vec3(.1,-.5,0));
+    onBodyB.push_back(hand);  p_BS.push_back(Vec3(.2,.3,0));
+    Matrix JS, LambdaInvS;
+    matter.calcStationJacobian(state, onBodyB, p_BS, JS);
+    matter.calcTaskSpaceInertiaInverse(state, onBodyB, p_BS, LambdaInvS);
+    SimTK_TEST_EQ_TOL(LambdaInvS, JS*MInv*~JS, 1e-10);
+}
+
 // Position kinematics should be valid if:
 // - realize(Position) has been done
 // - or, realize(Instance) + realizePositionKinematics()
@@ -1491,11 +1771,15 @@ int main() {
         SimTK_SUBTEST(testRel2Cart);
         SimTK_SUBTEST(testJacobianBiasTerms);
         SimTK_SUBTEST(testCompositeBodyInertia);
+        SimTK_SUBTEST(testMassMatrixCaching);
+        SimTK_SUBTEST(testSparseMassMatrix);
         SimTK_SUBTEST(testArticulatedBodyInertia);
         SimTK_SUBTEST(testArticulatedBodyVelocity);
         SimTK_SUBTEST(testUnconstrainedSystem);
         SimTK_SUBTEST(testConstrainedSystem);
         SimTK_SUBTEST(testTaskJacobians);
+        SimTK_SUBTEST(testTaskJacobianPlan);
+        SimTK_SUBTEST(testTaskSpaceInertia);
     SimTK_END_TEST();
 }
 
@@ -558,6 +558,55 @@ void testFreeMobilizer() {
     assertEqual(fwdReac[1], SpatialVec(Vec3(0)));
 }
 
+/**
+ * Check that the cached reactions agree with the freebody method, that they are
+ * recalculated after the state changes, and that filling a caller-supplied
+ * buffer doesn't disturb its storage.
+ */
+
+void testCachedReactionForces() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::UniformGravity(forces, matter, Vec3(0, -9.8, 0));
+
+    Inertia inertia = Inertia(Mat33(0.1, 0.01, 0.01,
+                                    0.01, 0.1, 0.01,
+                                    0.01, 0.01, 0.1));
+    MobilizedBody::Slider body1(matter.updGround(), MassProperties(10.0, Vec3(0), inertia));
+    MobilizedBody::Pin body2(body1, Vec3(0.1, 0.1, 0), MassProperties(20.0, Vec3(0), inertia), Vec3(0, -0.2, 0));
+    MobilizedBody::Gimbal body3(body2, Vec3(0, 0.2, 0), MassProperties(20.0, Vec3(0), inertia), Vec3(0, -0.2, 0));
+    MobilizedBody::Pin body4(body3, Vec3(0, 0.2, 0), MassProperties(30.0, Vec3(0), inertia), Vec3(0, -0.2, 0));
+    MobilizedBody::Pin body5(body2, Vec3(0.2, 0, 0), MassProperties(5.0, Vec3(0), inertia), Vec3(0, -0.1, 0));
+    State state = system.realizeTopology();
+    const int nb = matter.getNumBodies();
+
+    Vector_<SpatialVec> reaction(nb), freebody(nb);
+    const SpatialVec* storage = &reaction[0];
+    for (int trial = 0; trial < 3; ++trial) {
+        state.updQ() = Test::randVector(state.getNQ());
+        state.updU() = Test::randVector(state.getNU());
+        system.realize(state, Stage::Acceleration);
+
+        const Vector_<SpatialVec>& cached = 
+            matter.getMobilizerReactionForces(state);
+        SimTK_TEST(&matter.getMobilizerReactionForces(state)[0] == &cached[0]);
+        matter.calcMobilizerReactionForcesUsingFreebodyMethod(state, freebody);
+        SimTK_TEST_EQ_TOL(cached, freebody, 1e-10);
+
+        matter.calcMobilizerReactionForces(state, reaction);
+        SimTK_TEST(&reaction[0] == storage);
+        SimTK_TEST_EQ(reaction, cached);
+        SimTK_TEST_EQ(reaction[body4.getMobilizedBodyIndex()],
+            body4.findMobilizerReactionOnBodyAtMInGround(state));
+    }
+
+    // The cache must not survive invalidation of Acceleration stage.
+    state.updU()[0] += 0.1;
+    system.realize(state, Stage::Velocity);
+    SimTK_TEST_MUST_THROW(matter.getMobilizerReactionForces(state));
+}
+
 int main() {
     SimTK_START_TEST("TestMobilizerReactionForces");
         SimTK_SUBTEST(testByComparingToConstraints);
@@ -566,5 +615,6 @@ int main() {
         SimTK_SUBTEST(testByComparingToSDFAST2);
         SimTK_SUBTEST(testByComparingToSDFASTWithConstraint);
         SimTK_SUBTEST(testFreeMobilizer);
+        SimTK_SUBTEST(testCachedReactionForces);
     SimTK_END_TEST();
 }
@@ -0,0 +1,98 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that once a State's workspace has grown to size, realizing
+// Stage::Acceleration again performs no heap allocation, with and without
+// constraints.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include "HeapAllocationCounter.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// Realize Acceleration stage repeatedly and return the number of heap
+// allocations done by the last realization.
+static long long countAllocations(const MultibodySystem& system, State& state)
+{
+    long long count = 0;
+    for (int i=0; i < 3; ++i) {
+        state.invalidateAllCacheAtOrAbove(Stage::Acceleration);
+        count = countHeapAllocations(
+            [&] {system.realize(state, Stage::Acceleration);});
+    }
+    return count;
+}
+
+// A chain of pins whose tip is tied back to Ground with a ball constraint
+// if requested.
+void testChain(bool closeLoop) {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::Gravity(forces, matter, -YAxis, 9.8);
+    Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(.1,.2,.3)));
+    MobilizedBody* outer = &matter.Ground();
+    for (int i=0; i < 5; ++i) {
+        MobilizedBody::Ball link(*outer, Vec3(0,-.5,0), body, Vec3(0,.5,0));
+        outer = &matter.updMobilizedBody(link.getMobilizedBodyIndex());
+    }
+    if (closeLoop)
+        Constraint::Ball(matter.Ground(), Vec3(1,-1.5,0),
+                         *outer, Vec3(0,-.5,0));
+
+    // The default QTZ factorization allocates inside its solver.
+    matter.setUseCholeskyForMultipliers(true);
+
+    State state = system.realizeTopology();
+    Random::Uniform random(-1, 1);
+    for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] = random.getValue();
+    for (int i=0; i < state.getNU(); ++i) state.updU()[i] = random.getValue();
+    system.realize(state, Stage::Position);
+    system.projectQ(state, 1e-12);
+
+    const long long n = countAllocations(system, state);
+    cout << (closeLoop ? "loop" : "chain") << ": " << n
+         << " allocations per realize(Acceleration)" << endl;
+    SimTK_TEST(n == 0);
+    if (closeLoop)
+        SimTK_TEST_EQ_TOL(state.getUDotErr(),
+                          Vector(state.getNUDotErr(), 0.), 1e-10);
+}
+
+void testNoAllocations() {
+    // Make sure the counter sees allocations made inside the library.
+    SimTK_TEST(countHeapAllocations([] {Vector v(100);}) > 0);
+    testChain(false);
+    testChain(true);
+}
+
+int main() {
+    SimTK_START_TEST("TestOperatorAllocations");
+        SimTK_SUBTEST(testNoAllocations);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,159 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that evaluating constraint errors and constraint forces in parallel
+// blocks gives the same answers as the ordinary serial loop, and that the
+// parallel answers are reproducible.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+template <class T>
+static bool isIdentical(const Vector_<T>& a, const Vector_<T>& b) {
+    if (a.size() != b.size())
+        return false;
+    for (int i=0; i < a.size(); ++i)
+        if (a[i] != b[i])
+            return false;
+    return true;
+}
+
+// A lattice of particles joined by rods, some of them held in a plane, plus
+// a small tree with a loop whose Ancestor body is not Ground so that the
+// constraint forces have to be re-expressed.
+static void buildModel(MultibodySystem& system, SimbodyMatterSubsystem& matter,
+                       GeneralForceSubsystem& forces, int N)
+{
+    Force::Gravity(forces, matter, -YAxis, 9.8);
+    Body::Rigid particle(MassProperties(1, Vec3(0), UnitInertia(1)));
+
+    Array_<MobilizedBodyIndex> node;
+    for (int i=0; i < N; ++i)
+        for (int j=0; j < N; ++j)
+            node.push_back(MobilizedBody::Translation(matter.Ground(),
+                Vec3(i, j, 0), particle, Vec3(0)).getMobilizedBodyIndex());
+    for (int i=0; i < N; ++i)
+        for (int j=0; j < N; ++j) {
+            const int k = i*N + j;
+            MobilizedBody& here = matter.updMobilizedBody(node[k]);
+            if (i+1 < N) Constraint::Rod(here, Vec3(0),
+                matter.updMobilizedBody(node[k+N]), Vec3(0), 1);
+            if (j+1 < N) Constraint::Rod(here, Vec3(0),
+                matter.updMobilizedBody(node[k+1]), Vec3(0), 1);
+            if (i == 0) Constraint::PointInPlane(matter.updGround(),
+                UnitVec3(ZAxis), 0, here, Vec3(0));
+        }
+
+    Body::Rigid link(MassProperties(2, Vec3(0,-.5,0),
+                                    UnitInertia(.3,.1,.3)));
+    MobilizedBody::Free base(matter.Ground(), Vec3(-2,0,0), link, Vec3(0));
+    MobilizedBody::Pin left1(base, Vec3(-.2,0,0), link, Vec3(0,.5,0));
+    MobilizedBody::Pin left2(left1, Vec3(0,-.5,0), link, Vec3(0,.5,0));
+    MobilizedBody::Pin right1(base, Vec3(.2,0,0), link, Vec3(0,.5,0));
+    MobilizedBody::Pin right2(right1, Vec3(0,-.5,0), link, Vec3(0,.5,0));
+    Constraint::Rod(left2, Vec3(0,-.5,0), right2, Vec3(0,-.5,0), .4);
+}
+
+void testCompareToSerial() {
+    MultibodySystem serialSys, parallelSys;
+    SimbodyMatterSubsystem serial(serialSys), parallel(parallelSys);
+    GeneralForceSubsystem serialForces(serialSys), parallelForces(parallelSys);
+    buildModel(serialSys, serial, serialForces, 8);
+    buildModel(parallelSys, parallel, parallelForces, 8);
+    parallel.setNumberOfThreads(3);
+    parallel.setUseParallelConstraintEvaluation(true);
+    SimTK_TEST(parallel.getUseParallelConstraintEvaluation());
+    SimTK_TEST(!serial.getUseParallelConstraintEvaluation());
+
+    State ss = serialSys.realizeTopology();
+    State ps = parallelSys.realizeTopology();
+    Random::Uniform rand(-.1,.1);
+    for (int i=0; i < ss.getNQ(); ++i) ss.updQ()[i] += rand.getValue();
+    for (int i=0; i < ss.getNU(); ++i) ss.updU()[i] = rand.getValue();
+    ps.updQ() = ss.getQ();
+    ps.updU() = ss.getU();
+    serialSys.realize(ss, Stage::Acceleration);
+    parallelSys.realize(ps, Stage::Acceleration);
+
+    // Each Constraint writes its own errors so these must match exactly.
+    SimTK_TEST(isIdentical(ss.getQErr(), ps.getQErr()));
+    SimTK_TEST(isIdentical(ss.getUErr(), ps.getUErr()));
+
+    // Constraint forces are summed in a different order.
+    SimTK_TEST_EQ_TOL(ss.getMultipliers(), ps.getMultipliers(), 1e-10);
+    SimTK_TEST_EQ_TOL(ss.getUDot(), ps.getUDot(), 1e-10);
+    SimTK_TEST_EQ_TOL(ss.getUDotErr(), ps.getUDotErr(), 1e-10);
+
+    Vector lambda(ss.getNMultipliers());
+    for (int i=0; i < lambda.size(); ++i) lambda[i] = rand.getValue();
+    Vector_<SpatialVec> sBodyForces, pBodyForces;
+    Vector              sMobForces,  pMobForces;
+    serial.calcConstraintForcesFromMultipliers(ss, lambda,
+                                               sBodyForces, sMobForces);
+    parallel.calcConstraintForcesFromMultipliers(ps, lambda,
+                                                 pBodyForces, pMobForces);
+    SimTK_TEST_EQ_TOL(sBodyForces, pBodyForces, 1e-12);
+    SimTK_TEST_EQ_TOL(sMobForces, pMobForces, 1e-12);
+}
+
+// Repeating the parallel calculation must produce bitwise-identical results,
+// and it must be possible to switch back to serial evaluation at any time.
+void testReproducible() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildModel(system, matter, forces, 8);
+    matter.setNumberOfThreads(4);
+    matter.setUseParallelConstraintEvaluation(true);
+
+    State state = system.realizeTopology();
+    Random::Uniform rand(-.1,.1);
+    for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] += rand.getValue();
+    for (int i=0; i < state.getNU(); ++i) state.updU()[i] = rand.getValue();
+    State copy = state;
+    system.realize(state, Stage::Acceleration);
+    const Vector udot = state.getUDot();
+    const Vector mult = state.getMultipliers();
+    for (int i=0; i < 3; ++i) {
+        State again = copy;
+        system.realize(again, Stage::Acceleration);
+        SimTK_TEST(isIdentical(again.getUDot(), udot));
+        SimTK_TEST(isIdentical(again.getMultipliers(), mult));
+    }
+
+    matter.setUseParallelConstraintEvaluation(false);
+    system.realize(copy, Stage::Acceleration);
+    SimTK_TEST_EQ_TOL(copy.getUDot(), udot, 1e-10);
+}
+
+int main() {
+    SimTK_START_TEST("TestParallelConstraintEvaluation");
+        SimTK_SUBTEST(testCompareToSerial);
+        SimTK_SUBTEST(testReproducible);
+    SimTK_END_TEST();
+}
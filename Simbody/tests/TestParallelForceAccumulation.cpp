@@ -0,0 +1,258 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that parallel forces that report the bodies and mobilities they
+// affect are accumulated correctly, whether or not they are cached, mixed
+// with forces that don't report what they affect.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// A spring between two body origins that also pushes on the first mobility
+// of the first body. Optionally it is damped, so depends on velocities.
+class PairSpringImpl : public Force::Custom::Implementation {
+public:
+    PairSpringImpl(const MobilizedBody& body1, const MobilizedBody& body2,
+                   Real k, Real c, bool parallel, bool sparse)
+    :   body1(body1), body2(body2), k(k), c(c),
+        parallel(parallel), sparse(sparse) {}
+
+    void calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
+                   Vector_<Vec3>& particleForces,
+                   Vector& mobilityForces) const override {
+        const Vec3 r = body2.getBodyOriginLocation(state)
+                     - body1.getBodyOriginLocation(state);
+        Vec3 f = k*r;
+        if (c != 0)
+            f += c*(body2.getBodyOriginVelocity(state)
+                    - body1.getBodyOriginVelocity(state));
+        bodyForces[body1.getMobilizedBodyIndex()][1] += f;
+        bodyForces[body2.getMobilizedBodyIndex()][1] -= f;
+        mobilityForces[body1.getFirstUIndex(state)] += f.norm();
+    }
+    Real calcPotentialEnergy(const State& state) const override {
+        const Vec3 r = body2.getBodyOriginLocation(state)
+                     - body1.getBodyOriginLocation(state);
+        return k*r.normSqr()/2;
+    }
+    bool dependsOnlyOnPositions() const override {return c == 0;}
+    bool shouldBeParallelIfPossible() const override {return parallel;}
+    bool findAffectedBodiesAndMobilities
+       (const State& state, Array_<MobilizedBodyIndex>& bodies,
+        Array_<UIndex>& mobilities) const override {
+        if (!sparse)
+            return false;
+        bodies.push_back(body1.getMobilizedBodyIndex());
+        bodies.push_back(body2.getMobilizedBodyIndex());
+        mobilities.push_back(body1.getFirstUIndex(state));
+        return true;
+    }
+private:
+    const MobilizedBody& body1;
+    const MobilizedBody& body2;
+    Real k, c;
+    bool parallel, sparse;
+};
+
+// Reports a body that doesn't exist.
+class BadFootprintImpl : public Force::Custom::Implementation {
+public:
+    void calcForce(const State&, Vector_<SpatialVec>&, Vector_<Vec3>&,
+                   Vector&) const override {}
+    Real calcPotentialEnergy(const State&) const override {return 0;}
+    bool shouldBeParallelIfPossible() const override {return true;}
+    bool findAffectedBodiesAndMobilities
+       (const State&, Array_<MobilizedBodyIndex>& bodies,
+        Array_<UIndex>&) const override {
+        bodies.push_back(MobilizedBodyIndex(1000));
+        return true;
+    }
+};
+
+// Reports only its first body but pushes on its second one as well.
+class OutsideFootprintImpl : public Force::Custom::Implementation {
+public:
+    OutsideFootprintImpl(const MobilizedBody& body1, const MobilizedBody& body2)
+    :   body1(body1), body2(body2) {}
+    void calcForce(const State& state, Vector_<SpatialVec>& bodyForces, 
+                   Vector_<Vec3>&, Vector&) const override {
+        body1.applyBodyForce(state, SpatialVec(Vec3(0), Vec3(1,0,0)), 
+                             bodyForces);
+        body2.applyBodyForce(state, SpatialVec(Vec3(0), Vec3(-1,0,0)), 
+                             bodyForces);
+    }
+    Real calcPotentialEnergy(const State&) const override {return 0;}
+    bool shouldBeParallelIfPossible() const override {return true;}
+    bool findAffectedBodiesAndMobilities
+       (const State&, Array_<MobilizedBodyIndex>& bodies,
+        Array_<UIndex>&) const override {
+        bodies.push_back(body1.getMobilizedBodyIndex());
+        return true;
+    }
+private:
+    const MobilizedBody& body1;
+    const MobilizedBody& body2;
+};
+
+// A chain of ball-jointed bodies with springs between random pairs. If
+// allSerial is set, every spring is calculated in the non-parallel path.
+// Every fourth spring is damped; every fifth doesn't report what it affects.
+static void buildModel(MultibodySystem& system, SimbodyMatterSubsystem& matter,
+                       GeneralForceSubsystem& forces, bool allSerial,
+                       Array_<ForceIndex>& springs)
+{
+    const int NBodies = 30, NSprings = 120;
+    Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    MobilizedBody* parent = &matter.updGround();
+    for (int i=0; i < NBodies; ++i)
+        parent = &matter.updMobilizedBody(MobilizedBody::Ball(*parent,
+            Vec3(0,-1,0), body, Vec3(0)).getMobilizedBodyIndex());
+
+    Random::Uniform pick(0, NBodies); pick.setSeed(17);
+    for (int s=0; s < NSprings; ++s) {
+        const MobilizedBody& b1 =
+            matter.getMobilizedBody(MobilizedBodyIndex(1+pick.getIntValue()%NBodies));
+        const MobilizedBody& b2 =
+            matter.getMobilizedBody(MobilizedBodyIndex(1+pick.getIntValue()%NBodies));
+        const Real c = s%4 == 0 ? Real(.3) : Real(0);
+        springs.push_back(Force::Custom(forces,
+            new PairSpringImpl(b1, b2, 1+s%7, c, !allSerial && s%3 != 0,
+                               s%5 != 0)).getForceIndex());
+    }
+    Force::UniformGravity(forces, matter, Vec3(0,-9.8,0));
+}
+
+void testCompareToSerial() {
+    MultibodySystem serialSys, parallelSys;
+    SimbodyMatterSubsystem serial(serialSys), parallel(parallelSys);
+    GeneralForceSubsystem serialForces(serialSys), parallelForces(parallelSys);
+    Array_<ForceIndex> serialSprings, parallelSprings;
+    buildModel(serialSys, serial, serialForces, true, serialSprings);
+    buildModel(parallelSys, parallel, parallelForces, false, parallelSprings);
+    parallelForces.setNumberOfThreads(4);
+
+    State ss = serialSys.realizeTopology();
+    State ps = parallelSys.realizeTopology();
+    ss.updQ() += .5*Test::randVector(ss.getNQ());
+    ss.updU() = .5*Test::randVector(ss.getNU());
+    ps.updQ() = ss.getQ(); ps.updU() = ss.getU();
+
+    // Evaluate several times so that the cached position-only forces are
+    // reused after a velocity change, then disable some springs to change
+    // the layout of the parallel force results.
+    for (int pass=0; pass < 3; ++pass) {
+        for (int eval=0; eval < 2; ++eval) {
+            serialSys.realize(ss, Stage::Dynamics);
+            parallelSys.realize(ps, Stage::Dynamics);
+            SimTK_TEST_EQ_TOL(serialSys.getRigidBodyForces(ss, Stage::Dynamics),
+                    parallelSys.getRigidBodyForces(ps, Stage::Dynamics), 1e-12);
+            SimTK_TEST_EQ_TOL(serialSys.getMobilityForces(ss, Stage::Dynamics),
+                    parallelSys.getMobilityForces(ps, Stage::Dynamics), 1e-12);
+            ss.updU()[0] += .1; ps.updU()[0] += .1;
+        }
+
+        for (int s = pass; s < (int)serialSprings.size(); s += 7) {
+            const bool disable = !serialForces.isForceDisabled(ss,
+                                                       serialSprings[s]);
+            serialForces.setForceIsDisabled(ss, serialSprings[s], disable);
+            parallelForces.setForceIsDisabled(ps, parallelSprings[s], disable);
+        }
+    }
+}
+
+// With every parallel force reporting what it affects, the results are added
+// up in a fixed order so repeated evaluations must agree exactly.
+void testReproducible() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Array_<ForceIndex> springs;
+    buildModel(system, matter, forces, false, springs);
+    for (int s=0; s < (int)springs.size(); s += 5)
+        forces.updForce(springs[s]).setDisabledByDefault(true);
+    forces.setNumberOfThreads(4);
+
+    State state = system.realizeTopology();
+    state.updQ() += .5*Test::randVector(state.getNQ());
+    state.updU() = .5*Test::randVector(state.getNU());
+    State copy = state;
+    system.realize(state, Stage::Dynamics);
+    const Vector_<SpatialVec> F = system.getRigidBodyForces(state,
+                                                            Stage::Dynamics);
+    const Vector f = system.getMobilityForces(state, Stage::Dynamics);
+    for (int i=0; i < 5; ++i) {
+        State again = copy;
+        system.realize(again, Stage::Dynamics);
+        const Vector_<SpatialVec>& F2 =
+            system.getRigidBodyForces(again, Stage::Dynamics);
+        const Vector& f2 = system.getMobilityForces(again, Stage::Dynamics);
+        for (int b=0; b < F.size(); ++b)
+            SimTK_TEST(F2[b] == F[b]);
+        for (int u=0; u < f.size(); ++u)
+            SimTK_TEST(f2[u] == f[u]);
+    }
+}
+
+void testBadFootprint() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::Custom(forces, new BadFootprintImpl());
+    State state = system.realizeTopology();
+    SimTK_TEST_MUST_THROW(system.realize(state, Stage::Instance));
+}
+
+// A force that writes outside the footprint it reported must be caught
+// rather than have that part of its force silently dropped.
+void testOutsideFootprint() {
+    for (int numThreads : {1, 4}) {
+        MultibodySystem system;
+        SimbodyMatterSubsystem matter(system);
+        GeneralForceSubsystem forces(system);
+        Array_<ForceIndex> springs;
+        buildModel(system, matter, forces, false, springs);
+        Force::Custom(forces, new OutsideFootprintImpl(
+            matter.getMobilizedBody(MobilizedBodyIndex(3)),
+            matter.getMobilizedBody(MobilizedBodyIndex(7))));
+        forces.setNumberOfThreads(numThreads);
+        State state = system.realizeTopology();
+        state.updQ() += .5*Test::randVector(state.getNQ());
+        state.updU() = .5*Test::randVector(state.getNU());
+        system.realize(state, Stage::Velocity);
+        SimTK_TEST_MUST_THROW(system.realize(state, Stage::Dynamics));
+    }
+}
+
+int main() {
+    SimTK_START_TEST("TestParallelForceAccumulation");
+        SimTK_SUBTEST(testCompareToSerial);
+        SimTK_SUBTEST(testReproducible);
+        SimTK_SUBTEST(testBadFootprint);
+        SimTK_SUBTEST(testOutsideFootprint);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,175 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that built-in force elements calculated in parallel, scheduled in
+// chunks of about equal cost, give the same results as the serial
+// calculation as forces are enabled and disabled and the thread count
+// changes.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// A parallel custom force that pulls a body toward a point, claiming to be
+// much more expensive than a spring.
+class ExpensivePullImpl : public Force::Custom::Implementation {
+public:
+    ExpensivePullImpl(const MobilizedBody& body, Real cost)
+    :   body(body), cost(cost) {}
+    void calcForce(const State& state, Vector_<SpatialVec>& bodyForces,
+                   Vector_<Vec3>& particleForces,
+                   Vector& mobilityForces) const override {
+        bodyForces[body.getMobilizedBodyIndex()][1] -=
+            cost*body.getBodyOriginLocation(state);
+    }
+    Real calcPotentialEnergy(const State& state) const override {
+        return cost*body.getBodyOriginLocation(state).normSqr()/2;
+    }
+    bool shouldBeParallelIfPossible() const override {return true;}
+    Real getCostEstimate() const override {return cost;}
+private:
+    const MobilizedBody& body;
+    Real cost;
+};
+
+// A chain of ball-jointed bodies with a mix of built-in elements between
+// pseudo-randomly chosen pairs of distinct bodies.
+static void buildModel(MultibodySystem& system, SimbodyMatterSubsystem& matter,
+                       GeneralForceSubsystem& forces, Array_<ForceIndex>& elts)
+{
+    const int NBodies = 40, NElements = 400;
+    Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    MobilizedBody* parent = &matter.updGround();
+    for (int i=0; i < NBodies; ++i)
+        parent = &matter.updMobilizedBody(MobilizedBody::Ball(*parent,
+            Vec3(0,-1,0), body, Vec3(0)).getMobilizedBodyIndex());
+
+    Random::Uniform pick(0, NBodies); pick.setSeed(5);
+    for (int e=0; e < NElements; ++e) {
+        const int i1 = pick.getIntValue()%NBodies;
+        const int i2 = (i1 + 1 + pick.getIntValue()%(NBodies-1)) % NBodies;
+        const MobilizedBody& b1 = matter.getMobilizedBody(
+            MobilizedBodyIndex(1+i1));
+        const MobilizedBody& b2 = matter.getMobilizedBody(
+            MobilizedBodyIndex(1+i2));
+        switch (e % 8) {
+        case 0: elts.push_back(Force::TwoPointLinearSpring(forces,
+                    b1, Vec3(.1,0,0), b2, Vec3(0,.1,0), 3, .5)
+                    .getForceIndex()); break;
+        case 1: elts.push_back(Force::TwoPointLinearDamper(forces,
+                    b1, Vec3(0), b2, Vec3(0), .2).getForceIndex()); break;
+        case 2: elts.push_back(Force::TwoPointConstantForce(forces,
+                    b1, Vec3(0), b2, Vec3(0,0,.1), .5).getForceIndex()); break;
+        case 3: elts.push_back(Force::LinearBushing(forces, b1, b2,
+                    Vec6(1,2,3,4,5,6), Vec6(.1,.2,.3,.4,.5,.6))
+                    .getForceIndex()); break;
+        case 4: elts.push_back(Force::MobilityLinearSpring(forces, b1,
+                    MobilizerQIndex(e%3), 2, .1).getForceIndex()); break;
+        case 5: elts.push_back(Force::MobilityLinearDamper(forces, b1,
+                    MobilizerUIndex(e%3), .3).getForceIndex()); break;
+        case 6: elts.push_back(Force::ConstantForce(forces, b1, Vec3(.1),
+                    Vec3(0,1,0)).getForceIndex()); break;
+        case 7: elts.push_back(Force::Custom(forces,
+                    new ExpensivePullImpl(b1, 1+e%50)).getForceIndex()); break;
+        }
+    }
+    Force::Gravity(forces, matter, -YAxis, 9.8);
+}
+
+void testCompareToSerial() {
+    MultibodySystem serialSys, parallelSys;
+    SimbodyMatterSubsystem serial(serialSys), parallel(parallelSys);
+    GeneralForceSubsystem serialForces(serialSys), parallelForces(parallelSys);
+    Array_<ForceIndex> serialElts, parallelElts;
+    buildModel(serialSys, serial, serialForces, serialElts);
+    buildModel(parallelSys, parallel, parallelForces, parallelElts);
+    serialForces.setNumberOfThreads(1);
+    parallelForces.setNumberOfThreads(4);
+    parallelForces.setUseParallelBuiltInForces(true);
+    SimTK_TEST(parallelForces.getUseParallelBuiltInForces());
+    SimTK_TEST(!serialForces.getUseParallelBuiltInForces());
+
+    State ss = serialSys.realizeTopology();
+    State ps = parallelSys.realizeTopology();
+    ss.updQ() += .5*Test::randVector(ss.getNQ());
+    ss.updU() = .5*Test::randVector(ss.getNU());
+    ps.updQ() = ss.getQ(); ps.updU() = ss.getU();
+
+    for (int pass=0; pass < 4; ++pass) {
+        serialSys.realize(ss, Stage::Acceleration);
+        parallelSys.realize(ps, Stage::Acceleration);
+        SimTK_TEST_EQ_TOL(serialSys.getRigidBodyForces(ss, Stage::Dynamics),
+                    parallelSys.getRigidBodyForces(ps, Stage::Dynamics), 1e-12);
+        SimTK_TEST_EQ_TOL(serialSys.getMobilityForces(ss, Stage::Dynamics),
+                    parallelSys.getMobilityForces(ps, Stage::Dynamics), 1e-12);
+        SimTK_TEST_EQ_TOL(ss.getUDot(), ps.getUDot(), 1e-10);
+        SimTK_TEST_EQ_TOL(serialSys.calcPotentialEnergy(ss),
+                          parallelSys.calcPotentialEnergy(ps), 1e-10);
+
+        // Disabling forces changes the chunks; so does the thread count.
+        for (int e = pass; e < (int)serialElts.size(); e += 5) {
+            const bool disable = !serialForces.isForceDisabled(ss,
+                                                               serialElts[e]);
+            serialForces.setForceIsDisabled(ss, serialElts[e], disable);
+            parallelForces.setForceIsDisabled(ps, parallelElts[e], disable);
+        }
+        if (pass == 1) {
+            parallelForces.setNumberOfThreads(3);
+            ps.updU()[0] += .1; ss.updU()[0] += .1;
+        }
+    }
+}
+
+// Turning parallel built-in forces on and off must not change the answers
+// by more than roundoff.
+void testToggleParallelBuiltIns() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Array_<ForceIndex> elts;
+    buildModel(system, matter, forces, elts);
+    forces.setNumberOfThreads(2);
+
+    State state = system.realizeTopology();
+    state.updQ() += .5*Test::randVector(state.getNQ());
+    state.updU() = .5*Test::randVector(state.getNU());
+    system.realize(state, Stage::Acceleration);
+    const Vector udot = state.getUDot();
+
+    forces.setUseParallelBuiltInForces(true);
+    State pstate = system.realizeTopology();
+    pstate.updQ() = state.getQ(); pstate.updU() = state.getU();
+    system.realize(pstate, Stage::Acceleration);
+    SimTK_TEST_EQ_TOL(pstate.getUDot(), udot, 1e-10);
+}
+
+int main() {
+    SimTK_START_TEST("TestParallelForceScheduling");
+        SimTK_SUBTEST(testCompareToSerial);
+        SimTK_SUBTEST(testToggleParallelBuiltIns);
+    SimTK_END_TEST();
+}
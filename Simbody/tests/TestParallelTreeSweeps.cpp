@@ -0,0 +1,161 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that the parallel tree sweeps produce exactly the same answers as
+// the ordinary serial ones, on trees that get partitioned in different ways.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// We expect bitwise-identical results, not just agreement to a tolerance.
+template <class T>
+static bool isIdentical(const Vector_<T>& a, const Vector_<T>& b) {
+    if (a.size() != b.size())
+        return false;
+    for (int i=0; i < a.size(); ++i)
+        if (a[i] != b[i])
+            return false;
+    return true;
+}
+
+// Add a chain of pins of the given length to parent, with an occasional side
+// branch so that the subtrees aren't all simple chains.
+static void addChain(MobilizedBody& parent, const Body& body, int length) {
+    MobilizedBody* outer = &parent;
+    for (int i=0; i < length; ++i) {
+        MobilizedBody::Pin pin(*outer, Vec3(0,-.5,0), body, Vec3(0,.5,0));
+        if (i % 3 == 1)
+            MobilizedBody::Ball(pin, Vec3(.2,0,0), body, Vec3(0,.3,0));
+        outer = &pin.updMatterSubsystem().updMobilizedBody(pin.getMobilizedBodyIndex());
+    }
+}
+
+// Either many branches off Ground, or a single free base body carrying all
+// the branches, which forces the partitioner to split below the base.
+static void buildModel(MultibodySystem& system, SimbodyMatterSubsystem& matter,
+                       GeneralForceSubsystem& forces,
+                       bool singleBase, int nBranches, int length)
+{
+    Force::Gravity(forces, matter, -YAxis, 9.8);
+    Body::Rigid body(MassProperties(1.5, Vec3(.1,.2,0), 
+                                    UnitInertia(.3,.2,.1,.01,.02,.03)));
+    if (singleBase) {
+        MobilizedBody::Free base(matter.Ground(), body);
+        for (int b=0; b < nBranches; ++b)
+            addChain(base, body, length);
+    } else {
+        for (int b=0; b < nBranches; ++b) {
+            MobilizedBody::Free base(matter.Ground(), Vec3(b,0,0), 
+                                     body, Vec3(0));
+            addChain(base, body, length);
+        }
+    }
+}
+
+static void compareSweeps(bool singleBase) {
+    MultibodySystem serialSys, parallelSys;
+    SimbodyMatterSubsystem serial(serialSys), parallel(parallelSys);
+    GeneralForceSubsystem serialForces(serialSys), parallelForces(parallelSys);
+    buildModel(serialSys, serial, serialForces, singleBase, 7, 5);
+    buildModel(parallelSys, parallel, parallelForces, singleBase, 7, 5);
+    parallel.setNumberOfThreads(3);
+    parallel.setUseParallelTreeSweeps(true);
+    SimTK_TEST(parallel.getUseParallelTreeSweeps());
+    SimTK_TEST(!serial.getUseParallelTreeSweeps());
+    SimTK_TEST(parallel.getNumberOfThreads() == 3);
+
+    State ss = serialSys.realizeTopology();
+    State ps = parallelSys.realizeTopology();
+    Random::Uniform rand(-1,1);
+    for (int i=0; i < ss.getNQ(); ++i) ss.updQ()[i] = rand.getValue();
+    for (int i=0; i < ss.getNU(); ++i) ss.updU()[i] = rand.getValue();
+    ps.updQ() = ss.getQ();
+    ps.updU() = ss.getU();
+    serialSys.realize(ss, Stage::Acceleration);
+    parallelSys.realize(ps, Stage::Acceleration);
+
+    for (MobilizedBodyIndex mbx(0); mbx < serial.getNumBodies(); ++mbx) {
+        const MobilizedBody& smb = serial.getMobilizedBody(mbx);
+        const MobilizedBody& pmb = parallel.getMobilizedBody(mbx);
+        SimTK_TEST(smb.getBodyTransform(ss).p() 
+                   == pmb.getBodyTransform(ps).p());
+        SimTK_TEST(smb.getBodyVelocity(ss) == pmb.getBodyVelocity(ps));
+        SimTK_TEST(smb.getBodyAcceleration(ss) 
+                   == pmb.getBodyAcceleration(ps));
+    }
+    SimTK_TEST(isIdentical(ss.getUDot(), ps.getUDot()));
+    SimTK_TEST(isIdentical(ss.getQDotDot(), ps.getQDotDot()));
+
+    Vector f(ss.getNU()), sMInvf, pMInvf, sMf, pMf;
+    for (int i=0; i < f.size(); ++i) f[i] = rand.getValue();
+    serial.multiplyByMInv(ss, f, sMInvf);
+    parallel.multiplyByMInv(ps, f, pMInvf);
+    SimTK_TEST(isIdentical(sMInvf, pMInvf));
+    serial.multiplyByM(ss, f, sMf);
+    parallel.multiplyByM(ps, f, pMf);
+    SimTK_TEST(isIdentical(sMf, pMf));
+
+    Vector sResidual, pResidual;
+    serial.calcResidualForceIgnoringConstraints(ss, f, 
+        Vector_<SpatialVec>(), ss.getUDot(), sResidual);
+    parallel.calcResidualForceIgnoringConstraints(ps, f, 
+        Vector_<SpatialVec>(), ps.getUDot(), pResidual);
+    SimTK_TEST(isIdentical(sResidual, pResidual));
+}
+
+void testManyBranchesOffGround() {
+    compareSweeps(false);
+}
+
+void testSingleFreeBase() {
+    compareSweeps(true);
+}
+
+// Changing the number of threads after realizeTopology() must cause the
+// tree to be repartitioned.
+void testChangeNumberOfThreads() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildModel(system, matter, forces, false, 4, 3);
+    matter.setUseParallelTreeSweeps(true);
+    system.realizeTopology();
+    matter.setNumberOfThreads(2);
+    SimTK_TEST(!system.systemTopologyHasBeenRealized());
+    State state = system.realizeTopology();
+    system.realize(state, Stage::Acceleration);
+    SimTK_TEST(state.getUDot().norm() > 0);
+}
+
+int main() {
+    SimTK_START_TEST("TestParallelTreeSweeps");
+        SimTK_SUBTEST(testManyBranchesOffGround);
+        SimTK_SUBTEST(testSingleFreeBase);
+        SimTK_SUBTEST(testChangeNumberOfThreads);
+    SimTK_END_TEST();
+}
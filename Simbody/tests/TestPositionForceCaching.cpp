@@ -0,0 +1,197 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that the GeneralForceSubsystem's cache of position-only forces, and
+// of the position-only parts of damped built-in force elements, gives the
+// same forces as calculating each element from scratch, that it is discarded
+// when a force parameter changes, and that it can be reused when the
+// configuration is revisited.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+const int NBodies = 8;
+
+// A chain of pin- and ball-jointed bodies with a damped bushing, limit stop,
+// spring and array element on each.
+struct Model {
+    Model() : matter(system), forces(system) {
+        Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+        MobilizedBody* parent = &matter.updGround();
+        for (int i=0; i < NBodies; ++i) {
+            if (i % 2)
+                parent = &matter.updMobilizedBody(MobilizedBody::Ball(*parent,
+                    Vec3(0,-1,0), body, Vec3(0)).getMobilizedBodyIndex());
+            else
+                parent = &matter.updMobilizedBody(MobilizedBody::Pin(*parent,
+                    Vec3(0,-1,0), body, Vec3(0)).getMobilizedBodyIndex());
+        }
+        springs = Force::LinearSpringArray(forces, matter);
+        bushings = Force::BushingArray(forces, matter);
+        for (MobilizedBodyIndex bx(1); bx <= NBodies; ++bx) {
+            const MobilizedBody& mobod = matter.getMobilizedBody(bx);
+            const MobilizedBody& other =
+                matter.getMobilizedBody(MobilizedBodyIndex(bx % NBodies + 1));
+            Force::LinearBushing(forces, mobod, other,
+                                 Vec6(1+bx), Vec6(.1*bx));
+            springs.addSpring(mobod, Vec3(.1,0,0), other, Vec3(0,.1,0),
+                              2, .5, bx%2 ? .3 : 0);
+            bushings.addBushing(mobod, other, Vec6(3), Vec6(bx%2 ? .2 : 0));
+            if (bx % 2 == 0) { // pins only
+                Force::MobilityLinearStop(forces, mobod, MobilizerQIndex(0),
+                                          50, .5, -.2, .2);
+                spring = Force::MobilityLinearSpring(forces, mobod,
+                                                     MobilizerQIndex(0), 4, 0);
+                Force::MobilityConstantForce(forces, mobod,
+                                             MobilizerUIndex(0), .7);
+            }
+        }
+        gravity = Force::Gravity(forces, matter, -YAxis, 9.8);
+    }
+
+    // Sum the forces produced by each element's unsplit calcForce().
+    void calcReference(const State& state, Vector_<SpatialVec>& bodyForces,
+                       Vector& mobilityForces) const {
+        bodyForces.resize(matter.getNumBodies()); bodyForces.setToZero();
+        mobilityForces.resize(state.getNU()); mobilityForces.setToZero();
+        Vector_<SpatialVec> b; Vector_<Vec3> p; Vector m;
+        for (ForceIndex fx(0); fx < forces.getNumForces(); ++fx) {
+            forces.getForce(fx).calcForceContribution(state, b, p, m);
+            bodyForces += b; mobilityForces += m;
+        }
+    }
+
+    void checkForces(const State& state) const {
+        system.realize(state, Stage::Dynamics);
+        Vector_<SpatialVec> bodyForces; Vector mobilityForces;
+        calcReference(state, bodyForces, mobilityForces);
+        SimTK_TEST_EQ_TOL(system.getRigidBodyForces(state, Stage::Dynamics),
+                          bodyForces, 1e-12);
+        SimTK_TEST_EQ_TOL(system.getMobilityForces(state, Stage::Dynamics),
+                          mobilityForces, 1e-12);
+    }
+
+    MultibodySystem             system;
+    SimbodyMatterSubsystem      matter;
+    GeneralForceSubsystem       forces;
+    Force::LinearSpringArray    springs;
+    Force::BushingArray         bushings;
+    Force::MobilityLinearSpring spring;
+    Force::Gravity              gravity;
+};
+
+// Changing only the velocities reuses the cached position-only parts; the
+// result must still match a calculation from scratch, serial or parallel.
+void testVelocityChanges(bool parallel) {
+    Model model;
+    if (parallel) {
+        model.forces.setNumberOfThreads(3);
+        model.forces.setUseParallelBuiltInForces(true);
+    }
+    State state = model.system.realizeTopology();
+    state.updQ() += .5*Test::randVector(state.getNQ());
+    state.updU() = .5*Test::randVector(state.getNU());
+    model.checkForces(state);
+    for (int i=0; i < state.getNU(); ++i) {
+        state.updU()[i] -= .3;
+        model.checkForces(state);
+    }
+    // Disabling an element discards the cache.
+    model.spring.disable(state);
+    model.checkForces(state);
+    model.spring.enable(state);
+    model.checkForces(state);
+}
+
+// Changing a Dynamics-stage parameter of a position-only force doesn't
+// invalidate Stage::Position, so the setter must discard the cache.
+void testParameterChanges() {
+    Model model;
+    State state = model.system.realizeTopology();
+    state.updQ() += .5*Test::randVector(state.getNQ());
+    state.updU() = .5*Test::randVector(state.getNU());
+    model.checkForces(state);
+
+    model.spring.setStiffness(state, 40);
+    model.checkForces(state);
+    model.spring.setQZero(state, .1);
+    model.checkForces(state);
+    model.gravity.setMagnitude(state, 3);
+    model.checkForces(state);
+}
+
+// With reuse enabled, writing back the same q keeps the cache, so Gravity
+// isn't evaluated again; a different q or time recalculates it.
+void testReuseAtSameConfiguration() {
+    Model model;
+    SimTK_TEST(!model.forces.getReuseCachedForcesAtSameConfiguration());
+    model.forces.setReuseCachedForcesAtSameConfiguration(true);
+    SimTK_TEST(model.forces.getReuseCachedForcesAtSameConfiguration());
+
+    State state = model.system.realizeTopology();
+    state.updQ() += .5*Test::randVector(state.getNQ());
+    state.updU() = .5*Test::randVector(state.getNU());
+    // The reference forces evaluate Gravity themselves, so count the
+    // evaluations made by realize() alone.
+    long long nEvals = 0;
+    auto realizeAndCount = [&]() {
+        const long long before = model.gravity.getNumEvaluations();
+        model.system.realize(state, Stage::Dynamics);
+        nEvals = model.gravity.getNumEvaluations() - before;
+        model.checkForces(state);
+    };
+    realizeAndCount();
+    SimTK_TEST(nEvals == 1);
+
+    const Vector q = state.getQ();
+    state.updQ() = q; state.updU()[0] += .2;
+    realizeAndCount();
+    SimTK_TEST(nEvals == 0);
+
+    state.updQ()[0] += .01;
+    realizeAndCount();
+    SimTK_TEST(nEvals == 1);
+
+    state.setTime(state.getTime() + .1);
+    realizeAndCount();
+    SimTK_TEST(nEvals == 1);
+
+    // A parameter change must still be seen at the same configuration.
+    state.updQ() = Vector(state.getQ());
+    model.spring.setStiffness(state, 17);
+    model.checkForces(state);
+}
+
+int main() {
+    SimTK_START_TEST("TestPositionForceCaching");
+        SimTK_SUBTEST1(testVelocityChanges, false);
+        SimTK_SUBTEST1(testVelocityChanges, true);
+        SimTK_SUBTEST(testParameterChanges);
+        SimTK_SUBTEST(testReuseAtSameConfiguration);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,132 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// The position and velocity kinematics sweeps regroup each level of the tree
+// so that mobilizers of the same concrete type are handed to one batch kernel
+// together. Check that this gives exactly the same kinematics as visiting the
+// nodes one at a time in tree order, which is what the parallel sweeps do, for
+// levels in which many mobilizer types are interleaved.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+const int NTypes = 18;
+
+// Add a mobilized body of the given kind with non-trivial frames.
+static MobilizedBodyIndex addBody(int type, MobilizedBody& parent, 
+                                  const Body& body) {
+    const Transform X_PF(Rotation(.3, XAxis), Vec3(.1,-.5,0));
+    const Transform X_BM(Rotation(-.2, ZAxis), Vec3(0,.5,.05));
+    const MobilizedBody::Direction rev = MobilizedBody::Reverse;
+    switch (type) {
+    case 0:  return MobilizedBody::Pin(parent, X_PF, body, X_BM);
+    case 1:  return MobilizedBody::Slider(parent, X_PF, body, X_BM);
+    case 2:  return MobilizedBody::Ball(parent, X_PF, body, X_BM);
+    case 3:  return MobilizedBody::Free(parent, X_PF, body, X_BM);
+    case 4:  return MobilizedBody::Universal(parent, X_PF, body, X_BM);
+    case 5:  return MobilizedBody::Cylinder(parent, X_PF, body, X_BM);
+    case 6:  return MobilizedBody::Gimbal(parent, X_PF, body, X_BM);
+    case 7:  return MobilizedBody::Planar(parent, X_PF, body, X_BM);
+    case 8:  return MobilizedBody::Screw(parent, X_PF, body, X_BM, .2);
+    case 9:  return MobilizedBody::Translation(parent, X_PF, body, X_BM);
+    case 10: return MobilizedBody::BendStretch(parent, X_PF, body, X_BM);
+    case 11: return MobilizedBody::Ellipsoid(parent, X_PF, body, X_BM, 
+                                             Vec3(.3,.2,.1));
+    case 12: return MobilizedBody::SphericalCoords(parent, X_PF, body, X_BM);
+    case 13: return MobilizedBody::Bushing(parent, X_PF, body, X_BM);
+    case 14: return MobilizedBody::Weld(parent, X_PF, body, X_BM);
+    case 15: return MobilizedBody::Pin(parent, X_PF, body, X_BM, rev);
+    case 16: return MobilizedBody::Ball(parent, X_PF, body, X_BM, rev);
+    default: return MobilizedBody::Free(parent, X_PF, body, X_BM, rev);
+    }
+}
+
+// Pairs of branches share a type at each level, so each level has short runs
+// of the same type separated by other types.
+static void buildModel(SimbodyMatterSubsystem& matter) {
+    const int NBranches = 12, Length = 6;
+    Body::Rigid body(MassProperties(1.5, Vec3(.1,.2,0), 
+                                    UnitInertia(.3,.2,.1,.01,.02,.03)));
+    for (int b=0; b < NBranches; ++b) {
+        MobilizedBody* outer = &matter.updGround();
+        for (int i=0; i < Length; ++i) {
+            const int type = (b/2 + 5*i) % NTypes;
+            outer = &matter.updMobilizedBody(addBody(type, *outer, body));
+        }
+    }
+}
+
+static void compareKinematics(bool useEulerAngles) {
+    MultibodySystem groupedSys, nodeSys;
+    SimbodyMatterSubsystem grouped(groupedSys), byNode(nodeSys);
+    buildModel(grouped); buildModel(byNode);
+    byNode.setNumberOfThreads(3);
+    byNode.setUseParallelTreeSweeps(true);
+
+    State gs = groupedSys.realizeTopology();
+    State ns = nodeSys.realizeTopology();
+    grouped.setUseEulerAngles(gs, useEulerAngles);
+    byNode.setUseEulerAngles(ns, useEulerAngles);
+    groupedSys.realizeModel(gs);
+    nodeSys.realizeModel(ns);
+    gs.updQ() = Test::randVector(gs.getNQ());
+    gs.updU() = Test::randVector(gs.getNU());
+    ns.updQ() = gs.getQ(); ns.updU() = gs.getU();
+    groupedSys.realize(gs, Stage::Velocity);
+    nodeSys.realize(ns, Stage::Velocity);
+
+    for (MobilizedBodyIndex mbx(0); mbx < grouped.getNumBodies(); ++mbx) {
+        const MobilizedBody& g = grouped.getMobilizedBody(mbx);
+        const MobilizedBody& n = byNode.getMobilizedBody(mbx);
+        SimTK_TEST(g.getBodyTransform(gs).p() == n.getBodyTransform(ns).p());
+        SimTK_TEST(g.getBodyTransform(gs).R().asMat33() 
+                   == n.getBodyTransform(ns).R().asMat33());
+        SimTK_TEST(g.getBodyVelocity(gs) == n.getBodyVelocity(ns));
+        SimTK_TEST(g.getMobilizerTransform(gs).p() 
+                   == n.getMobilizerTransform(ns).p());
+    }
+    for (int i=0; i < gs.getNQ(); ++i)
+        SimTK_TEST(gs.getQDot()[i] == ns.getQDot()[i]);
+    for (int i=0; i < gs.getNQErr(); ++i)
+        SimTK_TEST(gs.getQErr()[i] == ns.getQErr()[i]);
+}
+
+void testMixedTypesQuaternions() {
+    compareKinematics(false);
+}
+
+void testMixedTypesEulerAngles() {
+    compareKinematics(true);
+}
+
+int main() {
+    SimTK_START_TEST("TestTypeGroupedKinematics");
+        SimTK_SUBTEST(testMixedTypesQuaternions);
+        SimTK_SUBTEST(testMixedTypesEulerAngles);
+    SimTK_END_TEST();
+}
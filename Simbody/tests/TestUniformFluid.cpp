@@ -0,0 +1,167 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors: agent                                                             *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check the buoyancy, drag, and region handling of Force::UniformFluid, and
+// that it gives the same answers when calculated in parallel.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+const Real Mass = 2, Density = 1000, Volume = Mass/Density, G = 9.8;
+
+// A neutrally buoyant body at rest feels no net force; giving it a velocity
+// relative to the fluid produces drag as specified.
+void testSingleBody() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Body::Rigid body(MassProperties(Mass, Vec3(0), UnitInertia(1)));
+    MobilizedBody::Free mobod(matter.updGround(), body);
+    Force::Gravity gravity(forces, matter, -YAxis, G);
+    Force::UniformFluid fluid(forces, matter, gravity, Density);
+    const Vec6 cl(1,2,3,4,5,6), cq(.1,.2,.3,.4,.5,.6);
+    SimTK_TEST(fluid.addBody(mobod, Volume, Vec3(0), cl, cq) == 0);
+    SimTK_TEST(fluid.getNumBodies() == 1);
+
+    State state = system.realizeTopology();
+    mobod.setQToFitTranslation(state, Vec3(1,2,3));
+    system.realize(state, Stage::Acceleration);
+    SimTK_TEST_EQ(mobod.getBodyAcceleration(state), SpatialVec(Vec3(0)));
+    SimTK_TEST_EQ(fluid.calcPotentialEnergyContribution(state),
+                  Density*Volume*G*-2);
+    SimTK_TEST_EQ(system.calcPotentialEnergy(state), 0);
+
+    // A body at rest in a flowing fluid is dragged along with it.
+    const Vec3 v_f(.5,-.25,2);
+    fluid.setFlowVelocity(state, v_f);
+    SimTK_TEST_EQ(fluid.getFlowVelocity(state), v_f);
+    system.realize(state, Stage::Dynamics);
+    Vec3 f;
+    for (int k=0; k < 3; ++k)
+        f[k] = (cl[k+3] + cq[k+3]*std::abs(v_f[k]))*v_f[k];
+    SimTK_TEST_EQ(system.getRigidBodyForces(state, Stage::Dynamics)[1],
+                  SpatialVec(Vec3(0), f));
+
+    // Spinning and moving with the fluid: drag moment only.
+    mobod.setUToFitAngularVelocity(state, Vec3(1,-2,3));
+    mobod.setUToFitLinearVelocity(state, v_f);
+    system.realize(state, Stage::Dynamics);
+    const Vec3 w(1,-2,3);
+    Vec3 m;
+    for (int k=0; k < 3; ++k)
+        m[k] = -(cl[k] + cq[k]*std::abs(w[k]))*w[k];
+    SimTK_TEST_EQ(system.getRigidBodyForces(state, Stage::Dynamics)[1],
+                  SpatialVec(m, Vec3(0)));
+
+    // Doubling the density leaves a net upward force of m g.
+    fluid.setDensity(state, 2*Density);
+    SimTK_TEST_EQ(fluid.getDensity(state), 2*Density);
+    system.realize(state, Stage::Dynamics);
+    SimTK_TEST_EQ(system.getRigidBodyForces(state, Stage::Dynamics)[1][1],
+                  Vec3(0, Mass*G, 0));
+
+    // A body excluded from gravity is not buoyant either.
+    gravity.setBodyIsExcluded(state, mobod, true);
+    system.realize(state, Stage::Dynamics);
+    SimTK_TEST_EQ(system.getRigidBodyForces(state, Stage::Dynamics)[1][1],
+                  Vec3(0));
+}
+
+// Build a row of free bodies along x with an off-center buoyancy station.
+static void buildSwarm(SimbodyMatterSubsystem& matter,
+                       GeneralForceSubsystem& forces,
+                       Force::UniformFluid& fluid, int n) {
+    Body::Rigid body(MassProperties(Mass, Vec3(0), UnitInertia(1)));
+    Force::Gravity gravity(forces, matter, -YAxis, G);
+    fluid = Force::UniformFluid(forces, matter, gravity, Density);
+    for (int i=0; i < n; ++i) {
+        MobilizedBody::Free mobod(matter.updGround(), Vec3(i,0,0),
+                                  body, Vec3(0));
+        fluid.addBody(mobod, Volume*(1+.1*i), Vec3(0,.1,.05),
+                      Vec6(.1*i), Vec6(.05));
+    }
+}
+
+// Only bodies whose center of buoyancy is inside the region feel the fluid,
+// and the forces are the same calculated serially or in parallel.
+void testRegionAndParallel() {
+    const int N = 20;
+    MultibodySystem serialSys, parallelSys;
+    SimbodyMatterSubsystem serial(serialSys), parallel(parallelSys);
+    GeneralForceSubsystem serialForces(serialSys), parallelForces(parallelSys);
+    Force::UniformFluid serialFluid, parallelFluid;
+    buildSwarm(serial, serialForces, serialFluid, N);
+    buildSwarm(parallel, parallelForces, parallelFluid, N);
+    parallelForces.setNumberOfThreads(3);
+    parallelForces.setUseParallelBuiltInForces(true);
+
+    State ss = serialSys.realizeTopology();
+    State ps = parallelSys.realizeTopology();
+    ss.updQ() += .5*Test::randVector(ss.getNQ());
+    ss.updU() = .5*Test::randVector(ss.getNU());
+    ps.updQ() = ss.getQ(); ps.updU() = ss.getU();
+    serialSys.realize(ss, Stage::Position);
+    SimTK_TEST(serialFluid.getNumBodiesInRegion(ss) == N);
+
+    const Vec3 low(4.5,-Infinity,-Infinity), high(12.5,Infinity,Infinity);
+    serialFluid.setRegion(ss, low, high);
+    parallelFluid.setRegion(ps, low, high);
+    Vec3 l, h; serialFluid.getRegion(ss, l, h);
+    SimTK_TEST(l == low && h == high);
+
+    for (int pass=0; pass < 2; ++pass) {
+        serialSys.realize(ss, Stage::Acceleration);
+        parallelSys.realize(ps, Stage::Acceleration);
+        int nInside = 0;
+        for (MobilizedBodyIndex bx(1); bx <= N; ++bx) {
+            const MobilizedBody& mobod = serial.getMobilizedBody(bx);
+            const Real x = mobod.findStationLocationInGround
+                                (ss, Vec3(0,.1,.05))[0];
+            const bool inside = low[0] <= x && x <= high[0];
+            SimTK_TEST(serialFluid.isBodyInRegion(ss, bx-1) == inside);
+            if (inside) {++nInside; continue;}
+            // Outside the region only gravity acts.
+            SimTK_TEST_EQ(mobod.getBodyAcceleration(ss)[1], Vec3(0,-G,0));
+        }
+        SimTK_TEST(serialFluid.getNumBodiesInRegion(ss) == nInside);
+        SimTK_TEST(0 < nInside && nInside < N);
+        SimTK_TEST_EQ_TOL(serialSys.getRigidBodyForces(ss, Stage::Dynamics),
+                    parallelSys.getRigidBodyForces(ps, Stage::Dynamics), 1e-12);
+        SimTK_TEST_EQ_TOL(ss.getUDot(), ps.getUDot(), 1e-10);
+
+        // A velocity change reuses the cached buoyancy.
+        ss.updU()[0] += .1; ps.updU()[0] += .1;
+    }
+}
+
+int main() {
+    SimTK_START_TEST("TestUniformFluid");
+        SimTK_SUBTEST(testSingleBody);
+        SimTK_SUBTEST(testRegionAndParallel);
+    SimTK_END_TEST();
+}